@@ -1,4 +1,429 @@
 #include "supermarket_simulator_program_3.h"
+#include <csignal>
+
+// Set by Ctrl+C to stop the register server
+static atomic<bool> bServerStop(false);
+
+// Set by SIGHUP to reload the register server's store file
+static atomic<bool> bServerReload(false);
+
+/*********************************************************************
+static void stopServer(int iSignal)
+Purpose:
+    Signal handler that asks the register server to stop
+Parameters:
+    I   int iSignal     Signal received
+Return Value:
+    -
+Notes:
+    Only stores to a lock-free atomic, which is safe in a handler
+*********************************************************************/
+static void stopServer(int)
+{
+    bServerStop.store(true, memory_order_relaxed);
+}
+
+/*********************************************************************
+static void reloadServer(int iSignal)
+Purpose:
+    Signal handler that asks the register server to reload its store
+Parameters:
+    I   int iSignal     Signal received
+Return Value:
+    -
+Notes:
+    See stopServer
+*********************************************************************/
+static void reloadServer(int)
+{
+    bServerReload.store(true, memory_order_relaxed);
+}
+
+/*********************************************************************
+int runCommandLineMode(int argc, char* argv[])
+Purpose:
+    Run one of the non-interactive modes selected on the command line
+Parameters:
+    I   int argc        Number of command line arguments
+    I   char* argv[]    Command line arguments
+Return Value:
+    Program exit code
+Notes:
+    See the Command Parameters section of main for the modes
+*********************************************************************/
+int runCommandLineMode(int argc, char* argv[])
+{
+    cout << fixed << setprecision(2);
+    string szMode = argv[1];
+
+    if (szMode == "--replay" && argc == 4)
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+
+        displayReplayStats(replayTransactions(market, argv[3]));
+        displayTotalFunds(market);
+        return 0;
+    }
+
+    if (szMode == "--lanes" && (argc == 4 || argc == 5))
+    {
+        Supermarket market;
+        vector<Basket> basketsVec;
+        long long lMalformed = 0;
+        if (!loadSupermarketFile(argv[2], market) ||
+            !loadTransactionFile(argv[3], basketsVec, lMalformed))
+        {
+            return -1;
+        }
+
+        int iMaxLanes = argc == 5 ? atoi(argv[4]) : (int)thread::hardware_concurrency();
+        cout << basketsVec.size() << " baskets loaded, " << lMalformed << " malformed" << endl;
+        displayLaneScaling(market, basketsVec, iMaxLanes);
+        return 0;
+    }
+
+    if (szMode == "--simulate" && argc >= 4 && argc <= 6)
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+
+        SimulationConfig config;
+        config.iCustomers = atoi(argv[3]);
+        config.iLanes = argc >= 5 ? atoi(argv[4]) : max((int)market.employeesVec.size(), 1);
+        config.lSeed = argc == 6 ? strtoull(argv[5], nullptr, 10) : 1;
+        displaySimulationResults(runStoreSimulation(market, config));
+        return 0;
+    }
+
+    if (szMode == "--chain" && argc >= 3 && argc <= 6)
+    {
+        vector<ChainStoreSpec> storesVec;
+        if (!loadChainList(argv[2], storesVec))
+        {
+            return -1;
+        }
+
+        ChainConfig config;
+        config.iWorkers = argc >= 4 ? atoi(argv[3]) : (int)thread::hardware_concurrency();
+        config.simulation.iCustomers = argc >= 5 ? atoi(argv[4]) : config.simulation.iCustomers;
+        config.simulation.lSeed = argc == 6 ? strtoull(argv[5], nullptr, 10) : 1;
+        displayChainTotals(runChain(storesVec, config));
+        return 0;
+    }
+
+    if (szMode == "--stats" && argc >= 4 && argc <= 6)
+    {
+        Supermarket market;
+        vector<Basket> basketsVec;
+        long long lMalformed = 0;
+        if (!loadSupermarketFile(argv[2], market) ||
+            !loadTransactionFile(argv[3], basketsVec, lMalformed))
+        {
+            return -1;
+        }
+
+        int iLanes = argc >= 5 ? atoi(argv[4]) : (int)thread::hardware_concurrency();
+        MultiLaneStats stats = runMultiLaneCheckout(market, basketsVec, max(iLanes, 1));
+        cout << stats.lTransactions << " baskets on " << stats.iLanes << " lanes" << endl;
+        displayLedgerStats(stats);
+        displayPerformanceStats();
+        if (argc == 6 && !dumpPerformanceStats(argv[5]))
+        {
+            cout << argv[5] << ": stats could not be written" << endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    if (szMode == "--restock" && argc >= 4 && argc <= 6)
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+        displayReplayStats(replayTransactions(market, argv[3]));
+
+        RestockConfig config;
+        config.dReorderDays = argc >= 5 ? atof(argv[4]) : config.dReorderDays;
+        config.dTargetDays = argc == 6 ? atof(argv[5]) : config.dTargetDays;
+        RestockPlan plan = planRestock(market, config);
+        displayRestockPlan(plan, 20);
+        if (!applyRestock(market, plan))
+        {
+            cout << "Insufficient funds" << endl;
+            return -1;
+        }
+        displayTotalFunds(market);
+        return 0;
+    }
+
+    if (szMode == "--export" && (argc == 5 || argc == 6))
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+        if (argc == 6)
+        {
+            replayTransactions(market, argv[5]);
+        }
+
+        if (!exportReport(market, argv[3], argv[4]))
+        {
+            cout << argv[4] << ": " << argv[3] << " report could not be written" << endl;
+            return -1;
+        }
+        cout << "Report written to " << argv[4] << endl;
+        return 0;
+    }
+
+    if (szMode == "--bench-display" && (argc == 3 || argc == 4))
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+
+        benchmarkDisplay(market, argc == 4 ? atoi(argv[3]) : 2000);
+        return 0;
+    }
+
+    if (szMode == "--bench-members" && argc == 3)
+    {
+        benchmarkMembers(atoi(argv[2]));
+        return 0;
+    }
+
+    if (szMode == "--bench-inventory" && argc == 3)
+    {
+        benchmarkInventory(atoi(argv[2]));
+        return 0;
+    }
+
+    if (szMode == "--snapshot" && argc == 4)
+    {
+        Supermarket market;
+        StoreFileError error;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+        if (!saveStoreSnapshot(market, argv[3], error))
+        {
+            cout << argv[3] << ": " << error.szMessage << endl;
+            return -1;
+        }
+
+        cout << "Snapshot saved to " << argv[3] << endl;
+        return 0;
+    }
+
+    if (szMode == "--bench-snapshot" && (argc == 3 || argc == 4))
+    {
+        benchmarkSnapshot(argv[2], argc == 4 ? atoi(argv[3]) : 5);
+        return 0;
+    }
+
+    if (szMode == "--bench-journal" && (argc == 4 || argc == 5))
+    {
+        benchmarkJournal(argv[2], argv[3], argc == 5 ? atoi(argv[4]) : 1);
+        return 0;
+    }
+
+    if (szMode == "--bench-money" && argc == 3)
+    {
+        benchmarkMoney(atoi(argv[2]));
+        return 0;
+    }
+
+    if (szMode == "--bench-payroll" && argc >= 3 && argc <= 5)
+    {
+        benchmarkPayroll(atoi(argv[2]), argc >= 4 ? atoi(argv[3]) : (int)thread::hardware_concurrency(),
+                         argc == 5 ? argv[4] : "");
+        return 0;
+    }
+
+    if (szMode == "--generate" && (argc == 5 || argc == 6))
+    {
+        GeneratorConfig config;
+        config.lSeed = argc == 6 ? strtoull(argv[5], nullptr, 10) : 1;
+        if (!getGeneratorScale(argv[4], config))
+        {
+            cout << "Unknown scale " << argv[4] << endl;
+            return -1;
+        }
+        if (!generateStoreFile(config, argv[2]) || !generateTransactionFile(config, argv[3]))
+        {
+            cout << "Could not write the generated files" << endl;
+            return -1;
+        }
+
+        cout << "Generated " << config.iAisles << " aisles of " << config.iItemsPerAisle << " items, "
+             << config.iEmployees << " employees, " << config.iMembers << " members and "
+             << config.iCustomers << " customers" << endl;
+        return 0;
+    }
+
+    if (szMode == "--bench-suite" && argc >= 3 && argc <= 5)
+    {
+        benchmarkSuite(argv[2], argc >= 4 ? argv[3] : "small,medium,large",
+                       argc == 5 ? strtoull(argv[4], nullptr, 10) : 1);
+        return 0;
+    }
+
+    if (szMode == "--bench-chain" && (argc == 4 || argc == 5))
+    {
+        benchmarkChain(argv[2], atoi(argv[3]), argc == 5 ? atoi(argv[4]) : (int)thread::hardware_concurrency());
+        return 0;
+    }
+
+    if (szMode == "--bench-export" && argc == 4)
+    {
+        benchmarkExport(argv[2], argv[3]);
+        return 0;
+    }
+
+    if (szMode == "--bench-restock" && argc == 4)
+    {
+        benchmarkRestock(argv[2], argv[3]);
+        return 0;
+    }
+
+    if (szMode == "--bench-pricing" && argc == 3)
+    {
+        benchmarkPricing(atoi(argv[2]));
+        return 0;
+    }
+
+    if (szMode == "--bench-analytics" && argc == 3)
+    {
+        benchmarkAnalytics(atoi(argv[2]));
+        return 0;
+    }
+
+    if (szMode == "--serve" && argc == 4)
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market) || !attachJournal(market, argv[2], false))
+        {
+            return -1;
+        }
+
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        signal(SIGHUP, reloadServer);
+        cout << "Serving registers on " << argv[3] << ", Ctrl+C to stop, SIGHUP to reload "
+             << argv[2] << endl;
+        PosServerStats stats;
+        if (!runPosServer(market, argv[3], bServerStop, bServerReload, argv[2], stats))
+        {
+            return -1;
+        }
+        displayPosServerStats(stats);
+        displayTotalFunds(market);
+        return 0;
+    }
+
+    if (szMode == "--load" && (argc == 5 || argc == 6 || argc == 7))
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+
+        PosLoadConfig config;
+        config.szAddress = argv[3];
+        config.iTerminals = atoi(argv[4]);
+        config.iBasketsPerTerminal = argc >= 6 ? atoi(argv[5]) : config.iBasketsPerTerminal;
+        config.lSeed = argc == 7 ? strtoull(argv[6], nullptr, 10) : config.lSeed;
+        displayPosLoadResult(config, runPosLoad(market, config));
+        return 0;
+    }
+
+    if (szMode == "--bench-reload" && (argc == 3 || argc == 4))
+    {
+        benchmarkReload(argv[2], argc == 4 ? atoi(argv[3]) : 5);
+        return 0;
+    }
+
+    if (szMode == "--bench-server" && (argc == 4 || argc == 5))
+    {
+        benchmarkServer(argv[2], atoi(argv[3]), argc == 5 ? atoi(argv[4]) : 5);
+        return 0;
+    }
+
+    if (szMode == "--mine" && argc >= 4 && argc <= 6)
+    {
+        Supermarket market;
+        if (!loadSupermarketFile(argv[2], market))
+        {
+            return -1;
+        }
+
+        displayReplayStats(replayTransactions(market, argv[3]));
+        BasketMiningConfig config;
+        config.dMinSupport = argc >= 5 ? atof(argv[4]) / 100.0 : config.dMinSupport;
+        config.iThreads = argc == 6 ? atoi(argv[5]) : 0;
+        displayLineItemLog(market.lineItems);
+        displayBasketMining(market, mineBasketPairs(market, config));
+        return 0;
+    }
+
+    if (szMode == "--bench-mining" && (argc == 5 || argc == 6))
+    {
+        int iMaxThreads = argc == 6 ? atoi(argv[5]) : (int)thread::hardware_concurrency();
+        benchmarkMining(argv[2], argv[3], atoi(argv[4]), iMaxThreads);
+        return 0;
+    }
+
+    if (szMode == "--bench-loader" && (argc == 3 || argc == 4))
+    {
+        benchmarkLoader(argv[2], argc == 4 ? atoi(argv[3]) : 5);
+        return 0;
+    }
+
+    cout << "Usage: " << argv[0] << " [--replay <store file> <transaction file>]" << endl;
+    cout << "       " << argv[0] << " [--lanes <store file> <transaction file> [max lanes]]" << endl;
+    cout << "       " << argv[0] << " [--simulate <store file> <customers> [lanes] [seed]]" << endl;
+    cout << "       " << argv[0] << " [--chain <chain list file> [workers] [customers] [seed]]" << endl;
+    cout << "       " << argv[0] << " [--stats <store file> <transaction file> [lanes] [stats file]]" << endl;
+    cout << "       " << argv[0] << " [--restock <store file> <transaction file> [reorder days] [target days]]" << endl;
+    cout << "       " << argv[0] << " [--export <store file> <report> <report file> [transaction file]]" << endl;
+    cout << "       " << argv[0] << " [--bench-display <store file> [iterations]]" << endl;
+    cout << "       " << argv[0] << " [--bench-members <members>]" << endl;
+    cout << "       " << argv[0] << " [--bench-inventory <items>]" << endl;
+    cout << "       " << argv[0] << " [--bench-loader <store file> [iterations]]" << endl;
+    cout << "       " << argv[0] << " [--snapshot <store file> <snapshot file>]" << endl;
+    cout << "       " << argv[0] << " [--bench-snapshot <store file> [iterations]]" << endl;
+    cout << "       " << argv[0] << " [--bench-journal <store file> <transaction file> [lanes]]" << endl;
+    cout << "       " << argv[0] << " [--bench-money <lines>]" << endl;
+    cout << "       " << argv[0] << " [--bench-payroll <employees> [max threads] [ledger file]]" << endl;
+    cout << "       " << argv[0] << " [--generate <store file> <transaction file> <scale> [seed]]" << endl;
+    cout << "       " << argv[0] << " [--bench-suite <directory> [scales] [seed]]" << endl;
+    cout << "       " << argv[0] << " [--bench-chain <directory> <stores> [max workers]]" << endl;
+    cout << "       " << argv[0] << " [--bench-export <directory> <scale>]" << endl;
+    cout << "       " << argv[0] << " [--bench-restock <directory> <scale>]" << endl;
+    cout << "       " << argv[0] << " [--bench-pricing <baskets>]" << endl;
+    cout << "       " << argv[0] << " [--bench-analytics <lines>]" << endl;
+    cout << "       " << argv[0] << " [--serve <store file> <port | unix:path>]" << endl;
+    cout << "       " << argv[0] << " [--load <store file> <port | unix:path> <terminals> [baskets] [seed]]" << endl;
+    cout << "       " << argv[0] << " [--bench-server <store file> <terminals> [baskets]]" << endl;
+    cout << "       " << argv[0] << " [--bench-reload <store file> [reloads]]" << endl;
+    cout << "       " << argv[0] << " [--mine <store file> <transaction file> [min support %] [threads]]" << endl;
+    cout << "       " << argv[0] << " [--bench-mining <directory> <scale> <baskets> [max threads]]" << endl;
+    return -1;
+}
 
 
 /*********************************************************************
@@ -9,19 +434,115 @@ Date: 10/15/2024
 Purpose:
     Extend the supermarket simulation from program 2.
 Command Parameters:
-    -
+    --replay <store file> <transaction file>
+        Replay a transaction file through the checkout engine
+        without any prompts, then print replay statistics.
+    --lanes <store file> <transaction file> [max lanes]
+        Check out the transaction file on 1 up to max lanes (threads)
+        sharing one store and report throughput scaling. Max lanes
+        defaults to the number of cores.
+    --simulate <store file> <customers> [lanes] [seed]
+        Simulate a trading day with the discrete-event engine. Lanes
+        default to one per employee.
+    --chain <chain list file> [workers] [customers] [seed]
+        Run every store in the list on its own Supermarket, sharded
+        across worker threads pinned to cores, then pay each store's
+        staff and print per-store results and chain totals. Each list
+        line is a store file and optionally a transaction file to
+        replay, otherwise the store simulates a day of customers.
+        Workers default to the number of cores.
+    --stats <store file> <transaction file> [lanes] [stats file]
+        Check out the transaction file on the lanes and print the count
+        and p50/p90/p99 latency of each hot path, writing them to the
+        stats file too if given. Lanes default to the number of cores.
+    --restock <store file> <transaction file> [reorder days] [target days]
+        Replay the transaction file as one trading day, then order
+        every item with less than reorder days of stock (default 3)
+        up to target days (default 7) at wholesale and apply it.
+    --export <store file> <report> <report file> [transaction file]
+        Write the inventory, transactions, sales or payroll report as
+        CSV, or JSON if the report file ends in .json. The transaction
+        file, if given, is replayed first.
+    --bench-display <store file> [iterations]
+        Time the display functions against the old by-value versions.
+    --bench-members <members>
+        Time member registry inserts and lookups and report memory
+        per member.
+    --bench-inventory <items>
+        Time the column inventory kernels against loops over the aisles.
+    --bench-loader <store file> [iterations]
+        Time the mapped store file loader against the old stream loader.
+    --snapshot <store file> <snapshot file>
+        Load a store (text or snapshot) and save it as a binary snapshot.
+    --bench-snapshot <store file> [iterations]
+        Time saving and restoring a snapshot against loading the text file.
+    --bench-journal <store file> <transaction file> [lanes]
+        Time checkout with the transaction journal off and on, then check
+        that replaying the journal rebuilds the store. Lanes default to 1.
+    --bench-money <lines>
+        Time whole-cent Money against doubles and show which totals
+        change with the number of lanes.
+    --bench-payroll <employees> [max threads] [ledger file]
+        Time the payroll engine on a generated roster for each policy
+        on 1 up to max threads, then time writing the payout ledger.
+    --generate <store file> <transaction file> <scale> [seed]
+        Write a synthetic store and transaction file. Scale is small,
+        medium, large or aisles,items per aisle,employees,members,customers.
+        The same seed always writes the same files. Seed defaults to 1.
+    --bench-suite <directory> [scales] [seed]
+        Generate a store at each comma separated scale (counts separated
+        by ':') in the directory and print CSV timings, throughput and
+        peak memory for the main store operations. Scales default to
+        small,medium,large.
+    --bench-chain <directory> <stores> [max workers]
+        Generate a chain of medium stores in the directory and time it
+        on 1 up to max workers, checking the chain totals never change.
+    --bench-export <directory> <scale>
+        Generate a store at the scale, replay its transactions and time
+        every report in both formats.
+    --bench-restock <directory> <scale>
+        Generate a store at the scale, replay its transactions and time
+        the restock tracker against rescanning every item.
+    --bench-pricing <baskets>
+        Time pricing baskets of every customer tier with the tier
+        policies against choosing the price on every line.
+    --bench-analytics <lines>
+        Time the best seller sketches on a skewed stream of sales lines
+        and compare their answers with exact counts.
+    --serve <store file> <port | unix:path>
+        Serve register terminals over local TCP or a Unix socket until
+        Ctrl+C. Checkouts are journaled like the console's. SIGHUP
+        reloads the store file without pausing the terminals.
+    --load <store file> <port | unix:path> <terminals> [baskets] [seed]
+        Play many register terminals against a running server and
+        report sessions per second and request latency.
+    --bench-server <store file> <terminals> [baskets]
+        Run the server and the load generator in one process over a
+        Unix socket.
+    --bench-reload <store file> [reloads]
+        Check out baskets while the store file is reloaded in the
+        background, against reloading it in place, with and without
+        a journal.
+    --mine <store file> <transaction file> [min support %] [threads]
+        Replay a transaction file, then list the items bought together
+        from its line item log.
+    --bench-mining <directory> <scale> <baskets> [max threads]
+        Log synthetic baskets against a generated store and time mining
+        them for item pairs on 1 up to max threads.
+    No parameters starts the interactive simulation.
 Input:
-    Path to supermarket text files.
+    Path to supermarket text files or .snap snapshots. Changes made
+    after loading are journaled to the same path with .journal added
+    and replayed the next time that file is loaded.
     Various user input menu choices and market purchases.
 Results:
     Simulates supermarket operations.
 Notes:
     -
 *********************************************************************/
-int main()
+int main(int argc, char* argv[])
 {
     cout << fixed << setprecision(2);
-    fstream fileSupermarketInput;
     fstream fileDataIO;
     string szAdminPassword = "minimart";
     string szTemp;
@@ -37,19 +558,33 @@ int main()
         "Exit program"
     };
 
-    string szAdminMenuChoicesArr[6] = {
+    string szAdminMenuChoicesArr[15] = {
         "Update supermarket information",
         "Display total funds",
         "Display total sales",
         "Pay employees",
         "Update employee password",
+        "Save store snapshot",
+        "Load store snapshot",
+        "Display sales breakdown",
+        "Run payroll",
+        "Export report",
+        "Performance stats",
+        "Restock planner",
+        "Best sellers",
+        "Basket pairs",
         "Exit admin menu"
     };
 
+    if (argc > 1)
+    {
+        return runCommandLineMode(argc, argv);
+    }
+
     cout << "Starting supermarket simulation\n" << endl;
 
     Supermarket marketA;
-    processSupermarketInformation(fileSupermarketInput, marketA);
+    processSupermarketInformation(marketA);
 
     int iChoice;
     int iAdminChoice;
@@ -86,9 +621,7 @@ int main()
             }
             case 4:
             {
-                marketA.customersArr[marketA.iCurrentCustomers] = checkout(marketA);
-                if(marketA.customersArr[marketA.iCurrentCustomers].szName != "")
-                    marketA.iCurrentCustomers += 1;
+                checkout(marketA);
                 break;
             }
             case 5:
@@ -108,7 +641,7 @@ int main()
                     iAttempts = 0;
                     do
                     {
-                        displayMenu("\nEmployee Menu", szAdminMenuChoicesArr, 6);
+                        displayMenu("\nEmployee Menu", szAdminMenuChoicesArr, 15);
                         
                         if(cout << "\nEnter choice: " && !(cin >> iAdminChoice)) 
                         {
@@ -121,7 +654,7 @@ int main()
                             case 1:
                             {
                                 cin.ignore();
-                                processSupermarketInformation(fileSupermarketInput, marketA);
+                                processSupermarketInformation(marketA);
                                 break;
                             }
                             case 2:
@@ -156,6 +689,53 @@ int main()
                                 iAdminChoice = -1;
                                 break;
                             }
+                            case 6:
+                            {
+                                cin.ignore();
+                                processSnapshotSave(marketA);
+                                break;
+                            }
+                            case 7:
+                            {
+                                cin.ignore();
+                                processSnapshotLoad(marketA);
+                                break;
+                            }
+                            case 8:
+                            {
+                                displaySalesAggregates(marketA);
+                                break;
+                            }
+                            case 9:
+                            {
+                                processPayroll(marketA);
+                                break;
+                            }
+                            case 10:
+                            {
+                                processReportExport(marketA);
+                                break;
+                            }
+                            case 11:
+                            {
+                                processPerformanceStats();
+                                break;
+                            }
+                            case 12:
+                            {
+                                processRestock(marketA);
+                                break;
+                            }
+                            case 13:
+                            {
+                                processBestSellers(marketA);
+                                break;
+                            }
+                            case 14:
+                            {
+                                processBasketMining(marketA);
+                                break;
+                            }
                             default:
                                 cout << "Please choose a valid menu choice" << endl;
                             
@@ -2,25 +2,238 @@
 #include <iomanip>
 #include <fstream>
 #include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
+#include <random>
+#include <queue>
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <charconv>
+#include <string_view>
 
 using namespace std;
 
 inline string szBreakMessage = "*****************************\n";
-inline double dSALES_TAX = 0.08; 
+// Sales tax in hundredths of a percent, 800 is 8%
+inline const int64_t iSALES_TAX_BASIS_POINTS = 800;
+
+// Amount of money in whole cents. Adding cents is exact, so totals never
+// drift and come out the same in any order and on any number of lanes.
+struct Money
+{
+    int64_t iCents = 0;
+
+    constexpr Money() = default;
+    constexpr explicit Money(int64_t iCentsIn) : iCents(iCentsIn) {}
+
+    constexpr Money& operator+=(Money other) { iCents += other.iCents; return *this; }
+    constexpr Money& operator-=(Money other) { iCents -= other.iCents; return *this; }
+    constexpr Money operator+(Money other) const { return Money(iCents + other.iCents); }
+    constexpr Money operator-(Money other) const { return Money(iCents - other.iCents); }
+    constexpr Money operator*(int64_t iQuantity) const { return Money(iCents * iQuantity); }
+    constexpr auto operator<=>(const Money& other) const = default;
+};
+
+// Bump allocator that owns all of one store's container storage.
+// Memory is only returned when the last container using it goes away.
+class StoreArena
+{
+public:
+    StoreArena() = default;
+    StoreArena(const StoreArena&) = delete;
+    StoreArena& operator=(const StoreArena&) = delete;
+
+    void* allocate(size_t iBytes, size_t iAlign);
+    size_t bytesReserved() const;   // Bytes held in blocks
+    size_t bytesUsed() const;       // Bytes handed out, including abandoned storage
+
+private:
+    mutable mutex arenaLock;                // Lanes may grow containers concurrently
+    vector<unique_ptr<char[]>> blocksVec;   // Blocks owned by the arena
+    char* pNext = nullptr;                  // Next free byte in the current block
+    char* pEnd = nullptr;                   // End of the current block
+    size_t iNextBlockBytes = 4096;          // Size of the next block, doubles up to 1 MB
+    size_t iReserved = 0;
+    size_t iUsed = 0;
+};
+
+// Growable array whose storage comes from a StoreArena. Growing moves
+// the elements to a larger block and leaves the old block to the arena.
+// A container without an arena creates its own on first use, so a
+// copy owns its storage and never keeps the original's arena alive.
+// Supermarket copies the same way, into one fresh arena.
+template <typename T>
+class ArenaVector
+{
+public:
+    ArenaVector() = default;
+    explicit ArenaVector(shared_ptr<StoreArena> pArenaIn) : pArena(std::move(pArenaIn)) {}
+
+    ArenaVector(const ArenaVector& other)
+    {
+        copyFrom(other);
+    }
+
+    ArenaVector(ArenaVector&& other) noexcept
+        : pArena(std::move(other.pArena)), pData(other.pData), iSize(other.iSize), iCapacity(other.iCapacity)
+    {
+        other.pData = nullptr;
+        other.iSize = 0;
+        other.iCapacity = 0;
+    }
+
+    ArenaVector& operator=(const ArenaVector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ArenaVector& operator=(ArenaVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            // Elements must go before the arena reference they live in
+            clear();
+            pArena = std::move(other.pArena);
+            pData = other.pData;
+            iSize = other.iSize;
+            iCapacity = other.iCapacity;
+            other.pData = nullptr;
+            other.iSize = 0;
+            other.iCapacity = 0;
+        }
+        return *this;
+    }
+
+    ~ArenaVector()
+    {
+        clear();
+    }
+
+    size_t size() const { return iSize; }
+    size_t capacity() const { return iCapacity; }
+    bool empty() const { return iSize == 0; }
+    T& operator[](size_t i) { return pData[i]; }
+    const T& operator[](size_t i) const { return pData[i]; }
+    T* begin() { return pData; }
+    T* end() { return pData + iSize; }
+    const T* begin() const { return pData; }
+    const T* end() const { return pData + iSize; }
+    T& back() { return pData[iSize - 1]; }
+    const T& back() const { return pData[iSize - 1]; }
+    const shared_ptr<StoreArena>& arena() const { return pArena; }
+
+    void reserve(size_t iNewCapacity)
+    {
+        if (iNewCapacity > iCapacity)
+        {
+            T* pNewData = allocateStorage(iNewCapacity);
+            moveInto(pNewData);
+            pData = pNewData;
+            iCapacity = iNewCapacity;
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (iSize < iCapacity)
+        {
+            new (pData + iSize) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            // Build the new element first, args may refer to an element
+            size_t iNewCapacity = max<size_t>(iCapacity * 2, 4);
+            T* pNewData = allocateStorage(iNewCapacity);
+            new (pNewData + iSize) T(std::forward<Args>(args)...);
+            moveInto(pNewData);
+            pData = pNewData;
+            iCapacity = iNewCapacity;
+        }
+        return pData[iSize++];
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void clear()
+    {
+        for (size_t i = 0; i < iSize; i++)
+        {
+            pData[i].~T();
+        }
+        iSize = 0;
+    }
+
+private:
+    shared_ptr<StoreArena> pArena;  // Arena the storage comes from
+    T* pData = nullptr;             // Elements
+    size_t iSize = 0;               // Elements in use
+    size_t iCapacity = 0;           // Elements that fit in pData
+
+    T* allocateStorage(size_t iElements)
+    {
+        if (!pArena)
+        {
+            pArena = make_shared<StoreArena>();
+        }
+        return static_cast<T*>(pArena->allocate(iElements * sizeof(T), alignof(T)));
+    }
+
+    void moveInto(T* pNewData)
+    {
+        for (size_t i = 0; i < iSize; i++)
+        {
+            new (pNewData + i) T(std::move(pData[i]));
+            pData[i].~T();
+        }
+    }
+
+    void copyFrom(const ArenaVector& other)
+    {
+        reserve(other.iSize);
+        for (size_t i = 0; i < other.iSize; i++)
+        {
+            new (pData + i) T(other.pData[i]);
+        }
+        iSize = other.iSize;
+    }
+};
 
 struct Item
 {
     string szName;          // Name of the item
     int iQuantity = 30;     // Number of items left in stock
-    double dWholesale;      // Supermarket's cost
-    double dRegularPrice;   // Price for regular customers
-    double dMembersPrice;   // Price for store members
+    Money mWholesale;       // Supermarket's cost
+    Money mRegularPrice;    // Price for regular customers
+    Money mMembersPrice;    // Price for store members
+    int iSKU = 0;           // Stock keeping unit number, unique in the store
 };
 
 struct Aisle
 {
-    string szName = "";          // Name of store aisle
-    Item itemArr[100];      // Array of items on that aisle
+    string szName = "";             // Name of store aisle
+    ArenaVector<Item> itemVec;      // Items on that aisle
+
+    Aisle() = default;
+    explicit Aisle(const shared_ptr<StoreArena>& pArena) : itemVec(pArena) {}
 };
 
 struct CustomerPurchase
@@ -28,7 +241,7 @@ struct CustomerPurchase
     string szName = "";             // Name of person who made purchase
     bool bBoughtMembership = false; // Bought membership on the purchase
     int iNumberItems = 0;           // Number of items they purchased 
-    double dPurchaseCost = 0.0;     // How much did the purchase cost including tax
+    Money mPurchaseCost;            // How much did the purchase cost including tax
     
 };
 
@@ -37,41 +250,1124 @@ struct Member
     string szName = "";         // Name of person who bought membership
 };
 
+struct MemberRegistry
+{
+    vector<Member> membersVec;      // Members in sign-up order
+    vector<uint64_t> hashVec;       // Hash of each member name, same order
+    vector<uint32_t> slotsVec;      // Open-addressing table of member index + 1
+    vector<uint64_t> bloomVec;      // Bloom filter bits for fast negatives
+};
+
 struct Employee
 {
     string szID;                // ID of the employee
     string szName;              // Name of the employee
-    double dSalary;             // Salary of the employee
+    Money mSalary;              // Salary of the employee
+};
+
+struct ItemLocation
+{
+    int iAisleIndex = -1;   // Aisle the item is on
+    int iItemIndex = -1;    // Slot of the item on the aisle
+};
+
+struct CatalogEntry
+{
+    ItemLocation location;      // Aisle and slot of the item
+    int iSKU = 0;               // SKU of the item
+    uint64_t iNameHash = 0;     // Hash of the normalized item name
+};
+
+struct CatalogIndex
+{
+    vector<CatalogEntry> entriesVec;    // Every named item in aisle order
+    vector<uint64_t> nameSlotsVec;      // Table by name, high hash bits << 32 | entry index + 1, 0 is empty
+    vector<uint64_t> skuSlotsVec;       // Table by SKU, SKU << 32 | entry index + 1, 0 is empty
+};
+
+// Sales for one hour of the day or one aisle
+struct SalesBucket
+{
+    long long lCount = 0;           // Checkouts for an hour, basket lines for an aisle
+    long long lItems = 0;           // Items sold
+    Money mSales;                   // Item sales before tax
+    Money mProfit;                  // Item sales minus their wholesale cost
+};
+
+// Running sales totals, updated as each checkout is committed
+struct SalesAggregates
+{
+    long long lCheckouts = 0;       // Checkouts committed
+    long long lItems = 0;           // Items sold
+    Money mGrossSales;              // Paid by customers including tax
+    Money mTaxCollected;            // Sales tax, passed on and not kept
+    Money mMembershipFees;          // Membership fees paid
+    Money mCostOfGoods;             // Wholesale cost of the items sold
+    Money mProfit;                  // Item profit plus membership fees
+    SalesBucket hourArr[24];        // By local hour of day at commit
+    vector<SalesBucket> aisleVec;   // By aisle index, only as long as the last aisle sold from
+};
+
+struct RestockHeapNode
+{
+    double dCover = 0.0;        // Stock over units sold, lowest first
+    uint32_t iEntry = 0;        // Catalog entry of the item
+};
+
+// Items ordered by how long their stock lasts at the rate they sell.
+// Updated as each sale is committed, so finding what is running out
+// never rescans the aisles.
+struct RestockTracker
+{
+    vector<RestockHeapNode> heapVec;    // Binary min-heap by cover
+    vector<uint32_t> positionVec;       // Heap position of each catalog entry
+    vector<long long> soldVec;          // Units sold per catalog entry since tracking began
+    bool bHeapStale = false;            // Covers out of date, rebuilt before the heap is next read
+};
+
+struct HeavyHitter
+{
+    uint32_t iKey = 0;              // SKU or aisle index
+    uint64_t iCount = 0;            // Estimated units, never below the true count
+    uint64_t iError = 0;            // Most the estimate can be over
+};
+
+// Space-Saving summary of the heaviest keys in a weighted stream.
+// Keeps a fixed number of counters in a min-heap with a hash table
+// from key to counter, storage is made on the first add.
+class SpaceSavingSketch
+{
+public:
+    explicit SpaceSavingSketch(size_t iCapacityIn) : iCapacity(iCapacityIn) {}
+
+    void add(uint32_t iKey, uint64_t iWeight);
+    void clear();
+    vector<HeavyHitter> top(size_t iCount) const;
+    vector<HeavyHitter> counters() const;
+    void restore(const HeavyHitter* pHitters, size_t iHitters);
+    size_t capacity() const { return iCapacity; }
+    size_t memoryBytes() const;
+
+private:
+    struct Counter
+    {
+        uint64_t iCount;        // Estimated weight of the key
+        uint64_t iError;        // Weight inherited from the key it replaced
+        uint32_t iKey;
+        uint32_t iSlot;         // Table slot pointing at this counter
+    };
+
+    size_t findSlot(uint32_t iKey) const;
+    void placeCounter(size_t iPosition, const Counter& counter);
+    void siftDown(size_t iPosition);
+    void eraseSlot(size_t iSlot);
+
+    size_t iCapacity;
+    vector<Counter> heapVec;        // Min-heap by count
+    vector<uint32_t> slotsVec;      // Open-addressing table of heap position + 1, 0 is empty
+};
+
+// Count-Min sketch of a weighted stream. Estimates are never below
+// the true count and over it by at most 2.7 times total / width in
+// nearly all cases. Storage is made on the first add.
+class CountMinSketch
+{
+public:
+    CountMinSketch(size_t iWidthIn, size_t iDepthIn) : iWidth(iWidthIn), iDepth(iDepthIn) {}
+
+    void add(uint32_t iKey, uint64_t iWeight);
+    uint64_t estimate(uint32_t iKey) const;
+    void clear();
+    bool restore(const uint64_t* pCounts, size_t iCounts);
+    const vector<uint64_t>& counts() const { return countsVec; }
+    size_t width() const { return iWidth; }
+    size_t memoryBytes() const;
+
+private:
+    size_t iWidth;                  // Counters per row, a power of two
+    size_t iDepth;                  // Rows, each with its own hash
+    vector<uint64_t> countsVec;     // Rows one after another
+};
+
+// Sketches of the units sold in one window of time
+struct SalesWindowSketches
+{
+    SpaceSavingSketch topItems{1024};           // Best selling SKUs
+    SpaceSavingSketch topAisles{128};           // Best selling aisles
+    CountMinSketch itemUnits{8192, 4};          // Units per SKU
+    CountMinSketch aisleUnits{512, 4};          // Units per aisle
+    uint64_t iUnits = 0;                        // Units counted in the window
+    int iHour = -1;                             // Hour of day for an hourly window
+};
+
+// Streaming best-seller analytics, fed by every committed line. Memory
+// is fixed whatever the number of transactions.
+struct SalesAnalytics
+{
+    SalesWindowSketches hourWindow;     // Current hour of day, cleared when the hour changes
+    SalesWindowSketches dayWindow;      // Everything since the store was loaded
+};
+
+// Fixed block of line item columns
+struct LineItemChunk
+{
+    static const size_t iLINES = 16384;     // Lines in one chunk
+    int32_t skuArr[iLINES];                 // Item sold
+    int32_t quantityArr[iLINES];            // Units sold
+    int64_t unitCentsArr[iLINES];           // Unit price charged, in cents
+};
+
+// Checkout lines of one trading day in columns. Lines are appended a
+// chunk at a time, so stored lines never move as the day grows.
+struct LineItemDay
+{
+    int iDay = 0;                           // Days since 1 Jan 1970, local time
+    size_t iLines = 0;                      // Lines stored
+    vector<LineItemChunk*> chunksVec;       // Chunks in line order, the last may be part full
+    vector<uint32_t> basketEndVec;          // One past the last line of each basket
+    vector<uint8_t> tierVec;                // PricingTier of each basket
+
+    int sku(size_t iLine) const { return chunksVec[iLine / LineItemChunk::iLINES]->skuArr[iLine % LineItemChunk::iLINES]; }
+    int quantity(size_t iLine) const { return chunksVec[iLine / LineItemChunk::iLINES]->quantityArr[iLine % LineItemChunk::iLINES]; }
+    Money unitPrice(size_t iLine) const { return Money(chunksVec[iLine / LineItemChunk::iLINES]->unitCentsArr[iLine % LineItemChunk::iLINES]); }
+    size_t basketStart(size_t iBasket) const { return iBasket == 0 ? 0 : basketEndVec[iBasket - 1]; }
+};
+
+// Append-only log of every committed checkout line, by day. Chunks come
+// from a StoreArena, and like an ArenaVector a copy gets its own arena.
+class LineItemLog
+{
+public:
+    LineItemLog() = default;
+    explicit LineItemLog(shared_ptr<StoreArena> pArenaIn) : pArena(std::move(pArenaIn)) {}
+    LineItemLog(const LineItemLog& other) { appendLog(other); }
+    LineItemLog(LineItemLog&&) noexcept = default;
+    LineItemLog& operator=(const LineItemLog& other);
+    LineItemLog& operator=(LineItemLog&&) noexcept = default;
+
+    void beginBasket(int iDay, uint8_t iTier);
+    void appendLine(int iSKU, int iQuantity, Money mUnitPrice);
+    void appendLog(const LineItemLog& other);
+    const vector<LineItemDay>& days() const { return daysVec; }
+    long long lineCount() const;
+    long long basketCount() const;
+    size_t memoryBytes() const;
+
+private:
+    LineItemDay& dayFor(int iDay);
+
+    shared_ptr<StoreArena> pArena;          // Chunk storage, made on first use
+    vector<LineItemDay> daysVec;            // Oldest day first
+    size_t iOpenDay = 0;                    // Day of the basket being appended
 };
 
+class TransactionJournal;
+
 struct Supermarket
 {
     string szName;                      // Name of the supermarket
     string szStoreHours;                // Hold store hours info
-    int iCurrentCustomers = 0;          // Current number of customers
-    int iCurrentMembers = 0;            // Current number of members
-    int iCurrentEmployees = 0;          // Current number of employees
-    double dMembershipFee;              // Fee to become a store member
-    double dTotalFunds;                 // Total funds of the store
-    Aisle aislesArr[40];                // Array of supermarket aisles
-    Employee employeesArr[50];          // Array of employees
-    CustomerPurchase customersArr[200]; // Array of customers
-    Member membersArr[200];             // Array of members
+    Money mMembershipFee;               // Fee to become a store member
+    Money mTotalFunds;                  // Total funds of the store
+    shared_ptr<StoreArena> pArena = make_shared<StoreArena>();  // Storage for the containers below
+    ArenaVector<Aisle> aislesVec{pArena};               // Supermarket aisles
+    ArenaVector<Employee> employeesVec{pArena};         // Employees
+    ArenaVector<CustomerPurchase> customersVec{pArena}; // Completed purchases
+    MemberRegistry memberRegistry;                  // Store members
+    CatalogIndex catalog;                           // Index over every item, rebuilt on load
+    SalesAggregates sales;                          // Running sales totals
+    RestockTracker restock;                         // Items by cover, built on first use
+    SalesAnalytics analytics;                       // Best seller sketches
+    LineItemLog lineItems{pArena};                  // Every committed line, by day
+    shared_ptr<TransactionJournal> pJournal;        // Write-ahead journal, nullptr when off
+
+    Supermarket() = default;
+    Supermarket(const Supermarket& other);
+    Supermarket(Supermarket&&) noexcept = default;
+    Supermarket& operator=(const Supermarket& other);
+    Supermarket& operator=(Supermarket&&) noexcept = default;
+};
+
+struct InventoryColumns
+{
+    vector<int> quantityVec;            // Stock on the shelf
+    vector<Money> wholesaleVec;         // Supermarket's cost
+    vector<Money> regularVec;           // Price for regular customers
+    vector<Money> memberVec;            // Price for store members
+    vector<int> skuVec;                 // SKU of the item
+    vector<ItemLocation> locationVec;   // Aisle and slot of the item
+};
+
+struct InventoryValue
+{
+    Money mWholesale;               // Stock value at wholesale
+    Money mRetail;                  // Stock value at regular prices
+    Money mMemberRetail;            // Stock value at member prices
+};
+
+struct StoreFileError
+{
+    int iLine = 0;          // Line of the problem, 1 based, 0 if not a text error
+    int iColumn = 0;        // Column of the problem, 1 based
+    string szMessage;       // What was expected
+};
+
+// Read-only memory mapping of a whole file, unmapped on destruction
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& szFilename, StoreFileError& error);
+    const char* data() const { return pData; }
+    size_t size() const { return iSize; }
+
+private:
+    void* pMapping = nullptr;   // Mapping to release, nullptr for an empty file
+    const char* pData = "";     // First byte of the file
+    size_t iSize = 0;           // Bytes in the file
 };
 
+// Append-only journal file. Records are queued by append and written
+// and flushed to disk in batches by a background thread.
+class TransactionJournal
+{
+public:
+    TransactionJournal() = default;
+    ~TransactionJournal();
+    TransactionJournal(const TransactionJournal&) = delete;
+    TransactionJournal& operator=(const TransactionJournal&) = delete;
+
+    bool open(const string& szFilename, bool bTruncate, StoreFileError& error);
+    void append(const string& szRecord);
+    void sync();
+    void close();
+    long long recordsWritten() const;
+    long long syncsDone() const;
+    const string& filename() const { return szPath; }
+
+private:
+    void runFlusher();
+
+    mutable mutex journalLock;
+    condition_variable flusherWake;     // Records queued or closing
+    condition_variable writersWake;     // Batch written or queue drained
+    thread flusherThread;
+    string szPath;                      // Journal file, set by open
+    int iFile = -1;
+    string szPending;                   // Records waiting for the flusher
+    uint64_t iQueuedBytes = 0;          // Bytes ever queued
+    uint64_t iDurableBytes = 0;         // Bytes ever written and flushed
+    long long lRecords = 0;
+    long long lSyncs = 0;
+    bool bSyncRequested = false;        // A caller is waiting in sync
+    bool bWriteFailed = false;
+    bool bClosing = false;
+};
+
+struct ReloadStats
+{
+    long long lKeptItems = 0;       // Items in both stores, their stock carried over
+    long long lNewItems = 0;        // Items only in the new file, stocked from it
+    long long lDroppedItems = 0;    // Items only in the live store, taken off sale
+    long long lPriceChanges = 0;    // Kept items with a new price
+    double dLoadSeconds = 0.0;      // Loading the file and matching items, off the owner's path
+    double dSwapMicros = 0.0;       // Carrying state over and swapping, on the owner's path
+    double dJournalMillis = 0.0;    // Copying the new journal base, on the owner's path, 0 when not journaled
+};
+
+// Store file loaded beside a live store, with every new catalog entry
+// matched to the live entry whose stock it takes over
+struct PreparedReload
+{
+    Supermarket store;              // Loaded store, the replaced store after applyStoreReload
+    string szFilename;              // Store file or snapshot it was loaded from
+    vector<int> liveEntryVec;       // Live catalog entry of each new entry, -1 for a new item
+    vector<int> newEntryVec;        // New catalog entry of each live entry, -1 for a dropped item
+    ReloadStats stats;
+
+    // Journaled stores only, the base is saved off the owner's path
+    string szBaseFilename;          // Snapshot the new journal is based on, empty once saved
+    Supermarket baseStore;          // Loaded store, given the live state at the swap
+    shared_ptr<TransactionJournal> pNewJournal; // Journal opened by the loader, taken by the swap
+};
+
+// Reloads a live store's file without pausing its checkouts. A worker
+// thread loads the file and publishes it through an atomic pointer, the
+// thread that owns the store picks it up between checkouts and swaps it
+// in, and a reclaimer thread then saves the new journal base and frees
+// the replaced store, so the owner never waits on the disk or a free.
+class StoreReloader
+{
+public:
+    StoreReloader() = default;
+    ~StoreReloader();
+    StoreReloader(const StoreReloader&) = delete;
+    StoreReloader& operator=(const StoreReloader&) = delete;
+
+    bool start(const string& szFilename, const Supermarket& myStore);
+    bool poll(Supermarket& myStore, ReloadStats& stats);
+    bool busy() const { return bBusy.load(memory_order_acquire); }
+
+    // As poll, then calls remapOpen(reload) before the replaced store is
+    // let go, so the owner can move its open checkouts onto the new catalog
+    template <typename Remap>
+    bool poll(Supermarket& myStore, ReloadStats& stats, Remap remapOpen)
+    {
+        shared_ptr<PreparedReload> pReload = applyReady(myStore, stats);
+        if (!pReload)
+        {
+            return false;
+        }
+        remapOpen(static_cast<const PreparedReload&>(*pReload));
+        reclaim(std::move(pReload));
+        return true;
+    }
+
+private:
+    shared_ptr<PreparedReload> applyReady(Supermarket& myStore, ReloadStats& stats);
+    void reclaim(shared_ptr<PreparedReload> pReplaced);
+    void runReclaimer();
+
+    thread workerThread;                        // Loads the file
+    atomic<shared_ptr<PreparedReload>> pReady;  // Load waiting to be swapped in
+    atomic<bool> bBusy{false};                  // A load is running, waiting to be swapped in or being saved
+    thread reclaimerThread;                     // Saves and frees replaced stores, started by the first swap
+    mutex reclaimLock;
+    condition_variable reclaimWake;             // Store queued or closing
+    vector<shared_ptr<PreparedReload>> replacedVec; // Replaced stores waiting to be freed
+    bool bClosing = false;
+};
+
+// Report file formats
+enum ReportFormat
+{
+    REPORT_CSV,     // Header line then one line per row
+    REPORT_JSON     // Array with one object per row
+};
+
+// Writer for row reports. Rows are built in a buffer that is written
+// out whenever it fills, so memory stays the same for any report size.
+class ReportWriter
+{
+public:
+    ReportWriter() = default;
+    ~ReportWriter();
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    bool open(const string& szFilename, ReportFormat format, const vector<string>& columnsVec);
+    void field(string_view szValue);
+    void field(long long lValue);
+    void field(Money mValue);
+    void flag(bool bValue);
+    void blank();
+    void endRow();
+    bool close();
+    long long rowsWritten() const { return lRows; }
+    unsigned long long bytesWritten() const { return lBytes; }
+
+private:
+    void startField();
+    void flushBuffer();
+
+    ofstream fileOut;
+    ReportFormat format = REPORT_CSV;
+    vector<string> keysVec;             // Column names, quoted with a colon for JSON
+    string szBuffer;                    // Text not yet written
+    size_t iColumn = 0;                 // Next column of the current row
+    long long lRows = 0;
+    unsigned long long lBytes = 0;
+    bool bOpen = false;
+};
+
+// Hot paths timed by the performance stats
+enum StatProbe
+{
+    STAT_FILE_LOAD,         // Loading a store file or snapshot
+    STAT_ITEM_LOOKUP,       // Finding the item for one basket line
+    STAT_MEMBER_LOOKUP,     // Checking whether a customer is a member
+    STAT_CHECKOUT,          // One whole basket, lookups to commit
+    STAT_CHECKOUT_COMMIT,   // Adding a finished checkout to the store
+    STAT_PAYROLL,           // One payroll run
+    STAT_SERVER_REQUEST,    // One line from a register terminal
+    STAT_SALE_QUEUE,        // A sale waiting between a lane and the ledger
+    STAT_PROBE_COUNT
+};
+
+struct StatSummary
+{
+    string szProbe = "";            // Name of the hot path
+    long long lCount = 0;           // Times it was timed
+    double dMeanNs = 0.0;           // Mean latency
+    long long lP50Ns = 0;           // Latency percentiles, within about 3%
+    long long lP90Ns = 0;
+    long long lP99Ns = 0;
+    long long lP999Ns = 0;
+    long long lMaxNs = 0;           // Longest latency seen
+};
+
+#ifndef SUPERMARKET_NO_STATS
+void recordStat(StatProbe probe, uint64_t iNanoseconds);
+
+// Times the rest of the enclosing scope into one probe
+class StatTimer
+{
+public:
+    explicit StatTimer(StatProbe probeIn) : probe(probeIn), tStart(chrono::steady_clock::now()) {}
+    ~StatTimer()
+    {
+        recordStat(probe, (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - tStart).count());
+    }
+    StatTimer(const StatTimer&) = delete;
+    StatTimer& operator=(const StatTimer&) = delete;
+
+private:
+    StatProbe probe;
+    chrono::steady_clock::time_point tStart;
+};
+
+#define STAT_JOIN_NAME(szPrefix, iLine) szPrefix##iLine
+#define STAT_TIMER_NAME(iLine) STAT_JOIN_NAME(statTimer, iLine)
+#define STAT_SCOPE(probe) StatTimer STAT_TIMER_NAME(__LINE__)(probe)
+#else
+#define STAT_SCOPE(probe) ((void)0)
+#endif
+
+// Result of adding one line to an open checkout
+enum CheckoutStatus
+{
+    CHECKOUT_OK,                // Line added to the cart
+    CHECKOUT_INVALID_AISLE,     // Aisle index is out of range or empty
+    CHECKOUT_ITEM_NOT_FOUND,    // No item with that name on the aisle
+    CHECKOUT_OUT_OF_STOCK,      // Item has no stock left
+    CHECKOUT_INVALID_QUANTITY   // Quantity is not positive or exceeds stock
+};
+
+// Price list a checkout is charged from
+enum PricingTier
+{
+    PRICING_REGULAR,        // Regular prices plus sales tax
+    PRICING_MEMBER,         // Member prices plus sales tax
+    PRICING_EMPLOYEE,       // Halfway from wholesale to member price, plus sales tax
+    PRICING_TAX_EXEMPT      // Regular prices, no sales tax
+};
+
+struct StockChange
+{
+    int iSKU;                       // Item taken from the shelf
+    int iAisleIndex;                // Aisle the item was taken from
+    int iQuantity;                  // Number taken
+    Money mPrice;                   // Unit price charged, set when the line is priced
+    Money mWholesale;               // Unit cost to the store
+    Money mRegularPrice;            // Shelf prices when the item was taken
+    Money mMembersPrice;
+};
+
+struct CheckoutSession
+{
+    CustomerPurchase purchase;      // Purchase being built
+    PricingTier eTier = PRICING_REGULAR;    // Price list for the whole basket
+    Money mCartTotal;               // Pre-tax cart total including membership fee
+    Money mProfit;                  // Profit on the items in the cart
+    vector<StockChange> takenVec;   // Stock taken, for the journal and sales totals
+    size_t iPricedLines = 0;        // Lines of takenVec already in the totals
+};
+
+struct BasketLine
+{
+    int iAisleIndex = -1;           // Aisle the item is on, -1 to search every aisle
+    string szItemName = "";         // Name of the item
+    int iSKU = 0;                   // SKU of the item, used instead of the name when set
+    int iQuantity = 0;              // Quantity to buy
+};
+
+struct Basket
+{
+    string szCustomerName = "";     // Name of the customer
+    bool bBuyMembership = false;    // Customer wants to buy a membership
+    PricingTier eTier = PRICING_REGULAR;    // Employee or tax exempt, else member status decides
+    vector<BasketLine> linesVec;    // Items to buy
+};
+
+struct ReplayStats
+{
+    long long lTransactions = 0;    // Transactions committed
+    long long lLines = 0;           // Basket lines read
+    long long lRejectedLines = 0;   // Lines the checkout engine refused
+    long long lMalformed = 0;       // Transaction lines that could not be parsed
+    double dSeconds = 0.0;          // Wall time spent replaying
+};
+
+struct SoldLine
+{
+    int iSKU;                       // Item sold
+    int iAisleIndex;                // Aisle it was taken from
+    int iQuantity;                  // Units sold
+    int iHour;                      // Hour of day the sale was committed
+};
+
+struct alignas(64) LaneTotals
+{
+    long long lTransactions = 0;            // Baskets checked out
+    long long lLines = 0;                   // Basket lines processed
+    long long lRejectedLines = 0;           // Lines the checkout engine refused
+    long long lBackpressureWaits = 0;       // Times the lane found its sale ring full
+};
+
+// Committed checkout passed from a lane to the ledger thread
+struct SaleEvent
+{
+    CheckoutSession session;                    // Finished, priced session
+    Money mFunds;                               // Funds the store keeps from it
+    int iHour = 0;                              // Hour of day it was committed
+    int iDay = 0;                               // Day it was committed
+    chrono::steady_clock::time_point tPublished;    // When the lane handed it over
+};
+
+// Bounded ring passing values from one producer thread to one consumer
+// thread without locks. Each side keeps its own index on its own cache
+// line and a cached copy of the other's, so it only reads the other
+// side's line when the ring looks full or empty.
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t iMinCapacity = 1024)
+    {
+        size_t iCapacity = 2;
+        while (iCapacity < iMinCapacity)
+        {
+            iCapacity *= 2;
+        }
+        slotsVec.resize(iCapacity);
+        iMask = iCapacity - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only, false when the ring is full
+    bool tryPush(T&& value)
+    {
+        size_t iWrite = iWriteIndex.load(memory_order_relaxed);
+        if (iWrite - iCachedRead == slotsVec.size())
+        {
+            iCachedRead = iReadIndex.load(memory_order_acquire);
+            if (iWrite - iCachedRead == slotsVec.size())
+            {
+                return false;
+            }
+        }
+        slotsVec[iWrite & iMask] = std::move(value);
+        iWriteIndex.store(iWrite + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer only, moves up to iMax values onto the end of outVec and
+    // returns how many
+    size_t popBatch(vector<T>& outVec, size_t iMax)
+    {
+        size_t iRead = iReadIndex.load(memory_order_relaxed);
+        if (iCachedWrite == iRead)
+        {
+            iCachedWrite = iWriteIndex.load(memory_order_acquire);
+        }
+        size_t iCount = min(iCachedWrite - iRead, iMax);
+        for (size_t i = 0; i < iCount; i++)
+        {
+            outVec.push_back(std::move(slotsVec[(iRead + i) & iMask]));
+        }
+        iReadIndex.store(iRead + iCount, memory_order_release);
+        return iCount;
+    }
+
+    // Values waiting, exact only on the consumer thread
+    size_t depth() const
+    {
+        return iWriteIndex.load(memory_order_acquire) - iReadIndex.load(memory_order_relaxed);
+    }
+
+    size_t capacity() const
+    {
+        return slotsVec.size();
+    }
+
+private:
+    vector<T> slotsVec;
+    size_t iMask = 0;
+    alignas(64) atomic<size_t> iWriteIndex{0};  // Next slot to fill, stored by the producer
+    size_t iCachedRead = 0;                     // Producer's last look at iReadIndex
+    alignas(64) atomic<size_t> iReadIndex{0};   // Next slot to empty, stored by the consumer
+    size_t iCachedWrite = 0;                    // Consumer's last look at iWriteIndex
+};
+
+// What the ledger thread did while the lanes ran
+struct LedgerStats
+{
+    long long lEvents = 0;              // Sales applied
+    long long lBatches = 0;             // Non-empty drains of one ring
+    size_t iPeakDepth = 0;              // Most sales waiting in one ring
+    double dTotalQueueMicros = 0.0;     // Summed time from publish to apply
+    double dMaxQueueMicros = 0.0;       // Longest time from publish to apply
+    vector<string> newMembersVec;       // Sign-ups, added to the registry when the lanes stop
+    vector<SoldLine> soldVec;           // Lines sold, counted for restock when the lanes stop
+};
+
+struct PosServerStats
+{
+    long long lTerminals = 0;       // Terminals that connected
+    long long lPeakTerminals = 0;   // Most terminals connected at once
+    long long lRequests = 0;        // Lines handled
+    long long lCheckouts = 0;       // Checkouts committed
+    long long lAbandoned = 0;       // Checkouts cancelled by a hang-up
+    long long lReloads = 0;         // Store file reloads swapped in
+};
+
+struct PosLoadConfig
+{
+    string szAddress;                   // Port number, or unix:<path>
+    int iTerminals = 1000;              // Terminals connected at once
+    int iBasketsPerTerminal = 5;        // Checkouts each terminal makes
+    int iMaxBasketLines = 4;            // Most lines in one basket
+    unsigned long long lSeed = 1;       // Same seed, same scripts
+};
+
+struct PosLoadResult
+{
+    long long lTerminals = 0;       // Terminals that finished their script
+    long long lErrors = 0;          // Terminals that failed to connect or were cut off
+    long long lCheckouts = 0;       // Checkouts the server confirmed
+    long long lRequests = 0;        // Lines answered
+    double dSeconds = 0.0;          // Wall time for every terminal to finish
+    double dP50Micros = 0.0;        // Request latency percentiles
+    double dP99Micros = 0.0;
+    double dP999Micros = 0.0;
+    double dMaxMicros = 0.0;
+};
+
+struct BasketMiningConfig
+{
+    double dMinSupport = 0.001;             // Share of baskets a pair must appear in
+    double dMinConfidence = 0.1;            // Share of baskets with one item that also hold the other
+    int iThreads = 0;                       // Threads to count with, 0 for one per core
+    int iMaxRules = 20;                     // Most rules to keep, by lift
+};
+
+// Association rule, customers who buy item A also buy item B
+struct PairRule
+{
+    int iSKU_A = 0;                 // Item in the basket
+    int iSKU_B = 0;                 // Item it suggests
+    long long lBaskets = 0;         // Baskets holding both
+    double dSupport = 0.0;          // Share of all baskets holding both
+    double dConfidence = 0.0;       // Share of baskets with A that also hold B
+    double dLift = 0.0;             // Confidence over the share of baskets with B
+};
+
+struct BasketMiningResult
+{
+    long long lBaskets = 0;         // Baskets mined
+    long long lLines = 0;           // Lines mined
+    long long lUnknownLines = 0;    // Lines whose SKU is no longer in the store
+    long long lMinBaskets = 0;      // Baskets an item or pair needed to count as frequent
+    int iFrequentItems = 0;         // Items frequent enough to pair
+    int iDroppedItems = 0;          // Frequent items left out to bound the pair table
+    long long lFrequentPairs = 0;   // Pairs at or above the support
+    vector<PairRule> rulesVec;      // Best rules, highest lift first
+    int iThreads = 0;               // Threads used
+    double dSeconds = 0.0;          // Wall time to mine
+};
+
+struct MultiLaneStats
+{
+    int iLanes = 0;                 // Number of checkout lanes
+    long long lTransactions = 0;    // Baskets checked out
+    long long lLines = 0;           // Basket lines processed
+    long long lRejectedLines = 0;   // Lines the checkout engine refused
+    int iOversoldItems = 0;         // Items left with negative stock
+    double dSeconds = 0.0;          // Wall time for the lanes to finish
+    long long lNewMembers = 0;      // Customers who bought a membership
+    long long lBackpressureWaits = 0;   // Times a lane found its sale ring full
+    long long lLedgerBatches = 0;   // Batches the ledger drained
+    size_t iPeakQueueDepth = 0;     // Most sales waiting in one ring
+    double dMeanQueueMicros = 0.0;  // Mean time from a lane's publish to the ledger's apply
+    double dMaxQueueMicros = 0.0;   // Longest time from publish to apply
+};
+
+// Pay periods in a year, salaries are yearly
+enum PayPeriod
+{
+    PAY_PERIOD_YEARLY = 1,
+    PAY_PERIOD_MONTHLY = 12,
+    PAY_PERIOD_BIWEEKLY = 26,
+    PAY_PERIOD_WEEKLY = 52
+};
+
+// Who is paid when the funds do not cover the payroll
+enum PayrollPolicy
+{
+    PAYROLL_ALL_OR_NOTHING,     // Nobody
+    PAYROLL_LOWEST_FIRST,       // Smallest amounts in full first, then what is left to the next
+    PAYROLL_PRO_RATA            // Everyone the same share of what they are owed
+};
+
+struct PayrollConfig
+{
+    PayPeriod ePeriod = PAY_PERIOD_YEARLY;          // Pay periods in the year
+    int iPeriodIndex = 0;                           // Period being paid, 0 based
+    PayrollPolicy ePolicy = PAYROLL_ALL_OR_NOTHING; // What to do when funds are short
+    int iThreads = 1;                               // Threads for large rosters
+    string szLedgerFile = "";                       // Payout ledger, .json for JSON, empty for none
+};
+
+struct PayrollResult
+{
+    long long lEmployees = 0;       // Employees on the roster
+    long long lPaidInFull = 0;      // Paid everything owed for the period
+    long long lPaidPartly = 0;      // Paid some of it
+    long long lUnpaid = 0;          // Paid nothing
+    Money mOwed;                    // Pay owed for the period
+    Money mPaid;                    // Pay taken from the funds
+    bool bCovered = false;          // Funds covered everything owed
+    bool bLedgerWritten = false;    // Ledger file written in full
+    double dPlanSeconds = 0.0;      // Time to work out and pay the payroll
+    double dLedgerSeconds = 0.0;    // Time to write the ledger
+};
+
+struct RestockConfig
+{
+    double dObservedDays = 1.0;     // Trading days the tracked sales cover
+    double dReorderDays = 3.0;      // Reorder items with less cover than this
+    double dTargetDays = 7.0;       // Order enough to last this long
+    int iMinStock = 10;             // Stock to keep of items that have not sold
+    int iMaxLines = 0;              // Most items in one order, 0 for no limit
+    bool bWithinFunds = true;       // Leave out lines the funds cannot cover
+};
+
+struct RestockLine
+{
+    int iSKU = 0;                   // Item to reorder
+    ItemLocation location;          // Aisle and slot of the item
+    int iQuantity = 0;              // Units to order
+    double dCoverDays = 0.0;        // Cover before the restock
+    Money mCost;                    // Wholesale cost of the units
+};
+
+struct RestockPlan
+{
+    vector<RestockLine> linesVec;   // Items to reorder, lowest cover first
+    long long lUnits = 0;           // Units ordered
+    Money mCost;                    // Wholesale cost of the order
+    long long lDroppedLines = 0;    // Lines left out for the line limit or funds
+    double dPlanSeconds = 0.0;      // Time to build the plan
+};
+
+struct GeneratorConfig
+{
+    int iAisles = 10;                       // Aisles in the store
+    int iItemsPerAisle = 50;                // Items on each aisle
+    int iEmployees = 20;                    // Employees on the roster
+    int iMembers = 200;                     // Customers signing up first
+    int iCustomers = 2000;                  // Baskets after the sign-ups
+    int iMaxBasketLines = 8;                // Most lines in one basket
+    unsigned long long lSeed = 1;           // Same seed, same files
+};
+
+struct SimulationConfig
+{
+    int iCustomers = 10000;                 // Customers arriving during the day
+    int iLanes = 1;                         // Open checkout lanes
+    unsigned long long lSeed = 1;           // Random seed, same seed same day
+    double dDaySeconds = 14 * 3600.0;       // Length of the trading day
+    double dBrowseSecondsPerItem = 60.0;    // Mean time to pick up one line
+    int iMaxBasketLines = 8;                // Most lines in one basket
+    double dServiceSecondsFixed = 30.0;     // Register time per customer
+    double dServiceSecondsPerItem = 3.0;    // Register time per item scanned
+    double dMembershipRate = 0.05;          // Share of customers asking to join
+};
+
+struct SimulationResults
+{
+    int iLanes = 0;                     // Lanes that were open
+    long long lCustomers = 0;           // Customers that arrived
+    long long lEvents = 0;              // Events processed
+    long long lRejectedLines = 0;       // Basket lines the engine refused
+    Money mSales;                       // Sales including tax
+    double dSimulatedSeconds = 0.0;     // Simulated time until the last customer left
+    double dWallSeconds = 0.0;          // Real time the simulation took
+    double dWaitMean = 0.0;             // Queue wait statistics in seconds
+    double dWaitP50 = 0.0;
+    double dWaitP90 = 0.0;
+    double dWaitP99 = 0.0;
+    double dWaitMax = 0.0;
+    vector<long long> laneServedVec;        // Customers served per lane
+    vector<double> laneUtilizationVec;      // Busy fraction per lane
+    vector<double> laneAvgQueueVec;         // Time-weighted queue length per lane
+    vector<int> laneMaxQueueVec;            // Longest queue per lane
+};
+
+struct ChainStoreSpec
+{
+    string szStoreFile = "";            // Store file or snapshot
+    string szTransactionFile = "";      // Transactions to replay, empty to simulate a day
+};
+
+struct ChainConfig
+{
+    int iWorkers = 1;                   // Worker threads, each owns every iWorkers-th store
+    bool bPinWorkers = true;            // Pin each worker to its own core
+    SimulationConfig simulation;        // Day simulated by stores without transactions
+    bool bRunPayroll = true;            // Pay each store's employees after its day
+    PayrollConfig payroll;              // Period and policy for the payroll
+};
+
+struct StoreSummary
+{
+    string szFilename = "";             // Store file loaded
+    string szName = "";                 // Name of the store
+    string szError = "";                // Why the store did not load
+    bool bLoaded = false;               // Store loaded and ran its day
+    int iWorker = -1;                   // Worker that ran the store
+    long long lBaskets = 0;             // Baskets checked out
+    long long lRejectedLines = 0;       // Basket lines the engine refused
+    Money mFunds;                       // Funds at the end of the day
+    SalesAggregates sales;              // Sales totals for the day
+    PayrollResult payroll;              // Payroll run after the day
+    double dSeconds = 0.0;              // Time to load, trade and pay
+};
+
+struct ChainTotals
+{
+    int iStores = 0;                    // Stores listed
+    int iLoaded = 0;                    // Stores that loaded
+    int iWorkers = 0;                   // Worker threads used
+    long long lBaskets = 0;             // Baskets checked out chain-wide
+    long long lRejectedLines = 0;       // Basket lines refused chain-wide
+    Money mFunds;                       // Funds of every store added up
+    SalesAggregates sales;              // Sales of every store merged
+    PayrollResult payroll;              // Payroll of every store merged
+    double dWallSeconds = 0.0;          // Time for the workers to finish
+    vector<StoreSummary> storesVec;     // Summary per store, in list order
+};
+
+// Money
+bool parseMoney(string_view szText, Money& amount);
+void appendMoney(string& szOut, Money amount);
+string formatMoney(Money amount);
+ostream& operator<<(ostream& out, Money amount);
+istream& operator>>(istream& in, Money& amount);
+Money calculateSalesTax(Money amount);
+Money moneyFromDouble(double dAmount);
+double moneyToDouble(Money amount);
+
 // Functions to Implement
 string promptForFilename();
-void processSupermarketInformation(fstream& fileInput, Supermarket& myStore);
+void processSupermarketInformation(Supermarket& myStore);
 
 void displayMenu(string szMenuName, string szChoicesArr[], int iChoices);
-void displaySupermarketInfo(const Supermarket myStore);
-void displayAisles(const Supermarket myStore);
-void displayItems(const Supermarket myStore, int iAisleIndex);
+void displaySupermarketInfo(const Supermarket& myStore);
+void displayAisles(const Supermarket& myStore);
+void displayItems(const Supermarket& myStore, int iAisleIndex);
 CustomerPurchase checkout(Supermarket& myStore);
 
 void displayTotalFunds(const Supermarket& myStore);
-double calculateTotalSales(const Supermarket& myStore);
+Money calculateTotalSales(const Supermarket& myStore);
 bool payEmployees(Supermarket& myStore);
 void clearMembers(Supermarket& myStore);
 
-void extraCredit(Supermarket& myStore);
\ No newline at end of file
+void extraCredit(Supermarket& myStore);
+
+// Screen rendering, each screen is built in one buffer
+string renderMenu(const string& szMenuName, const string szChoicesArr[], int iChoices);
+string renderSupermarketInfo(const Supermarket& myStore);
+string renderAisles(const Supermarket& myStore);
+string renderItems(const Supermarket& myStore, int iAisleIndex);
+
+// Headless checkout engine
+bool loadSupermarketFile(const string& szFilename, Supermarket& myStore);
+bool isMember(const Supermarket& myStore, const string& szName);
+bool addMember(Supermarket& myStore, const string& szName);
+bool isValidAisle(const Supermarket& myStore, int iAisleIndex);
+Item* findItem(Supermarket& myStore, int iAisleIndex, const string& szItemName);
+CheckoutSession beginCheckout(Supermarket& myStore, const string& szName, bool bBuyMembership,
+                              PricingTier eTier = PRICING_REGULAR);
+CheckoutSession openCheckout(const Supermarket& myStore, const string& szName,
+                             bool bIsMember, bool bBoughtMembership, PricingTier eTier = PRICING_REGULAR);
+CheckoutStatus reserveStock(Item& item, int iQuantity);
+CheckoutStatus addCheckoutItem(CheckoutSession& session, Item& item, int iAisleIndex, int iQuantity);
+CheckoutStatus addBasketLine(Supermarket& myStore, CheckoutSession& session, const BasketLine& line);
+CheckoutStatus addCheckoutLine(Supermarket& myStore, CheckoutSession& session,
+                               int iAisleIndex, const string& szItemName, int iQuantity);
+CustomerPurchase finishCheckout(CheckoutSession& session);
+bool recordPurchase(Supermarket& myStore, const CustomerPurchase& purchase);
+CustomerPurchase commitCheckout(Supermarket& myStore, CheckoutSession& session);
+void cancelCheckout(Supermarket& myStore, CheckoutSession& session);
+Money checkoutFunds(const Supermarket& myStore, const CheckoutSession& session);
+CustomerPurchase checkoutBasket(Supermarket& myStore, const Basket& basket, ReplayStats* pStats = nullptr);
+bool parseTransactionLine(const string& szLine, Basket& basket);
+ReplayStats replayTransactions(Supermarket& myStore, const string& szFilename);
+bool loadTransactionFile(const string& szFilename, vector<Basket>& basketsVec, long long& lMalformed);
+void displayReplayStats(const ReplayStats& stats);
+
+// Catalog index
+string normalizeItemName(const string& szName);
+void normalizeItemName(const string& szName, string& szKey);
+void buildCatalogIndex(Supermarket& myStore);
+Item* lookupItemByName(Supermarket& myStore, const string& szItemName, ItemLocation* pLocation = nullptr);
+Item* lookupItemBySKU(Supermarket& myStore, int iSKU, ItemLocation* pLocation = nullptr);
+int findCatalogEntry(const Supermarket& myStore, int iSKU);
+
+// Pricing tiers
+void priceCheckout(CheckoutSession& session);
+Money checkoutSalesTax(PricingTier eTier, Money mCartTotal);
+const char* pricingTierName(PricingTier eTier);
+
+// Member registry
+uint64_t hashMemberName(const string& szName);
+bool registryContains(const MemberRegistry& registry, const string& szName);
+bool registryInsert(MemberRegistry& registry, const string& szName);
+void registryClear(MemberRegistry& registry);
+size_t registryMemoryBytes(const MemberRegistry& registry);
+
+// Column inventory analytics
+void buildInventoryColumns(const Supermarket& myStore, InventoryColumns& columns);
+void refreshInventoryQuantities(const Supermarket& myStore, InventoryColumns& columns);
+InventoryValue calculateInventoryValue(const InventoryColumns& columns);
+void calculateItemMargins(const InventoryColumns& columns,
+                          vector<Money>& regularMarginVec, vector<Money>& memberMarginVec);
+size_t findLowStock(const InventoryColumns& columns, int iThreshold, vector<uint32_t>& rowsVec);
+size_t filterPriceBand(const InventoryColumns& columns, Money mLow, Money mHigh,
+                       vector<uint32_t>& rowsVec);
+
+// Multi-lane checkout
+MultiLaneStats runMultiLaneCheckout(Supermarket& myStore, const vector<Basket>& basketsVec, int iLanes);
+void displayLaneScaling(const Supermarket& templateStore, const vector<Basket>& basketsVec, int iMaxLanes);
+void displayLedgerStats(const MultiLaneStats& stats);
+
+// Discrete-event store simulation
+SimulationResults runStoreSimulation(Supermarket& myStore, const SimulationConfig& config);
+void displaySimulationResults(const SimulationResults& results);
+
+// Mapped store file loader
+bool parseSupermarketText(const char* pText, size_t iLength, Supermarket& myStore,
+                          StoreFileError& error);
+bool mapSupermarketFile(const string& szFilename, Supermarket& myStore, StoreFileError& error);
+
+// Binary store snapshots
+bool saveStoreSnapshot(const Supermarket& myStore, const string& szFilename, StoreFileError& error);
+bool loadStoreSnapshot(const string& szFilename, Supermarket& myStore, StoreFileError& error);
+bool writeWholeFile(const string& szFilename, const string& szContents, StoreFileError& error);
+string promptForSnapshotFilename();
+void processSnapshotSave(Supermarket& myStore);
+void processSnapshotLoad(Supermarket& myStore);
+
+// Transaction journal
+bool attachJournal(Supermarket& myStore, const string& szBaseFilename, bool bFresh);
+bool replayJournal(Supermarket& myStore, const string& szFilename, long long& lRecords, StoreFileError& error);
+bool readJournalRedirect(const string& szFilename, string& szBaseFilename);
+bool writeJournalRedirect(const string& szFilename, const string& szBaseFilename, StoreFileError& error);
+void journalCheckout(Supermarket& myStore, const CheckoutSession& session, Money mFunds, int iHour, int iDay);
+void journalPayroll(Supermarket& myStore, Money mAmount);
+void journalClearMembers(Supermarket& myStore);
+void journalRestock(Supermarket& myStore, const RestockPlan& plan);
+
+// Payroll engine
+Money periodPay(Money mSalary, PayPeriod ePeriod, int iPeriodIndex);
+PayrollResult runPayroll(Supermarket& myStore, const PayrollConfig& config);
+void displayPayrollResult(const PayrollResult& result);
+void processPayroll(Supermarket& myStore);
+
+// Restock planner
+void recordRestockSale(Supermarket& myStore, int iSKU, int iQuantity);
+void recordRestockSales(Supermarket& myStore, const CheckoutSession& session);
+bool receiveRestock(Supermarket& myStore, int iSKU, int iQuantity);
+RestockPlan planRestock(Supermarket& myStore, const RestockConfig& config);
+bool applyRestock(Supermarket& myStore, const RestockPlan& plan);
+void displayRestockPlan(const RestockPlan& plan, int iMaxLines);
+void processRestock(Supermarket& myStore);
+void carryRestockSales(Supermarket& newStore, const Supermarket& oldStore, const vector<int>& oldEntryVec);
+
+// Best seller analytics
+void recordLineAnalytics(SalesAnalytics& analytics, int iSKU, int iAisleIndex, int iQuantity, int iHour);
+void recordCheckoutAnalytics(SalesAnalytics& analytics, const CheckoutSession& session, int iHour);
+size_t analyticsMemoryBytes(const SalesAnalytics& analytics);
+void displayBestSellers(const Supermarket& myStore, bool bHourWindow, bool bAisles, int iCount);
+void processBestSellers(const Supermarket& myStore);
+
+// Live store reload
+bool prepareStoreReload(const string& szFilename, const Supermarket& myStore, PreparedReload& reload);
+void applyStoreReload(Supermarket& myStore, PreparedReload& reload);
+bool reloadSupermarketFile(const string& szFilename, Supermarket& myStore);
+bool remapReloadedSession(const PreparedReload& reload, const Supermarket& myStore, CheckoutSession& session);
+int remapReloadedAisle(const PreparedReload& reload, const Supermarket& myStore, int iAisleIndex);
+void displayReloadStats(const ReloadStats& stats);
+
+// Register server
+bool runPosServer(Supermarket& myStore, const string& szAddress, const atomic<bool>& bStop,
+                  atomic<bool>& bReload, const string& szStoreFile, PosServerStats& stats);
+void displayPosServerStats(const PosServerStats& stats);
+PosLoadResult runPosLoad(const Supermarket& myStore, const PosLoadConfig& config);
+void displayPosLoadResult(const PosLoadConfig& config, const PosLoadResult& result);
+
+// Line item log and basket mining
+void recordCheckoutLines(LineItemLog& lineItems, const CheckoutSession& session, int iDay);
+BasketMiningResult mineBasketPairs(const Supermarket& myStore, const BasketMiningConfig& config);
+void displayLineItemLog(const LineItemLog& lineItems);
+void displayBasketMining(const Supermarket& myStore, const BasketMiningResult& result);
+void processBasketMining(const Supermarket& myStore);
+
+// Sales aggregates
+int currentHourOfDay();
+int currentDayNumber();
+void recordCheckoutSales(SalesAggregates& sales, const CheckoutSession& session,
+                         Money mMembershipFee, int iHour);
+void mergeSalesAggregates(SalesAggregates& target, const SalesAggregates& source);
+void displaySalesAggregates(const Supermarket& myStore);
+
+// Multi-store chain
+ChainTotals runChain(const vector<ChainStoreSpec>& storesVec, const ChainConfig& config);
+bool loadChainList(const string& szFilename, vector<ChainStoreSpec>& storesVec);
+void displayChainTotals(const ChainTotals& totals);
+
+// Report exports
+ReportFormat reportFormatForFile(const string& szFilename);
+bool exportInventoryReport(const Supermarket& myStore, const string& szFilename);
+bool exportTransactionReport(const Supermarket& myStore, const string& szFilename);
+bool exportSalesReport(const Supermarket& myStore, const string& szFilename);
+bool exportPayrollReport(const Supermarket& myStore, const string& szFilename);
+bool exportReport(const Supermarket& myStore, const string& szReport, const string& szFilename);
+void processReportExport(const Supermarket& myStore);
+
+// Performance stats, compiled out with -DSUPERMARKET_NO_STATS
+vector<StatSummary> collectPerformanceStats();
+void resetPerformanceStats();
+void displayPerformanceStats();
+bool dumpPerformanceStats(const string& szFilename);
+void processPerformanceStats();
+
+// Synthetic store generator
+bool getGeneratorScale(const string& szScale, GeneratorConfig& config);
+bool generateStoreFile(const GeneratorConfig& config, const string& szFilename);
+bool generateTransactionFile(const GeneratorConfig& config, const string& szFilename);
+
+// Benchmarks
+void benchmarkDisplay(const Supermarket& myStore, int iIterations);
+void benchmarkMembers(int iMembers);
+void benchmarkInventory(int iItems);
+void benchmarkLoader(const string& szFilename, int iIterations);
+void benchmarkSnapshot(const string& szFilename, int iIterations);
+void benchmarkJournal(const string& szStoreFile, const string& szTransactionFile, int iLanes);
+void benchmarkMoney(int iItems);
+void benchmarkPayroll(int iEmployees, int iMaxThreads, const string& szLedgerFile);
+void benchmarkSuite(const string& szDirectory, const string& szScales, unsigned long long lSeed);
+void benchmarkChain(const string& szDirectory, int iStores, int iMaxWorkers);
+void benchmarkExport(const string& szDirectory, const string& szScale);
+void benchmarkRestock(const string& szDirectory, const string& szScale);
+void benchmarkPricing(int iBaskets);
+void benchmarkAnalytics(int iLines);
+void benchmarkServer(const string& szStoreFile, int iTerminals, int iBaskets);
+void benchmarkReload(const string& szStoreFile, int iReloads);
+void benchmarkMining(const string& szDirectory, const string& szScale, int iBaskets, int iMaxThreads);
@@ -0,0 +1,711 @@
+#include "supermarket_simulator_program_3.h"
+#include <limits>
+/*********************************************************************
+File name: supermarket_simulator_program_3_analytics.cpp
+
+Purpose:
+    Streaming best seller analytics over the committed checkout lines.
+
+Notes:
+    - Every committed line is counted by SKU and by aisle, in a window
+      for the current hour of day and one since the store was loaded.
+    - Space-Saving keeps the heaviest keys with a bound on how far each
+      count can be over. Count-Min answers units sold for any key, the
+      conservative update keeps its estimates low.
+    - Sketch sizes are fixed, so memory does not grow with the number
+      of transactions and an update touches a few cache lines.
+    - Snapshots save the sketches as they are. Loading a store file
+      starts them empty and journal replay refills them with the
+      replayed checkouts.
+*********************************************************************/
+
+// Slots in the key table per Space-Saving counter, keeps probes short
+static const size_t iSLOTS_PER_COUNTER = 4;
+
+// Best sellers listed when the employee asks for more than the sketch holds
+static const int iMAX_BEST_SELLERS = 100;
+
+/*********************************************************************
+static uint64_t hashKey(uint32_t iKey)
+Purpose:
+    Helper function to spread keys over a table
+Parameters:
+    I   uint32_t iKey       SKU or aisle index
+Return Value:
+    64 bit hash of the key
+Notes:
+    SKUs are mostly consecutive, the multiply keeps them from
+    clustering in the low bits
+*********************************************************************/
+static uint64_t hashKey(uint32_t iKey)
+{
+    uint64_t iHash = ((uint64_t)iKey + 1) * 0x9e3779b97f4a7c15ULL;
+    iHash ^= iHash >> 31;
+    iHash *= 0xbf58476d1ce4e5b9ULL;
+    return iHash ^ (iHash >> 29);
+}
+
+/*********************************************************************
+size_t SpaceSavingSketch::findSlot(uint32_t iKey) const
+Purpose:
+    Helper function to find the table slot of a key
+Parameters:
+    I   uint32_t iKey       Key to find
+Return Value:
+    Slot holding the key, or the empty slot where it would go
+Notes:
+    The table is never more than a quarter full, so a slot is found
+*********************************************************************/
+size_t SpaceSavingSketch::findSlot(uint32_t iKey) const
+{
+    size_t iMask = slotsVec.size() - 1;
+    size_t iSlot = hashKey(iKey) & iMask;
+    while (slotsVec[iSlot] != 0 && heapVec[slotsVec[iSlot] - 1].iKey != iKey)
+    {
+        iSlot = (iSlot + 1) & iMask;
+    }
+    return iSlot;
+}
+
+/*********************************************************************
+void SpaceSavingSketch::placeCounter(size_t iPosition, const Counter& counter)
+Purpose:
+    Helper function to put a counter in the heap and point its slot at it
+Parameters:
+    I   size_t iPosition    Heap position
+    I   Counter counter     Counter to place
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void SpaceSavingSketch::placeCounter(size_t iPosition, const Counter& counter)
+{
+    heapVec[iPosition] = counter;
+    slotsVec[counter.iSlot] = (uint32_t)iPosition + 1;
+}
+
+/*********************************************************************
+void SpaceSavingSketch::siftDown(size_t iPosition)
+Purpose:
+    Helper function to move a counter whose count grew below its children
+Parameters:
+    I   size_t iPosition    Heap position of the counter
+Return Value:
+    -
+Notes:
+    Counts only grow, so a counter never has to move up
+*********************************************************************/
+void SpaceSavingSketch::siftDown(size_t iPosition)
+{
+    Counter counter = heapVec[iPosition];
+    size_t iSize = heapVec.size();
+    while (true)
+    {
+        size_t iChild = 2 * iPosition + 1;
+        if (iChild >= iSize)
+        {
+            break;
+        }
+        if (iChild + 1 < iSize && heapVec[iChild + 1].iCount < heapVec[iChild].iCount)
+        {
+            iChild++;
+        }
+        if (heapVec[iChild].iCount >= counter.iCount)
+        {
+            break;
+        }
+        placeCounter(iPosition, heapVec[iChild]);
+        iPosition = iChild;
+    }
+    placeCounter(iPosition, counter);
+}
+
+/*********************************************************************
+void SpaceSavingSketch::eraseSlot(size_t iSlot)
+Purpose:
+    Helper function to empty a table slot without breaking probe chains
+Parameters:
+    I   size_t iSlot        Slot to empty
+Return Value:
+    -
+Notes:
+    Later keys in the chain shift back into the gap when their home
+    slot allows it, so no tombstones build up
+*********************************************************************/
+void SpaceSavingSketch::eraseSlot(size_t iSlot)
+{
+    size_t iMask = slotsVec.size() - 1;
+    size_t iNext = (iSlot + 1) & iMask;
+    while (slotsVec[iNext] != 0)
+    {
+        Counter& moved = heapVec[slotsVec[iNext] - 1];
+        size_t iHome = hashKey(moved.iKey) & iMask;
+        if (((iNext - iHome) & iMask) >= ((iNext - iSlot) & iMask))
+        {
+            slotsVec[iSlot] = slotsVec[iNext];
+            moved.iSlot = (uint32_t)iSlot;
+            iSlot = iNext;
+        }
+        iNext = (iNext + 1) & iMask;
+    }
+    slotsVec[iSlot] = 0;
+}
+
+/*********************************************************************
+void SpaceSavingSketch::add(uint32_t iKey, uint64_t iWeight)
+Purpose:
+    Function to count units of a key
+Parameters:
+    I   uint32_t iKey       SKU or aisle index
+    I   uint64_t iWeight    Units to add
+Return Value:
+    -
+Notes:
+    When every counter is taken the smallest is handed to the new key,
+    which inherits its count as the error bound
+*********************************************************************/
+void SpaceSavingSketch::add(uint32_t iKey, uint64_t iWeight)
+{
+    if (slotsVec.empty())
+    {
+        size_t iSlots = 1;
+        while (iSlots < iCapacity * iSLOTS_PER_COUNTER)
+        {
+            iSlots <<= 1;
+        }
+        slotsVec.assign(iSlots, 0);
+        heapVec.reserve(iCapacity);
+    }
+
+    size_t iSlot = findSlot(iKey);
+    if (slotsVec[iSlot] != 0)
+    {
+        size_t iPosition = slotsVec[iSlot] - 1;
+        heapVec[iPosition].iCount += iWeight;
+        siftDown(iPosition);
+        return;
+    }
+
+    if (heapVec.size() < iCapacity)
+    {
+        // New counts can be below the parents, move up to the right place
+        size_t iPosition = heapVec.size();
+        heapVec.push_back({});
+        Counter counter = {iWeight, 0, iKey, (uint32_t)iSlot};
+        while (iPosition > 0 && heapVec[(iPosition - 1) / 2].iCount > counter.iCount)
+        {
+            placeCounter(iPosition, heapVec[(iPosition - 1) / 2]);
+            iPosition = (iPosition - 1) / 2;
+        }
+        placeCounter(iPosition, counter);
+        return;
+    }
+
+    uint64_t iMinimum = heapVec[0].iCount;
+    eraseSlot(heapVec[0].iSlot);
+    iSlot = findSlot(iKey);
+    placeCounter(0, {iMinimum + iWeight, iMinimum, iKey, (uint32_t)iSlot});
+    siftDown(0);
+}
+
+/*********************************************************************
+void SpaceSavingSketch::clear()
+Purpose:
+    Function to forget every key and keep the storage
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void SpaceSavingSketch::clear()
+{
+    heapVec.clear();
+    fill(slotsVec.begin(), slotsVec.end(), 0);
+}
+
+/*********************************************************************
+vector<HeavyHitter> SpaceSavingSketch::top(size_t iCount) const
+Purpose:
+    Function to list the heaviest keys
+Parameters:
+    I   size_t iCount       Most keys to list
+Return Value:
+    Keys from heaviest down
+Notes:
+    Any key with more than total / capacity units is in the sketch
+*********************************************************************/
+vector<HeavyHitter> SpaceSavingSketch::top(size_t iCount) const
+{
+    vector<HeavyHitter> hittersVec;
+    hittersVec.reserve(heapVec.size());
+    for (const Counter& counter : heapVec)
+    {
+        hittersVec.push_back({counter.iKey, counter.iCount, counter.iError});
+    }
+    iCount = min(iCount, hittersVec.size());
+    partial_sort(hittersVec.begin(), hittersVec.begin() + iCount, hittersVec.end(),
+                 [](const HeavyHitter& a, const HeavyHitter& b)
+                 {
+                     return a.iCount != b.iCount ? a.iCount > b.iCount : a.iKey < b.iKey;
+                 });
+    hittersVec.resize(iCount);
+    return hittersVec;
+}
+
+/*********************************************************************
+vector<HeavyHitter> SpaceSavingSketch::counters() const
+Purpose:
+    Function to list every counter for saving
+Parameters:
+    -
+Return Value:
+    Counters in heap order
+Notes:
+    Restoring them in this order gives back the same heap, so keys
+    tied at the smallest count are replaced in the same order
+*********************************************************************/
+vector<HeavyHitter> SpaceSavingSketch::counters() const
+{
+    vector<HeavyHitter> hittersVec;
+    hittersVec.reserve(heapVec.size());
+    for (const Counter& counter : heapVec)
+    {
+        hittersVec.push_back({counter.iKey, counter.iCount, counter.iError});
+    }
+    return hittersVec;
+}
+
+/*********************************************************************
+void SpaceSavingSketch::restore(const HeavyHitter* pHitters, size_t iHitters)
+Purpose:
+    Function to replace the counters with ones saved from counters
+Parameters:
+    I   HeavyHitter* pHitters   Saved counters, in heap order
+    I   size_t iHitters         Number of saved counters
+Return Value:
+    -
+Notes:
+    Counters past the capacity and repeated keys are dropped, and the
+    heap is rebuilt in case the saved order is not one
+*********************************************************************/
+void SpaceSavingSketch::restore(const HeavyHitter* pHitters, size_t iHitters)
+{
+    clear();
+    if (slotsVec.empty())
+    {
+        size_t iSlots = 1;
+        while (iSlots < iCapacity * iSLOTS_PER_COUNTER)
+        {
+            iSlots <<= 1;
+        }
+        slotsVec.assign(iSlots, 0);
+        heapVec.reserve(iCapacity);
+    }
+
+    for (size_t i = 0; i < iHitters && heapVec.size() < iCapacity; i++)
+    {
+        size_t iSlot = findSlot(pHitters[i].iKey);
+        if (slotsVec[iSlot] == 0)
+        {
+            heapVec.push_back({pHitters[i].iCount, pHitters[i].iError, pHitters[i].iKey, (uint32_t)iSlot});
+            slotsVec[iSlot] = (uint32_t)heapVec.size();
+        }
+    }
+    for (size_t i = heapVec.size() / 2; i-- > 0;)
+    {
+        siftDown(i);
+    }
+}
+
+/*********************************************************************
+size_t SpaceSavingSketch::memoryBytes() const
+Purpose:
+    Function to report the storage the sketch holds
+Parameters:
+    -
+Return Value:
+    Bytes of counters and key table
+Notes:
+    -
+*********************************************************************/
+size_t SpaceSavingSketch::memoryBytes() const
+{
+    return heapVec.capacity() * sizeof(Counter) + slotsVec.capacity() * sizeof(uint32_t);
+}
+
+/*********************************************************************
+void CountMinSketch::add(uint32_t iKey, uint64_t iWeight)
+Purpose:
+    Function to count units of a key
+Parameters:
+    I   uint32_t iKey       SKU or aisle index
+    I   uint64_t iWeight    Units to add
+Return Value:
+    -
+Notes:
+    Conservative update, a row is only raised as far as the smallest
+    row plus the weight
+*********************************************************************/
+void CountMinSketch::add(uint32_t iKey, uint64_t iWeight)
+{
+    if (countsVec.empty())
+    {
+        countsVec.assign(iWidth * iDepth, 0);
+    }
+
+    uint64_t iHash = hashKey(iKey);
+    uint64_t iStep = (iHash >> 32) | 1;
+    size_t iMask = iWidth - 1;
+    uint64_t* pCounts = countsVec.data();
+
+    uint64_t iMinimum = UINT64_MAX;
+    for (size_t iRow = 0; iRow < iDepth; iRow++)
+    {
+        iMinimum = min(iMinimum, pCounts[iRow * iWidth + ((iHash + iRow * iStep) & iMask)]);
+    }
+    uint64_t iTarget = iMinimum + iWeight;
+    for (size_t iRow = 0; iRow < iDepth; iRow++)
+    {
+        uint64_t& iCounter = pCounts[iRow * iWidth + ((iHash + iRow * iStep) & iMask)];
+        iCounter = max(iCounter, iTarget);
+    }
+}
+
+/*********************************************************************
+uint64_t CountMinSketch::estimate(uint32_t iKey) const
+Purpose:
+    Function to estimate the units counted for a key
+Parameters:
+    I   uint32_t iKey       SKU or aisle index
+Return Value:
+    Estimate, never below the true count
+Notes:
+    -
+*********************************************************************/
+uint64_t CountMinSketch::estimate(uint32_t iKey) const
+{
+    if (countsVec.empty())
+    {
+        return 0;
+    }
+
+    uint64_t iHash = hashKey(iKey);
+    uint64_t iStep = (iHash >> 32) | 1;
+    size_t iMask = iWidth - 1;
+    uint64_t iMinimum = UINT64_MAX;
+    for (size_t iRow = 0; iRow < iDepth; iRow++)
+    {
+        iMinimum = min(iMinimum, countsVec[iRow * iWidth + ((iHash + iRow * iStep) & iMask)]);
+    }
+    return iMinimum;
+}
+
+/*********************************************************************
+void CountMinSketch::clear()
+Purpose:
+    Function to zero every counter and keep the storage
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void CountMinSketch::clear()
+{
+    fill(countsVec.begin(), countsVec.end(), 0);
+}
+
+/*********************************************************************
+bool CountMinSketch::restore(const uint64_t* pCounts, size_t iCounts)
+Purpose:
+    Function to replace the counters with ones saved from counts
+Parameters:
+    I   uint64_t* pCounts       Saved counters, rows one after another
+    I   size_t iCounts          Number of saved counters
+Return Value:
+    True if the counters fit this sketch's width and depth, else false
+Notes:
+    An empty save restores a sketch that has never been added to
+*********************************************************************/
+bool CountMinSketch::restore(const uint64_t* pCounts, size_t iCounts)
+{
+    if (iCounts != 0 && iCounts != iWidth * iDepth)
+    {
+        return false;
+    }
+    countsVec.assign(pCounts, pCounts + iCounts);
+    return true;
+}
+
+/*********************************************************************
+size_t CountMinSketch::memoryBytes() const
+Purpose:
+    Function to report the storage the sketch holds
+Parameters:
+    -
+Return Value:
+    Bytes of counters
+Notes:
+    -
+*********************************************************************/
+size_t CountMinSketch::memoryBytes() const
+{
+    return countsVec.capacity() * sizeof(uint64_t);
+}
+
+/*********************************************************************
+static void addToWindow(SalesWindowSketches& window, uint32_t iSKU, uint32_t iAisle, uint64_t iUnits)
+Purpose:
+    Helper function to count a line in one window
+Parameters:
+    I/O SalesWindowSketches& window     Window to update
+    I   uint32_t iSKU                   Item sold
+    I   uint32_t iAisle                 Aisle it was taken from
+    I   uint64_t iUnits                 Units sold
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void addToWindow(SalesWindowSketches& window, uint32_t iSKU, uint32_t iAisle, uint64_t iUnits)
+{
+    window.topItems.add(iSKU, iUnits);
+    window.itemUnits.add(iSKU, iUnits);
+    window.topAisles.add(iAisle, iUnits);
+    window.aisleUnits.add(iAisle, iUnits);
+    window.iUnits += iUnits;
+}
+
+/*********************************************************************
+static void clearWindow(SalesWindowSketches& window)
+Purpose:
+    Helper function to empty a window
+Parameters:
+    I/O SalesWindowSketches& window     Window to empty
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void clearWindow(SalesWindowSketches& window)
+{
+    window.topItems.clear();
+    window.itemUnits.clear();
+    window.topAisles.clear();
+    window.aisleUnits.clear();
+    window.iUnits = 0;
+}
+
+/*********************************************************************
+void recordLineAnalytics(SalesAnalytics& analytics, int iSKU, int iAisleIndex, int iQuantity, int iHour)
+Purpose:
+    Function to count one committed line in the analytics
+Parameters:
+    I/O SalesAnalytics& analytics   Sketches to update
+    I   int iSKU                    Item sold
+    I   int iAisleIndex             Aisle it was taken from
+    I   int iQuantity               Units sold
+    I   int iHour                   Hour of day the line was committed
+Return Value:
+    -
+Notes:
+    A line from a new hour starts the hourly window again
+*********************************************************************/
+void recordLineAnalytics(SalesAnalytics& analytics, int iSKU, int iAisleIndex, int iQuantity, int iHour)
+{
+    if (iQuantity <= 0)
+    {
+        return;
+    }
+    if (analytics.hourWindow.iHour != iHour)
+    {
+        clearWindow(analytics.hourWindow);
+        analytics.hourWindow.iHour = iHour;
+    }
+    addToWindow(analytics.hourWindow, (uint32_t)iSKU, (uint32_t)iAisleIndex, (uint64_t)iQuantity);
+    addToWindow(analytics.dayWindow, (uint32_t)iSKU, (uint32_t)iAisleIndex, (uint64_t)iQuantity);
+}
+
+/*********************************************************************
+void recordCheckoutAnalytics(SalesAnalytics& analytics, const CheckoutSession& session, int iHour)
+Purpose:
+    Function to count every line of a committed checkout in the analytics
+Parameters:
+    I/O SalesAnalytics& analytics   Sketches to update
+    I   CheckoutSession session     Committed checkout
+    I   int iHour                   Hour of day it was committed
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void recordCheckoutAnalytics(SalesAnalytics& analytics, const CheckoutSession& session, int iHour)
+{
+    for (const StockChange& change : session.takenVec)
+    {
+        recordLineAnalytics(analytics, change.iSKU, change.iAisleIndex, change.iQuantity, iHour);
+    }
+}
+
+/*********************************************************************
+size_t analyticsMemoryBytes(const SalesAnalytics& analytics)
+Purpose:
+    Function to report the storage every sketch holds
+Parameters:
+    I   SalesAnalytics analytics    Sketches to measure
+Return Value:
+    Bytes held, fixed once both windows have seen a line
+Notes:
+    -
+*********************************************************************/
+size_t analyticsMemoryBytes(const SalesAnalytics& analytics)
+{
+    size_t iBytes = 0;
+    for (const SalesWindowSketches* pWindow : {&analytics.hourWindow, &analytics.dayWindow})
+    {
+        iBytes += pWindow->topItems.memoryBytes() + pWindow->itemUnits.memoryBytes()
+                + pWindow->topAisles.memoryBytes() + pWindow->aisleUnits.memoryBytes();
+    }
+    return iBytes;
+}
+
+/*********************************************************************
+static string itemNameBySKU(const Supermarket& myStore, int iSKU)
+Purpose:
+    Helper function to name an item for the best seller list
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   int iSKU                SKU of the item
+Return Value:
+    Item name, empty if the SKU is no longer in the store
+Notes:
+    -
+*********************************************************************/
+static string itemNameBySKU(const Supermarket& myStore, int iSKU)
+{
+    int iEntry = findCatalogEntry(myStore, iSKU);
+    if (iEntry < 0)
+    {
+        return "";
+    }
+    const ItemLocation& location = myStore.catalog.entriesVec[iEntry].location;
+    return myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex].szName;
+}
+
+/*********************************************************************
+void displayBestSellers(const Supermarket& myStore, bool bHourWindow, bool bAisles, int iCount)
+Purpose:
+    Function to display the best selling items or aisles
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   bool bHourWindow        True for this hour, false for since load
+    I   bool bAisles            True to rank aisles, false for items
+    I   int iCount              Most lines to list
+Return Value:
+    -
+Notes:
+    Units is the Space-Saving count, which can be over by the error
+    shown. Estimate is the Count-Min answer for the same key.
+*********************************************************************/
+void displayBestSellers(const Supermarket& myStore, bool bHourWindow, bool bAisles, int iCount)
+{
+    const SalesWindowSketches& window = bHourWindow ? myStore.analytics.hourWindow : myStore.analytics.dayWindow;
+    const SpaceSavingSketch& topKeys = bAisles ? window.topAisles : window.topItems;
+    const CountMinSketch& keyUnits = bAisles ? window.aisleUnits : window.itemUnits;
+    vector<HeavyHitter> hittersVec = topKeys.top((size_t)iCount);
+
+    cout << "Best Selling " << (bAisles ? "Aisles" : "Items");
+    if (bHourWindow)
+    {
+        cout << " This Hour";
+        if (window.iHour >= 0)
+        {
+            cout << " (" << window.iHour << ":00)";
+        }
+    }
+    else
+    {
+        cout << " Since Load";
+    }
+    cout << endl;
+    cout << szBreakMessage;
+    cout << left << setw(6) << "Rank" << setw(10) << (bAisles ? "Aisle" : "SKU") << setw(24) << "Name"
+         << setw(10) << "Units" << setw(10) << "Error" << "Estimate" << right << endl;
+    for (size_t i = 0; i < hittersVec.size(); i++)
+    {
+        const HeavyHitter& hitter = hittersVec[i];
+        string szName;
+        if (bAisles)
+        {
+            szName = hitter.iKey < myStore.aislesVec.size() ? myStore.aislesVec[hitter.iKey].szName : "";
+        }
+        else
+        {
+            szName = itemNameBySKU(myStore, (int)hitter.iKey);
+        }
+        cout << left << setw(6) << i + 1 << setw(10) << hitter.iKey << setw(24) << szName.substr(0, 23)
+             << setw(10) << hitter.iCount << setw(10) << hitter.iError << keyUnits.estimate(hitter.iKey) << right << endl;
+    }
+    if (hittersVec.empty())
+    {
+        cout << "No sales counted yet." << endl;
+    }
+    cout << szBreakMessage;
+    cout << "Units counted: " << window.iUnits << ", sketch memory: " << analyticsMemoryBytes(myStore.analytics) << " bytes" << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void processBestSellers(const Supermarket& myStore)
+Purpose:
+    Function to prompt for a window and list the best sellers, then
+    look up units sold for any SKU
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processBestSellers(const Supermarket& myStore)
+{
+    char cWindow = 'd';
+    char cKind = 'i';
+    int iCount = 10;
+    int iSKU = 0;
+
+    cout << "Window, this (h)our or since (l)oad: ";
+    cin >> cWindow;
+    cout << "Rank (i)tems or (a)isles: ";
+    cin >> cKind;
+    cout << "How many to list: ";
+    if (!(cin >> iCount) || iCount <= 0)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid count." << endl;
+        return;
+    }
+    iCount = min(iCount, iMAX_BEST_SELLERS);
+
+    bool bHourWindow = cWindow == 'h' || cWindow == 'H';
+    displayBestSellers(myStore, bHourWindow, cKind == 'a' || cKind == 'A', iCount);
+
+    const SalesWindowSketches& window = bHourWindow ? myStore.analytics.hourWindow : myStore.analytics.dayWindow;
+    cout << "Enter a SKU to look up units sold (0 to skip): ";
+    if (!(cin >> iSKU))
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid SKU." << endl;
+        return;
+    }
+    if (iSKU > 0)
+    {
+        cout << "SKU " << iSKU << " estimated units sold: " << window.itemUnits.estimate((uint32_t)iSKU) << endl;
+    }
+}
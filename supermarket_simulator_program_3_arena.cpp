@@ -0,0 +1,169 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_arena.cpp
+
+Purpose:
+    Per-store bump allocator behind the store containers.
+
+Notes:
+    - Blocks start at 4 KB so a small store stays small, and double up
+      to 1 MB so a large store is a handful of contiguous blocks.
+    - Requests larger than the next block get a block of their own.
+    - Nothing is freed until the arena itself is destroyed, which
+      happens when the store is reset with myStore = Supermarket().
+*********************************************************************/
+
+// Largest block the arena grows to on its own
+static const size_t iMAX_ARENA_BLOCK = 1 << 20;
+
+/*********************************************************************
+void* StoreArena::allocate(size_t iBytes, size_t iAlign)
+Purpose:
+    Function to hand out storage from the arena
+Parameters:
+    I   size_t iBytes       Number of bytes needed
+    I   size_t iAlign       Alignment needed, a power of two
+Return Value:
+    Pointer to the storage
+Notes:
+    Thread safe
+*********************************************************************/
+void* StoreArena::allocate(size_t iBytes, size_t iAlign)
+{
+    lock_guard<mutex> guard(arenaLock);
+
+    uintptr_t iAddress = ((uintptr_t)pNext + iAlign - 1) & ~(uintptr_t)(iAlign - 1);
+    if (pNext == nullptr || iAddress + iBytes > (uintptr_t)pEnd)
+    {
+        size_t iBlockBytes = max(iNextBlockBytes, iBytes + iAlign);
+        blocksVec.emplace_back(new char[iBlockBytes]);
+        pNext = blocksVec.back().get();
+        pEnd = pNext + iBlockBytes;
+        iReserved += iBlockBytes;
+        iNextBlockBytes = min(iNextBlockBytes * 2, iMAX_ARENA_BLOCK);
+
+        iAddress = ((uintptr_t)pNext + iAlign - 1) & ~(uintptr_t)(iAlign - 1);
+    }
+
+    pNext = (char*)(iAddress + iBytes);
+    iUsed += iBytes;
+    return (void*)iAddress;
+}
+
+/*********************************************************************
+size_t StoreArena::bytesReserved() const
+Purpose:
+    Function to report the bytes held by the arena
+Parameters:
+    -
+Return Value:
+    Total size of every block
+Notes:
+    -
+*********************************************************************/
+size_t StoreArena::bytesReserved() const
+{
+    lock_guard<mutex> guard(arenaLock);
+    return iReserved;
+}
+
+/*********************************************************************
+size_t StoreArena::bytesUsed() const
+Purpose:
+    Function to report the bytes handed out by the arena
+Parameters:
+    -
+Return Value:
+    Bytes handed out, including storage left behind by growth
+Notes:
+    -
+*********************************************************************/
+size_t StoreArena::bytesUsed() const
+{
+    lock_guard<mutex> guard(arenaLock);
+    return iUsed;
+}
+
+/*********************************************************************
+Supermarket::Supermarket(const Supermarket& other)
+Purpose:
+    Copy constructor, copies a store into a fresh arena
+Parameters:
+    I   Supermarket other       Store to copy
+Return Value:
+    -
+Notes:
+    See operator=
+*********************************************************************/
+Supermarket::Supermarket(const Supermarket& other)
+{
+    *this = other;
+}
+
+/*********************************************************************
+Supermarket& Supermarket::operator=(const Supermarket& other)
+Purpose:
+    Function to replace the store with a copy of another
+Parameters:
+    I   Supermarket other       Store to copy
+Return Value:
+    This store
+Notes:
+    The copy gets an arena of its own and holds nothing of the
+    original's, and has no journal so it never writes to the
+    original's file. Attach one to journal the copy.
+*********************************************************************/
+Supermarket& Supermarket::operator=(const Supermarket& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    szName = other.szName;
+    szStoreHours = other.szStoreHours;
+    mMembershipFee = other.mMembershipFee;
+    mTotalFunds = other.mTotalFunds;
+
+    // Containers made in the old arena must go before it does
+    aislesVec = ArenaVector<Aisle>();
+    employeesVec = ArenaVector<Employee>();
+    customersVec = ArenaVector<CustomerPurchase>();
+    lineItems = LineItemLog();
+    pArena = make_shared<StoreArena>();
+
+    aislesVec = ArenaVector<Aisle>(pArena);
+    aislesVec.reserve(other.aislesVec.size());
+    for (const Aisle& aisle : other.aislesVec)
+    {
+        Aisle& copy = aislesVec.emplace_back(pArena);
+        copy.szName = aisle.szName;
+        copy.itemVec.reserve(aisle.itemVec.size());
+        for (const Item& item : aisle.itemVec)
+        {
+            copy.itemVec.push_back(item);
+        }
+    }
+    employeesVec = ArenaVector<Employee>(pArena);
+    employeesVec.reserve(other.employeesVec.size());
+    for (const Employee& employee : other.employeesVec)
+    {
+        employeesVec.push_back(employee);
+    }
+    customersVec = ArenaVector<CustomerPurchase>(pArena);
+    customersVec.reserve(other.customersVec.size());
+    for (const CustomerPurchase& purchase : other.customersVec)
+    {
+        customersVec.push_back(purchase);
+    }
+
+    memberRegistry = other.memberRegistry;
+    catalog = other.catalog;
+    sales = other.sales;
+    restock = other.restock;
+    analytics = other.analytics;
+    lineItems = LineItemLog(pArena);
+    lineItems.appendLog(other.lineItems);
+    pJournal.reset();
+    return *this;
+}
@@ -0,0 +1,1971 @@
+#include "supermarket_simulator_program_3.h"
+#include <sys/resource.h>
+#include <unistd.h>
+/*********************************************************************
+File name: supermarket_simulator_program_3_bench.cpp
+
+Purpose:
+    Micro-benchmarks for the simulator hot paths.
+
+Notes:
+    - Output is written to /dev/null so terminal speed is not measured.
+    - Timings are reported as nanoseconds per call.
+    - The suite prints CSV so runs can be compared by scripts.
+*********************************************************************/
+
+/*********************************************************************
+static void legacyDisplayItems(const Supermarket myStore, int iAisleIndex, ostream& out)
+Purpose:
+    Copy of the original by-value displayItems, kept as a baseline
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info, copied
+    I   int iAisleIndex         Index of the aisle to display items
+    O   ostream& out            Stream to write to
+Return Value:
+    -
+Notes:
+    Copies the store, the aisle and every item and flushes each line
+    exactly like the display functions did before they took references
+*********************************************************************/
+static void legacyDisplayItems(const Supermarket myStore, int iAisleIndex, ostream& out)
+{
+    if (!isValidAisle(myStore, iAisleIndex))
+    {
+        out << "Invalid Aisle Index." << endl;
+        return;
+    }
+
+    Aisle aisle = myStore.aislesVec[iAisleIndex];
+    out << "Aisle " << iAisleIndex << ": " << aisle.szName << endl;
+    out << szBreakMessage;
+
+    for (size_t i = 0; i < aisle.itemVec.size(); i++)
+    {
+        if (!aisle.itemVec[i].szName.empty())
+        {
+            Item item = aisle.itemVec[i];
+            out << endl;
+            out << item.szName << endl;
+            out << "Item Quantity: " << item.iQuantity << endl;
+            out << "Regular Price: " << item.mRegularPrice << endl;
+            out << "Member  Price: " << item.mMembersPrice << endl;
+        }
+    }
+    out << szBreakMessage;
+}
+
+/*********************************************************************
+static void legacyDisplayAisles(const Supermarket myStore, ostream& out)
+Purpose:
+    Copy of the original by-value displayAisles, kept as a baseline
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info, copied
+    O   ostream& out            Stream to write to
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void legacyDisplayAisles(const Supermarket myStore, ostream& out)
+{
+    out << myStore.szName << "'s Aisles" << endl;
+    out << szBreakMessage;
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
+    {
+        if (!myStore.aislesVec[i].szName.empty())
+        {
+            out << "Aisle " << i << ": " << myStore.aislesVec[i].szName << endl;
+        }
+    }
+    out << szBreakMessage;
+}
+
+/*********************************************************************
+static bool legacyLoadSupermarketFile(const string& szFilename, Supermarket& myStore)
+Purpose:
+    Copy of the original getline and istringstream loader, kept as a
+    baseline
+Parameters:
+    I   string szFilename       Path of the supermarket text file
+    I/O Supermarket& myStore    Supermarket structure to populate
+Return Value:
+    True if the file was opened, else false
+Notes:
+    Builds a stream for every item and employee line and rewrites
+    underscores afterwards, exactly like the loader did before mapping
+*********************************************************************/
+static bool legacyLoadSupermarketFile(const string& szFilename, Supermarket& myStore)
+{
+    fstream fileInput(szFilename, ios::in);
+    if (!fileInput.is_open())
+    {
+        return false;
+    }
+
+    myStore = Supermarket();
+    getline(fileInput, myStore.szName);
+    getline(fileInput, myStore.szStoreHours);
+    fileInput >> myStore.mTotalFunds;
+    fileInput.ignore();
+    fileInput >> myStore.mMembershipFee;
+    fileInput.ignore();
+    string szLine;
+    getline(fileInput, szLine);
+
+    while (getline(fileInput, szLine) && szLine != "*Employee Information*")
+    {
+        if (szLine.find("Aisle") != string::npos)
+        {
+            Aisle& currentAisle = myStore.aislesVec.emplace_back(myStore.pArena);
+            currentAisle.szName = szLine.substr(szLine.find(":") + 2);
+
+            while (getline(fileInput, szLine) && szLine != "############################")
+            {
+                istringstream issItem(szLine);
+                Item& currentItem = currentAisle.itemVec.emplace_back();
+                issItem >> currentItem.szName >> currentItem.mWholesale >> currentItem.mRegularPrice >> currentItem.mMembersPrice;
+                if (!(issItem >> currentItem.iSKU))
+                {
+                    currentItem.iSKU = 0;
+                }
+                for (char& c : currentItem.szName)
+                {
+                    if (c == '_')
+                    {
+                        c = ' ';
+                    }
+                }
+            }
+        }
+    }
+
+    while (getline(fileInput, szLine))
+    {
+        if (szLine.empty())
+        {
+            continue;
+        }
+
+        istringstream issEmployee(szLine);
+        Employee& currentEmployee = myStore.employeesVec.emplace_back();
+        issEmployee >> currentEmployee.szName >> currentEmployee.szID >> currentEmployee.mSalary;
+        for (char& c : currentEmployee.szName)
+        {
+            if (c == '_')
+            {
+                c = ' ';
+            }
+        }
+    }
+
+    buildCatalogIndex(myStore);
+    return true;
+}
+
+/*********************************************************************
+static double nanosecondsPerCall(int iIterations, F function)
+Purpose:
+    Helper function to time a callable
+Parameters:
+    I   int iIterations     Number of calls to time
+    I   F function          Callable to time
+Return Value:
+    Mean nanoseconds per call
+Notes:
+    -
+*********************************************************************/
+template <typename F>
+static double nanosecondsPerCall(int iIterations, F function)
+{
+    auto tStart = chrono::steady_clock::now();
+    for (int i = 0; i < iIterations; i++)
+    {
+        function();
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - tStart;
+    return elapsed.count() / max(iIterations, 1);
+}
+
+/*********************************************************************
+void benchmarkDisplay(const Supermarket& myStore, int iIterations)
+Purpose:
+    Function to compare the old by-value display path with the
+    reference and single buffer renderer
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   int iIterations         Calls to time for each function
+Return Value:
+    -
+Notes:
+    Items are rendered for the first non-empty aisle
+*********************************************************************/
+void benchmarkDisplay(const Supermarket& myStore, int iIterations)
+{
+    ofstream nullOut("/dev/null");
+    nullOut << fixed << setprecision(2);
+
+    int iAisleIndex = 0;
+    while (iAisleIndex < (int)myStore.aislesVec.size() - 1 && myStore.aislesVec[iAisleIndex].szName.empty())
+    {
+        iAisleIndex++;
+    }
+
+    double dOldAisles = nanosecondsPerCall(iIterations, [&]() { legacyDisplayAisles(myStore, nullOut); });
+    double dNewAisles = nanosecondsPerCall(iIterations, [&]() { nullOut << renderAisles(myStore) << flush; });
+    double dOldItems = nanosecondsPerCall(iIterations, [&]() { legacyDisplayItems(myStore, iAisleIndex, nullOut); });
+    double dNewItems = nanosecondsPerCall(iIterations, [&]() { nullOut << renderItems(myStore, iAisleIndex) << flush; });
+
+    cout << "Display Benchmark (ns per call)" << endl;
+    cout << szBreakMessage;
+    cout << left << setw(16) << "Function" << setw(16) << "By value" << setw(16) << "Renderer" << "Speedup" << right << endl;
+    cout << fixed << setprecision(0);
+    cout << left << setw(16) << "displayAisles" << setw(16) << dOldAisles << setw(16) << dNewAisles
+         << setprecision(1) << dOldAisles / dNewAisles << right << endl;
+    cout << setprecision(0);
+    cout << left << setw(16) << "displayItems" << setw(16) << dOldItems << setw(16) << dNewItems
+         << setprecision(1) << dOldItems / dNewItems << right << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkMembers(int iMembers)
+Purpose:
+    Function to time the member registry at a given size
+Parameters:
+    I   int iMembers        Number of members to sign up
+Return Value:
+    -
+Notes:
+    Misses use names that were never signed up, so most of them are
+    answered by the Bloom filter. The linear scan the registry replaced
+    is timed over at most 10000 members to keep the run short.
+*********************************************************************/
+void benchmarkMembers(int iMembers)
+{
+    iMembers = max(iMembers, 1);
+    vector<string> namesVec(iMembers);
+    vector<string> visitorsVec(iMembers);
+    for (int i = 0; i < iMembers; i++)
+    {
+        namesVec[i] = "Member " + to_string(i);
+        visitorsVec[i] = "Visitor " + to_string(i);
+    }
+
+    MemberRegistry registry;
+    int iIndex = 0;
+    double dInsert = nanosecondsPerCall(iMembers, [&]() { registryInsert(registry, namesVec[iIndex++]); });
+
+    long long lFound = 0;
+    iIndex = 0;
+    double dHit = nanosecondsPerCall(iMembers, [&]() { lFound += registryContains(registry, namesVec[iIndex++]); });
+    iIndex = 0;
+    double dMiss = nanosecondsPerCall(iMembers, [&]() { lFound += registryContains(registry, visitorsVec[iIndex++]); });
+
+    // The array scan checkout used before the registry
+    int iScanMembers = min(iMembers, 10000);
+    int iScanLookups = min(iMembers, 2000);
+    iIndex = 0;
+    double dScan = nanosecondsPerCall(iScanLookups, [&]()
+    {
+        const string& szName = namesVec[(iIndex++ * 7919) % iScanMembers];
+        for (int i = 0; i < iScanMembers; i++)
+        {
+            if (registry.membersVec[i].szName == szName)
+            {
+                lFound += 1;
+                break;
+            }
+        }
+    });
+
+    size_t iBytes = registryMemoryBytes(registry);
+    double dClear = nanosecondsPerCall(1, [&]() { registryClear(registry); });
+
+    cout << "Member Registry Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Members: " << iMembers << endl;
+    cout << fixed << setprecision(1);
+    cout << "Insert ns/op: " << dInsert << endl;
+    cout << "Lookup hit ns/op: " << dHit << endl;
+    cout << "Lookup miss ns/op: " << dMiss << endl;
+    cout << "Linear scan ns/op (" << iScanMembers << " members): " << dScan << endl;
+    cout << "Clear ns: " << dClear << endl;
+    cout << "Bytes per member: " << (double)iBytes / iMembers << endl;
+    cout << "Checksum: " << lFound << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkInventory(int iItems)
+Purpose:
+    Function to compare the column inventory kernels with plain loops
+    over the aisles
+Parameters:
+    I   int iItems          Number of items in the generated store
+Return Value:
+    -
+Notes:
+    The store has 1000 items per aisle with prices from a fixed seed.
+    Each kernel is run several times and the mean is reported.
+*********************************************************************/
+void benchmarkInventory(int iItems)
+{
+    const int iITEMS_PER_AISLE = 1000;
+    const int iPASSES = 10;
+    iItems = max(iItems, 1);
+
+    Supermarket market;
+    mt19937_64 rng(42);
+    uniform_real_distribution<double> wholesalePrice(0.10, 20.0);
+    uniform_int_distribution<int> stock(0, 60);
+    for (int i = 0; i < iItems; i++)
+    {
+        if (i % iITEMS_PER_AISLE == 0)
+        {
+            market.aislesVec.emplace_back(market.pArena).szName = "Aisle " + to_string(i / iITEMS_PER_AISLE);
+        }
+        Item& item = market.aislesVec.back().itemVec.emplace_back();
+        item.szName = "Item " + to_string(i);
+        item.iQuantity = stock(rng);
+        double dWholesale = wholesalePrice(rng);
+        item.mWholesale = moneyFromDouble(dWholesale);
+        item.mRegularPrice = moneyFromDouble(dWholesale * 1.5);
+        item.mMembersPrice = moneyFromDouble(dWholesale * 1.3);
+        item.iSKU = i + 1;
+    }
+
+    InventoryColumns columns;
+    double dBuild = nanosecondsPerCall(1, [&]() { buildInventoryColumns(market, columns); });
+
+    // Scalar loops over the aisles, as the store is laid out
+    InventoryValue scalarValue;
+    double dScalarValue = nanosecondsPerCall(iPASSES, [&]()
+    {
+        scalarValue = InventoryValue();
+        for (const Aisle& aisle : market.aislesVec)
+        {
+            for (const Item& item : aisle.itemVec)
+            {
+                scalarValue.mWholesale += item.mWholesale * item.iQuantity;
+                scalarValue.mRetail += item.mRegularPrice * item.iQuantity;
+                scalarValue.mMemberRetail += item.mMembersPrice * item.iQuantity;
+            }
+        }
+    });
+    vector<Money> regularMarginVec(iItems);
+    vector<Money> memberMarginVec(iItems);
+    double dScalarMargins = nanosecondsPerCall(iPASSES, [&]()
+    {
+        size_t iRow = 0;
+        for (const Aisle& aisle : market.aislesVec)
+        {
+            for (const Item& item : aisle.itemVec)
+            {
+                regularMarginVec[iRow] = item.mRegularPrice - item.mWholesale;
+                memberMarginVec[iRow] = item.mMembersPrice - item.mWholesale;
+                iRow++;
+            }
+        }
+    });
+    size_t iScalarLow = 0;
+    double dScalarLow = nanosecondsPerCall(iPASSES, [&]()
+    {
+        iScalarLow = 0;
+        for (const Aisle& aisle : market.aislesVec)
+        {
+            for (const Item& item : aisle.itemVec)
+            {
+                iScalarLow += item.iQuantity < 5;
+            }
+        }
+    });
+    size_t iScalarBand = 0;
+    double dScalarBand = nanosecondsPerCall(iPASSES, [&]()
+    {
+        iScalarBand = 0;
+        for (const Aisle& aisle : market.aislesVec)
+        {
+            for (const Item& item : aisle.itemVec)
+            {
+                iScalarBand += item.mRegularPrice >= Money(500) && item.mRegularPrice <= Money(600);
+            }
+        }
+    });
+
+    // Column kernels
+    InventoryValue columnValue;
+    double dColumnValue = nanosecondsPerCall(iPASSES, [&]() { columnValue = calculateInventoryValue(columns); });
+    double dColumnMargins = nanosecondsPerCall(iPASSES, [&]() { calculateItemMargins(columns, regularMarginVec, memberMarginVec); });
+    vector<uint32_t> rowsVec;
+    size_t iColumnLow = 0;
+    double dColumnLow = nanosecondsPerCall(iPASSES, [&]() { iColumnLow = findLowStock(columns, 5, rowsVec); });
+    size_t iColumnBand = 0;
+    double dColumnBand = nanosecondsPerCall(iPASSES, [&]() { iColumnBand = filterPriceBand(columns, Money(500), Money(600), rowsVec); });
+
+    cout << "Inventory Analytics Benchmark (ms per pass)" << endl;
+    cout << szBreakMessage;
+    cout << "Items: " << iItems << endl;
+    cout << fixed << setprecision(3);
+    cout << "Column build: " << dBuild / 1e6 << endl;
+    cout << left << setw(16) << "Kernel" << setw(12) << "Aisles" << setw(12) << "Columns" << "Speedup" << right << endl;
+    cout << left << setw(16) << "Value" << setw(12) << dScalarValue / 1e6 << setw(12) << dColumnValue / 1e6
+         << dScalarValue / dColumnValue << right << endl;
+    cout << left << setw(16) << "Margins" << setw(12) << dScalarMargins / 1e6 << setw(12) << dColumnMargins / 1e6
+         << dScalarMargins / dColumnMargins << right << endl;
+    cout << left << setw(16) << "Low stock" << setw(12) << dScalarLow / 1e6 << setw(12) << dColumnLow / 1e6
+         << dScalarLow / dColumnLow << right << endl;
+    cout << left << setw(16) << "Price band" << setw(12) << dScalarBand / 1e6 << setw(12) << dColumnBand / 1e6
+         << dScalarBand / dColumnBand << right << endl;
+    cout << setprecision(2);
+    cout << "Wholesale value: $" << columnValue.mWholesale << " (aisles $" << scalarValue.mWholesale << ")" << endl;
+    cout << "Low stock items: " << iColumnLow << " (aisles " << iScalarLow << ")" << endl;
+    cout << "Items in band: " << iColumnBand << " (aisles " << iScalarBand << ")" << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkLoader(const string& szFilename, int iIterations)
+Purpose:
+    Function to compare the old stream loader with the mapped loader
+Parameters:
+    I   string szFilename       Path of the supermarket text file
+    I   int iIterations         Loads to time for each loader
+Return Value:
+    -
+Notes:
+    Both loaders include building the catalog index. The file is read
+    once first so both are timed from the page cache.
+*********************************************************************/
+void benchmarkLoader(const string& szFilename, int iIterations)
+{
+    iIterations = max(iIterations, 1);
+
+    Supermarket market;
+    StoreFileError error;
+    if (!mapSupermarketFile(szFilename, market, error))
+    {
+        cout << szFilename << ": line " << error.iLine << ", column " << error.iColumn
+             << ": " << error.szMessage << endl;
+        return;
+    }
+
+    ifstream fileSize(szFilename, ios::binary | ios::ate);
+    double dMegabytes = (double)fileSize.tellg() / 1e6;
+    size_t iItems = 0;
+    for (const Aisle& aisle : market.aislesVec)
+    {
+        iItems += aisle.itemVec.size();
+    }
+
+    double dStream = nanosecondsPerCall(iIterations, [&]()
+    {
+        Supermarket store;
+        legacyLoadSupermarketFile(szFilename, store);
+    });
+    double dMapped = nanosecondsPerCall(iIterations, [&]()
+    {
+        Supermarket store;
+        mapSupermarketFile(szFilename, store, error);
+    });
+
+    double dIndex = nanosecondsPerCall(1, [&]() { buildCatalogIndex(market); });
+
+    cout << "Store File Loader Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "File MB: " << dMegabytes << endl;
+    cout << "Aisles: " << market.aislesVec.size() << ", items: " << iItems
+         << ", employees: " << market.employeesVec.size() << endl;
+    cout << left << setw(16) << "Loader" << setw(12) << "ms/load" << setw(12) << "MB/s" << right << endl;
+    cout << fixed << setprecision(1);
+    cout << left << setw(16) << "Stream" << setw(12) << dStream / 1e6 << setw(12) << dMegabytes / (dStream / 1e9) << right << endl;
+    cout << left << setw(16) << "Mapped" << setw(12) << dMapped / 1e6 << setw(12) << dMegabytes / (dMapped / 1e9) << right << endl;
+    cout << "Speedup: " << dStream / dMapped << endl;
+    cout << "Catalog index ms (in both loads): " << dIndex / 1e6 << endl;
+    cout << "Mapped parse MB/s without index: " << dMegabytes / (max(dMapped - dIndex, 1.0) / 1e9) << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkSnapshot(const string& szFilename, int iIterations)
+Purpose:
+    Function to compare restoring a binary snapshot with loading the
+    store text file
+Parameters:
+    I   string szFilename       Path of the supermarket text file
+    I   int iIterations         Loads to time for each format
+Return Value:
+    -
+Notes:
+    The snapshot is written beside the text file and removed afterwards.
+    Only the text load builds the catalog index, the snapshot carries it.
+*********************************************************************/
+void benchmarkSnapshot(const string& szFilename, int iIterations)
+{
+    iIterations = max(iIterations, 1);
+
+    Supermarket market;
+    StoreFileError error;
+    if (!mapSupermarketFile(szFilename, market, error))
+    {
+        cout << szFilename << ": line " << error.iLine << ", column " << error.iColumn
+             << ": " << error.szMessage << endl;
+        return;
+    }
+
+    string szSnapshot = szFilename + ".bench.snap";
+    bool bSaved = true;
+    double dSave = nanosecondsPerCall(1, [&]() { bSaved = saveStoreSnapshot(market, szSnapshot, error); });
+    if (!bSaved)
+    {
+        cout << szSnapshot << ": " << error.szMessage << endl;
+        return;
+    }
+
+    ifstream textSize(szFilename, ios::binary | ios::ate);
+    ifstream snapshotSize(szSnapshot, ios::binary | ios::ate);
+    double dTextMegabytes = (double)textSize.tellg() / 1e6;
+    double dSnapshotMegabytes = (double)snapshotSize.tellg() / 1e6;
+
+    double dText = nanosecondsPerCall(iIterations, [&]()
+    {
+        Supermarket store;
+        mapSupermarketFile(szFilename, store, error);
+    });
+    bool bRestored = true;
+    double dRestore = nanosecondsPerCall(iIterations, [&]()
+    {
+        Supermarket store;
+        bRestored = loadStoreSnapshot(szSnapshot, store, error) && bRestored;
+    });
+    double dIndex = nanosecondsPerCall(1, [&]() { buildCatalogIndex(market); });
+    remove(szSnapshot.c_str());
+
+    cout << "Store Snapshot Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Text MB: " << dTextMegabytes << ", snapshot MB: " << dSnapshotMegabytes << endl;
+    cout << fixed << setprecision(1);
+    cout << "Snapshot save ms: " << dSave / 1e6 << endl;
+    cout << left << setw(16) << "Load" << setw(12) << "ms/load" << right << endl;
+    cout << left << setw(16) << "Text file" << setw(12) << dText / 1e6 << right << endl;
+    cout << left << setw(16) << "Snapshot" << setw(12) << dRestore / 1e6 << right << endl;
+    cout << "Speedup: " << dText / dRestore << endl;
+    cout << "Catalog index ms (text load only): " << dIndex / 1e6 << endl;
+    cout << "Snapshot restored: " << (bRestored ? "yes" : "no") << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkJournal(const string& szStoreFile, const string& szTransactionFile, int iLanes)
+Purpose:
+    Function to compare checkout throughput with the journal off and on
+    and check that replaying the journal rebuilds the store and its
+    sales totals
+Parameters:
+    I   string szStoreFile          Path of the supermarket text file
+    I   string szTransactionFile    Path of the transaction file
+    I   int iLanes                  Checkout lanes (threads) to run
+Return Value:
+    -
+Notes:
+    The journaled run includes the final sync, so every record is on
+    disk when the clock stops. The journal is written beside the store
+    file and removed afterwards.
+*********************************************************************/
+void benchmarkJournal(const string& szStoreFile, const string& szTransactionFile, int iLanes)
+{
+    Supermarket market;
+    vector<Basket> basketsVec;
+    long long lMalformed = 0;
+    if (!loadSupermarketFile(szStoreFile, market) ||
+        !loadTransactionFile(szTransactionFile, basketsVec, lMalformed))
+    {
+        return;
+    }
+
+    Supermarket plainStore = market;
+    MultiLaneStats plainStats = runMultiLaneCheckout(plainStore, basketsVec, iLanes);
+
+    string szBase = szStoreFile + ".bench";
+    string szJournal = szBase + ".journal";
+    Supermarket journaledStore = market;
+    if (!attachJournal(journaledStore, szBase, true))
+    {
+        return;
+    }
+    MultiLaneStats journaledStats;
+    double dJournaled = nanosecondsPerCall(1, [&]()
+    {
+        journaledStats = runMultiLaneCheckout(journaledStore, basketsVec, iLanes);
+        journaledStore.pJournal->sync();
+    });
+    long long lRecords = journaledStore.pJournal->recordsWritten();
+    long long lSyncs = journaledStore.pJournal->syncsDone();
+    journaledStore.pJournal->close();
+
+    // Replay onto a fresh copy of the store and compare
+    Supermarket replayedStore = market;
+    StoreFileError error;
+    long long lReplayed = 0;
+    bool bReplayed = true;
+    double dReplay = nanosecondsPerCall(1, [&]()
+    {
+        bReplayed = replayJournal(replayedStore, szJournal, lReplayed, error);
+    });
+    remove(szJournal.c_str());
+
+    bool bMatches = bReplayed &&
+                    replayedStore.mTotalFunds == journaledStore.mTotalFunds &&
+                    replayedStore.sales.mGrossSales == journaledStore.sales.mGrossSales &&
+                    replayedStore.sales.lCheckouts == journaledStore.sales.lCheckouts &&
+                    replayedStore.customersVec.size() == journaledStore.customersVec.size() &&
+                    replayedStore.memberRegistry.membersVec.size() == journaledStore.memberRegistry.membersVec.size();
+    for (size_t i = 0; bMatches && i < market.aislesVec.size(); i++)
+    {
+        for (size_t j = 0; bMatches && j < market.aislesVec[i].itemVec.size(); j++)
+        {
+            bMatches = replayedStore.aislesVec[i].itemVec[j].iQuantity ==
+                       journaledStore.aislesVec[i].itemVec[j].iQuantity;
+        }
+    }
+
+    double dPlain = plainStats.dSeconds;
+    double dOn = dJournaled / 1e9;
+    cout << "Transaction Journal Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << basketsVec.size() << " baskets, " << max(iLanes, 1) << " lanes" << endl;
+    cout << fixed << setprecision(1);
+    cout << left << setw(16) << "Journal" << setw(12) << "ms" << setw(16) << "tx/s" << right << endl;
+    cout << left << setw(16) << "Off" << setw(12) << dPlain * 1e3
+         << setw(16) << plainStats.lTransactions / max(dPlain, 1e-9) << right << endl;
+    cout << left << setw(16) << "On" << setw(12) << dOn * 1e3
+         << setw(16) << journaledStats.lTransactions / max(dOn, 1e-9) << right << endl;
+    cout << "Records: " << lRecords << ", syncs: " << lSyncs
+         << ", records per sync: " << (double)lRecords / max(lSyncs, 1LL) << endl;
+    cout << "Replay ms: " << dReplay / 1e6 << ", records replayed: " << lReplayed << endl;
+    cout << "Replayed store matches: " << (bMatches ? "yes" : "no") << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+static double sumInParts(const vector<T>& valuesVec, int iParts, R zero, F add)
+Purpose:
+    Helper function to sum values on several threads the way lanes do
+Parameters:
+    I   vector<T> valuesVec     Values to sum
+    I   int iParts              Threads, each sums one contiguous part
+    I   R zero                  Empty sum
+    I   F add                   Adds one value to a partial sum
+Return Value:
+    Partial sums added together in part order
+Notes:
+    -
+*********************************************************************/
+template <typename T, typename R, typename F>
+static R sumInParts(const vector<T>& valuesVec, int iParts, R zero, F add)
+{
+    vector<R> partsVec(iParts, zero);
+    vector<thread> threadsVec;
+    for (int i = 0; i < iParts; i++)
+    {
+        threadsVec.emplace_back([&, i]()
+        {
+            size_t iStart = valuesVec.size() * i / iParts;
+            size_t iEnd = valuesVec.size() * (i + 1) / iParts;
+            R sum = zero;
+            for (size_t j = iStart; j < iEnd; j++)
+            {
+                sum = add(sum, valuesVec[j]);
+            }
+            partsVec[i] = sum;
+        });
+    }
+    for (thread& partThread : threadsVec)
+    {
+        partThread.join();
+    }
+
+    R total = zero;
+    for (const R& part : partsVec)
+    {
+        total = add(total, part);
+    }
+    return total;
+}
+
+/*********************************************************************
+void benchmarkMoney(int iItems)
+Purpose:
+    Function to compare whole-cent Money with the double amounts it
+    replaced, for speed and for exactness
+Parameters:
+    I   int iItems          Number of generated line totals
+Return Value:
+    -
+Notes:
+    Amounts are generated as whole cents from a fixed seed, so both
+    paths start from the same values. The exact total is the Money one.
+*********************************************************************/
+void benchmarkMoney(int iItems)
+{
+    const int iPASSES = 10;
+    iItems = max(iItems, 1);
+
+    mt19937_64 rng(42);
+    uniform_int_distribution<int64_t> cents(1, 5000);
+    uniform_int_distribution<int> quantity(1, 12);
+    vector<Money> pricesVec(iItems);
+    vector<double> priceDoublesVec(iItems);
+    vector<int> quantitiesVec(iItems);
+    for (int i = 0; i < iItems; i++)
+    {
+        pricesVec[i] = Money(cents(rng));
+        priceDoublesVec[i] = moneyToDouble(pricesVec[i]);
+        quantitiesVec[i] = quantity(rng);
+    }
+
+    // Cart lines: price times quantity summed
+    double dDoubleTotal = 0.0;
+    double dDoubleLines = nanosecondsPerCall(iPASSES, [&]()
+    {
+        dDoubleTotal = 0.0;
+        for (int i = 0; i < iItems; i++)
+        {
+            dDoubleTotal += priceDoublesVec[i] * quantitiesVec[i];
+        }
+    });
+    Money mMoneyTotal;
+    double dMoneyLines = nanosecondsPerCall(iPASSES, [&]()
+    {
+        mMoneyTotal = Money();
+        for (int i = 0; i < iItems; i++)
+        {
+            mMoneyTotal += pricesVec[i] * quantitiesVec[i];
+        }
+    });
+
+    // Taxed purchases: each line as its own checkout
+    double dDoubleTaxed = 0.0;
+    double dDoubleTax = nanosecondsPerCall(1, [&]()
+    {
+        dDoubleTaxed = 0.0;
+        for (int i = 0; i < iItems; i++)
+        {
+            dDoubleTaxed += priceDoublesVec[i] * quantitiesVec[i] * (1 + iSALES_TAX_BASIS_POINTS / 10000.0);
+        }
+    });
+    Money mMoneyTaxed;
+    double dMoneyTax = nanosecondsPerCall(1, [&]()
+    {
+        mMoneyTaxed = Money();
+        for (int i = 0; i < iItems; i++)
+        {
+            Money mCart = pricesVec[i] * quantitiesVec[i];
+            mMoneyTaxed += mCart + calculateSalesTax(mCart);
+        }
+    });
+
+    cout << "Money Benchmark (ns per line)" << endl;
+    cout << szBreakMessage;
+    cout << "Lines: " << iItems << endl;
+    cout << fixed << setprecision(3);
+    cout << left << setw(16) << "Path" << setw(12) << "Double" << setw(12) << "Money" << right << endl;
+    cout << left << setw(16) << "Line totals" << setw(12) << dDoubleLines / iItems
+         << setw(12) << dMoneyLines / iItems << right << endl;
+    cout << left << setw(16) << "Taxed checkout" << setw(12) << dDoubleTax / iItems
+         << setw(12) << dMoneyTax / iItems << right << endl;
+    cout << setprecision(6);
+    cout << "Line total drift, double minus exact: " << dDoubleTotal - moneyToDouble(mMoneyTotal) << endl;
+    cout << "Taxed total, double: " << dDoubleTaxed << ", Money: " << mMoneyTaxed << endl;
+    cout << szBreakMessage;
+
+    // The same lines summed on 1 to 8 lanes
+    cout << left << setw(8) << "Lanes" << setw(26) << "Double total" << setw(20) << "Money total"
+         << "Double same as 1 lane" << right << endl;
+    vector<double> lineDoublesVec(iItems);
+    vector<Money> lineMoneyVec(iItems);
+    for (int i = 0; i < iItems; i++)
+    {
+        lineDoublesVec[i] = priceDoublesVec[i] * quantitiesVec[i] * (1 + iSALES_TAX_BASIS_POINTS / 10000.0);
+        lineMoneyVec[i] = pricesVec[i] * quantitiesVec[i];
+        lineMoneyVec[i] += calculateSalesTax(lineMoneyVec[i]);
+    }
+    double dOneLane = 0.0;
+    for (int iLanes = 1; iLanes <= 8; iLanes *= 2)
+    {
+        double dLanesTotal = sumInParts(lineDoublesVec, iLanes, 0.0, [](double dSum, double dValue) { return dSum + dValue; });
+        Money mLanesTotal = sumInParts(lineMoneyVec, iLanes, Money(), [](Money mSum, Money mValue) { return mSum + mValue; });
+        if (iLanes == 1)
+        {
+            dOneLane = dLanesTotal;
+        }
+        cout << left << setw(8) << iLanes << setw(26) << setprecision(10) << dLanesTotal << setw(20) << mLanesTotal
+             << (dLanesTotal == dOneLane ? "yes" : "no") << right << endl;
+    }
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkPayroll(int iEmployees, int iMaxThreads, const string& szLedgerFile)
+Purpose:
+    Function to time the payroll engine on a generated roster
+Parameters:
+    I   int iEmployees          Employees to generate
+    I   int iMaxThreads         Most threads to run, doubled from 1
+    I   string szLedgerFile     Ledger to write after the timings, empty for none
+Return Value:
+    -
+Notes:
+    The store holds 70% of a monthly payroll, so every policy other
+    than all or nothing pays some employees in part
+*********************************************************************/
+void benchmarkPayroll(int iEmployees, int iMaxThreads, const string& szLedgerFile)
+{
+    const string szPOLICY_NAMES_ARR[3] = {"All or nothing", "Lowest first", "Pro rata"};
+    iEmployees = max(iEmployees, 1);
+    iMaxThreads = max(iMaxThreads, 1);
+
+    Supermarket market;
+    market.szName = "Payroll Test";
+    market.employeesVec.reserve(iEmployees);
+    mt19937_64 rng(42);
+    uniform_int_distribution<int64_t> salary(2000000, 15000000);
+    for (int i = 0; i < iEmployees; i++)
+    {
+        Employee& employee = market.employeesVec.emplace_back();
+        employee.szID = "E" + to_string(100000 + i);
+        employee.szName = "Employee " + to_string(i + 1);
+        employee.mSalary = Money(salary(rng));
+    }
+
+    PayrollConfig config;
+    config.ePeriod = PAY_PERIOD_MONTHLY;
+    Money mMonthly;
+    for (const Employee& employee : market.employeesVec)
+    {
+        mMonthly += periodPay(employee.mSalary, config.ePeriod, config.iPeriodIndex);
+    }
+    Money mFunds = Money(mMonthly.iCents * 7 / 10);
+
+    cout << "Payroll Benchmark (ms per run)" << endl;
+    cout << szBreakMessage;
+    cout << "Employees: " << iEmployees << ", monthly payroll: $" << mMonthly << ", funds: $" << mFunds << endl;
+    cout << left << setw(16) << "Policy" << setw(9) << "Threads" << setw(10) << "ms"
+         << setw(12) << "Partly" << setw(20) << "Paid" << "Same as 1 thread" << right << endl;
+    cout << fixed << setprecision(3);
+    for (int iPolicy = PAYROLL_ALL_OR_NOTHING; iPolicy <= PAYROLL_PRO_RATA; iPolicy++)
+    {
+        config.ePolicy = (PayrollPolicy)iPolicy;
+        Money mOneThread;
+        for (int iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2)
+        {
+            config.iThreads = iThreads;
+            market.mTotalFunds = mFunds;
+            PayrollResult result = runPayroll(market, config);
+            if (iThreads == 1)
+            {
+                mOneThread = result.mPaid;
+            }
+            cout << left << setw(16) << szPOLICY_NAMES_ARR[iPolicy] << setw(9) << iThreads
+                 << setw(10) << result.dPlanSeconds * 1000.0 << setw(12) << result.lPaidPartly
+                 << setw(20) << result.mPaid << (result.mPaid == mOneThread ? "yes" : "no") << right << endl;
+        }
+    }
+    cout << setprecision(2);
+    cout << szBreakMessage;
+
+    if (!szLedgerFile.empty())
+    {
+        cout << "Pro rata with ledger " << szLedgerFile << endl;
+        config.iThreads = iMaxThreads;
+        config.szLedgerFile = szLedgerFile;
+        market.mTotalFunds = mFunds;
+        displayPayrollResult(runPayroll(market, config));
+    }
+}
+
+// Shortest time each suite benchmark is repeated for
+static const double dSUITE_MIN_SECONDS = 0.2;
+
+// Lookups timed per call in the suite
+static const int iSUITE_LOOKUPS = 4096;
+
+/*********************************************************************
+static long peakResidentKilobytes()
+Purpose:
+    Helper function to find the most memory the process has held
+Parameters:
+    -
+Return Value:
+    Peak resident set size in kilobytes
+Notes:
+    The peak never goes down, so later rows include earlier scales
+*********************************************************************/
+static long peakResidentKilobytes()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/*********************************************************************
+static void printSuiteRow(const string& szScale, const string& szName, const string& szUnit,
+                          long long lOps, double dSeconds)
+Purpose:
+    Helper function to print one suite result as a CSV row
+Parameters:
+    I   string szScale      Scale the store was generated at
+    I   string szName       Benchmark name
+    I   string szUnit       What one operation is
+    I   long long lOps      Operations timed
+    I   double dSeconds     Time they took
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void printSuiteRow(const string& szScale, const string& szName, const string& szUnit,
+                          long long lOps, double dSeconds)
+{
+    lOps = max(lOps, 1LL);
+    cout << szScale << ',' << szName << ',' << szUnit << ',' << lOps << ','
+         << setprecision(1) << dSeconds * 1e9 / lOps << ','
+         << setprecision(0) << lOps / max(dSeconds, 1e-9) << ','
+         << peakResidentKilobytes() << endl;
+}
+
+/*********************************************************************
+static void timeSuiteOperation(const string& szScale, const string& szName, const string& szUnit,
+                               long long lOpsPerCall, F function)
+Purpose:
+    Helper function to time a callable and print the suite row
+Parameters:
+    I   string szScale          Scale the store was generated at
+    I   string szName           Benchmark name
+    I   string szUnit           What one operation is
+    I   long long lOpsPerCall   Operations done by one call
+    I   F function              Callable to time
+Return Value:
+    -
+Notes:
+    Called at least once and until dSUITE_MIN_SECONDS have passed.
+    Calls are made in doubling batches between clock reads, so reading
+    the clock does not swamp very short calls.
+*********************************************************************/
+template <typename F>
+static void timeSuiteOperation(const string& szScale, const string& szName, const string& szUnit,
+                               long long lOpsPerCall, F function)
+{
+    long long lCalls = 0;
+    long long lBatch = 1;
+    auto tStart = chrono::steady_clock::now();
+    chrono::duration<double> elapsed(0.0);
+    do
+    {
+        for (long long i = 0; i < lBatch; i++)
+        {
+            function();
+        }
+        lCalls += lBatch;
+        lBatch *= 2;
+        elapsed = chrono::steady_clock::now() - tStart;
+    } while (elapsed.count() < dSUITE_MIN_SECONDS);
+
+    printSuiteRow(szScale, szName, szUnit, lCalls * lOpsPerCall, elapsed.count());
+}
+
+/*********************************************************************
+void benchmarkSuite(const string& szDirectory, const string& szScales, unsigned long long lSeed)
+Purpose:
+    Function to generate a store at each scale and time the main
+    store operations against it
+Parameters:
+    I   string szDirectory          Directory for the generated files
+    I   string szScales             Comma separated scales for getGeneratorScale,
+                                    counts in a scale separated by ':'
+    I   unsigned long long lSeed    Generator seed
+Return Value:
+    -
+Notes:
+    Rows are scale, benchmark, unit, ops, ns_per_op, ops_per_sec and
+    peak_rss_kb. Checkout runs each generated basket once, since it
+    uses up stock. Problems are reported on cerr so cout stays CSV.
+*********************************************************************/
+void benchmarkSuite(const string& szDirectory, const string& szScales, unsigned long long lSeed)
+{
+    ofstream nullOut("/dev/null");
+    nullOut << fixed << setprecision(2);
+
+    cout << fixed;
+    cout << "scale,benchmark,unit,ops,ns_per_op,ops_per_sec,peak_rss_kb" << endl;
+
+    stringstream scalesStream(szScales);
+    string szScale;
+    while (getline(scalesStream, szScale, ','))
+    {
+        GeneratorConfig config;
+        config.lSeed = lSeed;
+        string szCounts = szScale;
+        replace(szCounts.begin(), szCounts.end(), ':', ',');
+        if (!getGeneratorScale(szCounts, config))
+        {
+            cerr << "Unknown scale " << szScale << endl;
+            continue;
+        }
+
+        string szStoreFile = szDirectory + "/" + szScale + "_store.txt";
+        string szTransactionFile = szDirectory + "/" + szScale + "_transactions.txt";
+        if (!generateStoreFile(config, szStoreFile) || !generateTransactionFile(config, szTransactionFile))
+        {
+            cerr << "Could not write the generated files to " << szDirectory << endl;
+            return;
+        }
+
+        // Loader
+        Supermarket market;
+        if (!loadSupermarketFile(szStoreFile, market))
+        {
+            return;
+        }
+        timeSuiteOperation(szScale, "load_store", "file", 1, [&]()
+        {
+            Supermarket loaded;
+            loadSupermarketFile(szStoreFile, loaded);
+        });
+
+        // Item lookups
+        mt19937_64 rng(lSeed);
+        vector<string> namesVec(iSUITE_LOOKUPS);
+        vector<int> skusVec(iSUITE_LOOKUPS);
+        for (int i = 0; i < iSUITE_LOOKUPS; i++)
+        {
+            const Aisle& aisle = market.aislesVec[rng() % market.aislesVec.size()];
+            const Item& item = aisle.itemVec[rng() % aisle.itemVec.size()];
+            namesVec[i] = item.szName;
+            skusVec[i] = item.iSKU;
+        }
+        long long lFound = 0;
+        long long lLookups = 0;
+        timeSuiteOperation(szScale, "lookup_name", "lookup", iSUITE_LOOKUPS, [&]()
+        {
+            for (const string& szName : namesVec)
+            {
+                lFound += lookupItemByName(market, szName) != nullptr;
+            }
+            lLookups += iSUITE_LOOKUPS;
+        });
+        timeSuiteOperation(szScale, "lookup_sku", "lookup", iSUITE_LOOKUPS, [&]()
+        {
+            for (int iSKU : skusVec)
+            {
+                lFound += lookupItemBySKU(market, iSKU) != nullptr;
+            }
+            lLookups += iSUITE_LOOKUPS;
+        });
+        if (lFound != lLookups)
+        {
+            cerr << szScale << ": " << lLookups - lFound << " lookups missed" << endl;
+        }
+
+        // Display screens
+        timeSuiteOperation(szScale, "display_info", "call", 1, [&]()
+        {
+            nullOut << renderSupermarketInfo(market) << flush;
+        });
+        timeSuiteOperation(szScale, "display_aisles", "call", 1, [&]()
+        {
+            nullOut << renderAisles(market) << flush;
+        });
+        timeSuiteOperation(szScale, "display_items", "call", 1, [&]()
+        {
+            nullOut << renderItems(market, 0) << flush;
+        });
+
+        // Checkout, each basket once
+        vector<Basket> basketsVec;
+        long long lMalformed = 0;
+        if (!loadTransactionFile(szTransactionFile, basketsVec, lMalformed))
+        {
+            return;
+        }
+        auto tStart = chrono::steady_clock::now();
+        for (const Basket& basket : basketsVec)
+        {
+            checkoutBasket(market, basket);
+        }
+        chrono::duration<double> checkedOut = chrono::steady_clock::now() - tStart;
+        printSuiteRow(szScale, "checkout", "basket", (long long)basketsVec.size(), checkedOut.count());
+
+        // Reports and payroll
+        Money mSales;
+        timeSuiteOperation(szScale, "calculate_total_sales", "call", 1, [&]()
+        {
+            mSales += calculateTotalSales(market);
+        });
+        market.mTotalFunds = Money(INT64_MAX / 2);
+        timeSuiteOperation(szScale, "pay_employees", "call", 1, [&]()
+        {
+            payEmployees(market);
+        });
+
+        // Clearing members, signed up again between calls
+        vector<string> memberNamesVec(config.iMembers);
+        for (int i = 0; i < config.iMembers; i++)
+        {
+            memberNamesVec[i] = "Member " + to_string(i);
+        }
+        long long lClears = 0;
+        chrono::duration<double> cleared(0.0);
+        do
+        {
+            for (const string& szName : memberNamesVec)
+            {
+                addMember(market, szName);
+            }
+            auto tClearStart = chrono::steady_clock::now();
+            clearMembers(market);
+            cleared += chrono::steady_clock::now() - tClearStart;
+            lClears++;
+        } while (lClears < 3);
+        printSuiteRow(szScale, "clear_members", "call", lClears, cleared.count());
+
+        if (mSales < Money())
+        {
+            cerr << szScale << ": negative sales" << endl;
+        }
+    }
+    cout << setprecision(2);
+}
+
+/*********************************************************************
+void benchmarkChain(const string& szDirectory, int iStores, int iMaxWorkers)
+Purpose:
+    Function to time a generated chain on 1 up to iMaxWorkers workers
+Parameters:
+    I   string szDirectory      Directory for the generated stores
+    I   int iStores             Stores in the chain
+    I   int iMaxWorkers         Most workers to run, doubled from 1
+Return Value:
+    -
+Notes:
+    Every store is the medium scale with its own seed and replays its
+    own transaction file, so each run does exactly the same work
+*********************************************************************/
+void benchmarkChain(const string& szDirectory, int iStores, int iMaxWorkers)
+{
+    iStores = max(iStores, 1);
+    iMaxWorkers = max(iMaxWorkers, 1);
+
+    vector<ChainStoreSpec> storesVec(iStores);
+    for (int i = 0; i < iStores; i++)
+    {
+        GeneratorConfig config;
+        getGeneratorScale("medium", config);
+        config.lSeed = i + 1;
+        storesVec[i].szStoreFile = szDirectory + "/chain_store_" + to_string(i) + ".txt";
+        storesVec[i].szTransactionFile = szDirectory + "/chain_transactions_" + to_string(i) + ".txt";
+        if (!generateStoreFile(config, storesVec[i].szStoreFile) ||
+            !generateTransactionFile(config, storesVec[i].szTransactionFile))
+        {
+            cout << "Could not write the generated files to " << szDirectory << endl;
+            return;
+        }
+    }
+
+    ChainConfig config;
+    config.payroll.ePolicy = PAYROLL_PRO_RATA;
+
+    cout << "Chain Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Stores: " << iStores << ", cores: " << thread::hardware_concurrency() << endl;
+    cout << left << setw(9) << "Workers" << setw(10) << "Seconds" << setw(16) << "Baskets/s"
+         << setw(10) << "Speedup" << "Same totals" << right << endl;
+    ChainTotals oneWorker;
+    for (int iWorkers = 1; iWorkers <= iMaxWorkers; iWorkers *= 2)
+    {
+        config.iWorkers = iWorkers;
+        ChainTotals totals = runChain(storesVec, config);
+        if (iWorkers == 1)
+        {
+            oneWorker = totals;
+        }
+
+        bool bSame = totals.iLoaded == oneWorker.iLoaded && totals.lBaskets == oneWorker.lBaskets &&
+                     totals.sales.mGrossSales == oneWorker.sales.mGrossSales &&
+                     totals.sales.mProfit == oneWorker.sales.mProfit &&
+                     totals.payroll.mPaid == oneWorker.payroll.mPaid && totals.mFunds == oneWorker.mFunds;
+        cout << left << setw(9) << iWorkers << setprecision(3) << setw(10) << totals.dWallSeconds
+             << setprecision(0) << setw(16) << totals.lBaskets / totals.dWallSeconds
+             << setprecision(2) << setw(10) << oneWorker.dWallSeconds / totals.dWallSeconds
+             << (bSame ? "yes" : "no") << right << endl;
+    }
+    cout << szBreakMessage;
+    cout << "Chain gross sales: $" << oneWorker.sales.mGrossSales << ", payroll paid: $"
+         << oneWorker.payroll.mPaid << ", funds: $" << oneWorker.mFunds << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkExport(const string& szDirectory, const string& szScale)
+Purpose:
+    Function to time every report in both formats on a generated store
+Parameters:
+    I   string szDirectory      Directory for the generated files and reports
+    I   string szScale          Scale for getGeneratorScale
+Return Value:
+    -
+Notes:
+    Peak memory is shown after each report, it should not grow with
+    the report size
+*********************************************************************/
+void benchmarkExport(const string& szDirectory, const string& szScale)
+{
+    const string szREPORTS_ARR[4] = {"inventory", "transactions", "sales", "payroll"};
+
+    GeneratorConfig config;
+    if (!getGeneratorScale(szScale, config))
+    {
+        cout << "Unknown scale " << szScale << endl;
+        return;
+    }
+    string szStoreFile = szDirectory + "/export_store.txt";
+    string szTransactionFile = szDirectory + "/export_transactions.txt";
+    Supermarket market;
+    if (!generateStoreFile(config, szStoreFile) || !generateTransactionFile(config, szTransactionFile) ||
+        !loadSupermarketFile(szStoreFile, market))
+    {
+        cout << "Could not write the generated files to " << szDirectory << endl;
+        return;
+    }
+    replayTransactions(market, szTransactionFile);
+
+    cout << "Export Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << left << setw(14) << "Report" << setw(8) << "Format" << setw(10) << "Rows" << setw(12) << "MB"
+         << setw(10) << "ms" << setw(10) << "MB/s" << "Peak RSS KB" << right << endl;
+    for (const string& szReport : szREPORTS_ARR)
+    {
+        for (const string szExtension : {".csv", ".json"})
+        {
+            string szFilename = szDirectory + "/export_" + szReport + szExtension;
+            auto tStart = chrono::steady_clock::now();
+            bool bWritten = exportReport(market, szReport, szFilename);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - tStart;
+
+            ifstream fileReport(szFilename, ios::binary | ios::ate);
+            double dMegabytes = bWritten ? fileReport.tellg() / 1e6 : 0.0;
+            long long lRows = 0;
+            if (szReport == "inventory")
+            {
+                lRows = (long long)config.iAisles * config.iItemsPerAisle;
+            }
+            else if (szReport == "transactions")
+            {
+                lRows = (long long)market.customersVec.size();
+            }
+            else if (szReport == "sales")
+            {
+                lRows = 1 + count_if(begin(market.sales.hourArr), end(market.sales.hourArr),
+                                     [](const SalesBucket& hour) { return hour.lCount > 0; }) +
+                        count_if(market.sales.aisleVec.begin(), market.sales.aisleVec.end(),
+                                 [](const SalesBucket& aisle) { return aisle.lCount > 0; });
+            }
+            else if (szReport == "payroll")
+            {
+                lRows = (long long)market.employeesVec.size();
+            }
+            cout << left << setw(14) << szReport << setw(8) << szExtension.substr(1) << setw(10) << lRows
+                 << setprecision(2) << setw(12) << dMegabytes << setprecision(1) << setw(10) << elapsed.count() * 1000.0
+                 << setw(10) << dMegabytes / max(elapsed.count(), 1e-9) << peakResidentKilobytes() << right << endl;
+        }
+    }
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+static size_t scanLowCover(const Supermarket& myStore, const vector<long long>& soldVec,
+                           double dReorderCover, vector<uint32_t>& entriesVec)
+Purpose:
+    Helper function to find the items below the reorder point by
+    scanning every item, kept as a baseline for the restock tracker
+Parameters:
+    I   Supermarket myStore         Populated Supermarket info
+    I   vector<long long> soldVec   Units sold per catalog entry
+    I   double dReorderCover        Reorder point as stock over units sold
+    O   vector<uint32_t>& entriesVec Catalog entries below the point,
+                                    lowest cover first
+Return Value:
+    Number of entries found
+Notes:
+    -
+*********************************************************************/
+static size_t scanLowCover(const Supermarket& myStore, const vector<long long>& soldVec,
+                           double dReorderCover, vector<uint32_t>& entriesVec)
+{
+    vector<pair<double, uint32_t>> lowVec;
+    for (size_t i = 0; i < myStore.catalog.entriesVec.size(); i++)
+    {
+        const ItemLocation& location = myStore.catalog.entriesVec[i].location;
+        const Item& item = myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex];
+        double dCover = item.iQuantity <= 0 ? 0.0 : soldVec[i] <= 0 ? dReorderCover
+                                                  : (double)item.iQuantity / (double)soldVec[i];
+        if (dCover < dReorderCover)
+        {
+            lowVec.emplace_back(dCover, (uint32_t)i);
+        }
+    }
+    sort(lowVec.begin(), lowVec.end());
+
+    entriesVec.clear();
+    for (const pair<double, uint32_t>& low : lowVec)
+    {
+        entriesVec.push_back(low.second);
+    }
+    return entriesVec.size();
+}
+
+/*********************************************************************
+void benchmarkRestock(const string& szDirectory, const string& szScale)
+Purpose:
+    Function to time the restock tracker on a generated store against
+    rescanning every item
+Parameters:
+    I   string szDirectory      Directory for the generated files
+    I   string szScale          Scale for getGeneratorScale
+Return Value:
+    -
+Notes:
+    The store replays its generated day and is stocked up to the
+    target first, then extra sales on a few hot items run them down,
+    so only a small part of the store needs reordering
+*********************************************************************/
+void benchmarkRestock(const string& szDirectory, const string& szScale)
+{
+    GeneratorConfig config;
+    if (!getGeneratorScale(szScale, config))
+    {
+        cout << "Unknown scale " << szScale << endl;
+        return;
+    }
+    string szStoreFile = szDirectory + "/restock_store.txt";
+    string szTransactionFile = szDirectory + "/restock_transactions.txt";
+    Supermarket market;
+    if (!generateStoreFile(config, szStoreFile) || !generateTransactionFile(config, szTransactionFile) ||
+        !loadSupermarketFile(szStoreFile, market))
+    {
+        cout << "Could not write the generated files to " << szDirectory << endl;
+        return;
+    }
+    ReplayStats replay = replayTransactions(market, szTransactionFile);
+
+    // Stock every item up to the target first, so only the items the
+    // extra sales run down fall below the reorder point
+    RestockConfig restock;
+    restock.bWithinFunds = false;
+    RestockPlan plan = planRestock(market, restock);
+    market.mTotalFunds += plan.mCost;
+    applyRestock(market, plan);
+
+    // Extra sales of one unit, most of them on a hot 1% of the items
+    const int iSALES = 200000;
+    mt19937_64 rng(config.lSeed);
+    size_t iEntries = market.catalog.entriesVec.size();
+    size_t iHotEntries = max<size_t>(iEntries / 100, 1);
+    vector<int> skusVec(iSALES);
+    for (int& iSKU : skusVec)
+    {
+        iSKU = market.catalog.entriesVec[rng() % 10 == 0 ? rng() % iEntries : rng() % iHotEntries].iSKU;
+    }
+    int iNextSale = 0;
+    double dSale = nanosecondsPerCall(iSALES, [&]()
+    {
+        int iSKU = skusVec[iNextSale++];
+        lookupItemBySKU(market, iSKU)->iQuantity -= 1;
+        recordRestockSale(market, iSKU, 1);
+    });
+
+    double dPlan = nanosecondsPerCall(20, [&]() { plan = planRestock(market, restock); });
+    vector<uint32_t> entriesVec;
+    size_t iScanned = 0;
+    double dScan = nanosecondsPerCall(20, [&]()
+    {
+        iScanned = scanLowCover(market, market.restock.soldVec,
+                                restock.dReorderDays / restock.dObservedDays, entriesVec);
+    });
+
+    market.mTotalFunds += plan.mCost;
+    bool bApplied = false;
+    double dApply = nanosecondsPerCall(1, [&]() { bApplied = applyRestock(market, plan); });
+    RestockPlan after = planRestock(market, restock);
+
+    cout << "Restock Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Items: " << iEntries << ", baskets replayed: " << replay.lTransactions << endl;
+    cout << fixed << setprecision(1);
+    cout << "Tracker update ns/sale: " << dSale << endl;
+    cout << setprecision(3);
+    cout << left << setw(16) << "Find low cover" << setw(12) << "ms" << "Items" << right << endl;
+    cout << left << setw(16) << "Tracker heap" << setw(12) << dPlan / 1e6 << plan.linesVec.size() + plan.lDroppedLines << right << endl;
+    cout << left << setw(16) << "Rescan" << setw(12) << dScan / 1e6 << iScanned << right << endl;
+    cout << "Speedup: " << dScan / dPlan << endl;
+    cout << "Apply ms: " << dApply / 1e6 << " for " << plan.linesVec.size() << " lines, "
+         << plan.lUnits << " units, $" << plan.mCost << (bApplied ? "" : " (not applied)") << endl;
+    cout << "Lines left after restock: " << after.linesVec.size() << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+static Money legacyPriceCheckout(CheckoutSession& session)
+Purpose:
+    Copy of the per-line pricing checkout used before the pricing
+    policies, with the tier checked on every line, kept as a baseline
+Parameters:
+    I/O CheckoutSession& session    Session with unpriced lines
+Return Value:
+    Purchase cost including tax
+Notes:
+    -
+*********************************************************************/
+static Money legacyPriceCheckout(CheckoutSession& session)
+{
+    for (StockChange& change : session.takenVec)
+    {
+        Money mPrice;
+        if (session.eTier == PRICING_MEMBER)
+        {
+            mPrice = change.mMembersPrice;
+        }
+        else if (session.eTier == PRICING_EMPLOYEE)
+        {
+            mPrice = change.mWholesale + Money((change.mMembersPrice - change.mWholesale).iCents / 2);
+        }
+        else
+        {
+            mPrice = change.mRegularPrice;
+        }
+        change.mPrice = mPrice;
+        session.mCartTotal += mPrice * change.iQuantity;
+        session.mProfit += (mPrice - change.mWholesale) * change.iQuantity;
+    }
+    session.iPricedLines = session.takenVec.size();
+    Money mTax = session.eTier == PRICING_TAX_EXEMPT ? Money() : calculateSalesTax(session.mCartTotal);
+    return session.mCartTotal + mTax;
+}
+
+/*********************************************************************
+void benchmarkPricing(int iBaskets)
+Purpose:
+    Function to compare basket pricing throughput of the tier policies
+    against checking the tier on every line
+Parameters:
+    I   int iBaskets        Baskets to price, customers of every tier
+Return Value:
+    -
+Notes:
+    Baskets have 1 to 16 lines. Each path prices every basket five
+    times and the fastest pass is shown.
+*********************************************************************/
+void benchmarkPricing(int iBaskets)
+{
+    iBaskets = max(iBaskets, 1);
+    const int iPASSES = 5;
+
+    mt19937_64 rng(1);
+    vector<CheckoutSession> sessionsVec(iBaskets);
+    long long lLines = 0;
+    long long lTierBasketsArr[4] = {};
+    for (CheckoutSession& session : sessionsVec)
+    {
+        session.eTier = (PricingTier)(rng() % 4);
+        lTierBasketsArr[session.eTier] += 1;
+        int iLines = 1 + (int)(rng() % 16);
+        for (int i = 0; i < iLines; i++)
+        {
+            Money mWholesale = Money(10 + (int64_t)(rng() % 2000));
+            Money mRegular = mWholesale + Money(5 + (int64_t)(rng() % 500));
+            Money mMember = mRegular - Money((int64_t)(rng() % (mRegular - mWholesale).iCents));
+            session.takenVec.push_back({100000 + i, 0, 1 + (int)(rng() % 3), Money(), mWholesale, mRegular, mMember});
+        }
+        lLines += iLines;
+    }
+
+    auto resetSessions = [&]()
+    {
+        for (CheckoutSession& session : sessionsVec)
+        {
+            session.mCartTotal = Money();
+            session.mProfit = Money();
+            session.iPricedLines = 0;
+        }
+    };
+
+    Money mLegacyTotal;
+    Money mPolicyTotal;
+    double dLegacy = 1e300;
+    double dPolicy = 1e300;
+    for (int iPass = 0; iPass < iPASSES; iPass++)
+    {
+        resetSessions();
+        mLegacyTotal = Money();
+        dLegacy = min(dLegacy, nanosecondsPerCall(1, [&]()
+        {
+            for (CheckoutSession& session : sessionsVec)
+            {
+                mLegacyTotal += legacyPriceCheckout(session);
+            }
+        }));
+
+        resetSessions();
+        mPolicyTotal = Money();
+        dPolicy = min(dPolicy, nanosecondsPerCall(1, [&]()
+        {
+            for (CheckoutSession& session : sessionsVec)
+            {
+                priceCheckout(session);
+                mPolicyTotal += session.mCartTotal + checkoutSalesTax(session.eTier, session.mCartTotal);
+            }
+        }));
+    }
+
+    cout << "Basket Pricing Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Baskets: " << iBaskets << ", lines: " << lLines << endl;
+    for (int i = 0; i < 4; i++)
+    {
+        cout << "  " << pricingTierName((PricingTier)i) << ": " << lTierBasketsArr[i] << endl;
+    }
+    cout << left << setw(16) << "Pricing" << setw(14) << "ns/basket" << setw(12) << "ns/line" << "M baskets/s" << right << endl;
+    cout << fixed << setprecision(1);
+    cout << left << setw(16) << "Per-line tier" << setw(14) << dLegacy / iBaskets << setw(12) << dLegacy / lLines
+         << setprecision(2) << iBaskets / dLegacy * 1e3 << setprecision(1) << right << endl;
+    cout << left << setw(16) << "Tier policy" << setw(14) << dPolicy / iBaskets << setw(12) << dPolicy / lLines
+         << setprecision(2) << iBaskets / dPolicy * 1e3 << setprecision(1) << right << endl;
+    cout << "Speedup: " << dLegacy / dPolicy << endl;
+    cout << setprecision(2);
+    cout << "Totals match: " << (mLegacyTotal == mPolicyTotal ? "yes" : "no") << " ($" << mPolicyTotal << ")" << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkAnalytics(int iLines)
+Purpose:
+    Function to time the best seller sketches against exact counts and
+    check how well they find the true best sellers
+Parameters:
+    I   int iLines          Sales lines to stream through
+Return Value:
+    -
+Notes:
+    SKUs are drawn from a Zipf distribution with exponent 1.1 over
+    100,000 items, 1 to 3 units a line. The stream is drawn before
+    timing starts.
+*********************************************************************/
+void benchmarkAnalytics(int iLines)
+{
+    iLines = max(iLines, 1);
+    const int iITEMS = 100000;
+    const int iAISLES = 64;
+    const size_t iTOP = 100;
+
+    mt19937_64 rng(1);
+    vector<double> cumulativeVec(iITEMS);
+    double dTotal = 0.0;
+    for (int i = 0; i < iITEMS; i++)
+    {
+        dTotal += 1.0 / pow(i + 1, 1.1);
+        cumulativeVec[i] = dTotal;
+    }
+    uniform_real_distribution<double> uniform(0.0, dTotal);
+    vector<SoldLine> linesVec(iLines);
+    for (SoldLine& line : linesVec)
+    {
+        int iRank = (int)(lower_bound(cumulativeVec.begin(), cumulativeVec.end(), uniform(rng)) - cumulativeVec.begin());
+        iRank = min(iRank, iITEMS - 1);
+        // Scatter ranks over the SKU range so the best sellers are not the lowest SKUs
+        line.iSKU = 100000 + (int)(((uint64_t)iRank * 48271) % iITEMS);
+        line.iAisleIndex = line.iSKU % iAISLES;
+        line.iQuantity = 1 + (int)(rng() % 3);
+        line.iHour = 12;
+    }
+
+    SalesAnalytics analytics;
+    double dSketch = nanosecondsPerCall(1, [&]()
+    {
+        for (const SoldLine& line : linesVec)
+        {
+            recordLineAnalytics(analytics, line.iSKU, line.iAisleIndex, line.iQuantity, line.iHour);
+        }
+    });
+
+    unordered_map<int, uint64_t> exactMap;
+    double dExact = nanosecondsPerCall(1, [&]()
+    {
+        for (const SoldLine& line : linesVec)
+        {
+            exactMap[line.iSKU] += (uint64_t)line.iQuantity;
+        }
+    });
+
+    vector<pair<uint64_t, int>> exactVec;
+    exactVec.reserve(exactMap.size());
+    for (const pair<const int, uint64_t>& count : exactMap)
+    {
+        exactVec.push_back({count.second, count.first});
+    }
+    size_t iTop = min(iTOP, exactVec.size());
+    partial_sort(exactVec.begin(), exactVec.begin() + iTop, exactVec.end(), greater<pair<uint64_t, int>>());
+
+    vector<HeavyHitter> hittersVec = analytics.dayWindow.topItems.top(iTop);
+    vector<uint32_t> foundVec;
+    for (const HeavyHitter& hitter : hittersVec)
+    {
+        foundVec.push_back(hitter.iKey);
+    }
+    sort(foundVec.begin(), foundVec.end());
+    size_t iFound = 0;
+    double dWorstOver = 0.0;
+    for (size_t i = 0; i < iTop; i++)
+    {
+        if (binary_search(foundVec.begin(), foundVec.end(), (uint32_t)exactVec[i].second))
+        {
+            iFound++;
+        }
+        uint64_t iEstimate = analytics.dayWindow.itemUnits.estimate((uint32_t)exactVec[i].second);
+        dWorstOver = max(dWorstOver, (double)(iEstimate - exactVec[i].first) / (double)exactVec[i].first);
+    }
+    // Buckets and nodes of the hash map, a pointer and the count per key
+    size_t iExactBytes = exactMap.bucket_count() * sizeof(void*)
+                       + exactMap.size() * (sizeof(pair<const int, uint64_t>) + sizeof(void*));
+
+    cout << "Best Seller Analytics Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Lines: " << iLines << ", distinct SKUs sold: " << exactMap.size() << endl;
+    cout << left << setw(16) << "Counting" << setw(12) << "ns/line" << "Memory bytes" << right << endl;
+    cout << fixed << setprecision(1);
+    cout << left << setw(16) << "Sketches" << setw(12) << dSketch / iLines << analyticsMemoryBytes(analytics) << right << endl;
+    cout << left << setw(16) << "Exact map" << setw(12) << dExact / iLines << iExactBytes << right << endl;
+    cout << "True top " << iTop << " items listed: " << iFound << endl;
+    cout << "Worst Count-Min overcount on them: " << dWorstOver * 100.0 << "%" << endl;
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void benchmarkMining(const string& szDirectory, const string& szScale, int iBaskets, int iMaxThreads)
+Purpose:
+    Function to time basket mining over a large line item log from 1
+    thread up to iMaxThreads
+Parameters:
+    I   string szDirectory      Directory for the generated store file
+    I   string szScale          Scale for getGeneratorScale
+    I   int iBaskets            Baskets to log
+    I   int iMaxThreads         Most threads to mine with
+Return Value:
+    -
+Notes:
+    Baskets are logged straight into the store's line item log. Items
+    are drawn from a skewed popularity, and every 50th item has a
+    partner bought with it 40% of the time, so there are real rules
+    to find.
+*********************************************************************/
+void benchmarkMining(const string& szDirectory, const string& szScale, int iBaskets, int iMaxThreads)
+{
+    GeneratorConfig config;
+    if (!getGeneratorScale(szScale, config))
+    {
+        cout << "Unknown scale " << szScale << endl;
+        return;
+    }
+    string szStoreFile = szDirectory + "/mining_store.txt";
+    Supermarket market;
+    if (!generateStoreFile(config, szStoreFile) || !loadSupermarketFile(szStoreFile, market))
+    {
+        cout << "Could not write the generated files to " << szDirectory << endl;
+        return;
+    }
+    const vector<CatalogEntry>& entriesVec = market.catalog.entriesVec;
+    if (entriesVec.size() < 2)
+    {
+        cout << "The generated store has too few items" << endl;
+        return;
+    }
+
+    iBaskets = max(iBaskets, 1);
+    iMaxThreads = max(iMaxThreads, 1);
+    mt19937_64 rng(config.lSeed);
+    size_t iEntries = entriesVec.size();
+    auto tLogStart = chrono::steady_clock::now();
+    for (int iBasket = 0; iBasket < iBaskets; iBasket++)
+    {
+        market.lineItems.beginBasket(20000 + iBasket / 1000000, (uint8_t)(rng() % 4));
+        int iLines = 1 + (int)(rng() % config.iMaxBasketLines);
+        for (int i = 0; i < iLines; i++)
+        {
+            // Square of a uniform draw favours the first items
+            double dDraw = (double)(rng() >> 11) / 9007199254740992.0;
+            size_t iEntry = (size_t)(dDraw * dDraw * iEntries);
+            market.lineItems.appendLine(entriesVec[iEntry].iSKU, 1 + (int)(rng() % 3), Money(199));
+            if (iEntry % 50 == 0 && rng() % 10 < 4)
+            {
+                market.lineItems.appendLine(entriesVec[(iEntry + iEntries / 2) % iEntries].iSKU, 1, Money(299));
+            }
+        }
+    }
+    double dLogSeconds = chrono::duration<double>(chrono::steady_clock::now() - tLogStart).count();
+    long long lLines = market.lineItems.lineCount();
+
+    BasketMiningConfig mining;
+    mining.dMinSupport = 0.0005;
+    mining.dMinConfidence = 0.2;
+
+    cout << "Basket Mining Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << "Items: " << iEntries << ", baskets: " << iBaskets << ", lines: " << lLines << endl;
+    cout << "Logged at " << setprecision(1) << lLines / dLogSeconds / 1e6 << "M lines/s into "
+         << market.lineItems.memoryBytes() / (1024 * 1024) << " MB" << setprecision(2) << endl;
+    cout << left << setw(10) << "Threads" << setw(12) << "ms" << setw(14) << "M lines/s" << setw(10) << "Speedup" << "Rules" << right << endl;
+
+    double dBaseSeconds = 0.0;
+    BasketMiningResult firstResult;
+    bool bMatch = true;
+    for (int iThreads = 1; ; iThreads *= 2)
+    {
+        iThreads = min(iThreads, iMaxThreads);
+        mining.iThreads = iThreads;
+        BasketMiningResult result = mineBasketPairs(market, mining);
+        if (iThreads == 1)
+        {
+            dBaseSeconds = result.dSeconds;
+            firstResult = result;
+        }
+        else if (result.lFrequentPairs != firstResult.lFrequentPairs ||
+                 result.rulesVec.size() != firstResult.rulesVec.size())
+        {
+            bMatch = false;
+        }
+        cout << left << setw(10) << result.iThreads << setw(12) << result.dSeconds * 1000.0
+             << setw(14) << lLines / result.dSeconds / 1e6 << setw(10) << dBaseSeconds / result.dSeconds
+             << result.lFrequentPairs << right << endl;
+        if (iThreads == iMaxThreads)
+        {
+            break;
+        }
+    }
+    cout << "Results match: " << (bMatch ? "yes" : "no") << endl;
+    cout << szBreakMessage;
+    displayBasketMining(market, firstResult);
+}
+
+/*********************************************************************
+void benchmarkServer(const string& szStoreFile, int iTerminals, int iBaskets)
+Purpose:
+    Function to time the register server against many terminals in
+    one process
+Parameters:
+    I   string szStoreFile      Store to serve
+    I   int iTerminals          Terminals connected at once
+    I   int iBaskets            Checkouts each terminal makes
+Return Value:
+    -
+Notes:
+    The server runs on its own thread over a Unix socket in /tmp. Each
+    terminal needs two sockets in this process, so the open file limit
+    is raised as far as it goes.
+*********************************************************************/
+void benchmarkServer(const string& szStoreFile, int iTerminals, int iBaskets)
+{
+    Supermarket market;
+    if (!loadSupermarketFile(szStoreFile, market))
+    {
+        return;
+    }
+    Supermarket loadStore = market;
+
+    rlimit fileLimit;
+    if (getrlimit(RLIMIT_NOFILE, &fileLimit) == 0 && fileLimit.rlim_cur < fileLimit.rlim_max)
+    {
+        fileLimit.rlim_cur = fileLimit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &fileLimit);
+    }
+
+    PosLoadConfig config;
+    config.szAddress = "unix:/tmp/supermarket_bench_" + to_string(getpid()) + ".sock";
+    config.iTerminals = max(iTerminals, 1);
+    config.iBasketsPerTerminal = max(iBaskets, 1);
+
+    atomic<bool> bStop(false);
+    atomic<bool> bReload(false);
+    atomic<bool> bFailed(false);
+    PosServerStats serverStats;
+    thread serverThread([&]()
+    {
+        if (!runPosServer(market, config.szAddress, bStop, bReload, szStoreFile, serverStats))
+        {
+            bFailed.store(true);
+        }
+    });
+
+    // Give the server a moment to listen before the terminals connect
+    this_thread::sleep_for(chrono::milliseconds(200));
+    PosLoadResult result;
+    if (!bFailed.load())
+    {
+        result = runPosLoad(loadStore, config);
+    }
+    bStop.store(true);
+    serverThread.join();
+
+    displayPosLoadResult(config, result);
+    displayPosServerStats(serverStats);
+}
+
+/*********************************************************************
+void benchmarkReload(const string& szStoreFile, int iReloads)
+Purpose:
+    Function to time checkouts while the store file is reloaded
+Parameters:
+    I   string szStoreFile      Store to check out against and reload
+    I   int iReloads            Reloads to make during the run
+Return Value:
+    -
+Notes:
+    One thread checks out one-line baskets back to back and polls a
+    StoreReloader between them, as the register server does. The
+    longest gap between two checkouts is the pause a customer would
+    see, and on one core includes the loader's time slices. The
+    longest start or poll is the reload's own cost on the checkout
+    thread. Loading the file in place stops checkouts for the whole load.
+    The live run is repeated on a journaled copy of the file, written
+    beside it and removed afterwards, where each reload also copies
+    the new journal base and the reclaimer saves it.
+*********************************************************************/
+void benchmarkReload(const string& szStoreFile, int iReloads)
+{
+    Supermarket market;
+    if (!loadSupermarketFile(szStoreFile, market) || market.catalog.entriesVec.empty())
+    {
+        return;
+    }
+    iReloads = max(iReloads, 1);
+
+    // Baskets of one unit of a random item, by SKU so they survive a reload
+    mt19937_64 rng(1);
+    vector<Basket> basketsVec(4096);
+    for (Basket& basket : basketsVec)
+    {
+        const CatalogEntry& entry = market.catalog.entriesVec[rng() % market.catalog.entriesVec.size()];
+        basket.szCustomerName = "Reload_" + to_string(rng() % 1000);
+        basket.linesVec.push_back({-1, "", entry.iSKU, 1});
+    }
+
+    // Stop the world reload, checkouts wait for the whole load
+    Supermarket inPlaceStore = market;
+    double dInPlace = nanosecondsPerCall(1, [&]()
+    {
+        Supermarket loaded;
+        loadSupermarketFile(szStoreFile, loaded);
+        inPlaceStore = std::move(loaded);
+    });
+
+    struct LiveRun
+    {
+        long long lCheckouts = 0;
+        double dSeconds = 0.0;
+        double dLoadSeconds = 0.0;
+        double dMaxSwapMicros = 0.0;
+        double dMaxBaseMillis = 0.0;
+        double dMaxGapMicros = 0.0;
+        double dMaxCallMicros = 0.0;
+    };
+    auto runLive = [&](Supermarket& store, const string& szFilename)
+    {
+        LiveRun run;
+        StoreReloader reloader;
+        ReloadStats stats;
+        int iApplied = 0;
+        auto tStart = chrono::steady_clock::now();
+        auto tLast = tStart;
+        while (iApplied < iReloads)
+        {
+            auto tCall = chrono::steady_clock::now();
+            if (!reloader.busy())
+            {
+                reloader.start(szFilename, store);
+            }
+            run.dMaxCallMicros = max(run.dMaxCallMicros,
+                                     chrono::duration<double, micro>(chrono::steady_clock::now() - tCall).count());
+            checkoutBasket(store, basketsVec[run.lCheckouts % basketsVec.size()]);
+            run.lCheckouts++;
+            tCall = chrono::steady_clock::now();
+            if (reloader.poll(store, stats))
+            {
+                iApplied++;
+                run.dLoadSeconds += stats.dLoadSeconds;
+                run.dMaxSwapMicros = max(run.dMaxSwapMicros, stats.dSwapMicros);
+                run.dMaxBaseMillis = max(run.dMaxBaseMillis, stats.dJournalMillis);
+            }
+            run.dMaxCallMicros = max(run.dMaxCallMicros,
+                                     chrono::duration<double, micro>(chrono::steady_clock::now() - tCall).count());
+
+            auto tNow = chrono::steady_clock::now();
+            run.dMaxGapMicros = max(run.dMaxGapMicros, chrono::duration<double, micro>(tNow - tLast).count());
+            tLast = tNow;
+        }
+        run.dSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+        return run;
+    };
+
+    Supermarket plainStore = market;
+    LiveRun plain = runLive(plainStore, szStoreFile);
+
+    // Journaled copy, so the reloads never touch the real file's journal
+    bool bSnapshot = szStoreFile.length() >= 5 && szStoreFile.substr(szStoreFile.length() - 5) == ".snap";
+    string szCopy = szStoreFile + (bSnapshot ? ".bench.snap" : ".bench");
+    LiveRun journaled;
+    bool bJournaled = false;
+    {
+        ifstream source(szStoreFile, ios::binary);
+        ofstream copy(szCopy, ios::binary | ios::trunc);
+        bJournaled = (bool)(copy << source.rdbuf());
+    }
+    if (bJournaled)
+    {
+        Supermarket journaledStore = market;
+        bJournaled = attachJournal(journaledStore, szCopy, true);
+        if (bJournaled)
+        {
+            journaled = runLive(journaledStore, szCopy);
+        }
+    }
+    for (const char* szSuffix : {"", ".journal", ".snap", ".snap.journal", ".2.snap", ".2.snap.journal"})
+    {
+        remove((szCopy + szSuffix).c_str());
+    }
+
+    cout << "Live Reload Benchmark" << endl;
+    cout << szBreakMessage;
+    cout << market.catalog.entriesVec.size() << " items, " << iReloads << " reloads" << endl;
+    cout << fixed << setprecision(1);
+    cout << "In place reload ms: " << dInPlace / 1e6 << " (checkouts stopped throughout)" << endl;
+    cout << "Live reload, load ms each: " << plain.dLoadSeconds * 1000.0 / iReloads
+         << ", longest swap us: " << plain.dMaxSwapMicros << endl;
+    cout << "Checkouts during the reloads: " << plain.lCheckouts << " (" << setprecision(0)
+         << plain.lCheckouts / plain.dSeconds << " per second)" << endl;
+    cout << "Longest gap between checkouts us: " << setprecision(1) << plain.dMaxGapMicros
+         << ", longest start or poll us: " << plain.dMaxCallMicros << endl;
+    if (bJournaled)
+    {
+        cout << "Journaled, longest base copy ms: " << journaled.dMaxBaseMillis << ", longest gap us: "
+             << journaled.dMaxGapMicros << ", longest start or poll us: " << journaled.dMaxCallMicros << endl;
+    }
+    cout << "Funds kept: $" << setprecision(2) << plainStore.mTotalFunds << ", purchases kept: "
+         << plainStore.customersVec.size() << endl;
+    cout << szBreakMessage;
+}
@@ -0,0 +1,480 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_catalog.cpp
+
+Purpose:
+    Store-wide index over every item for constant time lookups by
+    name or SKU.
+
+Notes:
+    - The index stores aisle and slot numbers, not pointers, so it
+      stays valid when the Supermarket is copied.
+    - The index lives inside the Supermarket, so resetting the store
+      on reload also resets the index before it is rebuilt.
+    - Names and SKUs each have an open-addressing table with linear
+      probing over one entry list. Each slot packs the entry number
+      with the high half of the name hash or the SKU, so a probe only
+      reads the entry and item when the slot already matches.
+*********************************************************************/
+
+// Smallest table, must be a power of two
+static const size_t iMIN_CATALOG_SLOTS = 64;
+
+/*********************************************************************
+static bool isKeySpace(char c)
+Purpose:
+    Helper function to check for a character that separates words
+Parameters:
+    I   char c              Character of an item name
+Return Value:
+    True for underscores and whitespace, else false
+Notes:
+    Same set as isspace in the C locale, without the library call
+*********************************************************************/
+static inline bool isKeySpace(char c)
+{
+    return c == '_' || c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/*********************************************************************
+static char toKeyLower(char c)
+Purpose:
+    Helper function to lowercase one character of an item name
+Parameters:
+    I   char c              Character of an item name
+Return Value:
+    Lowercase character
+Notes:
+    ASCII only, like tolower in the C locale
+*********************************************************************/
+static inline char toKeyLower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+/*********************************************************************
+string normalizeItemName(const string& szName)
+Purpose:
+    Function to build the lookup key for an item name
+Parameters:
+    I   string szName       Item name as typed or read from file
+Return Value:
+    Lowercase name with underscores as spaces and single spaces
+    between words
+Notes:
+    -
+*********************************************************************/
+string normalizeItemName(const string& szName)
+{
+    string szKey;
+    normalizeItemName(szName, szKey);
+    return szKey;
+}
+
+/*********************************************************************
+void normalizeItemName(const string& szName, string& szKey)
+Purpose:
+    Function to build the lookup key for an item name into a buffer
+Parameters:
+    I   string szName       Item name as typed or read from file
+    O   string& szKey       Lookup key, previous contents are replaced
+Return Value:
+    -
+Notes:
+    Lets hot lookups reuse one buffer instead of allocating a key
+*********************************************************************/
+void normalizeItemName(const string& szName, string& szKey)
+{
+    // The key is never longer than the name
+    szKey.resize(szName.size());
+    char* pKey = &szKey[0];
+
+    size_t iLength = 0;
+    bool bPendingSpace = false;
+    for (char c : szName)
+    {
+        if (isKeySpace(c))
+        {
+            bPendingSpace = iLength > 0;
+            continue;
+        }
+
+        if (bPendingSpace)
+        {
+            pKey[iLength++] = ' ';
+            bPendingSpace = false;
+        }
+        pKey[iLength++] = toKeyLower(c);
+    }
+    szKey.resize(iLength);
+}
+
+/*********************************************************************
+static uint64_t hashItemKey(const string& szKey)
+Purpose:
+    Helper function to hash a normalized item name
+Parameters:
+    I   string szKey        Lookup key from normalizeItemName
+Return Value:
+    64 bit hash of the key
+Notes:
+    FNV-1a followed by a final mix, like member names
+*********************************************************************/
+static uint64_t hashItemKey(const string& szKey)
+{
+    uint64_t iHash = 14695981039346656037ULL;
+    for (char c : szKey)
+    {
+        iHash ^= (unsigned char)c;
+        iHash *= 1099511628211ULL;
+    }
+
+    iHash ^= iHash >> 33;
+    iHash *= 0xff51afd7ed558ccdULL;
+    iHash ^= iHash >> 33;
+    return iHash;
+}
+
+/*********************************************************************
+static uint64_t hashSKU(int iSKU)
+Purpose:
+    Helper function to spread SKUs over the table
+Parameters:
+    I   int iSKU            SKU to hash
+Return Value:
+    64 bit hash of the SKU
+Notes:
+    SKUs are mostly consecutive, the multiply keeps them from
+    clustering in the low bits
+*********************************************************************/
+static uint64_t hashSKU(int iSKU)
+{
+    uint64_t iHash = (uint64_t)(uint32_t)iSKU * 0x9e3779b97f4a7c15ULL;
+    return iHash ^ (iHash >> 29);
+}
+
+/*********************************************************************
+static bool keyMatchesName(const string& szName, const string& szKey)
+Purpose:
+    Helper function to compare an item name with a lookup key
+Parameters:
+    I   string szName       Item name as stored
+    I   string szKey        Lookup key from normalizeItemName
+Return Value:
+    True if szName normalizes to szKey, else false
+Notes:
+    Normalizes on the fly so no key is built for the stored name
+*********************************************************************/
+static bool keyMatchesName(const string& szName, const string& szKey)
+{
+    size_t iKey = 0;
+    bool bPendingSpace = false;
+    for (char c : szName)
+    {
+        if (isKeySpace(c))
+        {
+            bPendingSpace = iKey > 0;
+            continue;
+        }
+
+        if (bPendingSpace)
+        {
+            if (iKey >= szKey.size() || szKey[iKey] != ' ')
+            {
+                return false;
+            }
+            iKey++;
+            bPendingSpace = false;
+        }
+        if (iKey >= szKey.size() || szKey[iKey] != toKeyLower(c))
+        {
+            return false;
+        }
+        iKey++;
+    }
+    return iKey == szKey.size();
+}
+
+/*********************************************************************
+static const Item& entryItem(const Supermarket& myStore, const CatalogEntry& entry)
+Purpose:
+    Helper function to find the item an entry points at
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   CatalogEntry entry      Catalog entry
+Return Value:
+    The item
+Notes:
+    -
+*********************************************************************/
+static const Item& entryItem(const Supermarket& myStore, const CatalogEntry& entry)
+{
+    return myStore.aislesVec[entry.location.iAisleIndex].itemVec[entry.location.iItemIndex];
+}
+
+/*********************************************************************
+static uint32_t slotEntry(uint64_t iValue)
+Purpose:
+    Helper function to take the entry index out of a table slot
+Parameters:
+    I   uint64_t iValue     Slot contents, not empty
+Return Value:
+    Index into entriesVec
+Notes:
+    -
+*********************************************************************/
+static uint32_t slotEntry(uint64_t iValue)
+{
+    return (uint32_t)iValue - 1;
+}
+
+/*********************************************************************
+static bool findNameSlot(const Supermarket& myStore, const string& szKey,
+                         uint64_t iHash, size_t& iSlot)
+Purpose:
+    Helper function to probe the name table for a key
+Parameters:
+    I   Supermarket myStore     Store the index belongs to
+    I   string szKey            Lookup key from normalizeItemName
+    I   uint64_t iHash          Hash of the key
+    O   size_t& iSlot           Slot holding the key, or the empty slot
+                                where it would go
+Return Value:
+    True if the key is in the table, else false
+Notes:
+    Stored hashes are compared before names
+*********************************************************************/
+static bool findNameSlot(const Supermarket& myStore, const string& szKey,
+                         uint64_t iHash, size_t& iSlot)
+{
+    const CatalogIndex& catalog = myStore.catalog;
+    size_t iMask = catalog.nameSlotsVec.size() - 1;
+    uint64_t iTag = iHash >> 32;
+    iSlot = iHash & iMask;
+
+    while (catalog.nameSlotsVec[iSlot] != 0)
+    {
+        uint64_t iValue = catalog.nameSlotsVec[iSlot];
+        if ((iValue >> 32) == iTag)
+        {
+            const CatalogEntry& entry = catalog.entriesVec[slotEntry(iValue)];
+            if (entry.iNameHash == iHash && keyMatchesName(entryItem(myStore, entry).szName, szKey))
+            {
+                return true;
+            }
+        }
+        iSlot = (iSlot + 1) & iMask;
+    }
+    return false;
+}
+
+/*********************************************************************
+static bool findSKUSlot(const CatalogIndex& catalog, int iSKU, size_t& iSlot)
+Purpose:
+    Helper function to probe the SKU table for a SKU
+Parameters:
+    I   CatalogIndex catalog    Index to search
+    I   int iSKU                SKU to find
+    O   size_t& iSlot           Slot holding the SKU, or the empty slot
+                                where it would go
+Return Value:
+    True if the SKU is in the table, else false
+Notes:
+    -
+*********************************************************************/
+static bool findSKUSlot(const CatalogIndex& catalog, int iSKU, size_t& iSlot)
+{
+    size_t iMask = catalog.skuSlotsVec.size() - 1;
+    iSlot = hashSKU(iSKU) & iMask;
+
+    while (catalog.skuSlotsVec[iSlot] != 0)
+    {
+        if ((uint32_t)(catalog.skuSlotsVec[iSlot] >> 32) == (uint32_t)iSKU)
+        {
+            return true;
+        }
+        iSlot = (iSlot + 1) & iMask;
+    }
+    return false;
+}
+
+/*********************************************************************
+void buildCatalogIndex(Supermarket& myStore)
+Purpose:
+    Function to index every item in every aisle
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+Return Value:
+    -
+Notes:
+    Items without a SKU, or with one already taken, are given the
+    next free number. When a name is stocked on several aisles the
+    name key points at the first one. Both tables are sized once, at
+    least twice the number of items, and never grow.
+*********************************************************************/
+void buildCatalogIndex(Supermarket& myStore)
+{
+    CatalogIndex& catalog = myStore.catalog;
+    catalog = CatalogIndex();
+
+    // Highest SKU given in the file, new SKUs start after it
+    int iNextSKU = 1;
+    size_t iItems = 0;
+    for (const Aisle& aisle : myStore.aislesVec)
+    {
+        for (const Item& item : aisle.itemVec)
+        {
+            if (!item.szName.empty())
+            {
+                iNextSKU = max(iNextSKU, item.iSKU + 1);
+                iItems++;
+            }
+        }
+    }
+
+    size_t iSlots = iMIN_CATALOG_SLOTS;
+    while (iSlots < iItems * 2)
+    {
+        iSlots *= 2;
+    }
+    catalog.entriesVec.reserve(iItems);
+    catalog.nameSlotsVec.assign(iSlots, 0);
+    catalog.skuSlotsVec.assign(iSlots, 0);
+
+    string szKey;
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
+    {
+        ArenaVector<Item>& itemVec = myStore.aislesVec[i].itemVec;
+        for (size_t j = 0; j < itemVec.size(); j++)
+        {
+            Item& item = itemVec[j];
+            if (item.szName.empty())
+            {
+                continue;
+            }
+
+            CatalogEntry entry;
+            entry.location.iAisleIndex = (int)i;
+            entry.location.iItemIndex = (int)j;
+            normalizeItemName(item.szName, szKey);
+            entry.iNameHash = hashItemKey(szKey);
+
+            size_t iSKUSlot;
+            if (item.iSKU <= 0 || findSKUSlot(catalog, item.iSKU, iSKUSlot))
+            {
+                item.iSKU = iNextSKU++;
+                findSKUSlot(catalog, item.iSKU, iSKUSlot);
+            }
+            entry.iSKU = item.iSKU;
+
+            size_t iNameSlot;
+            bool bNameTaken = findNameSlot(myStore, szKey, entry.iNameHash, iNameSlot);
+
+            catalog.entriesVec.push_back(entry);
+            uint64_t iEntry = catalog.entriesVec.size();
+            catalog.skuSlotsVec[iSKUSlot] = (uint64_t)(uint32_t)entry.iSKU << 32 | iEntry;
+            if (!bNameTaken)
+            {
+                catalog.nameSlotsVec[iNameSlot] = (entry.iNameHash >> 32) << 32 | iEntry;
+            }
+        }
+    }
+}
+
+/*********************************************************************
+Item* lookupItemByName(Supermarket& myStore, const string& szItemName, ItemLocation* pLocation)
+Purpose:
+    Function to find an item anywhere in the store by name
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   string szItemName       Name of the item, case and underscores ignored
+    O   ItemLocation* pLocation Optional aisle and slot of the item
+Return Value:
+    Pointer to the item, nullptr if no item has that name
+Notes:
+    The key is built in a per-thread buffer so lookups do not allocate
+*********************************************************************/
+Item* lookupItemByName(Supermarket& myStore, const string& szItemName, ItemLocation* pLocation)
+{
+    if (myStore.catalog.nameSlotsVec.empty())
+    {
+        return nullptr;
+    }
+
+    thread_local string szKey;
+    normalizeItemName(szItemName, szKey);
+
+    size_t iSlot;
+    if (!findNameSlot(myStore, szKey, hashItemKey(szKey), iSlot))
+    {
+        return nullptr;
+    }
+
+    const ItemLocation& location = myStore.catalog.entriesVec[slotEntry(myStore.catalog.nameSlotsVec[iSlot])].location;
+    if (pLocation != nullptr)
+    {
+        *pLocation = location;
+    }
+    return &myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex];
+}
+
+/*********************************************************************
+Item* lookupItemBySKU(Supermarket& myStore, int iSKU, ItemLocation* pLocation)
+Purpose:
+    Function to find an item anywhere in the store by SKU
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   int iSKU                SKU of the item
+    O   ItemLocation* pLocation Optional aisle and slot of the item
+Return Value:
+    Pointer to the item, nullptr if no item has that SKU
+Notes:
+    -
+*********************************************************************/
+Item* lookupItemBySKU(Supermarket& myStore, int iSKU, ItemLocation* pLocation)
+{
+    if (myStore.catalog.skuSlotsVec.empty())
+    {
+        return nullptr;
+    }
+
+    size_t iSlot;
+    if (!findSKUSlot(myStore.catalog, iSKU, iSlot))
+    {
+        return nullptr;
+    }
+
+    const ItemLocation& location = myStore.catalog.entriesVec[slotEntry(myStore.catalog.skuSlotsVec[iSlot])].location;
+    if (pLocation != nullptr)
+    {
+        *pLocation = location;
+    }
+    return &myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex];
+}
+
+/*********************************************************************
+int findCatalogEntry(const Supermarket& myStore, int iSKU)
+Purpose:
+    Function to find the catalog entry number of an item by SKU
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   int iSKU                SKU of the item
+Return Value:
+    Index into catalog.entriesVec, -1 if no item has that SKU
+Notes:
+    Entry numbers are dense, so other tables can be kept per item
+*********************************************************************/
+int findCatalogEntry(const Supermarket& myStore, int iSKU)
+{
+    if (myStore.catalog.skuSlotsVec.empty())
+    {
+        return -1;
+    }
+
+    size_t iSlot;
+    if (!findSKUSlot(myStore.catalog, iSKU, iSlot))
+    {
+        return -1;
+    }
+    return (int)slotEntry(myStore.catalog.skuSlotsVec[iSlot]);
+}
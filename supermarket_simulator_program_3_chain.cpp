@@ -0,0 +1,306 @@
+#include "supermarket_simulator_program_3.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+/*********************************************************************
+File name: supermarket_simulator_program_3_chain.cpp
+
+Purpose:
+    Run a chain of stores, each loaded into its own Supermarket, with
+    the stores sharded across worker threads.
+
+Notes:
+    - Store i belongs to worker i % workers. A worker loads, trades and
+      pays each of its stores alone, so workers share no store data
+      and take no locks.
+    - Workers are pinned to a core each where the platform allows it,
+      so a store's memory stays with the core that touched it first.
+    - Each store reports a summary when done. Chain totals are the
+      summaries merged in store order after the workers finish, so
+      they come out the same for any number of workers.
+    - Chain stores are not journaled.
+*********************************************************************/
+
+/*********************************************************************
+static void pinToCore(int iWorker)
+Purpose:
+    Helper function to pin the calling thread to one core
+Parameters:
+    I   int iWorker     Worker number, wraps around the cores allowed
+Return Value:
+    -
+Notes:
+    Does nothing on platforms without thread affinity
+*********************************************************************/
+static void pinToCore(int iWorker)
+{
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+    {
+        return;
+    }
+
+    // Worker n takes the n-th allowed core, wrapping around
+    int iTarget = iWorker % CPU_COUNT(&allowed);
+    for (int iCore = 0; iCore < CPU_SETSIZE; iCore++)
+    {
+        if (CPU_ISSET(iCore, &allowed) && iTarget-- == 0)
+        {
+            cpu_set_t pinned;
+            CPU_ZERO(&pinned);
+            CPU_SET(iCore, &pinned);
+            pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
+            return;
+        }
+    }
+#else
+    (void)iWorker;
+#endif
+}
+
+/*********************************************************************
+static void runChainStore(const ChainStoreSpec& spec, const ChainConfig& config,
+                          int iStoreIndex, StoreSummary& summary)
+Purpose:
+    Helper function to load one store, run its day and pay its staff
+Parameters:
+    I   ChainStoreSpec spec     Store file and optional transaction file
+    I   ChainConfig config      Workload and payroll settings
+    I   int iStoreIndex         Position of the store in the chain
+    O   StoreSummary& summary   What the store did
+Return Value:
+    -
+Notes:
+    Stores without a transaction file simulate a day, seeded with the
+    chain seed plus the store index
+*********************************************************************/
+static void runChainStore(const ChainStoreSpec& spec, const ChainConfig& config,
+                          int iStoreIndex, StoreSummary& summary)
+{
+    auto tStart = chrono::steady_clock::now();
+    summary.szFilename = spec.szStoreFile;
+
+    Supermarket myStore;
+    StoreFileError error;
+    bool bSnapshot = spec.szStoreFile.length() >= 5 &&
+                     spec.szStoreFile.substr(spec.szStoreFile.length() - 5) == ".snap";
+    if (!(bSnapshot ? loadStoreSnapshot(spec.szStoreFile, myStore, error)
+                    : mapSupermarketFile(spec.szStoreFile, myStore, error)))
+    {
+        summary.szError = error.szMessage;
+        if (error.iLine > 0)
+        {
+            summary.szError = "line " + to_string(error.iLine) + ": " + summary.szError;
+        }
+        return;
+    }
+    summary.szName = myStore.szName;
+    summary.bLoaded = true;
+
+    if (!spec.szTransactionFile.empty())
+    {
+        ReplayStats stats = replayTransactions(myStore, spec.szTransactionFile);
+        summary.lBaskets = stats.lTransactions;
+        summary.lRejectedLines = stats.lRejectedLines;
+    }
+    else
+    {
+        SimulationConfig simulation = config.simulation;
+        simulation.lSeed += iStoreIndex;
+        simulation.iLanes = max((int)myStore.employeesVec.size(), 1);
+        SimulationResults results = runStoreSimulation(myStore, simulation);
+        summary.lBaskets = results.lCustomers;
+        summary.lRejectedLines = results.lRejectedLines;
+    }
+
+    if (config.bRunPayroll)
+    {
+        PayrollConfig payroll = config.payroll;
+        payroll.iThreads = 1;
+        summary.payroll = runPayroll(myStore, payroll);
+    }
+
+    summary.mFunds = myStore.mTotalFunds;
+    summary.sales = myStore.sales;
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - tStart;
+    summary.dSeconds = elapsed.count();
+}
+
+/*********************************************************************
+static void runChainWorker(int iWorker, const vector<ChainStoreSpec>& storesVec,
+                           const ChainConfig& config, vector<StoreSummary>& summariesVec)
+Purpose:
+    Thread body of one chain worker
+Parameters:
+    I   int iWorker                         Worker number
+    I   vector<ChainStoreSpec> storesVec    Every store in the chain
+    I   ChainConfig config                  Workload and payroll settings
+    O   vector<StoreSummary>& summariesVec  Summary slot per store, this
+                                            worker fills its own stores'
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void runChainWorker(int iWorker, const vector<ChainStoreSpec>& storesVec,
+                           const ChainConfig& config, vector<StoreSummary>& summariesVec)
+{
+    if (config.bPinWorkers)
+    {
+        pinToCore(iWorker);
+    }
+
+    for (size_t i = iWorker; i < storesVec.size(); i += config.iWorkers)
+    {
+        summariesVec[i].iWorker = iWorker;
+        runChainStore(storesVec[i], config, (int)i, summariesVec[i]);
+    }
+}
+
+/*********************************************************************
+ChainTotals runChain(const vector<ChainStoreSpec>& storesVec, const ChainConfig& config)
+Purpose:
+    Function to run every store in the chain and merge their results
+Parameters:
+    I   vector<ChainStoreSpec> storesVec    Stores in the chain
+    I   ChainConfig config                  Workers, workload and payroll
+Return Value:
+    Chain totals with a summary per store
+Notes:
+    Stores that fail to load are counted and skipped
+*********************************************************************/
+ChainTotals runChain(const vector<ChainStoreSpec>& storesVec, const ChainConfig& config)
+{
+    ChainTotals totals;
+    ChainConfig workerConfig = config;
+    workerConfig.iWorkers = max(min(config.iWorkers, (int)storesVec.size()), 1);
+    totals.iWorkers = workerConfig.iWorkers;
+    totals.iStores = (int)storesVec.size();
+    totals.storesVec.resize(storesVec.size());
+
+    auto tStart = chrono::steady_clock::now();
+    vector<thread> workersVec;
+    for (int i = 0; i < workerConfig.iWorkers; i++)
+    {
+        workersVec.emplace_back(runChainWorker, i, cref(storesVec), cref(workerConfig), ref(totals.storesVec));
+    }
+    for (thread& worker : workersVec)
+    {
+        worker.join();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - tStart;
+    totals.dWallSeconds = elapsed.count();
+
+    for (const StoreSummary& summary : totals.storesVec)
+    {
+        if (!summary.bLoaded)
+        {
+            continue;
+        }
+        totals.iLoaded += 1;
+        totals.lBaskets += summary.lBaskets;
+        totals.lRejectedLines += summary.lRejectedLines;
+        totals.mFunds += summary.mFunds;
+        mergeSalesAggregates(totals.sales, summary.sales);
+
+        totals.payroll.lEmployees += summary.payroll.lEmployees;
+        totals.payroll.lPaidInFull += summary.payroll.lPaidInFull;
+        totals.payroll.lPaidPartly += summary.payroll.lPaidPartly;
+        totals.payroll.lUnpaid += summary.payroll.lUnpaid;
+        totals.payroll.mOwed += summary.payroll.mOwed;
+        totals.payroll.mPaid += summary.payroll.mPaid;
+        totals.payroll.dPlanSeconds += summary.payroll.dPlanSeconds;
+    }
+    totals.payroll.bCovered = totals.payroll.mPaid == totals.payroll.mOwed;
+    return totals;
+}
+
+/*********************************************************************
+bool loadChainList(const string& szFilename, vector<ChainStoreSpec>& storesVec)
+Purpose:
+    Function to read the list of stores in a chain
+Parameters:
+    I   string szFilename                   Chain list file
+    O   vector<ChainStoreSpec>& storesVec   Stores read, in file order
+Return Value:
+    True if the file was read and lists at least one store, else false
+Notes:
+    One store per line: store file, then optionally a transaction file.
+    Blank lines and lines starting with # are ignored. Relative paths
+    are relative to the current directory.
+*********************************************************************/
+bool loadChainList(const string& szFilename, vector<ChainStoreSpec>& storesVec)
+{
+    ifstream fileList(szFilename);
+    if (!fileList.is_open())
+    {
+        cout << szFilename << ": could not be opened" << endl;
+        return false;
+    }
+
+    storesVec.clear();
+    string szLine;
+    while (getline(fileList, szLine))
+    {
+        istringstream issLine(szLine);
+        ChainStoreSpec spec;
+        if (!(issLine >> spec.szStoreFile) || spec.szStoreFile[0] == '#')
+        {
+            continue;
+        }
+        issLine >> spec.szTransactionFile;
+        storesVec.push_back(spec);
+    }
+
+    if (storesVec.empty())
+    {
+        cout << szFilename << ": no stores listed" << endl;
+        return false;
+    }
+    return true;
+}
+
+/*********************************************************************
+void displayChainTotals(const ChainTotals& totals)
+Purpose:
+    Function to display each store's results and the chain totals
+Parameters:
+    I   ChainTotals totals      Result of runChain
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayChainTotals(const ChainTotals& totals)
+{
+    cout << "Chain Results" << endl;
+    cout << szBreakMessage;
+    cout << left << setw(24) << "Store" << setw(8) << "Worker" << setw(10) << "Baskets"
+         << setw(16) << "Sales" << setw(16) << "Payroll" << setw(16) << "Funds" << "Seconds" << right << endl;
+    for (const StoreSummary& summary : totals.storesVec)
+    {
+        if (!summary.bLoaded)
+        {
+            cout << left << setw(24) << summary.szFilename << "not loaded: " << summary.szError << right << endl;
+            continue;
+        }
+        cout << left << setw(24) << summary.szName.substr(0, 23) << setw(8) << summary.iWorker
+             << setw(10) << summary.lBaskets << setw(16) << summary.sales.mGrossSales
+             << setw(16) << summary.payroll.mPaid << setw(16) << summary.mFunds
+             << setprecision(3) << summary.dSeconds << setprecision(2) << right << endl;
+    }
+    cout << szBreakMessage;
+
+    cout << "Stores: " << totals.iLoaded << " of " << totals.iStores << " on " << totals.iWorkers << " workers" << endl;
+    cout << "Baskets: " << totals.lBaskets << ", rejected lines: " << totals.lRejectedLines << endl;
+    cout << "Gross sales: $" << totals.sales.mGrossSales << ", profit: $" << totals.sales.mProfit << endl;
+    cout << "Payroll owed: $" << totals.payroll.mOwed << ", paid: $" << totals.payroll.mPaid
+         << " to " << totals.payroll.lEmployees << " employees" << endl;
+    cout << "Funds: $" << totals.mFunds << endl;
+    cout << "Wall seconds: " << setprecision(3) << totals.dWallSeconds << ", baskets per second: "
+         << setprecision(0) << totals.lBaskets / max(totals.dWallSeconds, 1e-9) << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
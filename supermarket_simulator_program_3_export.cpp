@@ -0,0 +1,633 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_export.cpp
+
+Purpose:
+    Machine-readable CSV and JSON reports of the inventory, the
+    day's transactions, the sales totals and the payroll.
+
+Notes:
+    - Rows go straight from the store into a ReportWriter, which
+      writes its buffer out in blocks, so an export never holds more
+      than one block whatever the size of the store.
+    - Money is written as a plain number with two decimals, with no
+      currency sign, in both formats.
+    - Files ending in .json are written as JSON, anything else as CSV.
+*********************************************************************/
+
+// Buffered report bytes that trigger a write
+static const size_t iREPORT_BLOCK_BYTES = 256 * 1024;
+
+/*********************************************************************
+static void appendCsvText(string& szOut, string_view szValue)
+Purpose:
+    Helper function to append a CSV field, quoted if it needs to be
+Parameters:
+    I/O string& szOut           Text to append to
+    I   string_view szValue     Field value
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void appendCsvText(string& szOut, string_view szValue)
+{
+    if (szValue.find_first_of(",\"\r\n") == string_view::npos)
+    {
+        szOut += szValue;
+        return;
+    }
+
+    szOut += '"';
+    for (char c : szValue)
+    {
+        if (c == '"')
+        {
+            szOut += '"';
+        }
+        szOut += c;
+    }
+    szOut += '"';
+}
+
+/*********************************************************************
+static void appendJsonText(string& szOut, string_view szValue)
+Purpose:
+    Helper function to append a quoted, escaped JSON string
+Parameters:
+    I/O string& szOut           Text to append to
+    I   string_view szValue     String value
+Return Value:
+    -
+Notes:
+    Bytes from 0x80 up are copied as they are, store files are UTF-8
+*********************************************************************/
+static void appendJsonText(string& szOut, string_view szValue)
+{
+    static const char szHEX_DIGITS[] = "0123456789abcdef";
+
+    szOut += '"';
+    for (char c : szValue)
+    {
+        if (c == '"' || c == '\\')
+        {
+            szOut += '\\';
+            szOut += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            szOut += "\\u00";
+            szOut += szHEX_DIGITS[(unsigned char)c >> 4];
+            szOut += szHEX_DIGITS[c & 0xf];
+        }
+        else
+        {
+            szOut += c;
+        }
+    }
+    szOut += '"';
+}
+
+/*********************************************************************
+ReportFormat reportFormatForFile(const string& szFilename)
+Purpose:
+    Function to pick the report format from a file name
+Parameters:
+    I   string szFilename   Report file
+Return Value:
+    REPORT_JSON for names ending in .json, else REPORT_CSV
+Notes:
+    -
+*********************************************************************/
+ReportFormat reportFormatForFile(const string& szFilename)
+{
+    bool bJson = szFilename.length() >= 5 && szFilename.substr(szFilename.length() - 5) == ".json";
+    return bJson ? REPORT_JSON : REPORT_CSV;
+}
+
+/*********************************************************************
+ReportWriter::~ReportWriter()
+Purpose:
+    Destructor, finishes the report if close was not called
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+ReportWriter::~ReportWriter()
+{
+    close();
+}
+
+/*********************************************************************
+bool ReportWriter::open(const string& szFilename, ReportFormat formatIn,
+                        const vector<string>& columnsVec)
+Purpose:
+    Function to create a report file and write its header
+Parameters:
+    I   string szFilename           File to create or replace
+    I   ReportFormat formatIn       CSV or JSON
+    I   vector<string> columnsVec   Column names, every row has one field per column
+Return Value:
+    True if the file was created, else false
+Notes:
+    -
+*********************************************************************/
+bool ReportWriter::open(const string& szFilename, ReportFormat formatIn, const vector<string>& columnsVec)
+{
+    close();
+    fileOut.clear();
+    fileOut.open(szFilename, ios::binary | ios::trunc);
+    if (!fileOut)
+    {
+        return false;
+    }
+
+    format = formatIn;
+    keysVec.clear();
+    szBuffer.clear();
+    szBuffer.reserve(iREPORT_BLOCK_BYTES + 4096);
+    iColumn = 0;
+    lRows = 0;
+    lBytes = 0;
+    bOpen = true;
+
+    if (format == REPORT_JSON)
+    {
+        for (const string& szColumn : columnsVec)
+        {
+            string szKey;
+            appendJsonText(szKey, szColumn);
+            keysVec.push_back(szKey + ':');
+        }
+        szBuffer += '[';
+    }
+    else
+    {
+        for (size_t i = 0; i < columnsVec.size(); i++)
+        {
+            if (i > 0)
+            {
+                szBuffer += ',';
+            }
+            appendCsvText(szBuffer, columnsVec[i]);
+        }
+        szBuffer += '\n';
+    }
+    return true;
+}
+
+/*********************************************************************
+void ReportWriter::startField()
+Purpose:
+    Helper function to write what goes before the next field
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    Opens the row object and writes the key for JSON
+*********************************************************************/
+void ReportWriter::startField()
+{
+    if (format == REPORT_JSON)
+    {
+        if (iColumn == 0)
+        {
+            szBuffer += lRows == 0 ? "\n{" : ",\n{";
+        }
+        else
+        {
+            szBuffer += ',';
+        }
+        szBuffer += keysVec[iColumn];
+    }
+    else if (iColumn > 0)
+    {
+        szBuffer += ',';
+    }
+    iColumn++;
+}
+
+/*********************************************************************
+void ReportWriter::field(string_view szValue)
+Purpose:
+    Function to write a text field
+Parameters:
+    I   string_view szValue     Field value
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void ReportWriter::field(string_view szValue)
+{
+    startField();
+    if (format == REPORT_JSON)
+    {
+        appendJsonText(szBuffer, szValue);
+    }
+    else
+    {
+        appendCsvText(szBuffer, szValue);
+    }
+}
+
+/*********************************************************************
+void ReportWriter::field(long long lValue)
+Purpose:
+    Function to write a whole number field
+Parameters:
+    I   long long lValue    Field value
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void ReportWriter::field(long long lValue)
+{
+    startField();
+    char szDigitsArr[24];
+    to_chars_result written = to_chars(szDigitsArr, szDigitsArr + sizeof(szDigitsArr), lValue);
+    szBuffer.append(szDigitsArr, written.ptr);
+}
+
+/*********************************************************************
+void ReportWriter::field(Money mValue)
+Purpose:
+    Function to write an amount field
+Parameters:
+    I   Money mValue    Field value
+Return Value:
+    -
+Notes:
+    Written as a number with two decimals in both formats
+*********************************************************************/
+void ReportWriter::field(Money mValue)
+{
+    startField();
+    appendMoney(szBuffer, mValue);
+}
+
+/*********************************************************************
+void ReportWriter::flag(bool bValue)
+Purpose:
+    Function to write a yes or no field
+Parameters:
+    I   bool bValue     Field value
+Return Value:
+    -
+Notes:
+    true or false in JSON, y or n in CSV like transaction files
+*********************************************************************/
+void ReportWriter::flag(bool bValue)
+{
+    startField();
+    if (format == REPORT_JSON)
+    {
+        szBuffer += bValue ? "true" : "false";
+    }
+    else
+    {
+        szBuffer += bValue ? 'y' : 'n';
+    }
+}
+
+/*********************************************************************
+void ReportWriter::blank()
+Purpose:
+    Function to write a field with no value
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    null in JSON, empty in CSV
+*********************************************************************/
+void ReportWriter::blank()
+{
+    startField();
+    if (format == REPORT_JSON)
+    {
+        szBuffer += "null";
+    }
+}
+
+/*********************************************************************
+void ReportWriter::endRow()
+Purpose:
+    Function to finish the current row
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    Writes the buffer out once it holds a full block
+*********************************************************************/
+void ReportWriter::endRow()
+{
+    szBuffer += format == REPORT_JSON ? '}' : '\n';
+    iColumn = 0;
+    lRows++;
+    if (szBuffer.size() >= iREPORT_BLOCK_BYTES)
+    {
+        flushBuffer();
+    }
+}
+
+/*********************************************************************
+void ReportWriter::flushBuffer()
+Purpose:
+    Helper function to write the buffer to the file
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void ReportWriter::flushBuffer()
+{
+    fileOut.write(szBuffer.data(), szBuffer.size());
+    lBytes += szBuffer.size();
+    szBuffer.clear();
+}
+
+/*********************************************************************
+bool ReportWriter::close()
+Purpose:
+    Function to finish the report and close the file
+Parameters:
+    -
+Return Value:
+    True if every byte of the report was written, else false
+Notes:
+    Safe to call more than once
+*********************************************************************/
+bool ReportWriter::close()
+{
+    if (!bOpen)
+    {
+        return !fileOut.fail();
+    }
+    bOpen = false;
+
+    if (format == REPORT_JSON)
+    {
+        szBuffer += lRows == 0 ? "]\n" : "\n]\n";
+    }
+    flushBuffer();
+    fileOut.close();
+    return !fileOut.fail();
+}
+
+/*********************************************************************
+bool exportInventoryReport(const Supermarket& myStore, const string& szFilename)
+Purpose:
+    Function to write one row per item on the shelves
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   string szFilename       Report file, .json for JSON
+Return Value:
+    True if the whole report was written, else false
+Notes:
+    stock_value is the quantity at wholesale
+*********************************************************************/
+bool exportInventoryReport(const Supermarket& myStore, const string& szFilename)
+{
+    ReportWriter writer;
+    if (!writer.open(szFilename, reportFormatForFile(szFilename),
+                     {"aisle", "aisle_name", "sku", "item", "quantity", "wholesale",
+                      "regular_price", "member_price", "stock_value"}))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
+    {
+        const Aisle& aisle = myStore.aislesVec[i];
+        for (const Item& item : aisle.itemVec)
+        {
+            writer.field((long long)i);
+            writer.field(aisle.szName);
+            writer.field((long long)item.iSKU);
+            writer.field(item.szName);
+            writer.field((long long)item.iQuantity);
+            writer.field(item.mWholesale);
+            writer.field(item.mRegularPrice);
+            writer.field(item.mMembersPrice);
+            writer.field(item.mWholesale * item.iQuantity);
+            writer.endRow();
+        }
+    }
+    return writer.close();
+}
+
+/*********************************************************************
+bool exportTransactionReport(const Supermarket& myStore, const string& szFilename)
+Purpose:
+    Function to write one row per purchase made today
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   string szFilename       Report file, .json for JSON
+Return Value:
+    True if the whole report was written, else false
+Notes:
+    Rows are in the order the purchases were recorded
+*********************************************************************/
+bool exportTransactionReport(const Supermarket& myStore, const string& szFilename)
+{
+    ReportWriter writer;
+    if (!writer.open(szFilename, reportFormatForFile(szFilename),
+                     {"transaction", "customer", "bought_membership", "items", "cost"}))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < myStore.customersVec.size(); i++)
+    {
+        const CustomerPurchase& purchase = myStore.customersVec[i];
+        writer.field((long long)i + 1);
+        writer.field(purchase.szName);
+        writer.flag(purchase.bBoughtMembership);
+        writer.field((long long)purchase.iNumberItems);
+        writer.field(purchase.mPurchaseCost);
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+/*********************************************************************
+bool exportSalesReport(const Supermarket& myStore, const string& szFilename)
+Purpose:
+    Function to write the running sales totals as rows
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   string szFilename       Report file, .json for JSON
+Return Value:
+    True if the whole report was written, else false
+Notes:
+    One total row, then a row per hour and per aisle with sales.
+    Count is checkouts for the total and hours, lines for aisles.
+    Sales and profit are for items before tax in every row, the other
+    amounts are only filled in on the total row.
+*********************************************************************/
+bool exportSalesReport(const Supermarket& myStore, const string& szFilename)
+{
+    const SalesAggregates& sales = myStore.sales;
+    ReportWriter writer;
+    if (!writer.open(szFilename, reportFormatForFile(szFilename),
+                     {"scope", "key", "count", "items", "sales", "profit",
+                      "gross_sales", "tax", "membership_fees", "cost_of_goods"}))
+    {
+        return false;
+    }
+
+    writer.field("total");
+    writer.blank();
+    writer.field(sales.lCheckouts);
+    writer.field(sales.lItems);
+    writer.field(sales.mGrossSales - sales.mTaxCollected - sales.mMembershipFees);
+    writer.field(sales.mProfit - sales.mMembershipFees);
+    writer.field(sales.mGrossSales);
+    writer.field(sales.mTaxCollected);
+    writer.field(sales.mMembershipFees);
+    writer.field(sales.mCostOfGoods);
+    writer.endRow();
+
+    auto writeBucket = [&](string_view szScope, long long lKey, const SalesBucket& bucket)
+    {
+        writer.field(szScope);
+        writer.field(to_string(lKey));
+        writer.field(bucket.lCount);
+        writer.field(bucket.lItems);
+        writer.field(bucket.mSales);
+        writer.field(bucket.mProfit);
+        writer.blank();
+        writer.blank();
+        writer.blank();
+        writer.blank();
+        writer.endRow();
+    };
+    for (int i = 0; i < 24; i++)
+    {
+        if (sales.hourArr[i].lCount > 0)
+        {
+            writeBucket("hour", i, sales.hourArr[i]);
+        }
+    }
+    for (size_t i = 0; i < sales.aisleVec.size(); i++)
+    {
+        if (sales.aisleVec[i].lCount > 0)
+        {
+            writeBucket("aisle", (long long)i, sales.aisleVec[i]);
+        }
+    }
+    return writer.close();
+}
+
+/*********************************************************************
+bool exportPayrollReport(const Supermarket& myStore, const string& szFilename)
+Purpose:
+    Function to write one row per employee with their pay per period
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   string szFilename       Report file, .json for JSON
+Return Value:
+    True if the whole report was written, else false
+Notes:
+    Period pay is for the first period of the year, see periodPay
+*********************************************************************/
+bool exportPayrollReport(const Supermarket& myStore, const string& szFilename)
+{
+    ReportWriter writer;
+    if (!writer.open(szFilename, reportFormatForFile(szFilename),
+                     {"id", "name", "salary", "monthly", "biweekly", "weekly"}))
+    {
+        return false;
+    }
+
+    for (const Employee& employee : myStore.employeesVec)
+    {
+        writer.field(employee.szID);
+        writer.field(employee.szName);
+        writer.field(employee.mSalary);
+        writer.field(periodPay(employee.mSalary, PAY_PERIOD_MONTHLY, 0));
+        writer.field(periodPay(employee.mSalary, PAY_PERIOD_BIWEEKLY, 0));
+        writer.field(periodPay(employee.mSalary, PAY_PERIOD_WEEKLY, 0));
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+/*********************************************************************
+bool exportReport(const Supermarket& myStore, const string& szReport, const string& szFilename)
+Purpose:
+    Function to write a report chosen by name
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   string szReport         inventory, transactions, sales or payroll
+    I   string szFilename       Report file, .json for JSON
+Return Value:
+    True if the report is known and was written, else false
+Notes:
+    -
+*********************************************************************/
+bool exportReport(const Supermarket& myStore, const string& szReport, const string& szFilename)
+{
+    if (szReport == "inventory")
+    {
+        return exportInventoryReport(myStore, szFilename);
+    }
+    if (szReport == "transactions")
+    {
+        return exportTransactionReport(myStore, szFilename);
+    }
+    if (szReport == "sales")
+    {
+        return exportSalesReport(myStore, szFilename);
+    }
+    if (szReport == "payroll")
+    {
+        return exportPayrollReport(myStore, szFilename);
+    }
+    return false;
+}
+
+/*********************************************************************
+void processReportExport(const Supermarket& myStore)
+Purpose:
+    Function to prompt for a report and a file and export it
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processReportExport(const Supermarket& myStore)
+{
+    string szReport;
+    string szFilename;
+
+    cout << "Enter report (inventory, transactions, sales or payroll): ";
+    cin >> szReport;
+    if (szReport != "inventory" && szReport != "transactions" && szReport != "sales" && szReport != "payroll")
+    {
+        cout << "Unknown report." << endl;
+        return;
+    }
+
+    cout << "Enter report file (.json for JSON, else CSV): ";
+    cin >> szFilename;
+    if (exportReport(myStore, szReport, szFilename))
+    {
+        cout << "Report written to " << szFilename << endl;
+    }
+    else
+    {
+        cout << szFilename << ": report could not be written" << endl;
+    }
+}
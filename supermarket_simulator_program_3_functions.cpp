@@ -1,4 +1,5 @@
 #include "supermarket_simulator_program_3.h"
+#include <limits>
 /*********************************************************************
 File name: supermarket_simulator_v3.cpp
 Author:Pranaya Poudel(ddf85)
@@ -56,9 +57,9 @@ string promptForFilename()
             return "EXIT";
         }
 
-        // Check if the filename ends with .txt and has no spaces
-        bool isValidFile = szFilename.length() >= 4 &&
-                           szFilename.substr(szFilename.length() - 4) == ".txt" &&
+        // Check if the filename ends with .txt or .snap and has no spaces
+        bool isValidFile = ((szFilename.length() >= 4 && szFilename.substr(szFilename.length() - 4) == ".txt") ||
+                            (szFilename.length() >= 5 && szFilename.substr(szFilename.length() - 5) == ".snap")) &&
                            szFilename.find(' ') == string::npos;
 
         if (isValidFile)
@@ -72,19 +73,20 @@ string promptForFilename()
 }
 
 /*********************************************************************
-void processSupermarketInformation(fstream& fileInput, Supermarket& myStore)
+void processSupermarketInformation(Supermarket& myStore)
 Purpose:
     Function to read supermarket text file and process the information
     into a supermarket structure
 Parameters:
-    I/O fstream& fileInput       File stream to read supermarket info
     I/O Supermarket& myStore     Supermarket structure to populate
 Return Value:
     -
 Notes:
-    This function does not validate the file structure it is provided
+    The file is memory mapped by loadSupermarketFile. A store that is
+    already loaded is reloaded in place, keeping its stock, funds,
+    members and purchases.
 *********************************************************************/
-void processSupermarketInformation(fstream &fileInput, Supermarket &myStore) {
+void processSupermarketInformation(Supermarket &myStore) {
     // Prompt for file
     string szFilename = promptForFilename();
     if (szFilename == "EXIT") {
@@ -92,218 +94,277 @@ void processSupermarketInformation(fstream &fileInput, Supermarket &myStore) {
         return;
     }
 
-    // Open file
-    fileInput.open(szFilename, ios::in);
-    if (!fileInput.is_open()) {
-        cout << "File could not be opened. Please try again." << endl;
-        return;
+    if (!myStore.aislesVec.empty())
+    {
+        reloadSupermarketFile(szFilename, myStore);
     }
+    else if (loadSupermarketFile(szFilename, myStore))
+    {
+        attachJournal(myStore, szFilename, false);
+    }
+}
 
-    // Resetting supermarket structure
-    myStore = Supermarket();
-
-    // Parse general supermarket information
-    do {
-        getline(fileInput, myStore.szName);       // Name
-        getline(fileInput, myStore.szStoreHours); // Store Hours
-        fileInput >> myStore.dTotalFunds;         // Total Funds
-        fileInput.ignore();                       // Clear newline
-        fileInput >> myStore.dMembershipFee;      // Membership Fee
-        fileInput.ignore();                       // Clear newline
-        string szLine;
-        getline(fileInput, szLine);               // Skipping "Aisle Information"
-    } while (false); // Ensures this executes once while maintaining a `do-while` structure
-
-    // Parse aisles and items
-    string szLine;
-    int iAisleIndex = 0;
-    do {
-        while (getline(fileInput, szLine) && szLine != "*Employee Information*") {
-            if (szLine.find("Aisle") != string::npos) {
-                myStore.aislesArr[iAisleIndex].szName = szLine.substr(szLine.find(":") + 2);
-                int iItemIndex = 0;
-
-                while (getline(fileInput, szLine) && szLine != "############################") {
-                    istringstream issItem(szLine);
-                    Item &currentItem = myStore.aislesArr[iAisleIndex].itemArr[iItemIndex];
-                    issItem >> currentItem.szName >> currentItem.dWholesale >> currentItem.dRegularPrice >> currentItem.dMembersPrice;
-
-                    // Replace underscores with spaces
-                    for (char &c : currentItem.szName) {
-                        switch (c) {
-                            case '_':
-                                c = ' ';
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    iItemIndex++;
-                }
-                iAisleIndex++;
-            }
-        }
-    } while (false); // Single execution block for do-while structure
-
-    // Parse employees
-    int iEmployeeIndex = 0;
-    while (getline(fileInput, szLine)) {
-        istringstream issEmployee(szLine);
-        Employee &currentEmployee = myStore.employeesArr[iEmployeeIndex];
-        issEmployee >> currentEmployee.szName >> currentEmployee.szID >> currentEmployee.dSalary;
-
-        // Replace underscores with spaces
-        for (char &c : currentEmployee.szName) {
-            switch (c) {
-                case '_':
-                    c = ' ';
-                    break;
-                default:
-                    break;
-            }
-        }
-        iEmployeeIndex++;
+/*********************************************************************
+bool loadSupermarketFile(const string& szFilename, Supermarket& myStore)
+Purpose:
+    Function to read a supermarket text file without prompting
+Parameters:
+    I   string szFilename           Path of the supermarket text file
+    I/O Supermarket& myStore        Supermarket structure to populate
+Return Value:
+    True if the file was opened and parsed, else false
+Notes:
+    Paths ending in .snap are restored as binary snapshots. Malformed
+    text files are reported with the line and column of the problem.
+    A file that fails to load leaves myStore unchanged.
+*********************************************************************/
+bool loadSupermarketFile(const string &szFilename, Supermarket &myStore) {
+    STAT_SCOPE(STAT_FILE_LOAD);
+    StoreFileError error;
+    bool bSnapshot = szFilename.length() >= 5 && szFilename.substr(szFilename.length() - 5) == ".snap";
+    if (bSnapshot ? loadStoreSnapshot(szFilename, myStore, error) : mapSupermarketFile(szFilename, myStore, error)) {
+        return true;
     }
 
-    // Updating employee count
-    myStore.iCurrentEmployees = iEmployeeIndex;
+    if (error.iLine == 0) {
+        cout << szFilename << ": " << error.szMessage << ". Please try again." << endl;
+    } else {
+        cout << szFilename << ": line " << error.iLine << ", column " << error.iColumn
+             << ": " << error.szMessage << endl;
+    }
+    return false;
+}
 
-    // Close the file
-    fileInput.close();
+/*********************************************************************
+static void appendPrice(string& szScreen, Money mValue)
+Purpose:
+    Helper function to append a price with two decimals to a screen
+Parameters:
+    I/O string& szScreen    Screen being built
+    I   Money mValue        Price to append
+Return Value:
+    -
+Notes:
+    Matches how Money prints on cout
+*********************************************************************/
+static void appendPrice(string& szScreen, Money mValue)
+{
+    szScreen += formatMoney(mValue);
 }
 
 /*********************************************************************
-void displayMenu(string szMenuName, string szChoicesArr[], int iChoices)
+string renderMenu(const string& szMenuName, const string szChoicesArr[], int iChoices)
 Purpose:
-    Function to display the menu choices of a provided menu
+    Function to build the menu choices screen of a provided menu
 Parameters:
     I   string szMenuName       Title of the displayed menu
     I   string szChoicesArr     Menu choices to be displayed
     I   int iChoices            Number of menu choices    
 Return Value:
-    -
+    Screen text
 Notes:
     Menu options are displayed starting at 1
     The last menu option should always be displayed as -1
 *********************************************************************/
-void displayMenu(string szMenuName, string szChoicesArr[], int iChoices)
+string renderMenu(const string& szMenuName, const string szChoicesArr[], int iChoices)
 {
+    string szScreen;
+
     // Print top border
-    cout << szMenuName << endl;
-    cout << szBreakMessage;
+    szScreen += szMenuName + "\n";
+    szScreen += szBreakMessage;
     
     // Display menu choices
     for (int i = 0; i < iChoices - 1; i++)
     {
-        cout << i + 1 << ". " << szChoicesArr[i] << endl;
+        szScreen += to_string(i + 1) + ". " + szChoicesArr[i] + "\n";
     }
     
     // Always display the exit option as -1
     if (szMenuName == "\nEmployee Menu") 
     { 
-        cout << "-1. Exit admin menu" << endl; } 
-    else { 
-        cout << "-1. Exit program" << endl;
+        szScreen += "-1. Exit admin menu\n";
+    } 
+    else
+    { 
+        szScreen += "-1. Exit program\n";
     }
     
-    
     // Print bottom border
-    cout << szBreakMessage;
+    szScreen += szBreakMessage;
+    return szScreen;
 }
 
 /*********************************************************************
-void displaySupermarketInfo(const Supermarket myStore)
+void displayMenu(string szMenuName, string szChoicesArr[], int iChoices)
 Purpose:
-    Function to display basic supermarket information
+    Function to display the menu choices of a provided menu
 Parameters:
-    I   Supermarket myStore   Populated Supermarket info   
+    I   string szMenuName       Title of the displayed menu
+    I   string szChoicesArr     Menu choices to be displayed
+    I   int iChoices            Number of menu choices    
 Return Value:
     -
+Notes:
+    See renderMenu
+*********************************************************************/
+void displayMenu(string szMenuName, string szChoicesArr[], int iChoices)
+{
+    cout << renderMenu(szMenuName, szChoicesArr, iChoices) << flush;
+}
+
+/*********************************************************************
+string renderSupermarketInfo(const Supermarket& myStore)
+Purpose:
+    Function to build the supermarket information screen
+Parameters:
+    I   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    Screen text
 Notes:
     -
 *********************************************************************/
-void displaySupermarketInfo(const Supermarket myStore) {
+string renderSupermarketInfo(const Supermarket& myStore)
+{
+    string szScreen;
+
     // Display supermarket name and general information
-    cout << myStore.szName << "'s Information" << endl;
-    cout << szBreakMessage;
+    szScreen += myStore.szName + "'s Information\n";
+    szScreen += szBreakMessage;
 
     // Display store hours
-    cout << "Hours: " << myStore.szStoreHours << endl;
+    szScreen += "Hours: " + myStore.szStoreHours + "\n";
 
-    // Display membership fee (formatted correctly with consistent spacing)
-    cout << "Membership fee: " << endl;
-    cout << "$" << fixed << setprecision(2) << myStore.dMembershipFee << endl;
+    // Display membership fee
+    szScreen += "Membership fee: \n$";
+    appendPrice(szScreen, myStore.mMembershipFee);
+    szScreen += "\n";
 
-    // Display total number of employees (with additional formatting for alignment)
-    cout << "Total employees: " ;
-    cout << myStore.iCurrentEmployees << endl;
+    // Display total number of employees
+    szScreen += "Total employees: " + to_string(myStore.employeesVec.size()) + "\n";
 
-    cout << szBreakMessage;
+    szScreen += szBreakMessage;
+    return szScreen;
 }
 
 /*********************************************************************
-void displayAisles(const Supermarket myStore)
+void displaySupermarketInfo(const Supermarket& myStore)
 Purpose:
-    Function to display all aisles in the supermarket
+    Function to display basic supermarket information
 Parameters:
     I   Supermarket myStore   Populated Supermarket info   
 Return Value:
     -
 Notes:
-    Movies are displayed starting at 0
+    -
 *********************************************************************/
-void displayAisles(const Supermarket myStore)
+void displaySupermarketInfo(const Supermarket& myStore)
 {
-    cout << myStore.szName << "'s Aisles" << endl;
-    cout << szBreakMessage;
-    for (int i = 0; i < 40; i++)
+    cout << renderSupermarketInfo(myStore) << flush;
+}
+
+/*********************************************************************
+string renderAisles(const Supermarket& myStore)
+Purpose:
+    Function to build the list of aisles screen
+Parameters:
+    I   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    Screen text
+Notes:
+    Aisles are displayed starting at 0
+*********************************************************************/
+string renderAisles(const Supermarket& myStore)
+{
+    string szScreen;
+
+    szScreen += myStore.szName + "'s Aisles\n";
+    szScreen += szBreakMessage;
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
     {
-        if (!myStore.aislesArr[i].szName.empty())
+        const Aisle& aisle = myStore.aislesVec[i];
+        if (!aisle.szName.empty())
         {
-            cout << "Aisle " << i << ": " << myStore.aislesArr[i].szName << endl;
+            szScreen += "Aisle " + to_string(i) + ": " + aisle.szName + "\n";
         }
     }
-    cout << szBreakMessage;
+    szScreen += szBreakMessage;
+    return szScreen;
 }
 
-
 /*********************************************************************
-void displayItems(const Supermarket myStore, int iAisleIndex)
+void displayAisles(const Supermarket& myStore)
 Purpose:
     Function to display all aisles in the supermarket
+Parameters:
+    I   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    -
+Notes:
+    Aisles are displayed starting at 0
+*********************************************************************/
+void displayAisles(const Supermarket& myStore)
+{
+    cout << renderAisles(myStore) << flush;
+}
+
+/*********************************************************************
+string renderItems(const Supermarket& myStore, int iAisleIndex)
+Purpose:
+    Function to build the items on an aisle screen
 Parameters:
     I   Supermarket myStore     Populated Supermarket info   
     I   int iAisleIndex         Index of the aisle to display items
 Return Value:
-    -
+    Screen text
 Notes:
-    Movies are displayed starting at 0
+    -
 *********************************************************************/
-void displayItems(const Supermarket myStore, int iAisleIndex)
+string renderItems(const Supermarket& myStore, int iAisleIndex)
 {
-    if (iAisleIndex < 0 || iAisleIndex >= 40 || myStore.aislesArr[iAisleIndex].szName.empty())
+    if (!isValidAisle(myStore, iAisleIndex))
     {
-        cout << "Invalid Aisle Index." << endl;
-        return;
+        return "Invalid Aisle Index.\n";
     }
 
-    Aisle aisle = myStore.aislesArr[iAisleIndex];
-    cout << "Aisle " << iAisleIndex << ": " << aisle.szName << endl;
-    cout << szBreakMessage;
+    const Aisle& aisle = myStore.aislesVec[iAisleIndex];
+    string szScreen;
+    szScreen += "Aisle " + to_string(iAisleIndex) + ": " + aisle.szName + "\n";
+    szScreen += szBreakMessage;
 
-    for (int i = 0; i < 100; i++)
+    for (const Item& item : aisle.itemVec)
     {
-        if (!aisle.itemArr[i].szName.empty())
+        if (!item.szName.empty())
         {
-            Item item = aisle.itemArr[i];
-            cout << endl;
-            cout << item.szName << endl;
-            cout << "Item Quantity: " << item.iQuantity << endl;
-            cout << "Regular Price: " << item.dRegularPrice << endl;
-            cout << "Member  Price: " << item.dMembersPrice << endl;
+            szScreen += "\n";
+            szScreen += item.szName + "\n";
+            szScreen += "Item Quantity: " + to_string(item.iQuantity) + "\n";
+            szScreen += "Regular Price: ";
+            appendPrice(szScreen, item.mRegularPrice);
+            szScreen += "\nMember  Price: ";
+            appendPrice(szScreen, item.mMembersPrice);
+            szScreen += "\n";
         }
     }
-    cout << szBreakMessage;
+    szScreen += szBreakMessage;
+    return szScreen;
+}
+
+/*********************************************************************
+void displayItems(const Supermarket& myStore, int iAisleIndex)
+Purpose:
+    Function to display all items on an aisle
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info   
+    I   int iAisleIndex         Index of the aisle to display items
+Return Value:
+    -
+Notes:
+    Items are displayed in shelf order
+*********************************************************************/
+void displayItems(const Supermarket& myStore, int iAisleIndex)
+{
+    cout << renderItems(myStore, iAisleIndex) << flush;
 }
 
 /*********************************************************************
@@ -311,56 +372,43 @@ CustomerPurchase checkout(Supermarket& myStore)
 Purpose:
     Function to handle customer buying store items
 Parameters:
-    I/O Supermarket& myStore   Populated Supermarket info 
+    I/O Supermarket& myStore   Populated Supermarket info
 Return Value:
     Populated CustomerPurchase if transaction was successful
     Empty CustomerPurchase if transaction was unsuccessful
 Notes:
-    -
+    Interactive client of the checkout engine. The purchase is
+    committed and recorded in customersVec before returning.
 *********************************************************************/
 CustomerPurchase checkout(Supermarket& myStore)
 {
-    CustomerPurchase tempCust;
-
     // Step 1: Ask for the customer’s name.
+    string szName;
     cout << "Please enter your name: ";
     cin.ignore();  // Clear the newline character left in the buffer
-    getline(cin, tempCust.szName);
+    getline(cin, szName);
 
     // Step 2: Check membership status.
-    bool bisMember = false;
-    for (int i = 0; i < myStore.iCurrentMembers; i++)
+    bool bBuyMembership = false;
+    if (isMember(myStore, szName))
     {
-        if (myStore.membersArr[i].szName == tempCust.szName)
-        {
-            bisMember = true;
-            cout << "Welcome back " << tempCust.szName << endl;
-            break;
-        }
+        cout << "Welcome back " << szName << endl;
     }
-
-    double dcartTotal = 0.0;
-
-    if (!bisMember)
+    else
     {
         cout << "Would you like to become a member (y/n)? ";
         char response;
         cin >> response;
-        if (response == 'y')
-        {
-            tempCust.bBoughtMembership = true;
-            myStore.membersArr[myStore.iCurrentMembers++] = {tempCust.szName};
-            bisMember = true;
-
-            // Add membership fee to cart total
-            dcartTotal += myStore.dMembershipFee;
-        }
+        bBuyMembership = (response == 'y');
     }
 
+    CheckoutSession session = beginCheckout(myStore, szName, bBuyMembership);
+
     // Step 3: Shopping process.
     while (true)
     {
-        cout << "\nCurrent cart total: " << fixed << setprecision(2) << dcartTotal << endl << endl;
+        priceCheckout(session);
+        cout << "\nCurrent cart total: " << fixed << setprecision(2) << session.mCartTotal << endl << endl;
         displayAisles(myStore);
         cout << "Please enter aisle index (-1 to exit): ";
         int iaisleIndex;
@@ -370,15 +418,14 @@ CustomerPurchase checkout(Supermarket& myStore)
         {
             case -1:
             {
-                double dtotalCostWithTax = dcartTotal * (1 + dSALES_TAX);
-                tempCust.dPurchaseCost = dtotalCostWithTax;
+                CustomerPurchase purchase = commitCheckout(myStore, session);
 
-                cout << "\nYour total is $" << fixed << setprecision(2) << dtotalCostWithTax << endl;
-                return tempCust;
+                cout << "\nYour total is $" << fixed << setprecision(2) << purchase.mPurchaseCost << endl;
+                return purchase;
             }
 
             default:
-                if (iaisleIndex < 0 || iaisleIndex >= 40 || myStore.aislesArr[iaisleIndex].szName.empty())
+                if (!isValidAisle(myStore, iaisleIndex))
                 {
                     cout << "Invalid Aisle Index. Please try again." << endl;
                     break;
@@ -399,157 +446,848 @@ CustomerPurchase checkout(Supermarket& myStore)
                     }
                 }
 
-                bool bitemFound = false;
-                for (int i = 0; i < 100; i++)
+                Item* pItem = findItem(myStore, iaisleIndex, szitemName);
+                if (pItem == nullptr)
                 {
-                    Item& item = myStore.aislesArr[iaisleIndex].itemArr[i];
-                    if (item.szName == szitemName)
-                    {
-                        bitemFound = true;
-                        if (item.iQuantity > 0)
-                        {
-                            cout << "Please enter valid quantity: ";
-                            int iquantity;
-                            cin >> iquantity;
-
-                            if (iquantity > 0 && iquantity <= item.iQuantity)
-                            {
-                                double dprice = bisMember ? item.dMembersPrice : item.dRegularPrice;
-                                dcartTotal += dprice * iquantity;
-                                item.iQuantity -= iquantity;
-                                tempCust.iNumberItems += iquantity;
-                                tempCust.dPurchaseCost += dprice * iquantity;
-
-                                // Calculate and add profit to the supermarket's funds
-                                double dprofitPerItem = dprice - item.dWholesale; // Profit per item sold
-                                double dtotalProfit = dcartTotal - item.dWholesale * iquantity;
-                                myStore.dTotalFunds += dtotalProfit; // Add the profit to the supermarket's total funds
-                            }
-                            else
-                            {
-                                cout << "Invalid Quantity." << endl;
-                            }
-                        }
-                        else
-                        {
-                            cout << szitemName << " out of stock" << endl;
-                        }
-                        break;
-                    }
+                    cout << "No item " << szitemName << " found." << endl;
                 }
-
-                if (!bitemFound)
+                else if (pItem->iQuantity <= 0)
                 {
-                    cout << "No item " << szitemName << " found." << endl;
+                    cout << szitemName << " out of stock" << endl;
+                }
+                else
+                {
+                    cout << "Please enter valid quantity: ";
+                    int iquantity;
+                    cin >> iquantity;
+
+                    if (addCheckoutLine(myStore, session, iaisleIndex, szitemName, iquantity) != CHECKOUT_OK)
+                    {
+                        cout << "Invalid Quantity." << endl;
+                    }
                 }
                 break;
         }
     }
 
     // This return will only be reached if there's an error
-    return tempCust;
+    return session.purchase;
 }
 
-
 /*********************************************************************
-void displayTotalFunds(const Supermarket& myStore)
+bool isMember(const Supermarket& myStore, const string& szName)
 Purpose:
-    Function to display the total funds of the store
+    Function to check if a customer is a store member
 Parameters:
-    I   Supermarket myStore   Populated Supermarket info   
+    I   Supermarket myStore     Populated Supermarket info
+    I   string szName           Name of the customer
 Return Value:
+    True if the customer is a member, else false
+Notes:
     -
+*********************************************************************/
+bool isMember(const Supermarket& myStore, const string& szName)
+{
+    STAT_SCOPE(STAT_MEMBER_LOOKUP);
+    return registryContains(myStore.memberRegistry, szName);
+}
+
+/*********************************************************************
+bool addMember(Supermarket& myStore, const string& szName)
+Purpose:
+    Function to register a new store member
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   string szName           Name of the new member
+Return Value:
+    True if the member was added, false if they were already a member
 Notes:
-    This function should only be called by an employee
+    -
 *********************************************************************/
-void displayTotalFunds(const Supermarket& myStore)
+bool addMember(Supermarket& myStore, const string& szName)
 {
-    cout << myStore.szName << "'s Total Funds" << endl;
-    cout << szBreakMessage;
-    cout << "Funds: $" << fixed << setprecision(2) << myStore.dTotalFunds << endl;
-    cout << szBreakMessage;
+    return registryInsert(myStore.memberRegistry, szName);
 }
 
+/*********************************************************************
+bool isValidAisle(const Supermarket& myStore, int iAisleIndex)
+Purpose:
+    Function to check an aisle index entered by a customer
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   int iAisleIndex         Aisle index to check
+Return Value:
+    True if the aisle exists and has a name, else false
+Notes:
+    -
+*********************************************************************/
+bool isValidAisle(const Supermarket& myStore, int iAisleIndex)
+{
+    return iAisleIndex >= 0 && iAisleIndex < (int)myStore.aislesVec.size() &&
+           !myStore.aislesVec[iAisleIndex].szName.empty();
+}
 
 /*********************************************************************
-double calculatedTotalSales(const Supermarket& myStore)
+Item* findItem(Supermarket& myStore, int iAisleIndex, const string& szItemName)
 Purpose:
-    Function to calculate the total sales of the supermarket
+    Function to find an item on an aisle by name
 Parameters:
-    I   Supermarket myStore   Populated Supermarket info   
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   int iAisleIndex         Aisle to search
+    I   string szItemName       Name of the item with spaces, not underscores
 Return Value:
-    Total sales
+    Pointer to the item, nullptr if the aisle or item does not exist
 Notes:
-    This function should only be called by an employee
+    Uses the catalog index. The aisle is only scanned when the name
+    is also stocked on an earlier aisle.
 *********************************************************************/
-double calculateTotalSales(const Supermarket& myStore)
+Item* findItem(Supermarket& myStore, int iAisleIndex, const string& szItemName)
 {
-    double dtotalSales = 0.0;
+    if (!isValidAisle(myStore, iAisleIndex))
+    {
+        return nullptr;
+    }
+
+    ItemLocation location;
+    Item* pItem = lookupItemByName(myStore, szItemName, &location);
+    if (pItem == nullptr || location.iAisleIndex == iAisleIndex)
+    {
+        return pItem;
+    }
 
-    for (int i = 0; i < myStore.iCurrentCustomers; i++)
+    string szKey = normalizeItemName(szItemName);
+    for (Item& item : myStore.aislesVec[iAisleIndex].itemVec)
     {
-        double purchaseCost = myStore.customersArr[i].dPurchaseCost;
-        if (purchaseCost > 0) {
-            dtotalSales += purchaseCost / (1 + dSALES_TAX);
+        if (!item.szName.empty() && normalizeItemName(item.szName) == szKey)
+        {
+            return &item;
         }
     }
+    return nullptr;
+}
+
+/*********************************************************************
+CheckoutSession beginCheckout(Supermarket& myStore, const string& szName, bool bBuyMembership,
+                              PricingTier eTier)
+Purpose:
+    Function to open a checkout for a customer
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   string szName           Name of the customer
+    I   bool bBuyMembership     Customer asked to buy a membership
+    I   PricingTier eTier       Employee or tax exempt pricing, else regular
+Return Value:
+    Open checkout session
+Notes:
+    Existing members get member pricing without paying the fee again.
+*********************************************************************/
+CheckoutSession beginCheckout(Supermarket& myStore, const string& szName, bool bBuyMembership,
+                              PricingTier eTier)
+{
+    bool bIsMember = isMember(myStore, szName);
+    bool bBoughtMembership = !bIsMember && bBuyMembership && addMember(myStore, szName);
 
-    return dtotalSales;
+    return openCheckout(myStore, szName, bIsMember, bBoughtMembership, eTier);
 }
 
+/*********************************************************************
+CheckoutSession openCheckout(const Supermarket& myStore, const string& szName,
+                             bool bIsMember, bool bBoughtMembership, PricingTier eTier)
+Purpose:
+    Function to open a checkout once membership has been decided
+Parameters:
+    I   Supermarket myStore         Populated Supermarket info
+    I   string szName               Name of the customer
+    I   bool bIsMember              Customer was already a member
+    I   bool bBoughtMembership      Customer was just signed up
+    I   PricingTier eTier           Employee or tax exempt pricing, else regular
+Return Value:
+    Open checkout session
+Notes:
+    Does not touch the member list, callers that share the store
+    between lanes register members under their own lock. Employee and
+    tax exempt pricing apply whether or not the customer is a member.
+*********************************************************************/
+CheckoutSession openCheckout(const Supermarket& myStore, const string& szName,
+                             bool bIsMember, bool bBoughtMembership, PricingTier eTier)
+{
+    CheckoutSession session;
+    session.purchase.szName = szName;
+    session.eTier = eTier;
+    if (eTier == PRICING_REGULAR && (bIsMember || bBoughtMembership))
+    {
+        session.eTier = PRICING_MEMBER;
+    }
+
+    if (bBoughtMembership)
+    {
+        session.purchase.bBoughtMembership = true;
+
+        // Add membership fee to cart total
+        session.mCartTotal += myStore.mMembershipFee;
+    }
+
+    return session;
+}
 
 /*********************************************************************
-bool payEmployees(Supermarket& myStore)
+CheckoutStatus reserveStock(Item& item, int iQuantity)
 Purpose:
-    Function to calculate the total sales of the supermarket
+    Function to take items off the shelf without overselling
 Parameters:
-    I/O   Supermarket myStore   Populated Supermarket info   
+    I/O Item& item          Item to take from
+    I   int iQuantity       Number of items to take
 Return Value:
-    True if funds were successfully subtracted, else false. 
+    CHECKOUT_OK if the stock was taken, else the reason it was not
 Notes:
-    This function should only be called by an employee
+    Uses a compare and swap on iQuantity so concurrent lanes never
+    take more than is on the shelf
 *********************************************************************/
-bool payEmployees(Supermarket& myStore)
+CheckoutStatus reserveStock(Item& item, int iQuantity)
 {
-    double dtotalSalaries = 0.0;
+    atomic_ref<int> stock(item.iQuantity);
+    int iCurrent = stock.load(memory_order_relaxed);
+
+    do
+    {
+        if (iCurrent <= 0)
+        {
+            return CHECKOUT_OUT_OF_STOCK;
+        }
+        if (iQuantity <= 0 || iQuantity > iCurrent)
+        {
+            return CHECKOUT_INVALID_QUANTITY;
+        }
+    } while (!stock.compare_exchange_weak(iCurrent, iCurrent - iQuantity, memory_order_relaxed));
+
+    return CHECKOUT_OK;
+}
 
-    for (int i = 0; i < myStore.iCurrentEmployees; i++)
+/*********************************************************************
+CheckoutStatus addCheckoutLine(Supermarket& myStore, CheckoutSession& session,
+                               int iAisleIndex, const string& szItemName, int iQuantity)
+Purpose:
+    Function to add items to an open checkout
+Parameters:
+    I/O Supermarket& myStore        Populated Supermarket info
+    I/O CheckoutSession& session    Open checkout session
+    I   int iAisleIndex             Aisle the item is on, -1 for any aisle
+    I   string szItemName           Name of the item
+    I   int iQuantity               Number of items to buy
+Return Value:
+    CHECKOUT_OK if the items were added, else the reason they were not
+Notes:
+    Stock is taken from the shelf immediately.
+    Safe to call from several checkout lanes at once.
+*********************************************************************/
+CheckoutStatus addCheckoutLine(Supermarket& myStore, CheckoutSession& session,
+                               int iAisleIndex, const string& szItemName, int iQuantity)
+{
+    Item* pItem = nullptr;
     {
-        dtotalSalaries = dtotalSalaries + myStore.employeesArr[i].dSalary;
+        STAT_SCOPE(STAT_ITEM_LOOKUP);
+        if (iAisleIndex == -1)
+        {
+            ItemLocation location;
+            pItem = lookupItemByName(myStore, szItemName, &location);
+            iAisleIndex = location.iAisleIndex;
+        }
+        else if (!isValidAisle(myStore, iAisleIndex))
+        {
+            return CHECKOUT_INVALID_AISLE;
+        }
+        else
+        {
+            pItem = findItem(myStore, iAisleIndex, szItemName);
+        }
     }
 
-    if (myStore.dTotalFunds < dtotalSalaries)
+    if (pItem == nullptr)
     {
-        return false;
+        return CHECKOUT_ITEM_NOT_FOUND;
     }
+    return addCheckoutItem(session, *pItem, iAisleIndex, iQuantity);
+}
 
-    myStore.dTotalFunds = myStore.dTotalFunds - dtotalSalaries;
-    return true;
+/*********************************************************************
+CheckoutStatus addBasketLine(Supermarket& myStore, CheckoutSession& session, const BasketLine& line)
+Purpose:
+    Function to add one basket line to an open checkout
+Parameters:
+    I/O Supermarket& myStore        Populated Supermarket info
+    I/O CheckoutSession& session    Open checkout session
+    I   BasketLine line             SKU or aisle and name, and quantity
+Return Value:
+    CHECKOUT_OK if the items were added, else the reason they were not
+Notes:
+    Lines with a SKU skip the name lookup
+*********************************************************************/
+CheckoutStatus addBasketLine(Supermarket& myStore, CheckoutSession& session, const BasketLine& line)
+{
+    if (line.iSKU > 0)
+    {
+        ItemLocation location;
+        Item* pItem;
+        {
+            STAT_SCOPE(STAT_ITEM_LOOKUP);
+            pItem = lookupItemBySKU(myStore, line.iSKU, &location);
+        }
+        if (pItem == nullptr)
+        {
+            return CHECKOUT_ITEM_NOT_FOUND;
+        }
+        return addCheckoutItem(session, *pItem, location.iAisleIndex, line.iQuantity);
+    }
+
+    return addCheckoutLine(myStore, session, line.iAisleIndex, line.szItemName, line.iQuantity);
 }
 
 /*********************************************************************
-void clearMembers(Supermarket& myStore);
+CheckoutStatus addCheckoutItem(CheckoutSession& session, Item& item, int iAisleIndex, int iQuantity)
 Purpose:
-    Function to clear the members from the supermarket
+    Function to take a located item off the shelf and price it
 Parameters:
-    I/O   Supermarket myStore   Populated Supermarket info   
+    I/O CheckoutSession& session    Open checkout session
+    I/O Item& item                  Item to buy
+    I   int iAisleIndex             Aisle the item is on
+    I   int iQuantity               Number of items to buy
 Return Value:
-    -
+    CHECKOUT_OK if the items were added, else the reason they were not
 Notes:
-    A cleared member should set back to a default state.
-    This function should only be called by an employee.
-    This does not clear the stored text file.
+    The shelf prices are kept with the line and the whole basket is
+    priced for its tier by priceCheckout, so the cart total only
+    includes the line once the session has been priced.
 *********************************************************************/
-void clearMembers(Supermarket& myStore)
+CheckoutStatus addCheckoutItem(CheckoutSession& session, Item& item, int iAisleIndex, int iQuantity)
 {
-    myStore.iCurrentMembers = 0;
-    for (int i = 0; i < 200; i++)
+    CheckoutStatus status = reserveStock(item, iQuantity);
+    if (status != CHECKOUT_OK)
     {
-        myStore.membersArr[i] = Member();
+        return status;
     }
+
+    session.purchase.iNumberItems += iQuantity;
+    session.takenVec.push_back({item.iSKU, iAisleIndex, iQuantity, Money(), item.mWholesale,
+                                item.mRegularPrice, item.mMembersPrice});
+
+    return CHECKOUT_OK;
 }
 
-void extraCredit(Supermarket& myStore)
+/*********************************************************************
+CustomerPurchase finishCheckout(CheckoutSession& session)
+Purpose:
+    Function to close a checkout and apply sales tax
+Parameters:
+    I/O CheckoutSession& session    Open checkout session
+Return Value:
+    Completed purchase
+Notes:
+    Does not touch the store, see commitCheckout. Tax is rounded once
+    on the whole cart, see calculateSalesTax.
+*********************************************************************/
+CustomerPurchase finishCheckout(CheckoutSession& session)
 {
-    cout << "Not implemented yet" << endl;
+    priceCheckout(session);
+    session.purchase.mPurchaseCost = session.mCartTotal + checkoutSalesTax(session.eTier, session.mCartTotal);
+    return session.purchase;
+}
+
+/*********************************************************************
+bool recordPurchase(Supermarket& myStore, const CustomerPurchase& purchase)
+Purpose:
+    Function to store a completed purchase in customersVec
+Parameters:
+    I/O Supermarket& myStore            Populated Supermarket info
+    I   CustomerPurchase purchase       Completed purchase
+Return Value:
+    True if the purchase was stored, false if it has no customer name
+Notes:
+    -
+*********************************************************************/
+bool recordPurchase(Supermarket& myStore, const CustomerPurchase& purchase)
+{
+    if (purchase.szName == "")
+    {
+        return false;
+    }
+
+    myStore.customersVec.push_back(purchase);
+    return true;
+}
+
+/*********************************************************************
+CustomerPurchase commitCheckout(Supermarket& myStore, CheckoutSession& session)
+Purpose:
+    Function to complete a checkout against the store
+Parameters:
+    I/O Supermarket& myStore        Populated Supermarket info
+    I/O CheckoutSession& session    Open checkout session
+Return Value:
+    Completed purchase
+Notes:
+    The store keeps the profit on the items plus any membership fee.
+    Sales tax is not kept by the store.
+*********************************************************************/
+CustomerPurchase commitCheckout(Supermarket& myStore, CheckoutSession& session)
+{
+    STAT_SCOPE(STAT_CHECKOUT_COMMIT);
+    CustomerPurchase purchase = finishCheckout(session);
+
+    Money mFunds = checkoutFunds(myStore, session);
+    int iHour = currentHourOfDay();
+    int iDay = currentDayNumber();
+    myStore.mTotalFunds += mFunds;
+    recordCheckoutSales(myStore.sales, session, myStore.mMembershipFee, iHour);
+    recordRestockSales(myStore, session);
+    recordCheckoutAnalytics(myStore.analytics, session, iHour);
+    recordCheckoutLines(myStore.lineItems, session, iDay);
+    journalCheckout(myStore, session, mFunds, iHour, iDay);
+    recordPurchase(myStore, purchase);
+    return purchase;
+}
+
+/*********************************************************************
+void cancelCheckout(Supermarket& myStore, CheckoutSession& session)
+Purpose:
+    Function to abandon an open checkout and put its stock back
+Parameters:
+    I/O Supermarket& myStore        Populated Supermarket info
+    I/O CheckoutSession& session    Open checkout session, emptied
+Return Value:
+    -
+Notes:
+    Nothing is journaled or recorded, since nothing was sold. Safe to
+    call from several checkout lanes at once.
+*********************************************************************/
+void cancelCheckout(Supermarket& myStore, CheckoutSession& session)
+{
+    for (const StockChange& change : session.takenVec)
+    {
+        Item* pItem = lookupItemBySKU(myStore, change.iSKU);
+        if (pItem != nullptr)
+        {
+            atomic_ref<int>(pItem->iQuantity).fetch_add(change.iQuantity, memory_order_relaxed);
+        }
+    }
+    session = CheckoutSession();
+}
+
+/*********************************************************************
+Money checkoutFunds(const Supermarket& myStore, const CheckoutSession& session)
+Purpose:
+    Function to calculate what a checkout adds to the store funds
+Parameters:
+    I   Supermarket myStore         Populated Supermarket info
+    I   CheckoutSession session     Finished checkout session
+Return Value:
+    Profit on the items plus any membership fee
+Notes:
+    -
+*********************************************************************/
+Money checkoutFunds(const Supermarket& myStore, const CheckoutSession& session)
+{
+    Money mFunds = session.mProfit;
+    if (session.purchase.bBoughtMembership)
+    {
+        mFunds += myStore.mMembershipFee;
+    }
+    return mFunds;
+}
+
+/*********************************************************************
+CustomerPurchase checkoutBasket(Supermarket& myStore, const Basket& basket, ReplayStats* pStats)
+Purpose:
+    Function to check out a whole basket without any prompts
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   Basket basket           Customer and items to buy
+    I/O ReplayStats* pStats     Optional line counters, may be nullptr
+Return Value:
+    Completed purchase
+Notes:
+    Lines the engine refuses are skipped, the rest of the basket is kept
+*********************************************************************/
+CustomerPurchase checkoutBasket(Supermarket& myStore, const Basket& basket, ReplayStats* pStats)
+{
+    STAT_SCOPE(STAT_CHECKOUT);
+    CheckoutSession session = beginCheckout(myStore, basket.szCustomerName, basket.bBuyMembership, basket.eTier);
+
+    for (const BasketLine& line : basket.linesVec)
+    {
+        CheckoutStatus status = addBasketLine(myStore, session, line);
+        if (pStats != nullptr)
+        {
+            pStats->lLines += 1;
+            if (status != CHECKOUT_OK)
+            {
+                pStats->lRejectedLines += 1;
+            }
+        }
+    }
+
+    return commitCheckout(myStore, session);
+}
+
+/*********************************************************************
+static bool nextToken(const string& szLine, size_t& iPos, string& szToken)
+Purpose:
+    Helper function to read the next whitespace separated token
+Parameters:
+    I   string szLine       Line being tokenized
+    I/O size_t& iPos        Read position, moved past the token
+    O   string& szToken     Token that was read
+Return Value:
+    True if a token was read, false at the end of the line
+Notes:
+    Underscores in the token are replaced with spaces
+*********************************************************************/
+static bool nextToken(const string& szLine, size_t& iPos, string& szToken)
+{
+    while (iPos < szLine.length() && isspace((unsigned char)szLine[iPos]))
+    {
+        iPos++;
+    }
+    if (iPos >= szLine.length())
+    {
+        return false;
+    }
+
+    size_t iStart = iPos;
+    while (iPos < szLine.length() && !isspace((unsigned char)szLine[iPos]))
+    {
+        iPos++;
+    }
+
+    szToken.assign(szLine, iStart, iPos - iStart);
+    for (char& c : szToken)
+    {
+        if (c == '_')
+        {
+            c = ' ';
+        }
+    }
+    return true;
+}
+
+/*********************************************************************
+static bool parseCount(const string& szToken, int& iValue)
+Purpose:
+    Helper function to parse a whole number token
+Parameters:
+    I   string szToken      Token to parse
+    O   int& iValue         Parsed value
+Return Value:
+    True if the whole token was a number, else false
+Notes:
+    -
+*********************************************************************/
+static bool parseCount(const string& szToken, int& iValue)
+{
+    char* pEnd = nullptr;
+    long lValue = strtol(szToken.c_str(), &pEnd, 10);
+    if (pEnd == szToken.c_str() || *pEnd != '\0')
+    {
+        return false;
+    }
+
+    iValue = (int)lValue;
+    return true;
+}
+
+/*********************************************************************
+bool parseTransactionLine(const string& szLine, Basket& basket)
+Purpose:
+    Function to parse one transaction from a transaction file
+Parameters:
+    I   string szLine       Transaction line
+    O   Basket& basket      Parsed basket, lines are replaced
+Return Value:
+    True if the line is a valid transaction, else false
+Notes:
+    Format is: Name y|n|e|x aisle item quantity [aisle item quantity ...]
+    y buys a membership, e is an employee and x is tax exempt.
+    Names use underscores in place of spaces, like the store file.
+    An aisle of -1 searches every aisle, an item of #123 is a SKU.
+*********************************************************************/
+bool parseTransactionLine(const string& szLine, Basket& basket)
+{
+    size_t iPos = 0;
+    string szToken;
+
+    basket.linesVec.clear();
+    if (!nextToken(szLine, iPos, basket.szCustomerName) || !nextToken(szLine, iPos, szToken))
+    {
+        return false;
+    }
+    if (szToken != "y" && szToken != "n" && szToken != "e" && szToken != "x")
+    {
+        return false;
+    }
+    basket.bBuyMembership = (szToken == "y");
+    basket.eTier = szToken == "e" ? PRICING_EMPLOYEE : szToken == "x" ? PRICING_TAX_EXEMPT : PRICING_REGULAR;
+
+    BasketLine line;
+    while (nextToken(szLine, iPos, szToken))
+    {
+        if (!parseCount(szToken, line.iAisleIndex) ||
+            !nextToken(szLine, iPos, line.szItemName) ||
+            !nextToken(szLine, iPos, szToken) ||
+            !parseCount(szToken, line.iQuantity))
+        {
+            return false;
+        }
+
+        // #123 names an item by SKU
+        line.iSKU = 0;
+        if (line.szItemName.length() > 1 && line.szItemName[0] == '#' &&
+            !parseCount(line.szItemName.substr(1), line.iSKU))
+        {
+            return false;
+        }
+        basket.linesVec.push_back(line);
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ReplayStats replayTransactions(Supermarket& myStore, const string& szFilename)
+Purpose:
+    Function to push a transaction file through the checkout engine
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+    I   string szFilename       Path of the transaction file
+Return Value:
+    Counters and timing for the replay
+Notes:
+    Blank lines and lines starting with # are ignored
+*********************************************************************/
+ReplayStats replayTransactions(Supermarket& myStore, const string& szFilename)
+{
+    ReplayStats stats;
+    ifstream fileTransactions(szFilename);
+    if (!fileTransactions.is_open())
+    {
+        cout << "Transaction file could not be opened." << endl;
+        return stats;
+    }
+
+    auto tStart = chrono::steady_clock::now();
+
+    string szLine;
+    Basket basket;
+    while (getline(fileTransactions, szLine))
+    {
+        if (szLine.empty() || szLine[0] == '#')
+        {
+            continue;
+        }
+
+        if (!parseTransactionLine(szLine, basket))
+        {
+            stats.lMalformed += 1;
+            continue;
+        }
+
+        checkoutBasket(myStore, basket, &stats);
+        stats.lTransactions += 1;
+    }
+
+    stats.dSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+    return stats;
+}
+
+/*********************************************************************
+bool loadTransactionFile(const string& szFilename, vector<Basket>& basketsVec, long long& lMalformed)
+Purpose:
+    Function to parse a whole transaction file into memory
+Parameters:
+    I   string szFilename           Path of the transaction file
+    O   vector<Basket>& basketsVec  Parsed baskets, appended to
+    O   long long& lMalformed       Number of lines that could not be parsed
+Return Value:
+    True if the file was opened, else false
+Notes:
+    Used by drivers that must not time parsing along with checkout
+*********************************************************************/
+bool loadTransactionFile(const string& szFilename, vector<Basket>& basketsVec, long long& lMalformed)
+{
+    ifstream fileTransactions(szFilename);
+    if (!fileTransactions.is_open())
+    {
+        cout << "Transaction file could not be opened." << endl;
+        return false;
+    }
+
+    lMalformed = 0;
+    string szLine;
+    Basket basket;
+    while (getline(fileTransactions, szLine))
+    {
+        if (szLine.empty() || szLine[0] == '#')
+        {
+            continue;
+        }
+
+        if (parseTransactionLine(szLine, basket))
+        {
+            basketsVec.push_back(basket);
+        }
+        else
+        {
+            lMalformed += 1;
+        }
+    }
+    return true;
+}
+
+/*********************************************************************
+void displayReplayStats(const ReplayStats& stats)
+Purpose:
+    Function to display the results of a transaction replay
+Parameters:
+    I   ReplayStats stats   Replay counters and timing
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayReplayStats(const ReplayStats& stats)
+{
+    cout << "Replay Results" << endl;
+    cout << szBreakMessage;
+    cout << "Transactions: " << stats.lTransactions << endl;
+    cout << "Basket lines: " << stats.lLines << endl;
+    cout << "Rejected lines: " << stats.lRejectedLines << endl;
+    cout << "Malformed transactions: " << stats.lMalformed << endl;
+    cout << "Elapsed seconds: " << fixed << setprecision(3) << stats.dSeconds << endl;
+    if (stats.dSeconds > 0)
+    {
+        cout << "Transactions per second: " << setprecision(0) << stats.lTransactions / stats.dSeconds << endl;
+    }
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+
+/*********************************************************************
+void displayTotalFunds(const Supermarket& myStore)
+Purpose:
+    Function to display the total funds of the store
+Parameters:
+    I   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void displayTotalFunds(const Supermarket& myStore)
+{
+    cout << myStore.szName << "'s Total Funds" << endl;
+    cout << szBreakMessage;
+    cout << "Funds: $" << fixed << setprecision(2) << myStore.mTotalFunds << endl;
+    cout << szBreakMessage;
+}
+
+
+/*********************************************************************
+Money calculatedTotalSales(const Supermarket& myStore)
+Purpose:
+    Function to calculate the total sales of the supermarket
+Parameters:
+    I   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    Total sales
+Notes:
+    This function should only be called by an employee.
+    Reads the running totals, sales exclude tax.
+*********************************************************************/
+Money calculateTotalSales(const Supermarket& myStore)
+{
+    return myStore.sales.mGrossSales - myStore.sales.mTaxCollected;
+}
+
+
+/*********************************************************************
+bool payEmployees(Supermarket& myStore)
+Purpose:
+    Function to pay every employee their full salary
+Parameters:
+    I/O   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    True if funds were successfully subtracted, else false. 
+Notes:
+    This function should only be called by an employee.
+    Pays nobody if the funds do not cover everyone, see runPayroll
+    for pay periods and partial payment.
+*********************************************************************/
+bool payEmployees(Supermarket& myStore)
+{
+    return runPayroll(myStore, PayrollConfig()).bCovered;
+}
+
+/*********************************************************************
+void clearMembers(Supermarket& myStore);
+Purpose:
+    Function to clear the members from the supermarket
+Parameters:
+    I/O   Supermarket myStore   Populated Supermarket info   
+Return Value:
+    -
+Notes:
+    A cleared member should set back to a default state.
+    This function should only be called by an employee.
+    This does not clear the stored text file.
+*********************************************************************/
+void clearMembers(Supermarket& myStore)
+{
+    registryClear(myStore.memberRegistry);
+    journalClearMembers(myStore);
+}
+
+/*********************************************************************
+void extraCredit(Supermarket& myStore)
+Purpose:
+    Function to simulate a full trading day against the store
+Parameters:
+    I/O Supermarket& myStore   Populated Supermarket info
+Return Value:
+    -
+Notes:
+    Lanes default to one per employee. The simulated customers really
+    buy from the store, so stock, funds and members are updated.
+*********************************************************************/
+void extraCredit(Supermarket& myStore)
+{
+    SimulationConfig config;
+    config.iLanes = max((int)myStore.employeesVec.size(), 1);
+
+    cout << "Enter number of customers to simulate: ";
+    if (!(cin >> config.iCustomers) || config.iCustomers <= 0)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid number of customers." << endl;
+        return;
+    }
+
+    cout << "Enter number of open lanes (" << myStore.employeesVec.size() << " employees): ";
+    if (!(cin >> config.iLanes) || config.iLanes <= 0)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid number of lanes." << endl;
+        return;
+    }
+
+    cout << "Enter random seed: ";
+    if (!(cin >> config.lSeed))
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid seed." << endl;
+        return;
+    }
+
+    displaySimulationResults(runStoreSimulation(myStore, config));
 }
\ No newline at end of file
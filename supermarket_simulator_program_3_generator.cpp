@@ -0,0 +1,340 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_generator.cpp
+
+Purpose:
+    Write synthetic store files and transaction files of any size for
+    benchmarks and load tests.
+
+Notes:
+    - Everything is drawn from one mt19937_64 stream, whose output the
+      standard fixes, and mapped to ranges without the library
+      distributions, so a seed gives the same files on every platform.
+    - Store files use the SKU column, so every item can be bought by
+      name or by SKU.
+    - The transaction file signs the members up first, then the
+      customers shop, about half of them as members.
+*********************************************************************/
+
+// Generated files are written in blocks of this many bytes
+static const size_t iGENERATOR_BLOCK_BYTES = 256 * 1024;
+
+// Words for aisle and employee names
+static const char* const szAISLE_WORDS_ARR[] = {
+    "Produce", "Dairy", "Bakery", "Frozen", "Pantry", "Snacks", "Drinks", "Household",
+    "Deli", "Meat", "Seafood", "Health", "Baby", "Pets", "Breakfast", "International"
+};
+static const char* const szFIRST_NAMES_ARR[] = {
+    "John", "Jane", "Maria", "David", "Wei", "Aisha", "Carlos", "Emma",
+    "Omar", "Yuki", "Liam", "Sofia", "Noah", "Priya", "Lucas", "Chloe"
+};
+static const char* const szLAST_NAMES_ARR[] = {
+    "Smith", "Doe", "Garcia", "Chen", "Khan", "Silva", "Brown", "Tanaka",
+    "Lopez", "Patel", "Miller", "Rossi", "Novak", "Okafor", "Nguyen", "Berg"
+};
+
+/*********************************************************************
+static uint64_t drawBelow(mt19937_64& rng, uint64_t iBound)
+Purpose:
+    Helper function to draw a number from 0 up to but not including a bound
+Parameters:
+    I/O mt19937_64& rng     Generator to draw from
+    I   uint64_t iBound     Bound, at least 1
+Return Value:
+    Number drawn
+Notes:
+    Multiply and shift, the bias is far too small to matter here
+*********************************************************************/
+static uint64_t drawBelow(mt19937_64& rng, uint64_t iBound)
+{
+    return (uint64_t)(((unsigned __int128)rng() * iBound) >> 64);
+}
+
+/*********************************************************************
+static void flushBlock(ofstream& fileOut, string& szBlock, bool bForce)
+Purpose:
+    Helper function to write the block once it is full
+Parameters:
+    I/O ofstream& fileOut   File being generated
+    I/O string& szBlock     Text not yet written, cleared when written
+    I   bool bForce         Write even if the block is not full
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void flushBlock(ofstream& fileOut, string& szBlock, bool bForce)
+{
+    if (bForce || szBlock.size() >= iGENERATOR_BLOCK_BYTES)
+    {
+        fileOut.write(szBlock.data(), szBlock.size());
+        szBlock.clear();
+    }
+}
+
+/*********************************************************************
+static string generatedItemName(int iAisleIndex, int iItemIndex)
+Purpose:
+    Helper function to name a generated item
+Parameters:
+    I   int iAisleIndex     Aisle of the item
+    I   int iItemIndex      Slot of the item on the aisle
+Return Value:
+    Name as written to files, with underscores for spaces
+Notes:
+    -
+*********************************************************************/
+static string generatedItemName(int iAisleIndex, int iItemIndex)
+{
+    return "Item_" + to_string(iAisleIndex) + "_" + to_string(iItemIndex);
+}
+
+/*********************************************************************
+static int generatedSKU(const GeneratorConfig& config, int iAisleIndex, int iItemIndex)
+Purpose:
+    Helper function to find the SKU of a generated item
+Parameters:
+    I   GeneratorConfig config  Scale of the store
+    I   int iAisleIndex         Aisle of the item
+    I   int iItemIndex          Slot of the item on the aisle
+Return Value:
+    SKU, unique in the store
+Notes:
+    -
+*********************************************************************/
+static int generatedSKU(const GeneratorConfig& config, int iAisleIndex, int iItemIndex)
+{
+    return 100000 + iAisleIndex * config.iItemsPerAisle + iItemIndex;
+}
+
+/*********************************************************************
+bool getGeneratorScale(const string& szScale, GeneratorConfig& config)
+Purpose:
+    Function to set the generator counts from a scale
+Parameters:
+    I   string szScale              small, medium, large, or
+                                    aisles,items,employees,members,customers
+    I/O GeneratorConfig& config     Counts replaced, seed kept
+Return Value:
+    True if the scale is known or all five counts were read, else false
+Notes:
+    Items are per aisle
+*********************************************************************/
+bool getGeneratorScale(const string& szScale, GeneratorConfig& config)
+{
+    // Five counts separated by commas
+    int iCountsArr[5];
+    int iCounts = 0;
+    size_t iPos = 0;
+    bool bAtEnd = false;
+    while (iCounts < 5 && !bAtEnd)
+    {
+        size_t iComma = szScale.find(',', iPos);
+        bAtEnd = iComma == string::npos;
+        string_view szField = string_view(szScale).substr(iPos, bAtEnd ? string::npos : iComma - iPos);
+        from_chars_result parsed = from_chars(szField.data(), szField.data() + szField.size(), iCountsArr[iCounts]);
+        if (szField.empty() || parsed.ec != errc() || parsed.ptr != szField.data() + szField.size() ||
+            iCountsArr[iCounts] < 0)
+        {
+            break;
+        }
+        iCounts++;
+        iPos = iComma + 1;
+    }
+    if (iCounts == 5 && bAtEnd)
+    {
+        config.iAisles = iCountsArr[0];
+        config.iItemsPerAisle = iCountsArr[1];
+        config.iEmployees = iCountsArr[2];
+        config.iMembers = iCountsArr[3];
+        config.iCustomers = iCountsArr[4];
+        return config.iAisles > 0 && config.iItemsPerAisle > 0;
+    }
+
+    if (szScale == "small")
+    {
+        config.iAisles = 10;
+        config.iItemsPerAisle = 50;
+        config.iEmployees = 20;
+        config.iMembers = 200;
+        config.iCustomers = 2000;
+    }
+    else if (szScale == "medium")
+    {
+        config.iAisles = 50;
+        config.iItemsPerAisle = 400;
+        config.iEmployees = 2000;
+        config.iMembers = 10000;
+        config.iCustomers = 50000;
+    }
+    else if (szScale == "large")
+    {
+        config.iAisles = 200;
+        config.iItemsPerAisle = 2500;
+        config.iEmployees = 100000;
+        config.iMembers = 200000;
+        config.iCustomers = 500000;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+/*********************************************************************
+bool generateStoreFile(const GeneratorConfig& config, const string& szFilename)
+Purpose:
+    Function to write a synthetic store file
+Parameters:
+    I   GeneratorConfig config  Scale and seed
+    I   string szFilename       File to create or replace
+Return Value:
+    True if the whole file was written, else false
+Notes:
+    Funds cover a few payrolls and every price keeps member price
+    at or below regular price and regular price above wholesale
+*********************************************************************/
+bool generateStoreFile(const GeneratorConfig& config, const string& szFilename)
+{
+    ofstream fileOut(szFilename, ios::binary | ios::trunc);
+    if (!fileOut)
+    {
+        return false;
+    }
+    mt19937_64 rng(config.lSeed);
+
+    string szBlock;
+    szBlock.reserve(iGENERATOR_BLOCK_BYTES + 256);
+    szBlock += "Generated_Mart_" + to_string(config.lSeed) + "\n";
+    szBlock += "7am-11pm\n";
+    szBlock += formatMoney(Money((int64_t)config.iEmployees * 500000 + 100000)) + "\n";
+    szBlock += "25.00\n";
+    szBlock += "Aisle Information\n";
+
+    for (int i = 0; i < config.iAisles; i++)
+    {
+        szBlock += "Aisle " + to_string(i) + ": " + szAISLE_WORDS_ARR[i % size(szAISLE_WORDS_ARR)];
+        if (i >= (int)size(szAISLE_WORDS_ARR))
+        {
+            szBlock += " " + to_string(i / size(szAISLE_WORDS_ARR) + 1);
+        }
+        szBlock += '\n';
+
+        for (int j = 0; j < config.iItemsPerAisle; j++)
+        {
+            Money mWholesale = Money(10 + (int64_t)drawBelow(rng, 2000));
+            Money mRegular = mWholesale + Money(5 + (int64_t)drawBelow(rng, mWholesale.iCents + 1));
+            Money mMember = mRegular - Money((int64_t)drawBelow(rng, (mRegular - mWholesale).iCents));
+
+            szBlock += generatedItemName(i, j);
+            szBlock += ' ';
+            szBlock += formatMoney(mWholesale);
+            szBlock += ' ';
+            szBlock += formatMoney(mRegular);
+            szBlock += ' ';
+            szBlock += formatMoney(mMember);
+            szBlock += ' ';
+            szBlock += to_string(generatedSKU(config, i, j));
+            szBlock += '\n';
+            flushBlock(fileOut, szBlock, false);
+        }
+        szBlock += "############################\n";
+    }
+
+    szBlock += "*Employee Information*\n";
+    for (int i = 0; i < config.iEmployees; i++)
+    {
+        szBlock += szFIRST_NAMES_ARR[drawBelow(rng, size(szFIRST_NAMES_ARR))];
+        szBlock += '_';
+        szBlock += szLAST_NAMES_ARR[drawBelow(rng, size(szLAST_NAMES_ARR))];
+        szBlock += " E" + to_string(100000 + i) + " ";
+        szBlock += formatMoney(Money(30000 + (int64_t)drawBelow(rng, 120000)));
+        szBlock += '\n';
+        flushBlock(fileOut, szBlock, false);
+    }
+
+    flushBlock(fileOut, szBlock, true);
+    fileOut.close();
+    return !fileOut.fail();
+}
+
+/*********************************************************************
+bool generateTransactionFile(const GeneratorConfig& config, const string& szFilename)
+Purpose:
+    Function to write a synthetic transaction file for the store
+    generateStoreFile writes with the same config
+Parameters:
+    I   GeneratorConfig config  Scale and seed
+    I   string szFilename       File to create or replace
+Return Value:
+    True if the whole file was written, else false
+Notes:
+    Lines name items by aisle and name, by name on any aisle (-1), or
+    by SKU, so every lookup path is exercised
+*********************************************************************/
+bool generateTransactionFile(const GeneratorConfig& config, const string& szFilename)
+{
+    ofstream fileOut(szFilename, ios::binary | ios::trunc);
+    if (!fileOut)
+    {
+        return false;
+    }
+    mt19937_64 rng(config.lSeed ^ 0x9e3779b97f4a7c15ULL);
+
+    string szBlock;
+    szBlock.reserve(iGENERATOR_BLOCK_BYTES + 256);
+    szBlock += "# Generated, seed " + to_string(config.lSeed) + "\n";
+
+    auto appendLine = [&](int iLineKind)
+    {
+        int iAisle = (int)drawBelow(rng, max(config.iAisles, 1));
+        int iItem = (int)drawBelow(rng, max(config.iItemsPerAisle, 1));
+        int iQuantity = 1 + (int)drawBelow(rng, 3);
+        if (iLineKind == 0)
+        {
+            szBlock += " " + to_string(iAisle) + " " + generatedItemName(iAisle, iItem);
+        }
+        else if (iLineKind == 1)
+        {
+            szBlock += " -1 " + generatedItemName(iAisle, iItem);
+        }
+        else
+        {
+            szBlock += " -1 #" + to_string(generatedSKU(config, iAisle, iItem));
+        }
+        szBlock += " " + to_string(iQuantity);
+    };
+
+    for (int i = 0; i < config.iMembers; i++)
+    {
+        szBlock += "Member_" + to_string(i) + " y";
+        appendLine(0);
+        szBlock += '\n';
+        flushBlock(fileOut, szBlock, false);
+    }
+
+    for (int i = 0; i < config.iCustomers; i++)
+    {
+        if (config.iMembers > 0 && drawBelow(rng, 2) == 0)
+        {
+            szBlock += "Member_" + to_string(drawBelow(rng, config.iMembers)) + " n";
+        }
+        else
+        {
+            szBlock += "Customer_" + to_string(i) + " n";
+        }
+
+        int iLines = 1 + (int)drawBelow(rng, max(config.iMaxBasketLines, 1));
+        for (int j = 0; j < iLines; j++)
+        {
+            appendLine((int)drawBelow(rng, 3));
+        }
+        szBlock += '\n';
+        flushBlock(fileOut, szBlock, false);
+    }
+
+    flushBlock(fileOut, szBlock, true);
+    fileOut.close();
+    return !fileOut.fail();
+}
@@ -0,0 +1,318 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_inventory.cpp
+
+Purpose:
+    Column (structure of arrays) copy of the store inventory and the
+    whole-store analytics kernels that run over it.
+
+Notes:
+    - Each item field lives in its own contiguous column, so a scan
+      only touches the fields it needs instead of striding over names.
+    - Kernels use GCC/Clang vector extensions, which compile to SSE2 on
+      any x86-64 build and to AVX2 with -march=native. Each kernel
+      finishes the last few rows with a plain loop.
+    - Prices are whole cents in 64 bit lanes, so sums are exact and do
+      not depend on how rows are split into vectors.
+    - The columns are a snapshot. refreshInventoryQuantities re-reads
+      only the stock column after sales.
+*********************************************************************/
+
+// The vector helpers are static and inlined, so the note about the AVX
+// calling convention on non-AVX builds does not apply
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef int64_t v4l __attribute__((vector_size(32)));
+typedef int v4i __attribute__((vector_size(16)));
+
+static_assert(sizeof(Money) == sizeof(int64_t) && is_trivially_copyable_v<Money>, "Money must be bare cents");
+
+/*********************************************************************
+static v4l loadCents(const Money* pValues)
+Purpose:
+    Helper function to load four amounts from any address
+Parameters:
+    I   Money* pValues      First of four amounts
+Return Value:
+    Vector of the four amounts in cents
+Notes:
+    memcpy keeps unaligned loads legal, the compiler emits one load
+*********************************************************************/
+static v4l loadCents(const Money* pValues)
+{
+    v4l values;
+    memcpy(&values, pValues, sizeof(values));
+    return values;
+}
+
+/*********************************************************************
+static v4i loadInts(const int* pValues)
+Purpose:
+    Helper function to load four ints from any address
+Parameters:
+    I   int* pValues        First of four values
+Return Value:
+    Vector of the four values
+Notes:
+    -
+*********************************************************************/
+static v4i loadInts(const int* pValues)
+{
+    v4i values;
+    memcpy(&values, pValues, sizeof(values));
+    return values;
+}
+
+/*********************************************************************
+void buildInventoryColumns(const Supermarket& myStore, InventoryColumns& columns)
+Purpose:
+    Function to copy every item of the store into columns
+Parameters:
+    I   Supermarket myStore         Populated Supermarket info
+    O   InventoryColumns& columns   Columns to fill, previous rows are dropped
+Return Value:
+    -
+Notes:
+    Row order is aisle order then shelf order
+*********************************************************************/
+void buildInventoryColumns(const Supermarket& myStore, InventoryColumns& columns)
+{
+    size_t iItems = 0;
+    for (const Aisle& aisle : myStore.aislesVec)
+    {
+        iItems += aisle.itemVec.size();
+    }
+
+    columns = InventoryColumns();
+    columns.quantityVec.reserve(iItems);
+    columns.wholesaleVec.reserve(iItems);
+    columns.regularVec.reserve(iItems);
+    columns.memberVec.reserve(iItems);
+    columns.skuVec.reserve(iItems);
+    columns.locationVec.reserve(iItems);
+
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
+    {
+        const ArenaVector<Item>& itemVec = myStore.aislesVec[i].itemVec;
+        for (size_t j = 0; j < itemVec.size(); j++)
+        {
+            const Item& item = itemVec[j];
+            ItemLocation location;
+            location.iAisleIndex = (int)i;
+            location.iItemIndex = (int)j;
+
+            columns.quantityVec.push_back(item.iQuantity);
+            columns.wholesaleVec.push_back(item.mWholesale);
+            columns.regularVec.push_back(item.mRegularPrice);
+            columns.memberVec.push_back(item.mMembersPrice);
+            columns.skuVec.push_back(item.iSKU);
+            columns.locationVec.push_back(location);
+        }
+    }
+}
+
+/*********************************************************************
+void refreshInventoryQuantities(const Supermarket& myStore, InventoryColumns& columns)
+Purpose:
+    Function to re-read stock levels after sales
+Parameters:
+    I   Supermarket myStore         Store the columns were built from
+    I/O InventoryColumns& columns   Columns to update
+Return Value:
+    -
+Notes:
+    Prices and layout are assumed unchanged since the columns were built
+*********************************************************************/
+void refreshInventoryQuantities(const Supermarket& myStore, InventoryColumns& columns)
+{
+    for (size_t i = 0; i < columns.locationVec.size(); i++)
+    {
+        const ItemLocation& location = columns.locationVec[i];
+        columns.quantityVec[i] = myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex].iQuantity;
+    }
+}
+
+/*********************************************************************
+InventoryValue calculateInventoryValue(const InventoryColumns& columns)
+Purpose:
+    Function to value the stock on the shelves
+Parameters:
+    I   InventoryColumns columns    Inventory columns
+Return Value:
+    Stock value at wholesale, regular and member prices
+Notes:
+    Four rows per step with separate accumulators per price
+*********************************************************************/
+InventoryValue calculateInventoryValue(const InventoryColumns& columns)
+{
+    const size_t iRows = columns.quantityVec.size();
+    const int* pQuantity = columns.quantityVec.data();
+    const Money* pWholesale = columns.wholesaleVec.data();
+    const Money* pRegular = columns.regularVec.data();
+    const Money* pMember = columns.memberVec.data();
+
+    v4l wholesaleSum = {0, 0, 0, 0};
+    v4l regularSum = {0, 0, 0, 0};
+    v4l memberSum = {0, 0, 0, 0};
+
+    size_t i = 0;
+    for (; i + 4 <= iRows; i += 4)
+    {
+        v4l quantity = __builtin_convertvector(loadInts(pQuantity + i), v4l);
+        wholesaleSum += quantity * loadCents(pWholesale + i);
+        regularSum += quantity * loadCents(pRegular + i);
+        memberSum += quantity * loadCents(pMember + i);
+    }
+
+    InventoryValue value;
+    for (int j = 0; j < 4; j++)
+    {
+        value.mWholesale += Money(wholesaleSum[j]);
+        value.mRetail += Money(regularSum[j]);
+        value.mMemberRetail += Money(memberSum[j]);
+    }
+    for (; i < iRows; i++)
+    {
+        value.mWholesale += pWholesale[i] * pQuantity[i];
+        value.mRetail += pRegular[i] * pQuantity[i];
+        value.mMemberRetail += pMember[i] * pQuantity[i];
+    }
+    return value;
+}
+
+/*********************************************************************
+void calculateItemMargins(const InventoryColumns& columns,
+                          vector<Money>& regularMarginVec, vector<Money>& memberMarginVec)
+Purpose:
+    Function to calculate the profit per unit of every item
+Parameters:
+    I   InventoryColumns columns        Inventory columns
+    O   vector<Money>& regularMarginVec     Regular price minus wholesale per row
+    O   vector<Money>& memberMarginVec      Member price minus wholesale per row
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void calculateItemMargins(const InventoryColumns& columns,
+                          vector<Money>& regularMarginVec, vector<Money>& memberMarginVec)
+{
+    const size_t iRows = columns.wholesaleVec.size();
+    regularMarginVec.resize(iRows);
+    memberMarginVec.resize(iRows);
+
+    const Money* pWholesale = columns.wholesaleVec.data();
+    const Money* pRegular = columns.regularVec.data();
+    const Money* pMember = columns.memberVec.data();
+
+    size_t i = 0;
+    for (; i + 4 <= iRows; i += 4)
+    {
+        v4l wholesale = loadCents(pWholesale + i);
+        v4l regularMargin = loadCents(pRegular + i) - wholesale;
+        v4l memberMargin = loadCents(pMember + i) - wholesale;
+        memcpy((void*)&regularMarginVec[i], &regularMargin, sizeof(regularMargin));
+        memcpy((void*)&memberMarginVec[i], &memberMargin, sizeof(memberMargin));
+    }
+    for (; i < iRows; i++)
+    {
+        regularMarginVec[i] = pRegular[i] - pWholesale[i];
+        memberMarginVec[i] = pMember[i] - pWholesale[i];
+    }
+}
+
+/*********************************************************************
+size_t findLowStock(const InventoryColumns& columns, int iThreshold, vector<uint32_t>& rowsVec)
+Purpose:
+    Function to find items running out of stock
+Parameters:
+    I   InventoryColumns columns    Inventory columns
+    I   int iThreshold              Items with fewer than this many are low
+    O   vector<uint32_t>& rowsVec   Rows of the low items
+Return Value:
+    Number of low items
+Notes:
+    Four rows are compared at once and only blocks with a hit are
+    looked at row by row
+*********************************************************************/
+size_t findLowStock(const InventoryColumns& columns, int iThreshold, vector<uint32_t>& rowsVec)
+{
+    rowsVec.clear();
+    const size_t iRows = columns.quantityVec.size();
+    const int* pQuantity = columns.quantityVec.data();
+    v4i threshold = {iThreshold, iThreshold, iThreshold, iThreshold};
+
+    size_t i = 0;
+    for (; i + 4 <= iRows; i += 4)
+    {
+        v4i low = loadInts(pQuantity + i) < threshold;
+        if ((low[0] | low[1] | low[2] | low[3]) != 0)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                if (low[j])
+                {
+                    rowsVec.push_back((uint32_t)(i + j));
+                }
+            }
+        }
+    }
+    for (; i < iRows; i++)
+    {
+        if (pQuantity[i] < iThreshold)
+        {
+            rowsVec.push_back((uint32_t)i);
+        }
+    }
+    return rowsVec.size();
+}
+
+/*********************************************************************
+size_t filterPriceBand(const InventoryColumns& columns, Money mLow, Money mHigh,
+                       vector<uint32_t>& rowsVec)
+Purpose:
+    Function to find items whose regular price is within a band
+Parameters:
+    I   InventoryColumns columns    Inventory columns
+    I   Money mLow                  Lowest price, inclusive
+    I   Money mHigh                 Highest price, inclusive
+    O   vector<uint32_t>& rowsVec   Rows of the items in the band
+Return Value:
+    Number of items in the band
+Notes:
+    -
+*********************************************************************/
+size_t filterPriceBand(const InventoryColumns& columns, Money mLow, Money mHigh,
+                       vector<uint32_t>& rowsVec)
+{
+    rowsVec.clear();
+    const size_t iRows = columns.regularVec.size();
+    const Money* pRegular = columns.regularVec.data();
+    v4l low = {mLow.iCents, mLow.iCents, mLow.iCents, mLow.iCents};
+    v4l high = {mHigh.iCents, mHigh.iCents, mHigh.iCents, mHigh.iCents};
+
+    size_t i = 0;
+    for (; i + 4 <= iRows; i += 4)
+    {
+        v4l price = loadCents(pRegular + i);
+        v4l inBand = (price >= low) & (price <= high);
+        if ((inBand[0] | inBand[1] | inBand[2] | inBand[3]) != 0)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                if (inBand[j])
+                {
+                    rowsVec.push_back((uint32_t)(i + j));
+                }
+            }
+        }
+    }
+    for (; i < iRows; i++)
+    {
+        if (pRegular[i] >= mLow && pRegular[i] <= mHigh)
+        {
+            rowsVec.push_back((uint32_t)i);
+        }
+    }
+    return rowsVec.size();
+}
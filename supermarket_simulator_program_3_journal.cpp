@@ -0,0 +1,893 @@
+#include "supermarket_simulator_program_3.h"
+#include <fcntl.h>
+#include <unistd.h>
+/*********************************************************************
+File name: supermarket_simulator_program_3_journal.cpp
+
+Purpose:
+    Write-ahead transaction journal. Every change made to a store after
+    it is loaded is appended as a binary record, and replaying the
+    journal on top of the same store file or snapshot rebuilds the
+    store as it was.
+
+Notes:
+    - The journal for a store file or snapshot is the same path with
+      .journal added.
+    - append only queues a record. A background thread writes queued
+      records and flushes them with one fdatasync per batch (group
+      commit), so checkout lanes never wait on the disk. sync waits
+      until everything queued so far is on disk.
+    - A batch is written once records stop arriving for a short moment
+      or enough have queued up. A crash can lose at most that last
+      batch.
+    - Each record is framed by its length and a checksum. Replay stops
+      at the first incomplete record, which is what a crash during a
+      write leaves behind, and cuts the file back to the last good one.
+    - A reload leaves a redirect in place of the reloaded file's
+      journal, naming the snapshot its changes moved to. Attaching
+      follows it, so loading the file picks up where the store left off.
+*********************************************************************/
+
+static const char szJOURNAL_MAGIC[8] = {'S', 'M', 'J', 'R', 'N', 'L', '0', '3'};
+static const char szREDIRECT_MAGIC[8] = {'S', 'M', 'J', 'R', 'D', 'I', 'R', '1'};
+
+// How long the flusher waits for more records before writing a batch
+static const chrono::microseconds GROUP_COMMIT_WINDOW(2000);
+
+// Queued bytes that trigger a write without waiting, and that make
+// append wait for the flusher to catch up
+static const size_t iMAX_BATCH_BYTES = 256 * 1024;
+static const size_t iMAX_PENDING_BYTES = 16 * 1024 * 1024;
+
+// Record types
+enum JournalRecordType : uint8_t
+{
+    JOURNAL_CHECKOUT = 1,       // Completed purchase with the stock it took and line prices
+    JOURNAL_PAYROLL = 2,        // Employees paid
+    JOURNAL_CLEAR_MEMBERS = 3,  // Member list cleared
+    JOURNAL_RESTOCK = 4         // Restock order charged and put on the shelves
+};
+
+// Length and checksum in front of every record
+static const size_t iRECORD_FRAME_BYTES = 2 * sizeof(uint32_t);
+
+/*********************************************************************
+static uint32_t checksumRecord(const char* pData, size_t iLength)
+Purpose:
+    Helper function to checksum a record body
+Parameters:
+    I   char* pData         First byte of the body
+    I   size_t iLength      Bytes in the body
+Return Value:
+    32 bit FNV-1a of the body
+Notes:
+    -
+*********************************************************************/
+static uint32_t checksumRecord(const char* pData, size_t iLength)
+{
+    uint32_t iHash = 2166136261U;
+    for (size_t i = 0; i < iLength; i++)
+    {
+        iHash ^= (unsigned char)pData[i];
+        iHash *= 16777619U;
+    }
+    return iHash;
+}
+
+/*********************************************************************
+static void putValue(string& szRecord, T value)
+Purpose:
+    Helper function to append a fixed-width value to a record
+Parameters:
+    I/O string& szRecord    Record being built
+    I   T value             Value to append
+Return Value:
+    -
+Notes:
+    Machine byte order, like snapshots
+*********************************************************************/
+template <typename T>
+static void putValue(string& szRecord, T value)
+{
+    szRecord.append((const char*)&value, sizeof(value));
+}
+
+/*********************************************************************
+static bool getValue(const char*& pNext, const char* pEnd, T& value)
+Purpose:
+    Helper function to read a fixed-width value from a record
+Parameters:
+    I/O char*& pNext        Next unread byte, moved past the value
+    I   char* pEnd          One past the last byte of the record
+    O   T& value            Value read
+Return Value:
+    True if the record held the value, else false
+Notes:
+    -
+*********************************************************************/
+template <typename T>
+static bool getValue(const char*& pNext, const char* pEnd, T& value)
+{
+    if ((size_t)(pEnd - pNext) < sizeof(value))
+    {
+        return false;
+    }
+    memcpy(&value, pNext, sizeof(value));
+    pNext += sizeof(value);
+    return true;
+}
+
+/*********************************************************************
+static void sealRecord(string& szRecord)
+Purpose:
+    Helper function to fill in the frame of a finished record
+Parameters:
+    I/O string& szRecord    Record built after iRECORD_FRAME_BYTES of room
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void sealRecord(string& szRecord)
+{
+    uint32_t iLength = (uint32_t)(szRecord.size() - iRECORD_FRAME_BYTES);
+    uint32_t iChecksum = checksumRecord(szRecord.data() + iRECORD_FRAME_BYTES, iLength);
+    memcpy(&szRecord[0], &iLength, sizeof(iLength));
+    memcpy(&szRecord[sizeof(iLength)], &iChecksum, sizeof(iChecksum));
+}
+
+/*********************************************************************
+TransactionJournal::~TransactionJournal()
+Purpose:
+    Destructor to flush and close the journal
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+TransactionJournal::~TransactionJournal()
+{
+    close();
+}
+
+/*********************************************************************
+bool TransactionJournal::open(const string& szFilename, bool bTruncate, StoreFileError& error)
+Purpose:
+    Function to open a journal file for appending
+Parameters:
+    I   string szFilename           Path of the journal
+    I   bool bTruncate              Start the journal over
+    O   StoreFileError& error       Reason on failure, reported as line 0
+Return Value:
+    True if the journal is open, else false
+Notes:
+    A new or emptied journal gets its header before any record
+*********************************************************************/
+bool TransactionJournal::open(const string& szFilename, bool bTruncate, StoreFileError& error)
+{
+    error.iLine = 0;
+    error.iColumn = 0;
+    szPath = szFilename;
+
+    int iFlags = O_WRONLY | O_CREAT | O_APPEND | (bTruncate ? O_TRUNC : 0);
+    iFile = ::open(szFilename.c_str(), iFlags, 0644);
+    if (iFile < 0)
+    {
+        error.szMessage = "journal could not be opened";
+        return false;
+    }
+
+    if (lseek(iFile, 0, SEEK_END) == 0 &&
+        write(iFile, szJOURNAL_MAGIC, sizeof(szJOURNAL_MAGIC)) != (ssize_t)sizeof(szJOURNAL_MAGIC))
+    {
+        ::close(iFile);
+        iFile = -1;
+        error.szMessage = "journal could not be written";
+        return false;
+    }
+
+    flusherThread = thread(&TransactionJournal::runFlusher, this);
+    return true;
+}
+
+/*********************************************************************
+void TransactionJournal::append(const string& szRecord)
+Purpose:
+    Function to queue a sealed record for the flusher
+Parameters:
+    I   string szRecord     Record including its frame
+Return Value:
+    -
+Notes:
+    Only waits when the flusher has fallen far behind
+*********************************************************************/
+void TransactionJournal::append(const string& szRecord)
+{
+    unique_lock<mutex> lock(journalLock);
+    writersWake.wait(lock, [&]() { return szPending.size() < iMAX_PENDING_BYTES || bClosing; });
+
+    bool bWasEmpty = szPending.empty();
+    szPending += szRecord;
+    iQueuedBytes += szRecord.size();
+    lRecords += 1;
+
+    if (bWasEmpty || szPending.size() >= iMAX_BATCH_BYTES)
+    {
+        flusherWake.notify_one();
+    }
+}
+
+/*********************************************************************
+void TransactionJournal::sync()
+Purpose:
+    Function to wait until every queued record is on disk
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    Asks the flusher to skip its wait for more records
+*********************************************************************/
+void TransactionJournal::sync()
+{
+    unique_lock<mutex> lock(journalLock);
+    if (iFile < 0)
+    {
+        return;
+    }
+
+    uint64_t iTarget = iQueuedBytes;
+    bSyncRequested = true;
+    flusherWake.notify_one();
+    writersWake.wait(lock, [&]() { return iDurableBytes >= iTarget || bWriteFailed; });
+}
+
+/*********************************************************************
+void TransactionJournal::close()
+Purpose:
+    Function to write any queued records and close the journal
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    Safe to call more than once
+*********************************************************************/
+void TransactionJournal::close()
+{
+    {
+        lock_guard<mutex> guard(journalLock);
+        if (iFile < 0)
+        {
+            return;
+        }
+        bClosing = true;
+    }
+    flusherWake.notify_one();
+    flusherThread.join();
+
+    ::close(iFile);
+    iFile = -1;
+}
+
+/*********************************************************************
+long long TransactionJournal::recordsWritten() const
+Purpose:
+    Function to report the number of records appended
+Parameters:
+    -
+Return Value:
+    Records appended since the journal was opened
+Notes:
+    -
+*********************************************************************/
+long long TransactionJournal::recordsWritten() const
+{
+    lock_guard<mutex> guard(journalLock);
+    return lRecords;
+}
+
+/*********************************************************************
+long long TransactionJournal::syncsDone() const
+Purpose:
+    Function to report the number of batches flushed to disk
+Parameters:
+    -
+Return Value:
+    fdatasync calls since the journal was opened
+Notes:
+    -
+*********************************************************************/
+long long TransactionJournal::syncsDone() const
+{
+    lock_guard<mutex> guard(journalLock);
+    return lSyncs;
+}
+
+/*********************************************************************
+void TransactionJournal::runFlusher()
+Purpose:
+    Thread body that writes and flushes batches of records
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    The lock is released while writing, so appends carry on into the
+    next batch
+*********************************************************************/
+void TransactionJournal::runFlusher()
+{
+    unique_lock<mutex> lock(journalLock);
+    while (true)
+    {
+        flusherWake.wait(lock, [&]() { return !szPending.empty() || bClosing; });
+        if (szPending.empty())
+        {
+            break;
+        }
+
+        // Let other lanes add to the batch
+        flusherWake.wait_for(lock, GROUP_COMMIT_WINDOW, [&]()
+        {
+            return bClosing || bSyncRequested || szPending.size() >= iMAX_BATCH_BYTES;
+        });
+
+        string szBatch;
+        szBatch.swap(szPending);
+        uint64_t iBatchEnd = iQueuedBytes;
+        bSyncRequested = false;
+        writersWake.notify_all();
+        lock.unlock();
+
+        bool bWritten = true;
+        size_t iWritten = 0;
+        while (bWritten && iWritten < szBatch.size())
+        {
+            ssize_t iBytes = write(iFile, szBatch.data() + iWritten, szBatch.size() - iWritten);
+            bWritten = iBytes > 0;
+            iWritten += bWritten ? (size_t)iBytes : 0;
+        }
+        bWritten = bWritten && fdatasync(iFile) == 0;
+
+        lock.lock();
+        if (bWritten)
+        {
+            iDurableBytes = iBatchEnd;
+            lSyncs += 1;
+        }
+        else if (!bWriteFailed)
+        {
+            bWriteFailed = true;
+            cout << "Journal could not be written, changes are no longer saved" << endl;
+        }
+        writersWake.notify_all();
+    }
+}
+
+/*********************************************************************
+void journalCheckout(Supermarket& myStore, const CheckoutSession& session, Money mFunds, int iHour, int iDay)
+Purpose:
+    Function to journal a completed checkout
+Parameters:
+    I/O Supermarket& myStore        Store the checkout was made against
+    I   CheckoutSession session     Finished checkout session
+    I   Money mFunds                Amount the checkout added to the funds
+    I   int iHour                   Hour of day the sales were counted in
+    I   int iDay                    Day the lines were logged under
+Return Value:
+    -
+Notes:
+    Does nothing when the store has no journal. Safe to call from
+    several checkout lanes at once. The tier and day follow the lines
+    so records written before they were added still replay.
+*********************************************************************/
+void journalCheckout(Supermarket& myStore, const CheckoutSession& session, Money mFunds, int iHour, int iDay)
+{
+    if (myStore.pJournal == nullptr)
+    {
+        return;
+    }
+
+    const CustomerPurchase& purchase = session.purchase;
+    string szRecord(iRECORD_FRAME_BYTES, '\0');
+    szRecord.reserve(iRECORD_FRAME_BYTES + 45 + purchase.szName.size() + session.takenVec.size() * 24);
+    putValue<uint8_t>(szRecord, JOURNAL_CHECKOUT);
+    putValue<uint8_t>(szRecord, (uint8_t)iHour);
+    putValue<Money>(szRecord, mFunds);
+    putValue<Money>(szRecord, purchase.mPurchaseCost);
+    putValue<int32_t>(szRecord, purchase.iNumberItems);
+    putValue<uint8_t>(szRecord, purchase.bBoughtMembership ? 1 : 0);
+    putValue<uint32_t>(szRecord, (uint32_t)purchase.szName.size());
+    szRecord += purchase.szName;
+    putValue<uint32_t>(szRecord, (uint32_t)session.takenVec.size());
+    for (const StockChange& change : session.takenVec)
+    {
+        putValue<int32_t>(szRecord, change.iSKU);
+        putValue<int32_t>(szRecord, change.iQuantity);
+        putValue<Money>(szRecord, change.mPrice);
+        putValue<Money>(szRecord, change.mWholesale);
+    }
+    putValue<uint8_t>(szRecord, (uint8_t)session.eTier);
+    putValue<int32_t>(szRecord, iDay);
+    sealRecord(szRecord);
+
+    myStore.pJournal->append(szRecord);
+}
+
+/*********************************************************************
+void journalPayroll(Supermarket& myStore, Money mAmount)
+Purpose:
+    Function to journal a payroll run
+Parameters:
+    I/O Supermarket& myStore    Store that paid its employees
+    I   Money mAmount           Amount taken from the funds
+Return Value:
+    -
+Notes:
+    Does nothing when the store has no journal
+*********************************************************************/
+void journalPayroll(Supermarket& myStore, Money mAmount)
+{
+    if (myStore.pJournal == nullptr)
+    {
+        return;
+    }
+
+    string szRecord(iRECORD_FRAME_BYTES, '\0');
+    putValue<uint8_t>(szRecord, JOURNAL_PAYROLL);
+    putValue<Money>(szRecord, mAmount);
+    sealRecord(szRecord);
+
+    myStore.pJournal->append(szRecord);
+}
+
+/*********************************************************************
+void journalClearMembers(Supermarket& myStore)
+Purpose:
+    Function to journal clearing the member list
+Parameters:
+    I/O Supermarket& myStore    Store whose members were cleared
+Return Value:
+    -
+Notes:
+    Does nothing when the store has no journal
+*********************************************************************/
+void journalClearMembers(Supermarket& myStore)
+{
+    if (myStore.pJournal == nullptr)
+    {
+        return;
+    }
+
+    string szRecord(iRECORD_FRAME_BYTES, '\0');
+    putValue<uint8_t>(szRecord, JOURNAL_CLEAR_MEMBERS);
+    sealRecord(szRecord);
+
+    myStore.pJournal->append(szRecord);
+}
+
+/*********************************************************************
+void journalRestock(Supermarket& myStore, const RestockPlan& plan)
+Purpose:
+    Function to journal an applied restock order
+Parameters:
+    I/O Supermarket& myStore    Store that was restocked
+    I   RestockPlan plan        Order that was applied
+Return Value:
+    -
+Notes:
+    Does nothing when the store has no journal
+*********************************************************************/
+void journalRestock(Supermarket& myStore, const RestockPlan& plan)
+{
+    if (myStore.pJournal == nullptr)
+    {
+        return;
+    }
+
+    string szRecord(iRECORD_FRAME_BYTES, '\0');
+    szRecord.reserve(iRECORD_FRAME_BYTES + 16 + plan.linesVec.size() * 8);
+    putValue<uint8_t>(szRecord, JOURNAL_RESTOCK);
+    putValue<Money>(szRecord, plan.mCost);
+    putValue<uint32_t>(szRecord, (uint32_t)plan.linesVec.size());
+    for (const RestockLine& line : plan.linesVec)
+    {
+        putValue<int32_t>(szRecord, line.iSKU);
+        putValue<int32_t>(szRecord, line.iQuantity);
+    }
+    sealRecord(szRecord);
+
+    myStore.pJournal->append(szRecord);
+}
+
+/*********************************************************************
+static bool applyRestockRecord(Supermarket& myStore, const char* pNext, const char* pEnd, bool bApply)
+Purpose:
+    Helper function to redo a journaled restock order
+Parameters:
+    I/O Supermarket& myStore    Store to update
+    I   char* pNext             First byte after the record type
+    I   char* pEnd              One past the last byte of the record
+    I   bool bApply             False to only check the record
+Return Value:
+    True if the record fits the store, else false
+Notes:
+    -
+*********************************************************************/
+static bool applyRestockRecord(Supermarket& myStore, const char* pNext, const char* pEnd, bool bApply)
+{
+    Money mCost;
+    uint32_t iLines;
+    if (!getValue(pNext, pEnd, mCost) || !getValue(pNext, pEnd, iLines) ||
+        (size_t)(pEnd - pNext) != (size_t)iLines * 2 * sizeof(int32_t))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < iLines; i++)
+    {
+        int32_t iSKU = 0;
+        int32_t iQuantity = 0;
+        if (!getValue(pNext, pEnd, iSKU) || !getValue(pNext, pEnd, iQuantity) ||
+            findCatalogEntry(myStore, iSKU) < 0)
+        {
+            return false;
+        }
+        if (bApply)
+        {
+            receiveRestock(myStore, iSKU, iQuantity);
+        }
+    }
+    if (bApply)
+    {
+        myStore.mTotalFunds -= mCost;
+    }
+    return true;
+}
+
+/*********************************************************************
+static bool applyCheckoutRecord(Supermarket& myStore, const char* pNext, const char* pEnd, bool bApply)
+Purpose:
+    Helper function to redo a journaled checkout
+Parameters:
+    I/O Supermarket& myStore    Store to update
+    I   char* pNext             First byte after the record type
+    I   char* pEnd              One past the last byte of the record
+    I   bool bApply             False to only check the record
+Return Value:
+    True if the record fits the store, else false
+Notes:
+    The session is rebuilt line by line in the order checkout priced
+    it, so the sales totals come out the same
+*********************************************************************/
+static bool applyCheckoutRecord(Supermarket& myStore, const char* pNext, const char* pEnd, bool bApply)
+{
+    uint8_t iHour;
+    Money mFunds;
+    CheckoutSession session;
+    CustomerPurchase& purchase = session.purchase;
+    int32_t iNumberItems;
+    uint8_t iBoughtMembership;
+    uint32_t iNameLength;
+    if (!getValue(pNext, pEnd, iHour) || iHour >= 24 ||
+        !getValue(pNext, pEnd, mFunds) || !getValue(pNext, pEnd, purchase.mPurchaseCost) ||
+        !getValue(pNext, pEnd, iNumberItems) || !getValue(pNext, pEnd, iBoughtMembership) ||
+        !getValue(pNext, pEnd, iNameLength) || (size_t)(pEnd - pNext) < iNameLength)
+    {
+        return false;
+    }
+    purchase.iNumberItems = iNumberItems;
+    purchase.bBoughtMembership = iBoughtMembership != 0;
+    purchase.szName.assign(pNext, iNameLength);
+    pNext += iNameLength;
+    if (purchase.bBoughtMembership)
+    {
+        session.mCartTotal += myStore.mMembershipFee;
+    }
+
+    uint32_t iChanges;
+    if (!getValue(pNext, pEnd, iChanges))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < iChanges; i++)
+    {
+        StockChange change;
+        if (!getValue(pNext, pEnd, change.iSKU) || !getValue(pNext, pEnd, change.iQuantity) ||
+            !getValue(pNext, pEnd, change.mPrice) || !getValue(pNext, pEnd, change.mWholesale))
+        {
+            return false;
+        }
+
+        ItemLocation location;
+        Item* pItem = lookupItemBySKU(myStore, change.iSKU, &location);
+        if (pItem == nullptr)
+        {
+            return false;
+        }
+        if (bApply)
+        {
+            pItem->iQuantity -= change.iQuantity;
+            change.iAisleIndex = location.iAisleIndex;
+            session.mCartTotal += change.mPrice * change.iQuantity;
+            session.mProfit += (change.mPrice - change.mWholesale) * change.iQuantity;
+            session.takenVec.push_back(change);
+        }
+    }
+
+    // Older records end after the lines, their baskets are logged as
+    // regular ones on the day they are replayed
+    uint8_t iTier = PRICING_REGULAR;
+    int32_t iDay = currentDayNumber();
+    if (pNext != pEnd && (!getValue(pNext, pEnd, iTier) || iTier > PRICING_TAX_EXEMPT || !getValue(pNext, pEnd, iDay)))
+    {
+        return false;
+    }
+    if (!bApply)
+    {
+        return pNext == pEnd;
+    }
+    session.eTier = (PricingTier)iTier;
+    session.iPricedLines = session.takenVec.size();
+    if (purchase.bBoughtMembership)
+    {
+        registryInsert(myStore.memberRegistry, purchase.szName);
+    }
+    myStore.mTotalFunds += mFunds;
+    recordCheckoutSales(myStore.sales, session, myStore.mMembershipFee, iHour);
+    recordRestockSales(myStore, session);
+    recordCheckoutAnalytics(myStore.analytics, session, iHour);
+    recordCheckoutLines(myStore.lineItems, session, iDay);
+    recordPurchase(myStore, purchase);
+    return true;
+}
+
+/*********************************************************************
+static bool applyRecord(Supermarket& myStore, const char* pBody, uint32_t iLength, bool bApply)
+Purpose:
+    Helper function to redo one journaled change
+Parameters:
+    I/O Supermarket& myStore    Store to update
+    I   char* pBody             Record body, starting with its type
+    I   uint32_t iLength        Bytes in the body
+    I   bool bApply             False to only check the record
+Return Value:
+    True if the record fits the store, else false
+Notes:
+    -
+*********************************************************************/
+static bool applyRecord(Supermarket& myStore, const char* pBody, uint32_t iLength, bool bApply)
+{
+    const char* pNext = pBody + 1;
+    const char* pEnd = pBody + iLength;
+
+    switch ((uint8_t)pBody[0])
+    {
+        case JOURNAL_CHECKOUT:
+            return applyCheckoutRecord(myStore, pNext, pEnd, bApply);
+        case JOURNAL_PAYROLL:
+        {
+            Money mAmount;
+            if (!getValue(pNext, pEnd, mAmount))
+            {
+                return false;
+            }
+            if (bApply)
+            {
+                myStore.mTotalFunds -= mAmount;
+            }
+            return true;
+        }
+        case JOURNAL_CLEAR_MEMBERS:
+            if (bApply)
+            {
+                registryClear(myStore.memberRegistry);
+            }
+            return true;
+        case JOURNAL_RESTOCK:
+            return applyRestockRecord(myStore, pNext, pEnd, bApply);
+        default:
+            return false;
+    }
+}
+
+/*********************************************************************
+bool replayJournal(Supermarket& myStore, const string& szFilename, long long& lRecords,
+                   StoreFileError& error)
+Purpose:
+    Function to redo every journaled change on a freshly loaded store
+Parameters:
+    I/O Supermarket& myStore        Store loaded from the journal's base file
+    I   string szFilename           Path of the journal
+    O   long long& lRecords         Number of records replayed
+    O   StoreFileError& error       Reason on failure, reported as line 0
+Return Value:
+    True if the journal was replayed or does not exist, else false
+Notes:
+    Every record is checked against the store before any is applied,
+    so a journal that does not fit leaves the store untouched. A torn
+    record at the end is cut off the file.
+*********************************************************************/
+bool replayJournal(Supermarket& myStore, const string& szFilename, long long& lRecords,
+                   StoreFileError& error)
+{
+    lRecords = 0;
+    error.iLine = 0;
+    error.iColumn = 0;
+    if (access(szFilename.c_str(), F_OK) != 0)
+    {
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.open(szFilename, error))
+    {
+        return false;
+    }
+    if (file.size() < sizeof(szJOURNAL_MAGIC) || memcmp(file.data(), szJOURNAL_MAGIC, sizeof(szJOURNAL_MAGIC)) != 0)
+    {
+        error.szMessage = "not a store journal";
+        return false;
+    }
+
+    const char* pStart = file.data() + sizeof(szJOURNAL_MAGIC);
+    const char* pEnd = file.data() + file.size();
+    const char* pGoodEnd = pStart;
+    for (int iPass = 0; iPass < 2; iPass++)
+    {
+        bool bApply = iPass == 1;
+        const char* pNext = pStart;
+        long long lRecord = 0;
+        while ((size_t)((bApply ? pGoodEnd : pEnd) - pNext) >= iRECORD_FRAME_BYTES)
+        {
+            uint32_t iLength;
+            uint32_t iChecksum;
+            memcpy(&iLength, pNext, sizeof(iLength));
+            memcpy(&iChecksum, pNext + sizeof(iLength), sizeof(iChecksum));
+            const char* pBody = pNext + iRECORD_FRAME_BYTES;
+            if (iLength == 0 || (size_t)(pEnd - pBody) < iLength || checksumRecord(pBody, iLength) != iChecksum)
+            {
+                break;
+            }
+
+            lRecord += 1;
+            if (!applyRecord(myStore, pBody, iLength, bApply))
+            {
+                error.szMessage = "journal record " + to_string(lRecord) + " does not match the store";
+                return false;
+            }
+            pNext = pBody + iLength;
+        }
+
+        pGoodEnd = pNext;
+        lRecords = lRecord;
+    }
+
+    // Drop a record torn by a crash so new records follow good ones
+    if (pGoodEnd != pEnd && truncate(szFilename.c_str(), pGoodEnd - file.data()) != 0)
+    {
+        error.szMessage = "torn journal record could not be removed";
+        return false;
+    }
+    return true;
+}
+
+/*********************************************************************
+bool readJournalRedirect(const string& szFilename, string& szBaseFilename)
+Purpose:
+    Function to check whether a journal path holds a reload redirect
+Parameters:
+    I   string szFilename           Path of the journal
+    O   string& szBaseFilename      Snapshot the redirect names
+Return Value:
+    True if the file is a redirect, else false
+Notes:
+    A missing file or a real journal is not a redirect
+*********************************************************************/
+bool readJournalRedirect(const string& szFilename, string& szBaseFilename)
+{
+    ifstream file(szFilename, ios::binary);
+    char szMagic[sizeof(szREDIRECT_MAGIC)];
+    if (!file.read(szMagic, sizeof(szMagic)) || memcmp(szMagic, szREDIRECT_MAGIC, sizeof(szMagic)) != 0)
+    {
+        return false;
+    }
+
+    szBaseFilename.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return !szBaseFilename.empty();
+}
+
+/*********************************************************************
+bool writeJournalRedirect(const string& szFilename, const string& szBaseFilename, StoreFileError& error)
+Purpose:
+    Function to replace a journal with a redirect to another base
+Parameters:
+    I   string szFilename           Path of the journal
+    I   string szBaseFilename       Snapshot whose journal now holds the changes
+    O   StoreFileError& error       Reason on failure, reported as line 0
+Return Value:
+    True if the redirect is on disk, else false
+Notes:
+    Replaces the file in one step, so a crash leaves the old journal or
+    the redirect, never half of either
+*********************************************************************/
+bool writeJournalRedirect(const string& szFilename, const string& szBaseFilename, StoreFileError& error)
+{
+    string szContents(szREDIRECT_MAGIC, sizeof(szREDIRECT_MAGIC));
+    szContents += szBaseFilename;
+    return writeWholeFile(szFilename, szContents, error);
+}
+
+/*********************************************************************
+bool attachJournal(Supermarket& myStore, const string& szBaseFilename, bool bFresh)
+Purpose:
+    Function to bring a freshly loaded store up to date from its
+    journal and keep journaling its changes
+Parameters:
+    I/O Supermarket& myStore        Store loaded from szBaseFilename, replaced
+                                    if its journal redirects
+    I   string szBaseFilename       Store file or snapshot the store came from
+    I   bool bFresh                 Start an empty journal instead of replaying,
+                                    for a snapshot that was just saved
+Return Value:
+    True if the journal is attached, else false
+Notes:
+    The journal is left alone and not attached if it does not match
+    the store, so it can still be replayed on the right base file. A
+    redirect left by a reload is followed: the store is loaded from the
+    snapshot it names and that snapshot's journal is attached instead.
+    Redirects always name a longer path, so following them ends.
+*********************************************************************/
+bool attachJournal(Supermarket& myStore, const string& szBaseFilename, bool bFresh)
+{
+    string szJournal = szBaseFilename + ".journal";
+    StoreFileError error;
+
+    if (myStore.pJournal != nullptr)
+    {
+        myStore.pJournal->close();
+        myStore.pJournal = nullptr;
+    }
+
+    string szRedirected;
+    if (!bFresh && readJournalRedirect(szJournal, szRedirected))
+    {
+        cout << szBaseFilename << " was reloaded, continuing from " << szRedirected << endl;
+        Supermarket reloadedStore;
+        if (!loadSupermarketFile(szRedirected, reloadedStore))
+        {
+            cout << szJournal << ": the snapshot it names could not be loaded. Changes will not be journaled."
+                 << endl;
+            return false;
+        }
+        myStore = std::move(reloadedStore);
+        return attachJournal(myStore, szRedirected, false);
+    }
+
+    if (!bFresh)
+    {
+        long long lRecords;
+        if (!replayJournal(myStore, szJournal, lRecords, error))
+        {
+            cout << szJournal << ": " << error.szMessage << ". Changes will not be journaled." << endl;
+            return false;
+        }
+        if (lRecords > 0)
+        {
+            cout << "Replayed " << lRecords << " journal records from " << szJournal << endl;
+        }
+    }
+
+    shared_ptr<TransactionJournal> pJournal = make_shared<TransactionJournal>();
+    if (!pJournal->open(szJournal, bFresh, error))
+    {
+        cout << szJournal << ": " << error.szMessage << ". Changes will not be journaled." << endl;
+        return false;
+    }
+
+    myStore.pJournal = pJournal;
+    return true;
+}
@@ -0,0 +1,442 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_lanes.cpp
+
+Purpose:
+    Run several checkout lanes on their own threads against one
+    shared supermarket, with a ledger thread keeping the books.
+
+Notes:
+    - Stock is taken with reserveStock, so lanes never oversell.
+    - Each lane publishes its committed sales into its own lock-free
+      ring. One ledger thread drains the rings in batches and is the
+      only thread that updates funds, purchases, sales totals, the
+      analytics, the line item log and the journal, so lanes never
+      take a lock or contend on them.
+    - A lane whose ring is full waits for the ledger. The waits and the
+      time each sale spends queued are reported.
+    - Members are read from the registry, which does not change while
+      lanes run. Sign-ups during the run are claimed in a lock-free
+      table of name hashes, so a customer only pays the fee once, and
+      the ledger adds them to the registry when the lanes stop.
+*********************************************************************/
+
+// Number of baskets a lane claims at a time
+static const size_t iLANE_CHUNK = 64;
+
+// Sales each lane's ring holds before the lane waits for the ledger
+static const size_t iSALE_RING_SLOTS = 1024;
+
+// Most sales the ledger takes from one ring before moving to the next
+static const size_t iLEDGER_BATCH = 256;
+
+/*********************************************************************
+static uint64_t claimHash(const string& szName)
+Purpose:
+    Helper function to hash a name for the sign-up claim table
+Parameters:
+    I   string szName   Customer name
+Return Value:
+    Non-zero hash, zero marks an empty slot
+Notes:
+    -
+*********************************************************************/
+static uint64_t claimHash(const string& szName)
+{
+    uint64_t iHash = hashMemberName(szName);
+    return iHash != 0 ? iHash : 1;
+}
+
+/*********************************************************************
+static bool claimSignUp(vector<atomic<uint64_t>>& claimsVec, uint64_t iHash, bool bInsert)
+Purpose:
+    Helper function to find, or claim, a sign-up in the claim table
+Parameters:
+    I/O vector<atomic<uint64_t>> claimsVec  Open-addressing table of name hashes
+    I   uint64_t iHash                      Hash from claimHash
+    I   bool bInsert                        Claim the name if nobody has
+Return Value:
+    True if the name was already claimed, else false
+Notes:
+    Lock-free, slots only ever go from empty to a hash. The table is
+    sized to at least twice the sign-ups wanted, so it never fills.
+*********************************************************************/
+static bool claimSignUp(vector<atomic<uint64_t>>& claimsVec, uint64_t iHash, bool bInsert)
+{
+    size_t iMask = claimsVec.size() - 1;
+    for (size_t iSlot = iHash & iMask; ; iSlot = (iSlot + 1) & iMask)
+    {
+        uint64_t iSeen = claimsVec[iSlot].load(memory_order_acquire);
+        if (iSeen == 0)
+        {
+            if (!bInsert)
+            {
+                return false;
+            }
+            if (claimsVec[iSlot].compare_exchange_strong(iSeen, iHash, memory_order_acq_rel))
+            {
+                return false;
+            }
+        }
+        if (iSeen == iHash)
+        {
+            return true;
+        }
+    }
+}
+
+/*********************************************************************
+static void runCheckoutLane(Supermarket& myStore, const vector<Basket>& basketsVec,
+                            atomic<size_t>& iNextBasket, vector<atomic<uint64_t>>& claimsVec,
+                            SpscRing<SaleEvent>& ring, LaneTotals& totals)
+Purpose:
+    Thread body of one checkout lane
+Parameters:
+    I/O Supermarket& myStore                Shared supermarket
+    I   vector<Basket> basketsVec           Baskets waiting to be checked out
+    I/O atomic<size_t>& iNextBasket         Index of the next unclaimed basket
+    I/O vector<atomic<uint64_t>> claimsVec  Sign-ups made during the run
+    O   SpscRing<SaleEvent>& ring           Lane's ring to the ledger
+    O   LaneTotals& totals                  Lane counters
+Return Value:
+    -
+Notes:
+    Lanes claim baskets in chunks so the shared counter is rarely touched
+*********************************************************************/
+static void runCheckoutLane(Supermarket& myStore, const vector<Basket>& basketsVec,
+                            atomic<size_t>& iNextBasket, vector<atomic<uint64_t>>& claimsVec,
+                            SpscRing<SaleEvent>& ring, LaneTotals& totals)
+{
+    while (true)
+    {
+        size_t iStart = iNextBasket.fetch_add(iLANE_CHUNK, memory_order_relaxed);
+        if (iStart >= basketsVec.size())
+        {
+            return;
+        }
+        size_t iEnd = min(iStart + iLANE_CHUNK, basketsVec.size());
+
+        for (size_t i = iStart; i < iEnd; i++)
+        {
+            SaleEvent event;
+            {
+                STAT_SCOPE(STAT_CHECKOUT);
+                const Basket& basket = basketsVec[i];
+
+                bool bIsMember = isMember(myStore, basket.szCustomerName);
+                bool bBoughtMembership = false;
+                if (!bIsMember && !claimsVec.empty() && !basket.szCustomerName.empty())
+                {
+                    // Another lane may have signed the customer up during the run
+                    bIsMember = claimSignUp(claimsVec, claimHash(basket.szCustomerName), basket.bBuyMembership);
+                    bBoughtMembership = !bIsMember && basket.bBuyMembership;
+                }
+
+                event.session = openCheckout(myStore, basket.szCustomerName, bIsMember, bBoughtMembership,
+                                             basket.eTier);
+                for (const BasketLine& line : basket.linesVec)
+                {
+                    totals.lLines += 1;
+                    if (addBasketLine(myStore, event.session, line) != CHECKOUT_OK)
+                    {
+                        totals.lRejectedLines += 1;
+                    }
+                }
+
+                {
+                    STAT_SCOPE(STAT_CHECKOUT_COMMIT);
+                    finishCheckout(event.session);
+                    event.mFunds = checkoutFunds(myStore, event.session);
+                    event.iHour = currentHourOfDay();
+                    event.iDay = currentDayNumber();
+                }
+            }
+
+            // Time spent waiting on a full ring counts toward sale_queue, not checkout
+            event.tPublished = chrono::steady_clock::now();
+            if (!ring.tryPush(std::move(event)))
+            {
+                // Backpressure, the ledger is behind
+                totals.lBackpressureWaits += 1;
+                do
+                {
+                    this_thread::yield();
+                } while (!ring.tryPush(std::move(event)));
+            }
+            totals.lTransactions += 1;
+        }
+    }
+}
+
+/*********************************************************************
+static void applySaleEvent(Supermarket& myStore, const SaleEvent& event, LedgerStats& ledger)
+Purpose:
+    Helper function to book one committed sale against the store
+Parameters:
+    I/O Supermarket& myStore    Shared supermarket
+    I   SaleEvent event         Sale from a lane
+    I/O LedgerStats& ledger     Ledger counters and deferred updates
+Return Value:
+    -
+Notes:
+    Does what commitCheckout does, except sign-ups and restock counts
+    wait for the lanes to stop, since lanes read the member registry
+    and cover reads the shelf stock lanes are taking
+*********************************************************************/
+static void applySaleEvent(Supermarket& myStore, const SaleEvent& event, LedgerStats& ledger)
+{
+    const CheckoutSession& session = event.session;
+    if (session.purchase.bBoughtMembership)
+    {
+        ledger.newMembersVec.push_back(session.purchase.szName);
+    }
+    myStore.mTotalFunds += event.mFunds;
+    recordCheckoutSales(myStore.sales, session, myStore.mMembershipFee, event.iHour);
+    recordCheckoutAnalytics(myStore.analytics, session, event.iHour);
+    recordCheckoutLines(myStore.lineItems, session, event.iDay);
+    journalCheckout(myStore, session, event.mFunds, event.iHour, event.iDay);
+    for (const StockChange& change : session.takenVec)
+    {
+        ledger.soldVec.push_back({change.iSKU, change.iAisleIndex, change.iQuantity, event.iHour});
+    }
+    recordPurchase(myStore, session.purchase);
+}
+
+/*********************************************************************
+static void runLedger(Supermarket& myStore, deque<SpscRing<SaleEvent>>& ringsDeq,
+                      const atomic<int>& iLanesRunning, LedgerStats& ledger)
+Purpose:
+    Thread body of the ledger, which books every lane's sales
+Parameters:
+    I/O Supermarket& myStore                Shared supermarket
+    I/O deque<SpscRing<SaleEvent>> ringsDeq One ring per lane
+    I   atomic<int>& iLanesRunning          Lanes still checking out
+    O   LedgerStats& ledger                 Ledger counters and deferred updates
+Return Value:
+    -
+Notes:
+    Rings are drained in turn, a batch at a time, so a busy lane cannot
+    starve the others. The ledger stops once every lane has finished
+    and a pass over the rings finds nothing.
+*********************************************************************/
+static void runLedger(Supermarket& myStore, deque<SpscRing<SaleEvent>>& ringsDeq,
+                      const atomic<int>& iLanesRunning, LedgerStats& ledger)
+{
+    vector<SaleEvent> batchVec;
+    batchVec.reserve(iLEDGER_BATCH);
+    while (true)
+    {
+        // Read before draining, so sales published before the last lane
+        // finished are seen by this pass
+        bool bLanesDone = iLanesRunning.load(memory_order_acquire) == 0;
+        size_t iDrained = 0;
+        for (SpscRing<SaleEvent>& ring : ringsDeq)
+        {
+            ledger.iPeakDepth = max(ledger.iPeakDepth, ring.depth());
+            batchVec.clear();
+            size_t iCount = ring.popBatch(batchVec, iLEDGER_BATCH);
+            if (iCount == 0)
+            {
+                continue;
+            }
+            iDrained += iCount;
+            ledger.lBatches += 1;
+
+            auto tNow = chrono::steady_clock::now();
+            for (const SaleEvent& event : batchVec)
+            {
+                auto tQueued = chrono::duration_cast<chrono::nanoseconds>(tNow - event.tPublished).count();
+#ifndef SUPERMARKET_NO_STATS
+                recordStat(STAT_SALE_QUEUE, (uint64_t)max<long long>(tQueued, 0));
+#endif
+                double dMicros = tQueued / 1000.0;
+                ledger.dTotalQueueMicros += dMicros;
+                ledger.dMaxQueueMicros = max(ledger.dMaxQueueMicros, dMicros);
+                applySaleEvent(myStore, event, ledger);
+            }
+            ledger.lEvents += (long long)iCount;
+        }
+
+        if (iDrained == 0)
+        {
+            if (bLanesDone)
+            {
+                return;
+            }
+            this_thread::yield();
+        }
+    }
+}
+
+/*********************************************************************
+MultiLaneStats runMultiLaneCheckout(Supermarket& myStore, const vector<Basket>& basketsVec, int iLanes)
+Purpose:
+    Function to check out baskets on several lanes at once
+Parameters:
+    I/O Supermarket& myStore        Populated Supermarket info
+    I   vector<Basket> basketsVec   Baskets to check out
+    I   int iLanes                  Number of lanes (threads) to run
+Return Value:
+    Counters and timing for the run, including the ledger's queues
+Notes:
+    Purchases are recorded in the order the ledger books them. New
+    members and restock counts are added after the lanes finish.
+*********************************************************************/
+MultiLaneStats runMultiLaneCheckout(Supermarket& myStore, const vector<Basket>& basketsVec, int iLanes)
+{
+    MultiLaneStats stats;
+    stats.iLanes = max(iLanes, 1);
+
+    size_t iSignUps = 0;
+    for (const Basket& basket : basketsVec)
+    {
+        iSignUps += basket.bBuyMembership ? 1 : 0;
+    }
+    size_t iClaimSlots = 0;
+    if (iSignUps > 0)
+    {
+        iClaimSlots = 16;
+        while (iClaimSlots < iSignUps * 2)
+        {
+            iClaimSlots *= 2;
+        }
+    }
+    vector<atomic<uint64_t>> claimsVec(iClaimSlots);
+
+    vector<LaneTotals> lanesVec(stats.iLanes);
+    deque<SpscRing<SaleEvent>> ringsDeq;
+    for (int i = 0; i < stats.iLanes; i++)
+    {
+        ringsDeq.emplace_back(iSALE_RING_SLOTS);
+    }
+    vector<thread> threadsVec;
+    atomic<size_t> iNextBasket(0);
+    atomic<int> iLanesRunning(stats.iLanes);
+    LedgerStats ledger;
+
+    auto tStart = chrono::steady_clock::now();
+    thread ledgerThread(runLedger, ref(myStore), ref(ringsDeq), cref(iLanesRunning), ref(ledger));
+    for (int i = 0; i < stats.iLanes; i++)
+    {
+        threadsVec.emplace_back([&, i]()
+        {
+            runCheckoutLane(myStore, basketsVec, iNextBasket, claimsVec, ringsDeq[i], lanesVec[i]);
+            iLanesRunning.fetch_sub(1, memory_order_release);
+        });
+    }
+    for (thread& laneThread : threadsVec)
+    {
+        laneThread.join();
+    }
+    ledgerThread.join();
+    stats.dSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+
+    for (const string& szName : ledger.newMembersVec)
+    {
+        addMember(myStore, szName);
+    }
+    for (const SoldLine& sold : ledger.soldVec)
+    {
+        recordRestockSale(myStore, sold.iSKU, sold.iQuantity);
+    }
+
+    for (const LaneTotals& totals : lanesVec)
+    {
+        stats.lTransactions += totals.lTransactions;
+        stats.lLines += totals.lLines;
+        stats.lRejectedLines += totals.lRejectedLines;
+        stats.lBackpressureWaits += totals.lBackpressureWaits;
+    }
+    stats.lNewMembers = (long long)ledger.newMembersVec.size();
+    stats.lLedgerBatches = ledger.lBatches;
+    stats.iPeakQueueDepth = ledger.iPeakDepth;
+    stats.dMeanQueueMicros = ledger.lEvents > 0 ? ledger.dTotalQueueMicros / ledger.lEvents : 0.0;
+    stats.dMaxQueueMicros = ledger.dMaxQueueMicros;
+
+    for (const Aisle& aisle : myStore.aislesVec)
+    {
+        for (const Item& item : aisle.itemVec)
+        {
+            if (item.iQuantity < 0)
+            {
+                stats.iOversoldItems += 1;
+            }
+        }
+    }
+
+    return stats;
+}
+
+/*********************************************************************
+void displayLaneScaling(const Supermarket& templateStore, const vector<Basket>& basketsVec, int iMaxLanes)
+Purpose:
+    Function to report checkout throughput from 1 lane up to iMaxLanes
+Parameters:
+    I   Supermarket templateStore   Freshly loaded store, copied for each run
+    I   vector<Basket> basketsVec   Baskets to check out
+    I   int iMaxLanes               Largest number of lanes to try
+Return Value:
+    -
+Notes:
+    Lane counts double each run and always include iMaxLanes
+*********************************************************************/
+void displayLaneScaling(const Supermarket& templateStore, const vector<Basket>& basketsVec, int iMaxLanes)
+{
+    cout << "Multi-lane Checkout Scaling" << endl;
+    cout << szBreakMessage;
+    cout << left << setw(8) << "Lanes" << setw(16) << "Tx/second" << setw(10) << "Speedup"
+         << setw(10) << "Rejected" << "Oversold" << right << endl;
+
+    double dBaseRate = 0.0;
+    iMaxLanes = max(iMaxLanes, 1);
+    for (int iLanes = 1; ; iLanes *= 2)
+    {
+        iLanes = min(iLanes, iMaxLanes);
+        Supermarket store = templateStore;
+        MultiLaneStats stats = runMultiLaneCheckout(store, basketsVec, iLanes);
+
+        double dRate = stats.dSeconds > 0 ? stats.lTransactions / stats.dSeconds : 0.0;
+        if (iLanes == 1)
+        {
+            dBaseRate = dRate;
+        }
+
+        cout << left << setw(8) << iLanes << setw(16) << setprecision(0) << dRate
+             << setw(10) << setprecision(2) << (dBaseRate > 0 ? dRate / dBaseRate : 0.0)
+             << setw(10) << stats.lRejectedLines << stats.iOversoldItems << right << endl;
+
+        if (iLanes == iMaxLanes)
+        {
+            break;
+        }
+    }
+
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void displayLedgerStats(const MultiLaneStats& stats)
+Purpose:
+    Function to display how the sale rings and ledger kept up
+Parameters:
+    I   MultiLaneStats stats    Counters from runMultiLaneCheckout
+Return Value:
+    -
+Notes:
+    Percentiles of the queue time are in the performance stats, as
+    the sale_queue probe
+*********************************************************************/
+void displayLedgerStats(const MultiLaneStats& stats)
+{
+    double dBatch = stats.lLedgerBatches > 0 ? (double)stats.lTransactions / stats.lLedgerBatches : 0.0;
+    cout << "Ledger" << endl;
+    cout << szBreakMessage;
+    cout << "Sales booked: " << stats.lTransactions << " in " << stats.lLedgerBatches << " batches ("
+         << setprecision(1) << dBatch << " per batch)" << endl;
+    cout << "New members: " << stats.lNewMembers << endl;
+    cout << "Ring slots per lane: " << iSALE_RING_SLOTS << ", most waiting: " << stats.iPeakQueueDepth << endl;
+    cout << "Lane waits on a full ring: " << stats.lBackpressureWaits << endl;
+    cout << "Queue time us mean: " << stats.dMeanQueueMicros << ", max: " << stats.dMaxQueueMicros
+         << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
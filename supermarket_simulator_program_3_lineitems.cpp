@@ -0,0 +1,732 @@
+#include "supermarket_simulator_program_3.h"
+#include <limits>
+/*********************************************************************
+File name: supermarket_simulator_program_3_lineitems.cpp
+
+Purpose:
+    Line item log of every committed checkout and the market basket
+    miner that runs over it.
+
+Notes:
+    - A line is 16 bytes across three columns (SKU, quantity, unit
+      price). Baskets are a column of line ends plus the pricing tier.
+    - Columns grow a fixed chunk at a time from the store arena, so
+      appending never copies the lines already stored.
+    - Checkout lanes hand each committed sale to the ledger thread,
+      which appends its lines to the store's log, like the sales totals.
+    - The miner makes two passes over the baskets (Apriori). The first
+      counts the baskets holding each item, the second counts pairs of
+      the items that passed the support. Threads claim blocks of baskets
+      and count into their own tables, which are summed at the end.
+*********************************************************************/
+
+// Baskets a mining thread claims at a time
+static const size_t iMINING_BLOCK = 4096;
+
+// Most frequent items that are paired, bounds the pair table of each
+// thread at about 8 MB
+static const int iMAX_PAIR_ITEMS = 2048;
+
+/*********************************************************************
+LineItemLog& LineItemLog::operator=(const LineItemLog& other)
+Purpose:
+    Function to replace the log with a copy of another
+Parameters:
+    I   LineItemLog other       Log to copy
+Return Value:
+    This log
+Notes:
+    Chunks of the old lines are left to the arena
+*********************************************************************/
+LineItemLog& LineItemLog::operator=(const LineItemLog& other)
+{
+    if (this != &other)
+    {
+        daysVec.clear();
+        iOpenDay = 0;
+        appendLog(other);
+    }
+    return *this;
+}
+
+/*********************************************************************
+LineItemDay& LineItemLog::dayFor(int iDay)
+Purpose:
+    Helper function to find the columns of a day, adding them if needed
+Parameters:
+    I   int iDay                Days since 1 Jan 1970, local time
+Return Value:
+    Columns of the day
+Notes:
+    Days stay in order. Lines nearly always go to the last day, so it
+    is checked first.
+*********************************************************************/
+LineItemDay& LineItemLog::dayFor(int iDay)
+{
+    if (!daysVec.empty() && daysVec.back().iDay == iDay)
+    {
+        iOpenDay = daysVec.size() - 1;
+        return daysVec.back();
+    }
+
+    auto itDay = lower_bound(daysVec.begin(), daysVec.end(), iDay,
+                             [](const LineItemDay& day, int iValue) { return day.iDay < iValue; });
+    if (itDay == daysVec.end() || itDay->iDay != iDay)
+    {
+        itDay = daysVec.insert(itDay, LineItemDay());
+        itDay->iDay = iDay;
+    }
+    iOpenDay = itDay - daysVec.begin();
+    return *itDay;
+}
+
+/*********************************************************************
+void LineItemLog::beginBasket(int iDay, uint8_t iTier)
+Purpose:
+    Function to start a basket, the lines that follow belong to it
+Parameters:
+    I   int iDay                Day the basket was committed
+    I   uint8_t iTier           PricingTier of the basket
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void LineItemLog::beginBasket(int iDay, uint8_t iTier)
+{
+    LineItemDay& day = dayFor(iDay);
+    day.basketEndVec.push_back((uint32_t)day.iLines);
+    day.tierVec.push_back(iTier);
+}
+
+/*********************************************************************
+void LineItemLog::appendLine(int iSKU, int iQuantity, Money mUnitPrice)
+Purpose:
+    Function to add a line to the basket begun last
+Parameters:
+    I   int iSKU                Item sold
+    I   int iQuantity           Units sold
+    I   Money mUnitPrice        Unit price charged
+Return Value:
+    -
+Notes:
+    A new chunk is taken from the arena when the last one is full
+*********************************************************************/
+void LineItemLog::appendLine(int iSKU, int iQuantity, Money mUnitPrice)
+{
+    LineItemDay& day = daysVec[iOpenDay];
+    size_t iOffset = day.iLines % LineItemChunk::iLINES;
+    if (iOffset == 0)
+    {
+        if (!pArena)
+        {
+            pArena = make_shared<StoreArena>();
+        }
+        void* pStorage = pArena->allocate(sizeof(LineItemChunk), alignof(LineItemChunk));
+        day.chunksVec.push_back(static_cast<LineItemChunk*>(pStorage));
+    }
+
+    LineItemChunk* pChunk = day.chunksVec.back();
+    pChunk->skuArr[iOffset] = iSKU;
+    pChunk->quantityArr[iOffset] = iQuantity;
+    pChunk->unitCentsArr[iOffset] = mUnitPrice.iCents;
+    day.iLines += 1;
+    day.basketEndVec.back() = (uint32_t)day.iLines;
+}
+
+/*********************************************************************
+void LineItemLog::appendLog(const LineItemLog& other)
+Purpose:
+    Function to add every basket of another log to this one
+Parameters:
+    I   LineItemLog other       Log to copy the baskets from
+Return Value:
+    -
+Notes:
+    Lines are copied a chunk at a time, baskets keep their days
+*********************************************************************/
+void LineItemLog::appendLog(const LineItemLog& other)
+{
+    for (const LineItemDay& source : other.daysVec)
+    {
+        if (source.basketEndVec.empty())
+        {
+            continue;
+        }
+        LineItemDay& target = dayFor(source.iDay);
+        uint32_t iBase = (uint32_t)target.iLines;
+
+        size_t iLine = 0;
+        while (iLine < source.iLines)
+        {
+            size_t iOffset = target.iLines % LineItemChunk::iLINES;
+            if (iOffset == 0)
+            {
+                if (!pArena)
+                {
+                    pArena = make_shared<StoreArena>();
+                }
+                void* pStorage = pArena->allocate(sizeof(LineItemChunk), alignof(LineItemChunk));
+                target.chunksVec.push_back(static_cast<LineItemChunk*>(pStorage));
+            }
+
+            // Copy up to the end of either chunk
+            size_t iSourceOffset = iLine % LineItemChunk::iLINES;
+            size_t iCount = min({LineItemChunk::iLINES - iOffset, LineItemChunk::iLINES - iSourceOffset,
+                                 source.iLines - iLine});
+            const LineItemChunk* pFrom = source.chunksVec[iLine / LineItemChunk::iLINES];
+            LineItemChunk* pTo = target.chunksVec.back();
+            memcpy(pTo->skuArr + iOffset, pFrom->skuArr + iSourceOffset, iCount * sizeof(int32_t));
+            memcpy(pTo->quantityArr + iOffset, pFrom->quantityArr + iSourceOffset, iCount * sizeof(int32_t));
+            memcpy(pTo->unitCentsArr + iOffset, pFrom->unitCentsArr + iSourceOffset, iCount * sizeof(int64_t));
+            target.iLines += iCount;
+            iLine += iCount;
+        }
+
+        for (uint32_t iEnd : source.basketEndVec)
+        {
+            target.basketEndVec.push_back(iBase + iEnd);
+        }
+        target.tierVec.insert(target.tierVec.end(), source.tierVec.begin(), source.tierVec.end());
+    }
+}
+
+/*********************************************************************
+long long LineItemLog::lineCount() const
+Purpose:
+    Function to count the lines in the log
+Parameters:
+    -
+Return Value:
+    Lines over every day
+Notes:
+    -
+*********************************************************************/
+long long LineItemLog::lineCount() const
+{
+    long long lLines = 0;
+    for (const LineItemDay& day : daysVec)
+    {
+        lLines += (long long)day.iLines;
+    }
+    return lLines;
+}
+
+/*********************************************************************
+long long LineItemLog::basketCount() const
+Purpose:
+    Function to count the baskets in the log
+Parameters:
+    -
+Return Value:
+    Baskets over every day
+Notes:
+    -
+*********************************************************************/
+long long LineItemLog::basketCount() const
+{
+    long long lBaskets = 0;
+    for (const LineItemDay& day : daysVec)
+    {
+        lBaskets += (long long)day.basketEndVec.size();
+    }
+    return lBaskets;
+}
+
+/*********************************************************************
+size_t LineItemLog::memoryBytes() const
+Purpose:
+    Function to report the storage the log holds
+Parameters:
+    -
+Return Value:
+    Bytes of chunks and basket columns
+Notes:
+    -
+*********************************************************************/
+size_t LineItemLog::memoryBytes() const
+{
+    size_t iBytes = 0;
+    for (const LineItemDay& day : daysVec)
+    {
+        iBytes += day.chunksVec.size() * sizeof(LineItemChunk)
+                + day.basketEndVec.capacity() * sizeof(uint32_t) + day.tierVec.capacity();
+    }
+    return iBytes;
+}
+
+/*********************************************************************
+void recordCheckoutLines(LineItemLog& lineItems, const CheckoutSession& session, int iDay)
+Purpose:
+    Function to log the lines of a committed checkout
+Parameters:
+    I/O LineItemLog& lineItems      Log to append to
+    I   CheckoutSession session     Committed checkout
+    I   int iDay                    Day it was committed
+Return Value:
+    -
+Notes:
+    A checkout with no lines, such as a membership alone, is not logged
+*********************************************************************/
+void recordCheckoutLines(LineItemLog& lineItems, const CheckoutSession& session, int iDay)
+{
+    if (session.takenVec.empty())
+    {
+        return;
+    }
+
+    lineItems.beginBasket(iDay, (uint8_t)session.eTier);
+    for (const StockChange& change : session.takenVec)
+    {
+        lineItems.appendLine(change.iSKU, change.iQuantity, change.mPrice);
+    }
+}
+
+struct MiningBlock
+{
+    uint32_t iDay;          // Index into the log's days
+    uint32_t iFirst;        // First basket of the block
+    uint32_t iLast;         // One past the last basket
+};
+
+/*********************************************************************
+static vector<MiningBlock> splitBaskets(const LineItemLog& lineItems)
+Purpose:
+    Helper function to cut every day's baskets into blocks for threads
+Parameters:
+    I   LineItemLog lineItems   Log to split
+Return Value:
+    Blocks of at most iMINING_BLOCK baskets
+Notes:
+    -
+*********************************************************************/
+static vector<MiningBlock> splitBaskets(const LineItemLog& lineItems)
+{
+    vector<MiningBlock> blocksVec;
+    const vector<LineItemDay>& daysVec = lineItems.days();
+    for (size_t iDay = 0; iDay < daysVec.size(); iDay++)
+    {
+        size_t iBaskets = daysVec[iDay].basketEndVec.size();
+        for (size_t iFirst = 0; iFirst < iBaskets; iFirst += iMINING_BLOCK)
+        {
+            blocksVec.push_back({(uint32_t)iDay, (uint32_t)iFirst, (uint32_t)min(iFirst + iMINING_BLOCK, iBaskets)});
+        }
+    }
+    return blocksVec;
+}
+
+/*********************************************************************
+template <typename F>
+static void forEachBlock(const vector<MiningBlock>& blocksVec, int iThreads, F countBlock)
+Purpose:
+    Helper function to run countBlock over every block on several threads
+Parameters:
+    I   vector<MiningBlock> blocksVec   Blocks to count
+    I   int iThreads                    Threads to run
+    I   F countBlock                    Called with the thread number and a block
+Return Value:
+    -
+Notes:
+    Threads claim the next block from a shared counter, so a slow
+    thread does not hold the others up
+*********************************************************************/
+template <typename F>
+static void forEachBlock(const vector<MiningBlock>& blocksVec, int iThreads, F countBlock)
+{
+    atomic<size_t> iNextBlock(0);
+    auto runThread = [&](int iThread)
+    {
+        for (size_t i = iNextBlock.fetch_add(1, memory_order_relaxed); i < blocksVec.size();
+             i = iNextBlock.fetch_add(1, memory_order_relaxed))
+        {
+            countBlock(iThread, blocksVec[i]);
+        }
+    };
+
+    vector<thread> threadsVec;
+    for (int i = 1; i < iThreads; i++)
+    {
+        threadsVec.emplace_back(runThread, i);
+    }
+    runThread(0);
+    for (thread& worker : threadsVec)
+    {
+        worker.join();
+    }
+}
+
+/*********************************************************************
+static size_t pairIndex(size_t iFirst, size_t iSecond, size_t iItems)
+Purpose:
+    Helper function to find a pair in the triangular pair table
+Parameters:
+    I   size_t iFirst       Lower frequent item number
+    I   size_t iSecond      Higher frequent item number
+    I   size_t iItems       Frequent items
+Return Value:
+    Index of the pair
+Notes:
+    -
+*********************************************************************/
+static size_t pairIndex(size_t iFirst, size_t iSecond, size_t iItems)
+{
+    return iFirst * (2 * iItems - iFirst - 1) / 2 + (iSecond - iFirst - 1);
+}
+
+/*********************************************************************
+BasketMiningResult mineBasketPairs(const Supermarket& myStore, const BasketMiningConfig& config)
+Purpose:
+    Function to find the item pairs bought together in the line item
+    log and the association rules between them
+Parameters:
+    I   Supermarket myStore         Store with its line item log
+    I   BasketMiningConfig config   Support, confidence and threads
+Return Value:
+    Counts, timing and the rules with the highest lift
+Notes:
+    An item counts once per basket however many lines it is on. When
+    more than iMAX_PAIR_ITEMS items pass the support only the most
+    frequent are paired, and the support used is raised to match.
+*********************************************************************/
+BasketMiningResult mineBasketPairs(const Supermarket& myStore, const BasketMiningConfig& config)
+{
+    BasketMiningResult result;
+    auto tStart = chrono::steady_clock::now();
+
+    const vector<LineItemDay>& daysVec = myStore.lineItems.days();
+    const vector<CatalogEntry>& entriesVec = myStore.catalog.entriesVec;
+    vector<MiningBlock> blocksVec = splitBaskets(myStore.lineItems);
+    result.lBaskets = myStore.lineItems.basketCount();
+    result.lLines = myStore.lineItems.lineCount();
+    result.iThreads = config.iThreads > 0 ? config.iThreads : max((int)thread::hardware_concurrency(), 1);
+    result.iThreads = max(min(result.iThreads, (int)blocksVec.size()), 1);
+    result.lMinBaskets = max((long long)ceil(config.dMinSupport * result.lBaskets), 1LL);
+    size_t iEntries = entriesVec.size();
+
+    // Pass 1: baskets holding each catalog entry. The last basket seen
+    // for each entry keeps repeats in one basket from counting twice.
+    vector<vector<uint32_t>> itemCountsVec(result.iThreads);
+    vector<vector<uint64_t>> lastBasketVec(result.iThreads);
+    vector<long long> unknownVec(result.iThreads, 0);
+    forEachBlock(blocksVec, result.iThreads, [&](int iThread, const MiningBlock& block)
+    {
+        vector<uint32_t>& countsVec = itemCountsVec[iThread];
+        vector<uint64_t>& lastVec = lastBasketVec[iThread];
+        if (countsVec.empty())
+        {
+            countsVec.assign(iEntries, 0);
+            lastVec.assign(iEntries, UINT64_MAX);
+        }
+        const LineItemDay& day = daysVec[block.iDay];
+        for (uint32_t iBasket = block.iFirst; iBasket < block.iLast; iBasket++)
+        {
+            uint64_t iBasketKey = (uint64_t)block.iDay << 32 | iBasket;
+            for (size_t iLine = day.basketStart(iBasket); iLine < day.basketEndVec[iBasket]; iLine++)
+            {
+                int iEntry = findCatalogEntry(myStore, day.sku(iLine));
+                if (iEntry < 0)
+                {
+                    unknownVec[iThread] += 1;
+                }
+                else if (lastVec[iEntry] != iBasketKey)
+                {
+                    lastVec[iEntry] = iBasketKey;
+                    countsVec[iEntry] += 1;
+                }
+            }
+        }
+    });
+
+    vector<long long> itemBasketsVec(iEntries, 0);
+    for (int i = 0; i < result.iThreads; i++)
+    {
+        result.lUnknownLines += unknownVec[i];
+        for (size_t iEntry = 0; iEntry < itemCountsVec[i].size(); iEntry++)
+        {
+            itemBasketsVec[iEntry] += itemCountsVec[i][iEntry];
+        }
+    }
+    itemCountsVec.clear();
+
+    // Frequent items, most baskets first, numbered densely for the pair table
+    vector<uint32_t> frequentVec;
+    for (size_t iEntry = 0; iEntry < iEntries; iEntry++)
+    {
+        if (itemBasketsVec[iEntry] >= result.lMinBaskets)
+        {
+            frequentVec.push_back((uint32_t)iEntry);
+        }
+    }
+    sort(frequentVec.begin(), frequentVec.end(), [&](uint32_t a, uint32_t b)
+    {
+        return itemBasketsVec[a] != itemBasketsVec[b] ? itemBasketsVec[a] > itemBasketsVec[b] : a < b;
+    });
+    if ((int)frequentVec.size() > iMAX_PAIR_ITEMS)
+    {
+        result.iDroppedItems = (int)frequentVec.size() - iMAX_PAIR_ITEMS;
+        frequentVec.resize(iMAX_PAIR_ITEMS);
+        // A pair is never in more baskets than its rarer item
+        result.lMinBaskets = itemBasketsVec[frequentVec.back()];
+    }
+    result.iFrequentItems = (int)frequentVec.size();
+
+    size_t iItems = frequentVec.size();
+    vector<int32_t> frequentIdVec(iEntries, -1);
+    for (size_t i = 0; i < iItems; i++)
+    {
+        frequentIdVec[frequentVec[i]] = (int32_t)i;
+    }
+
+    // Pass 2: baskets holding each pair of frequent items
+    size_t iPairs = iItems * (iItems - (iItems > 0 ? 1 : 0)) / 2;
+    vector<vector<uint32_t>> pairCountsVec(result.iThreads);
+    if (iPairs > 0)
+    {
+        forEachBlock(blocksVec, result.iThreads, [&](int iThread, const MiningBlock& block)
+        {
+            vector<uint32_t>& countsVec = pairCountsVec[iThread];
+            if (countsVec.empty())
+            {
+                countsVec.assign(iPairs, 0);
+            }
+            vector<int32_t> basketVec;
+            const LineItemDay& day = daysVec[block.iDay];
+            for (uint32_t iBasket = block.iFirst; iBasket < block.iLast; iBasket++)
+            {
+                basketVec.clear();
+                for (size_t iLine = day.basketStart(iBasket); iLine < day.basketEndVec[iBasket]; iLine++)
+                {
+                    int iEntry = findCatalogEntry(myStore, day.sku(iLine));
+                    if (iEntry >= 0 && frequentIdVec[iEntry] >= 0)
+                    {
+                        basketVec.push_back(frequentIdVec[iEntry]);
+                    }
+                }
+                if (basketVec.size() < 2)
+                {
+                    continue;
+                }
+                sort(basketVec.begin(), basketVec.end());
+                basketVec.erase(unique(basketVec.begin(), basketVec.end()), basketVec.end());
+                for (size_t i = 0; i < basketVec.size(); i++)
+                {
+                    size_t iRow = pairIndex(basketVec[i], basketVec[i] + 1, iItems) - (basketVec[i] + 1);
+                    for (size_t j = i + 1; j < basketVec.size(); j++)
+                    {
+                        countsVec[iRow + basketVec[j]] += 1;
+                    }
+                }
+            }
+        });
+    }
+
+    // Sum the thread tables into the first one
+    vector<uint32_t> pairBasketsVec;
+    for (vector<uint32_t>& countsVec : pairCountsVec)
+    {
+        if (countsVec.empty())
+        {
+            continue;
+        }
+        if (pairBasketsVec.empty())
+        {
+            pairBasketsVec = std::move(countsVec);
+            continue;
+        }
+        for (size_t i = 0; i < iPairs; i++)
+        {
+            pairBasketsVec[i] += countsVec[i];
+        }
+    }
+    pairCountsVec.clear();
+
+    // Rules both ways for each frequent pair
+    double dBaskets = (double)max(result.lBaskets, 1LL);
+    for (size_t iFirst = 0; iFirst < iItems && !pairBasketsVec.empty(); iFirst++)
+    {
+        for (size_t iSecond = iFirst + 1; iSecond < iItems; iSecond++)
+        {
+            long long lBoth = pairBasketsVec[pairIndex(iFirst, iSecond, iItems)];
+            if (lBoth < result.lMinBaskets)
+            {
+                continue;
+            }
+            result.lFrequentPairs += 1;
+
+            long long lFirst = itemBasketsVec[frequentVec[iFirst]];
+            long long lSecond = itemBasketsVec[frequentVec[iSecond]];
+            double dLift = lBoth * dBaskets / ((double)lFirst * (double)lSecond);
+            int iSKU_First = entriesVec[frequentVec[iFirst]].iSKU;
+            int iSKU_Second = entriesVec[frequentVec[iSecond]].iSKU;
+            if ((double)lBoth / lFirst >= config.dMinConfidence)
+            {
+                result.rulesVec.push_back({iSKU_First, iSKU_Second, lBoth, lBoth / dBaskets, (double)lBoth / lFirst, dLift});
+            }
+            if ((double)lBoth / lSecond >= config.dMinConfidence)
+            {
+                result.rulesVec.push_back({iSKU_Second, iSKU_First, lBoth, lBoth / dBaskets, (double)lBoth / lSecond, dLift});
+            }
+        }
+    }
+
+    size_t iKeep = min(result.rulesVec.size(), (size_t)max(config.iMaxRules, 0));
+    partial_sort(result.rulesVec.begin(), result.rulesVec.begin() + iKeep, result.rulesVec.end(),
+                 [](const PairRule& a, const PairRule& b)
+                 {
+                     if (a.dLift != b.dLift)
+                     {
+                         return a.dLift > b.dLift;
+                     }
+                     if (a.lBaskets != b.lBaskets)
+                     {
+                         return a.lBaskets > b.lBaskets;
+                     }
+                     return a.dConfidence > b.dConfidence;
+                 });
+    result.rulesVec.resize(iKeep);
+
+    result.dSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+    return result;
+}
+
+/*********************************************************************
+void displayLineItemLog(const LineItemLog& lineItems)
+Purpose:
+    Function to display the baskets and lines logged each day
+Parameters:
+    I   LineItemLog lineItems   Log to summarize
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayLineItemLog(const LineItemLog& lineItems)
+{
+    cout << "Line Item Log" << endl;
+    cout << szBreakMessage;
+    cout << left << setw(14) << "Day" << setw(12) << "Baskets" << setw(12) << "Lines" << "Sales" << right << endl;
+    for (const LineItemDay& day : lineItems.days())
+    {
+        Money mSales;
+        for (size_t i = 0; i < day.iLines; i++)
+        {
+            mSales += day.unitPrice(i) * day.quantity(i);
+        }
+
+        time_t tDay = (time_t)day.iDay * 86400;
+        tm dayDate;
+        gmtime_r(&tDay, &dayDate);
+        char szDate[16];
+        strftime(szDate, sizeof(szDate), "%Y-%m-%d", &dayDate);
+        cout << left << setw(14) << szDate << setw(12) << day.basketEndVec.size() << setw(12) << day.iLines
+             << "$" << mSales << right << endl;
+    }
+    cout << szBreakMessage;
+    cout << "Baskets: " << lineItems.basketCount() << ", lines: " << lineItems.lineCount()
+         << ", memory: " << lineItems.memoryBytes() / 1024 << " KB" << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void displayBasketMining(const Supermarket& myStore, const BasketMiningResult& result)
+Purpose:
+    Function to display the rules found by mineBasketPairs
+Parameters:
+    I   Supermarket myStore         Store that was mined, for item names
+    I   BasketMiningResult result   Rules and counts
+Return Value:
+    -
+Notes:
+    Rules between items on different aisles are candidates for moving
+    the items closer or promoting them together
+*********************************************************************/
+void displayBasketMining(const Supermarket& myStore, const BasketMiningResult& result)
+{
+    auto itemName = [&](int iSKU, int& iAisleIndex)
+    {
+        int iEntry = findCatalogEntry(myStore, iSKU);
+        const ItemLocation& location = myStore.catalog.entriesVec[iEntry].location;
+        iAisleIndex = location.iAisleIndex;
+        return myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex].szName.substr(0, 19);
+    };
+
+    cout << "Items Bought Together" << endl;
+    cout << szBreakMessage;
+    cout << "Baskets: " << result.lBaskets << ", lines: " << result.lLines
+         << ", pair support: " << result.lMinBaskets << " baskets" << endl;
+    cout << "Frequent items: " << result.iFrequentItems << ", frequent pairs: " << result.lFrequentPairs << endl;
+    if (result.iDroppedItems > 0)
+    {
+        cout << "Less frequent items left out of pairing: " << result.iDroppedItems << endl;
+    }
+    if (result.lUnknownLines > 0)
+    {
+        cout << "Lines for items no longer in the store: " << result.lUnknownLines << endl;
+    }
+    cout << left << setw(20) << "Buys" << setw(20) << "Also buys" << setw(10) << "Baskets"
+         << setw(12) << "Confidence" << setw(8) << "Lift" << "Aisles" << right << endl;
+    for (const PairRule& rule : result.rulesVec)
+    {
+        int iAisleA;
+        int iAisleB;
+        string szNameA = itemName(rule.iSKU_A, iAisleA);
+        string szNameB = itemName(rule.iSKU_B, iAisleB);
+        cout << left << setw(20) << szNameA << setw(20) << szNameB << setw(10) << rule.lBaskets
+             << setw(12) << rule.dConfidence * 100.0 << setw(8) << rule.dLift;
+        if (iAisleA == iAisleB)
+        {
+            cout << "same" << right << endl;
+        }
+        else
+        {
+            cout << iAisleA << " and " << iAisleB << right << endl;
+        }
+    }
+    if (result.rulesVec.empty())
+    {
+        cout << "No rules at this support and confidence." << endl;
+    }
+    cout << szBreakMessage;
+    cout << "Threads: " << result.iThreads << ", mined in " << setprecision(3) << result.dSeconds * 1000.0
+         << " ms" << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void processBasketMining(const Supermarket& myStore)
+Purpose:
+    Function to show the line item log and prompt for the support and
+    confidence to mine it with
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processBasketMining(const Supermarket& myStore)
+{
+    BasketMiningConfig config;
+
+    displayLineItemLog(myStore.lineItems);
+    cout << "Enter the percent of baskets a pair must be in: ";
+    if (!(cin >> config.dMinSupport) || config.dMinSupport <= 0 || config.dMinSupport > 100)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid percent." << endl;
+        return;
+    }
+    cout << "Enter the least percent confidence for a rule: ";
+    if (!(cin >> config.dMinConfidence) || config.dMinConfidence < 0 || config.dMinConfidence > 100)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid percent." << endl;
+        return;
+    }
+    config.dMinSupport /= 100.0;
+    config.dMinConfidence /= 100.0;
+
+    displayBasketMining(myStore, mineBasketPairs(myStore, config));
+}
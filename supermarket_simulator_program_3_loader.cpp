@@ -0,0 +1,516 @@
+#include "supermarket_simulator_program_3.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+/*********************************************************************
+File name: supermarket_simulator_program_3_loader.cpp
+
+Purpose:
+    Store file loader that parses the file in place from a read-only
+    memory mapping.
+
+Notes:
+    - Lines and tokens are string_views into the mapping, numbers are
+      parsed with from_chars, and nothing is allocated per line apart
+      from names too long for the small string buffer.
+    - Each aisle's item count is found by counting lines up to its
+      terminator, so the aisle's storage is reserved once.
+    - The file is parsed into a fresh Supermarket that only replaces
+      the caller's store once the whole file is accepted.
+    - Lines may end in \n or \r\n.
+*********************************************************************/
+
+// Fault the whole file in with the mapping where the platform allows it
+#ifdef MAP_POPULATE
+static const int iMAP_FLAGS = MAP_PRIVATE | MAP_POPULATE;
+#else
+static const int iMAP_FLAGS = MAP_PRIVATE;
+#endif
+
+static const string_view szAISLE_END = "############################";
+static const string_view szEMPLOYEE_HEADER = "*Employee Information*";
+
+// Position of the parser in the text being loaded
+struct StoreFileCursor
+{
+    const char* pNext = nullptr;        // Start of the next line
+    const char* pEnd = nullptr;         // One past the last byte
+    const char* pLineStart = nullptr;   // Start of the current line
+    int iLine = 0;                      // Current line, 1 based
+};
+
+/*********************************************************************
+static bool nextLine(StoreFileCursor& cursor, string_view& szLine)
+Purpose:
+    Helper function to step to the next line of the text
+Parameters:
+    I/O StoreFileCursor& cursor     Parser position
+    O   string_view& szLine         Line without its line ending
+Return Value:
+    False at the end of the text, else true
+Notes:
+    -
+*********************************************************************/
+static bool nextLine(StoreFileCursor& cursor, string_view& szLine)
+{
+    if (cursor.pNext >= cursor.pEnd)
+    {
+        return false;
+    }
+
+    const char* pStart = cursor.pNext;
+    const char* pNewline = (const char*)memchr(pStart, '\n', cursor.pEnd - pStart);
+    const char* pStop = pNewline != nullptr ? pNewline : cursor.pEnd;
+    cursor.pNext = pNewline != nullptr ? pNewline + 1 : cursor.pEnd;
+    cursor.pLineStart = pStart;
+    cursor.iLine++;
+
+    if (pStop > pStart && pStop[-1] == '\r')
+    {
+        pStop--;
+    }
+    szLine = string_view(pStart, pStop - pStart);
+    return true;
+}
+
+/*********************************************************************
+static bool nextToken(string_view& szRest, string_view& szToken)
+Purpose:
+    Helper function to split the next whitespace separated token off a line
+Parameters:
+    I/O string_view& szRest     Unread part of the line
+    O   string_view& szToken    Token, empty if none is left
+Return Value:
+    True if a token was found, else false
+Notes:
+    -
+*********************************************************************/
+static bool nextToken(string_view& szRest, string_view& szToken)
+{
+    size_t iStart = 0;
+    while (iStart < szRest.size() && (szRest[iStart] == ' ' || szRest[iStart] == '\t'))
+    {
+        iStart++;
+    }
+
+    size_t iStop = iStart;
+    while (iStop < szRest.size() && szRest[iStop] != ' ' && szRest[iStop] != '\t')
+    {
+        iStop++;
+    }
+
+    szToken = szRest.substr(iStart, iStop - iStart);
+    szRest.remove_prefix(iStop);
+    return !szToken.empty();
+}
+
+/*********************************************************************
+static bool fail(const StoreFileCursor& cursor, const char* pAt, const char* pMessage,
+                 StoreFileError& error)
+Purpose:
+    Helper function to record where and why the text was rejected
+Parameters:
+    I   StoreFileCursor cursor      Parser position
+    I   char* pAt                   Byte the problem was found at
+    I   char* pMessage              Description of the problem
+    O   StoreFileError& error       Error to fill in
+Return Value:
+    Always false, so callers can return it directly
+Notes:
+    Columns are 1 based
+*********************************************************************/
+static bool fail(const StoreFileCursor& cursor, const char* pAt, const char* pMessage,
+                 StoreFileError& error)
+{
+    error.iLine = max(cursor.iLine, 1);
+    error.iColumn = pAt != nullptr && cursor.pLineStart != nullptr ? (int)(pAt - cursor.pLineStart) + 1 : 1;
+    error.szMessage = pMessage;
+    return false;
+}
+
+/*********************************************************************
+static bool parseNumber(const StoreFileCursor& cursor, string_view& szRest, T& value,
+                        const char* pWhat, StoreFileError& error)
+Purpose:
+    Helper function to read the next token of a line as a number
+Parameters:
+    I   StoreFileCursor cursor      Parser position
+    I/O string_view& szRest         Unread part of the line
+    O   T& value                    Number read
+    I   char* pWhat                 Message used if the token is missing or bad
+    O   StoreFileError& error       Error to fill in on failure
+Return Value:
+    True if the whole token is a number, else false
+Notes:
+    -
+*********************************************************************/
+template <typename T>
+static bool parseNumber(const StoreFileCursor& cursor, string_view& szRest, T& value,
+                        const char* pWhat, StoreFileError& error)
+{
+    string_view szToken;
+    if (!nextToken(szRest, szToken))
+    {
+        return fail(cursor, szRest.data(), pWhat, error);
+    }
+
+    const char* pStop = szToken.data() + szToken.size();
+    from_chars_result result = from_chars(szToken.data(), pStop, value);
+    if (result.ec != errc() || result.ptr != pStop)
+    {
+        return fail(cursor, szToken.data(), pWhat, error);
+    }
+    return true;
+}
+
+/*********************************************************************
+static bool parseNumber(const StoreFileCursor& cursor, string_view& szRest, Money& value,
+                        const char* pWhat, StoreFileError& error)
+Purpose:
+    Helper function to read the next token of a line as an amount
+Parameters:
+    I   StoreFileCursor cursor      Parser position
+    I/O string_view& szRest         Unread part of the line
+    O   Money& value                Amount read, rounded to the cent
+    I   char* pWhat                 Message used if the token is missing or bad
+    O   StoreFileError& error       Error to fill in on failure
+Return Value:
+    True if the whole token is an amount, else false
+Notes:
+    -
+*********************************************************************/
+static bool parseNumber(const StoreFileCursor& cursor, string_view& szRest, Money& value,
+                        const char* pWhat, StoreFileError& error)
+{
+    string_view szToken;
+    if (!nextToken(szRest, szToken))
+    {
+        return fail(cursor, szRest.data(), pWhat, error);
+    }
+    if (!parseMoney(szToken, value))
+    {
+        return fail(cursor, szToken.data(), pWhat, error);
+    }
+    return true;
+}
+
+/*********************************************************************
+static bool expectEndOfLine(const StoreFileCursor& cursor, string_view szRest,
+                            StoreFileError& error)
+Purpose:
+    Helper function to reject text left over after the last column
+Parameters:
+    I   StoreFileCursor cursor      Parser position
+    I   string_view szRest          Unread part of the line
+    O   StoreFileError& error       Error to fill in on failure
+Return Value:
+    True if only whitespace is left, else false
+Notes:
+    -
+*********************************************************************/
+static bool expectEndOfLine(const StoreFileCursor& cursor, string_view szRest,
+                            StoreFileError& error)
+{
+    string_view szToken;
+    if (nextToken(szRest, szToken))
+    {
+        return fail(cursor, szToken.data(), "unexpected text at end of line", error);
+    }
+    return true;
+}
+
+/*********************************************************************
+static void assignName(string& szName, string_view szToken)
+Purpose:
+    Helper function to copy a name token with underscores as spaces
+Parameters:
+    O   string& szName          Name to fill in
+    I   string_view szToken     Name as written in the file
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void assignName(string& szName, string_view szToken)
+{
+    szName.assign(szToken);
+    replace(szName.begin(), szName.end(), '_', ' ');
+}
+
+/*********************************************************************
+static size_t countAisleLines(const StoreFileCursor& cursor)
+Purpose:
+    Helper function to count the item lines of the aisle being read
+Parameters:
+    I   StoreFileCursor cursor      Parser position, just past the aisle line
+Return Value:
+    Number of lines before the aisle terminator or the end of the text
+Notes:
+    Blank lines are counted too, so this is an upper bound
+*********************************************************************/
+static size_t countAisleLines(const StoreFileCursor& cursor)
+{
+    size_t iLines = 0;
+    const char* p = cursor.pNext;
+    while (p < cursor.pEnd)
+    {
+        if ((size_t)(cursor.pEnd - p) >= szAISLE_END.size() &&
+            memcmp(p, szAISLE_END.data(), szAISLE_END.size()) == 0)
+        {
+            break;
+        }
+
+        const char* pNewline = (const char*)memchr(p, '\n', cursor.pEnd - p);
+        iLines++;
+        if (pNewline == nullptr)
+        {
+            break;
+        }
+        p = pNewline + 1;
+    }
+    return iLines;
+}
+
+/*********************************************************************
+bool parseSupermarketText(const char* pText, size_t iLength, Supermarket& myStore,
+                          StoreFileError& error)
+Purpose:
+    Function to parse the contents of a supermarket text file
+Parameters:
+    I   char* pText                 Contents of the file, need not end in a newline
+    I   size_t iLength              Number of bytes in pText
+    I/O Supermarket& myStore        Replaced by the parsed store on success
+    O   StoreFileError& error       Line, column and reason on failure
+Return Value:
+    True if the text was parsed, else false
+Notes:
+    myStore is left untouched when the text is rejected
+*********************************************************************/
+bool parseSupermarketText(const char* pText, size_t iLength, Supermarket& myStore,
+                          StoreFileError& error)
+{
+    StoreFileCursor cursor;
+    cursor.pNext = pText;
+    cursor.pEnd = pText + iLength;
+
+    Supermarket parsed;
+    string_view szLine;
+    string_view szRest;
+
+    // Parse general supermarket information
+    if (!nextLine(cursor, szLine))
+    {
+        return fail(cursor, nullptr, "file is empty", error);
+    }
+    parsed.szName.assign(szLine);
+
+    if (!nextLine(cursor, szLine))
+    {
+        return fail(cursor, cursor.pEnd, "expected store hours", error);
+    }
+    parsed.szStoreHours.assign(szLine);
+
+    if (!nextLine(cursor, szRest))
+    {
+        return fail(cursor, cursor.pEnd, "expected total funds", error);
+    }
+    if (!parseNumber(cursor, szRest, parsed.mTotalFunds, "expected total funds", error))
+    {
+        return false;
+    }
+
+    if (!nextLine(cursor, szRest))
+    {
+        return fail(cursor, cursor.pEnd, "expected membership fee", error);
+    }
+    if (!parseNumber(cursor, szRest, parsed.mMembershipFee, "expected membership fee", error))
+    {
+        return false;
+    }
+
+    // Skipping "Aisle Information"
+    nextLine(cursor, szLine);
+
+    // Parse aisles and items
+    bool bEmployees = false;
+    while (!bEmployees && nextLine(cursor, szLine))
+    {
+        if (szLine == szEMPLOYEE_HEADER)
+        {
+            bEmployees = true;
+            continue;
+        }
+        if (szLine.find("Aisle") == string_view::npos)
+        {
+            continue;
+        }
+
+        size_t iColon = szLine.find(':');
+        if (iColon == string_view::npos)
+        {
+            return fail(cursor, szLine.data() + szLine.size(), "expected ':' before aisle name", error);
+        }
+        string_view szAisleName = szLine.substr(iColon + 1);
+        while (!szAisleName.empty() && szAisleName.front() == ' ')
+        {
+            szAisleName.remove_prefix(1);
+        }
+
+        Aisle& currentAisle = parsed.aislesVec.emplace_back(parsed.pArena);
+        currentAisle.szName.assign(szAisleName);
+        currentAisle.itemVec.reserve(countAisleLines(cursor));
+
+        while (nextLine(cursor, szRest) && szRest != szAISLE_END)
+        {
+            string_view szToken;
+            if (!nextToken(szRest, szToken))
+            {
+                continue;
+            }
+
+            Item& currentItem = currentAisle.itemVec.emplace_back();
+            assignName(currentItem.szName, szToken);
+            if (!parseNumber(cursor, szRest, currentItem.mWholesale, "expected wholesale price", error) ||
+                !parseNumber(cursor, szRest, currentItem.mRegularPrice, "expected regular price", error) ||
+                !parseNumber(cursor, szRest, currentItem.mMembersPrice, "expected member price", error))
+            {
+                return false;
+            }
+
+            // SKU column is optional, missing SKUs are assigned by buildCatalogIndex
+            string_view szPeek = szRest;
+            if (nextToken(szPeek, szToken) &&
+                (!parseNumber(cursor, szRest, currentItem.iSKU, "expected SKU", error) ||
+                 !expectEndOfLine(cursor, szRest, error)))
+            {
+                return false;
+            }
+        }
+    }
+
+    // Parse employees
+    while (nextLine(cursor, szRest))
+    {
+        string_view szToken;
+        if (!nextToken(szRest, szToken))
+        {
+            continue;
+        }
+
+        Employee& currentEmployee = parsed.employeesVec.emplace_back();
+        assignName(currentEmployee.szName, szToken);
+        if (!nextToken(szRest, szToken))
+        {
+            return fail(cursor, szRest.data(), "expected employee ID", error);
+        }
+        currentEmployee.szID.assign(szToken);
+        if (!parseNumber(cursor, szRest, currentEmployee.mSalary, "expected salary", error) ||
+            !expectEndOfLine(cursor, szRest, error))
+        {
+            return false;
+        }
+    }
+
+    // Index every item for lookups by name and SKU
+    buildCatalogIndex(parsed);
+
+    myStore = move(parsed);
+    return true;
+}
+
+/*********************************************************************
+MappedFile::~MappedFile()
+Purpose:
+    Destructor to release the mapping
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+MappedFile::~MappedFile()
+{
+    if (pMapping != nullptr)
+    {
+        munmap(pMapping, iSize);
+    }
+}
+
+/*********************************************************************
+bool MappedFile::open(const string& szFilename, StoreFileError& error)
+Purpose:
+    Function to map a whole file for reading
+Parameters:
+    I   string szFilename           Path of the file
+    O   StoreFileError& error       Reason on failure, reported as line 0
+Return Value:
+    True if the file is mapped, else false
+Notes:
+    An empty file is not mapped and reads as zero bytes
+*********************************************************************/
+bool MappedFile::open(const string& szFilename, StoreFileError& error)
+{
+    error.iLine = 0;
+    error.iColumn = 0;
+
+    int iFile = ::open(szFilename.c_str(), O_RDONLY);
+    if (iFile < 0)
+    {
+        error.szMessage = "file could not be opened";
+        return false;
+    }
+
+    struct stat fileInfo;
+    if (fstat(iFile, &fileInfo) != 0)
+    {
+        close(iFile);
+        error.szMessage = "file could not be read";
+        return false;
+    }
+
+    size_t iLength = (size_t)fileInfo.st_size;
+    if (iLength == 0)
+    {
+        close(iFile);
+        return true;
+    }
+
+    void* pNewMapping = mmap(nullptr, iLength, PROT_READ, iMAP_FLAGS, iFile, 0);
+    close(iFile);
+    if (pNewMapping == MAP_FAILED)
+    {
+        error.szMessage = "file could not be mapped";
+        return false;
+    }
+    madvise(pNewMapping, iLength, MADV_SEQUENTIAL);
+
+    pMapping = pNewMapping;
+    pData = (const char*)pNewMapping;
+    iSize = iLength;
+    return true;
+}
+
+/*********************************************************************
+bool mapSupermarketFile(const string& szFilename, Supermarket& myStore, StoreFileError& error)
+Purpose:
+    Function to load a supermarket text file through a memory mapping
+Parameters:
+    I   string szFilename           Path of the supermarket text file
+    I/O Supermarket& myStore        Replaced by the loaded store on success
+    O   StoreFileError& error       Line, column and reason on failure
+Return Value:
+    True if the file was opened and parsed, else false
+Notes:
+    A file that cannot be opened is reported as line 0
+*********************************************************************/
+bool mapSupermarketFile(const string& szFilename, Supermarket& myStore, StoreFileError& error)
+{
+    MappedFile file;
+    if (!file.open(szFilename, error))
+    {
+        return false;
+    }
+    return parseSupermarketText(file.data(), file.size(), myStore, error);
+}
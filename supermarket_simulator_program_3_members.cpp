@@ -0,0 +1,280 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_members.cpp
+
+Purpose:
+    Member registry used by checkout in place of scanning a member
+    array.
+
+Notes:
+    - Members are kept in sign-up order in membersVec, with each name's
+      hash stored beside it in hashVec.
+    - slotsVec is an open-addressing table with linear probing. A slot
+      holds the member index plus one, 0 marks an empty slot.
+    - A Bloom filter answers most lookups for non-members without
+      touching the table.
+    - The stored hashes are compared before names, and growing the
+      table never hashes a name again.
+*********************************************************************/
+
+// Smallest table, must be a power of two
+static const size_t iMIN_MEMBER_SLOTS = 64;
+
+// Bloom filter bits per table slot, the table is at most half full
+static const size_t iBLOOM_BITS_PER_SLOT = 4;
+
+/*********************************************************************
+uint64_t hashMemberName(const string& szName)
+Purpose:
+    Function to hash a member name
+Parameters:
+    I   string szName       Name of the member
+Return Value:
+    64 bit hash of the name
+Notes:
+    FNV-1a followed by a final mix so low and high bits are both usable
+*********************************************************************/
+uint64_t hashMemberName(const string& szName)
+{
+    uint64_t iHash = 14695981039346656037ULL;
+    for (char c : szName)
+    {
+        iHash ^= (unsigned char)c;
+        iHash *= 1099511628211ULL;
+    }
+
+    iHash ^= iHash >> 33;
+    iHash *= 0xff51afd7ed558ccdULL;
+    iHash ^= iHash >> 33;
+    return iHash;
+}
+
+/*********************************************************************
+static void setBloomBits(MemberRegistry& registry, uint64_t iHash)
+Purpose:
+    Helper function to add a hash to the Bloom filter
+Parameters:
+    I/O MemberRegistry& registry    Registry to update
+    I   uint64_t iHash              Hash of the member name
+Return Value:
+    -
+Notes:
+    Three bit positions come from the two halves of the hash
+*********************************************************************/
+static void setBloomBits(MemberRegistry& registry, uint64_t iHash)
+{
+    size_t iBits = registry.bloomVec.size() * 64;
+    uint64_t iStep = (iHash >> 32) | 1;
+    for (int i = 0; i < 3; i++)
+    {
+        size_t iBit = (iHash + i * iStep) & (iBits - 1);
+        registry.bloomVec[iBit / 64] |= 1ULL << (iBit % 64);
+    }
+}
+
+/*********************************************************************
+static bool testBloomBits(const MemberRegistry& registry, uint64_t iHash)
+Purpose:
+    Helper function to check a hash against the Bloom filter
+Parameters:
+    I   MemberRegistry registry     Registry to check
+    I   uint64_t iHash              Hash of the name
+Return Value:
+    False if the name is definitely not a member, else true
+Notes:
+    -
+*********************************************************************/
+static bool testBloomBits(const MemberRegistry& registry, uint64_t iHash)
+{
+    size_t iBits = registry.bloomVec.size() * 64;
+    uint64_t iStep = (iHash >> 32) | 1;
+    for (int i = 0; i < 3; i++)
+    {
+        size_t iBit = (iHash + i * iStep) & (iBits - 1);
+        if ((registry.bloomVec[iBit / 64] & (1ULL << (iBit % 64))) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*********************************************************************
+static void resizeMemberTable(MemberRegistry& registry, size_t iSlots)
+Purpose:
+    Helper function to rebuild the table and Bloom filter at a new size
+Parameters:
+    I/O MemberRegistry& registry    Registry to resize
+    I   size_t iSlots               New number of slots, a power of two
+Return Value:
+    -
+Notes:
+    Uses the stored hashes, names are not hashed again
+*********************************************************************/
+static void resizeMemberTable(MemberRegistry& registry, size_t iSlots)
+{
+    registry.slotsVec.assign(iSlots, 0);
+    registry.bloomVec.assign(iSlots * iBLOOM_BITS_PER_SLOT / 64, 0);
+
+    size_t iMask = iSlots - 1;
+    for (size_t i = 0; i < registry.hashVec.size(); i++)
+    {
+        size_t iSlot = registry.hashVec[i] & iMask;
+        while (registry.slotsVec[iSlot] != 0)
+        {
+            iSlot = (iSlot + 1) & iMask;
+        }
+        registry.slotsVec[iSlot] = (uint32_t)(i + 1);
+        setBloomBits(registry, registry.hashVec[i]);
+    }
+}
+
+/*********************************************************************
+static bool findMemberSlot(const MemberRegistry& registry, const string& szName,
+                           uint64_t iHash, size_t& iSlot)
+Purpose:
+    Helper function to probe the table for a name
+Parameters:
+    I   MemberRegistry registry     Registry to search
+    I   string szName               Name to find
+    I   uint64_t iHash              Hash of the name
+    O   size_t& iSlot               Slot holding the name, or the empty
+                                    slot where it would go
+Return Value:
+    True if the name is in the table, else false
+Notes:
+    -
+*********************************************************************/
+static bool findMemberSlot(const MemberRegistry& registry, const string& szName,
+                           uint64_t iHash, size_t& iSlot)
+{
+    size_t iMask = registry.slotsVec.size() - 1;
+    iSlot = iHash & iMask;
+
+    while (registry.slotsVec[iSlot] != 0)
+    {
+        uint32_t iIndex = registry.slotsVec[iSlot] - 1;
+        if (registry.hashVec[iIndex] == iHash && registry.membersVec[iIndex].szName == szName)
+        {
+            return true;
+        }
+        iSlot = (iSlot + 1) & iMask;
+    }
+    return false;
+}
+
+/*********************************************************************
+bool registryContains(const MemberRegistry& registry, const string& szName)
+Purpose:
+    Function to check if a name is in the registry
+Parameters:
+    I   MemberRegistry registry     Registry to search
+    I   string szName               Name to find
+Return Value:
+    True if the name is a member, else false
+Notes:
+    -
+*********************************************************************/
+bool registryContains(const MemberRegistry& registry, const string& szName)
+{
+    if (registry.membersVec.empty())
+    {
+        return false;
+    }
+
+    uint64_t iHash = hashMemberName(szName);
+    if (!testBloomBits(registry, iHash))
+    {
+        return false;
+    }
+
+    size_t iSlot;
+    return findMemberSlot(registry, szName, iHash, iSlot);
+}
+
+/*********************************************************************
+bool registryInsert(MemberRegistry& registry, const string& szName)
+Purpose:
+    Function to add a name to the registry
+Parameters:
+    I/O MemberRegistry& registry    Registry to update
+    I   string szName               Name of the new member
+Return Value:
+    True if the name was added, false if it was already a member
+Notes:
+    The table doubles once it would be more than half full
+*********************************************************************/
+bool registryInsert(MemberRegistry& registry, const string& szName)
+{
+    if (registry.slotsVec.empty())
+    {
+        resizeMemberTable(registry, iMIN_MEMBER_SLOTS);
+    }
+
+    uint64_t iHash = hashMemberName(szName);
+    size_t iSlot;
+    if (findMemberSlot(registry, szName, iHash, iSlot))
+    {
+        return false;
+    }
+
+    registry.membersVec.push_back({szName});
+    registry.hashVec.push_back(iHash);
+
+    if (registry.membersVec.size() * 2 > registry.slotsVec.size())
+    {
+        resizeMemberTable(registry, registry.slotsVec.size() * 2);
+    }
+    else
+    {
+        registry.slotsVec[iSlot] = (uint32_t)registry.membersVec.size();
+        setBloomBits(registry, iHash);
+    }
+    return true;
+}
+
+/*********************************************************************
+void registryClear(MemberRegistry& registry)
+Purpose:
+    Function to remove every member from the registry
+Parameters:
+    I/O MemberRegistry& registry    Registry to clear
+Return Value:
+    -
+Notes:
+    Memory is released, the table starts small again on the next insert
+*********************************************************************/
+void registryClear(MemberRegistry& registry)
+{
+    registry = MemberRegistry();
+}
+
+/*********************************************************************
+size_t registryMemoryBytes(const MemberRegistry& registry)
+Purpose:
+    Function to measure the memory held by the registry
+Parameters:
+    I   MemberRegistry registry     Registry to measure
+Return Value:
+    Bytes held by the member list, hashes, table, Bloom filter and
+    names too long for the small string buffer
+Notes:
+    -
+*********************************************************************/
+size_t registryMemoryBytes(const MemberRegistry& registry)
+{
+    size_t iBytes = registry.membersVec.capacity() * sizeof(Member)
+                  + registry.hashVec.capacity() * sizeof(uint64_t)
+                  + registry.slotsVec.capacity() * sizeof(uint32_t)
+                  + registry.bloomVec.capacity() * sizeof(uint64_t);
+
+    string szEmpty;
+    for (const Member& member : registry.membersVec)
+    {
+        if (member.szName.capacity() > szEmpty.capacity())
+        {
+            iBytes += member.szName.capacity() + 1;
+        }
+    }
+    return iBytes;
+}
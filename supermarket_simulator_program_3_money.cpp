@@ -0,0 +1,230 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_money.cpp
+
+Purpose:
+    Parsing, printing and rounding for Money, the whole-cent amount
+    used for every price, cost, salary and balance in the store.
+
+Notes:
+    - Amounts in store files are read digit by digit and never pass
+      through a double, so 0.10 is exactly 10 cents.
+    - Amounts with more than two decimals are rounded to the nearest
+      cent, halves away from zero. Member prices are read from the
+      store file under the same rule.
+    - Sales tax is worked out once on the whole pre-tax cart, rounded
+      to the nearest cent with halves away from zero.
+*********************************************************************/
+
+// Longest whole part accepted, keeps cents well inside int64_t
+static const size_t iMAX_WHOLE_DIGITS = 15;
+
+/*********************************************************************
+bool parseMoney(string_view szText, Money& amount)
+Purpose:
+    Function to read a decimal amount such as 12.5 or -3.995
+Parameters:
+    I   string_view szText      Text of the amount, nothing else
+    O   Money& amount           Amount read, rounded to the cent
+Return Value:
+    True if the whole text is an amount, else false
+Notes:
+    An optional sign, digits and an optional point followed by digits.
+    Exponents and thousands separators are not accepted.
+*********************************************************************/
+bool parseMoney(string_view szText, Money& amount)
+{
+    size_t i = 0;
+    bool bNegative = false;
+    if (i < szText.size() && (szText[i] == '-' || szText[i] == '+'))
+    {
+        bNegative = szText[i] == '-';
+        i++;
+    }
+
+    int64_t iWhole = 0;
+    size_t iWholeDigits = 0;
+    while (i < szText.size() && szText[i] >= '0' && szText[i] <= '9')
+    {
+        iWhole = iWhole * 10 + (szText[i] - '0');
+        iWholeDigits++;
+        i++;
+    }
+    if (iWholeDigits > iMAX_WHOLE_DIGITS)
+    {
+        return false;
+    }
+
+    int64_t iFraction = 0;
+    size_t iFractionDigits = 0;
+    bool bRoundUp = false;
+    if (i < szText.size() && szText[i] == '.')
+    {
+        i++;
+        while (i < szText.size() && szText[i] >= '0' && szText[i] <= '9')
+        {
+            if (iFractionDigits < 2)
+            {
+                iFraction = iFraction * 10 + (szText[i] - '0');
+            }
+            else if (iFractionDigits == 2)
+            {
+                bRoundUp = szText[i] >= '5';
+            }
+            iFractionDigits++;
+            i++;
+        }
+    }
+
+    if (i != szText.size() || iWholeDigits + iFractionDigits == 0)
+    {
+        return false;
+    }
+
+    // Pad 0.5 to 50 cents
+    for (size_t j = iFractionDigits; j < 2; j++)
+    {
+        iFraction *= 10;
+    }
+
+    int64_t iCents = iWhole * 100 + iFraction + (bRoundUp ? 1 : 0);
+    amount = Money(bNegative ? -iCents : iCents);
+    return true;
+}
+
+/*********************************************************************
+void appendMoney(string& szOut, Money amount)
+Purpose:
+    Function to append an amount with exactly two decimals
+Parameters:
+    I/O string& szOut   Text to append to
+    I   Money amount    Amount to append
+Return Value:
+    -
+Notes:
+    Appends in place, for writers that build large buffers
+*********************************************************************/
+void appendMoney(string& szOut, Money amount)
+{
+    uint64_t iCents = amount.iCents < 0 ? 0 - (uint64_t)amount.iCents : (uint64_t)amount.iCents;
+    uint64_t iFraction = iCents % 100;
+
+    char szDigitsArr[24];
+    to_chars_result written = to_chars(szDigitsArr, szDigitsArr + sizeof(szDigitsArr), iCents / 100);
+    if (amount.iCents < 0)
+    {
+        szOut += '-';
+    }
+    szOut.append(szDigitsArr, written.ptr);
+    szOut += '.';
+    szOut += (char)('0' + iFraction / 10);
+    szOut += (char)('0' + iFraction % 10);
+}
+
+/*********************************************************************
+string formatMoney(Money amount)
+Purpose:
+    Function to write an amount with exactly two decimals
+Parameters:
+    I   Money amount    Amount to write
+Return Value:
+    Text such as 12.50 or -0.05, without a currency sign
+Notes:
+    -
+*********************************************************************/
+string formatMoney(Money amount)
+{
+    string szText;
+    appendMoney(szText, amount);
+    return szText;
+}
+
+/*********************************************************************
+ostream& operator<<(ostream& out, Money amount)
+Purpose:
+    Operator to print an amount with exactly two decimals
+Parameters:
+    I/O ostream& out    Stream to print to
+    I   Money amount    Amount to print
+Return Value:
+    The stream
+Notes:
+    Field width and alignment apply as for a string
+*********************************************************************/
+ostream& operator<<(ostream& out, Money amount)
+{
+    return out << formatMoney(amount);
+}
+
+/*********************************************************************
+istream& operator>>(istream& in, Money& amount)
+Purpose:
+    Operator to read an amount as one whitespace separated token
+Parameters:
+    I/O istream& in     Stream to read from
+    O   Money& amount   Amount read, rounded to the cent
+Return Value:
+    The stream, failed if the token is not an amount
+Notes:
+    -
+*********************************************************************/
+istream& operator>>(istream& in, Money& amount)
+{
+    string szToken;
+    if (in >> szToken && !parseMoney(szToken, amount))
+    {
+        in.setstate(ios::failbit);
+    }
+    return in;
+}
+
+/*********************************************************************
+Money calculateSalesTax(Money amount)
+Purpose:
+    Function to work out the sales tax on a pre-tax amount
+Parameters:
+    I   Money amount    Pre-tax amount
+Return Value:
+    Tax rounded to the nearest cent, halves away from zero
+Notes:
+    -
+*********************************************************************/
+Money calculateSalesTax(Money amount)
+{
+    int64_t iScaled = amount.iCents * iSALES_TAX_BASIS_POINTS;
+    int64_t iTax = (llabs(iScaled) + 5000) / 10000;
+    return Money(iScaled < 0 ? -iTax : iTax);
+}
+
+/*********************************************************************
+Money moneyFromDouble(double dAmount)
+Purpose:
+    Function to convert a floating point amount to whole cents
+Parameters:
+    I   double dAmount      Amount in dollars
+Return Value:
+    Amount rounded to the nearest cent
+Notes:
+    Only for amounts that start life as doubles, such as generated
+    test data. Store files are read with parseMoney.
+*********************************************************************/
+Money moneyFromDouble(double dAmount)
+{
+    return Money(llround(dAmount * 100.0));
+}
+
+/*********************************************************************
+double moneyToDouble(Money amount)
+Purpose:
+    Function to convert an amount to dollars as a double
+Parameters:
+    I   Money amount    Amount to convert
+Return Value:
+    Amount in dollars
+Notes:
+    For ratios and statistics only, never for further money sums
+*********************************************************************/
+double moneyToDouble(Money amount)
+{
+    return amount.iCents / 100.0;
+}
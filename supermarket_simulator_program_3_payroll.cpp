@@ -0,0 +1,411 @@
+#include "supermarket_simulator_program_3.h"
+#include <limits>
+/*********************************************************************
+File name: supermarket_simulator_program_3_payroll.cpp
+
+Purpose:
+    Payroll engine that pays one pay period of the yearly salaries,
+    for rosters from a handful of employees up to a whole chain.
+
+Notes:
+    - A period's pay is the part of the yearly salary that falls in
+      that period, rounded down to the cent. The rounding is carried
+      into the next period, so a year of periods adds up to the salary.
+    - When the funds do not cover the payroll the policy decides who
+      is paid: nobody, the smallest amounts first, or everyone the
+      same share of what they are owed.
+    - Totals are summed in parts on several threads. Amounts are
+      whole cents, so the totals never depend on the thread count.
+    - The ledger goes through a ReportWriter, so a large roster never
+      needs the whole file in memory. It is JSON if the file name ends
+      in .json, else CSV.
+*********************************************************************/
+
+// Rosters smaller than this are planned on one thread
+static const size_t iMIN_EMPLOYEES_PER_THREAD = 16384;
+
+/*********************************************************************
+Money periodPay(Money mSalary, PayPeriod ePeriod, int iPeriodIndex)
+Purpose:
+    Function to find the pay for one period of a yearly salary
+Parameters:
+    I   Money mSalary           Yearly salary
+    I   PayPeriod ePeriod       Pay periods in the year
+    I   int iPeriodIndex        Period of the year, 0 based
+Return Value:
+    Pay for the period
+Notes:
+    Pay due by the end of the period less pay due by its start, both
+    rounded down, so the periods of a year add up to the salary exactly
+*********************************************************************/
+Money periodPay(Money mSalary, PayPeriod ePeriod, int iPeriodIndex)
+{
+    int64_t iPeriods = (int64_t)ePeriod;
+    int64_t iIndex = ((int64_t)iPeriodIndex % iPeriods + iPeriods) % iPeriods;
+    return Money(mSalary.iCents * (iIndex + 1) / iPeriods - mSalary.iCents * iIndex / iPeriods);
+}
+
+/*********************************************************************
+static void runInParts(size_t iCount, int iParts, F work)
+Purpose:
+    Helper function to split a range into contiguous parts and run
+    each part on its own thread
+Parameters:
+    I   size_t iCount       Size of the range
+    I   int iParts          Number of parts, 1 runs on the caller
+    I   F work              Called as work(iPart, iStart, iEnd)
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+template <typename F>
+static void runInParts(size_t iCount, int iParts, F work)
+{
+    if (iParts <= 1)
+    {
+        work(0, (size_t)0, iCount);
+        return;
+    }
+
+    vector<thread> threadsVec;
+    for (int i = 0; i < iParts; i++)
+    {
+        threadsVec.emplace_back(work, i, iCount * i / iParts, iCount * (i + 1) / iParts);
+    }
+    for (thread& partThread : threadsVec)
+    {
+        partThread.join();
+    }
+}
+
+/*********************************************************************
+static bool writePayrollLedger(const Supermarket& myStore, const vector<Money>& owedVec,
+                               const vector<Money>& paidVec, const string& szFilename)
+Purpose:
+    Helper function to write one line per employee with what they
+    were owed and paid
+Parameters:
+    I   Supermarket myStore     Store that ran the payroll
+    I   vector<Money> owedVec   Pay owed, in roster order
+    I   vector<Money> paidVec   Pay paid, in roster order
+    I   string szFilename       Ledger file to create or replace
+Return Value:
+    True if the whole ledger was written, else false
+Notes:
+    Columns are id, name, owed, paid and status, where status is
+    paid, partial or unpaid
+*********************************************************************/
+static bool writePayrollLedger(const Supermarket& myStore, const vector<Money>& owedVec,
+                               const vector<Money>& paidVec, const string& szFilename)
+{
+    ReportWriter writer;
+    if (!writer.open(szFilename, reportFormatForFile(szFilename), {"id", "name", "owed", "paid", "status"}))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < owedVec.size(); i++)
+    {
+        const Employee& employee = myStore.employeesVec[i];
+        writer.field(employee.szID);
+        writer.field(employee.szName);
+        writer.field(owedVec[i]);
+        writer.field(paidVec[i]);
+        writer.field(paidVec[i] == owedVec[i] ? "paid" : (paidVec[i] == Money() ? "unpaid" : "partial"));
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+/*********************************************************************
+static void planLowestFirst(const vector<Money>& owedVec, Money mAvailable, vector<Money>& paidVec)
+Purpose:
+    Helper function to pay the smallest amounts in full first
+Parameters:
+    I   vector<Money> owedVec   Pay owed, in roster order
+    I   Money mAvailable        Funds that can be paid out
+    O   vector<Money> paidVec   Pay paid, in roster order, all zero on entry
+Return Value:
+    -
+Notes:
+    Ties go in roster order. The first employee that cannot be paid in
+    full gets what is left, so every cent available is used.
+*********************************************************************/
+static void planLowestFirst(const vector<Money>& owedVec, Money mAvailable, vector<Money>& paidVec)
+{
+    // Amount and roster index side by side, so the sort never chases indices
+    vector<pair<int64_t, uint32_t>> orderVec(owedVec.size());
+    for (size_t i = 0; i < orderVec.size(); i++)
+    {
+        orderVec[i] = {owedVec[i].iCents, (uint32_t)i};
+    }
+    sort(orderVec.begin(), orderVec.end());
+
+    for (const pair<int64_t, uint32_t>& order : orderVec)
+    {
+        if (mAvailable <= Money())
+        {
+            break;
+        }
+        Money mPay = min(Money(order.first), mAvailable);
+        paidVec[order.second] = mPay;
+        mAvailable -= mPay;
+    }
+}
+
+/*********************************************************************
+static void planProRata(const vector<Money>& owedVec, Money mOwed, Money mAvailable,
+                        int iParts, vector<Money>& paidVec)
+Purpose:
+    Helper function to pay everyone the same share of what they are owed
+Parameters:
+    I   vector<Money> owedVec   Pay owed, in roster order
+    I   Money mOwed             Sum of owedVec
+    I   Money mAvailable        Funds that can be paid out, less than mOwed
+    I   int iParts              Threads to share the work
+    O   vector<Money> paidVec   Pay paid, in roster order
+Return Value:
+    -
+Notes:
+    Shares are rounded down to the cent. The cents left over go one
+    each to the employees short changed most by the rounding, so
+    every cent available is used.
+*********************************************************************/
+static void planProRata(const vector<Money>& owedVec, Money mOwed, Money mAvailable,
+                        int iParts, vector<Money>& paidVec)
+{
+    // Rounding loss of each share, negated so the largest sort first
+    vector<pair<int64_t, uint32_t>> lossVec(owedVec.size());
+    vector<Money> partsVec(iParts);
+    runInParts(owedVec.size(), iParts, [&](int iPart, size_t iStart, size_t iEnd)
+    {
+        Money mPartPaid;
+        for (size_t i = iStart; i < iEnd; i++)
+        {
+            __int128 iScaled = (__int128)owedVec[i].iCents * mAvailable.iCents;
+            paidVec[i] = Money((int64_t)(iScaled / mOwed.iCents));
+            lossVec[i] = {-(int64_t)(iScaled % mOwed.iCents), (uint32_t)i};
+            mPartPaid += paidVec[i];
+        }
+        partsVec[iPart] = mPartPaid;
+    });
+
+    Money mLeftOver = mAvailable;
+    for (Money mPartPaid : partsVec)
+    {
+        mLeftOver -= mPartPaid;
+    }
+    if (mLeftOver <= Money())
+    {
+        return;
+    }
+
+    // Fewer cents are left over than there are shares with a rounding
+    // loss, so only the largest losses are picked out, ties in roster order
+    size_t iExtra = min((size_t)mLeftOver.iCents, lossVec.size());
+    nth_element(lossVec.begin(), lossVec.begin() + iExtra, lossVec.end());
+    for (size_t i = 0; i < iExtra; i++)
+    {
+        paidVec[lossVec[i].second] += Money(1);
+    }
+}
+
+/*********************************************************************
+PayrollResult runPayroll(Supermarket& myStore, const PayrollConfig& config)
+Purpose:
+    Function to pay the employees for one pay period
+Parameters:
+    I/O Supermarket& myStore        Store paying its employees
+    I   PayrollConfig config        Period, policy, threads and ledger file
+Return Value:
+    Counts, totals and timing for the run
+Notes:
+    The amount paid is taken from the funds and journaled as one
+    payroll. Nothing is paid if the funds are negative.
+    This function should only be called by an employee.
+*********************************************************************/
+PayrollResult runPayroll(Supermarket& myStore, const PayrollConfig& config)
+{
+    STAT_SCOPE(STAT_PAYROLL);
+    PayrollResult result;
+    result.lEmployees = (long long)myStore.employeesVec.size();
+
+    auto tStart = chrono::steady_clock::now();
+    size_t iEmployees = myStore.employeesVec.size();
+    int iParts = (int)max<size_t>(min<size_t>(max(config.iThreads, 1), iEmployees / iMIN_EMPLOYEES_PER_THREAD), 1);
+
+    // Work out each employee's pay for the period and sum it
+    vector<Money> owedVec(iEmployees);
+    vector<Money> partsVec(iParts);
+    runInParts(iEmployees, iParts, [&](int iPart, size_t iStart, size_t iEnd)
+    {
+        Money mPartOwed;
+        for (size_t i = iStart; i < iEnd; i++)
+        {
+            owedVec[i] = periodPay(myStore.employeesVec[i].mSalary, config.ePeriod, config.iPeriodIndex);
+            mPartOwed += owedVec[i];
+        }
+        partsVec[iPart] = mPartOwed;
+    });
+    for (Money mPartOwed : partsVec)
+    {
+        result.mOwed += mPartOwed;
+    }
+
+    // Decide who is paid what
+    result.bCovered = result.mOwed <= myStore.mTotalFunds;
+    Money mAvailable = max(myStore.mTotalFunds, Money());
+    vector<Money> paidVec;
+    if (result.bCovered)
+    {
+        paidVec = owedVec;
+    }
+    else
+    {
+        paidVec.assign(iEmployees, Money());
+        if (config.ePolicy == PAYROLL_LOWEST_FIRST)
+        {
+            planLowestFirst(owedVec, mAvailable, paidVec);
+        }
+        else if (config.ePolicy == PAYROLL_PRO_RATA && mAvailable > Money())
+        {
+            planProRata(owedVec, result.mOwed, mAvailable, iParts, paidVec);
+        }
+    }
+
+    // Count the outcomes and sum what was paid
+    vector<PayrollResult> countsVec(iParts);
+    runInParts(iEmployees, iParts, [&](int iPart, size_t iStart, size_t iEnd)
+    {
+        PayrollResult& counts = countsVec[iPart];
+        for (size_t i = iStart; i < iEnd; i++)
+        {
+            counts.mPaid += paidVec[i];
+            if (paidVec[i] == owedVec[i])
+            {
+                counts.lPaidInFull += 1;
+            }
+            else if (paidVec[i] == Money())
+            {
+                counts.lUnpaid += 1;
+            }
+            else
+            {
+                counts.lPaidPartly += 1;
+            }
+        }
+    });
+    for (const PayrollResult& counts : countsVec)
+    {
+        result.mPaid += counts.mPaid;
+        result.lPaidInFull += counts.lPaidInFull;
+        result.lPaidPartly += counts.lPaidPartly;
+        result.lUnpaid += counts.lUnpaid;
+    }
+
+    if (result.bCovered || result.mPaid > Money())
+    {
+        myStore.mTotalFunds -= result.mPaid;
+        journalPayroll(myStore, result.mPaid);
+    }
+    chrono::duration<double> planned = chrono::steady_clock::now() - tStart;
+    result.dPlanSeconds = planned.count();
+
+    if (!config.szLedgerFile.empty())
+    {
+        auto tLedgerStart = chrono::steady_clock::now();
+        result.bLedgerWritten = writePayrollLedger(myStore, owedVec, paidVec, config.szLedgerFile);
+        chrono::duration<double> written = chrono::steady_clock::now() - tLedgerStart;
+        result.dLedgerSeconds = written.count();
+    }
+    return result;
+}
+
+/*********************************************************************
+void displayPayrollResult(const PayrollResult& result)
+Purpose:
+    Function to display the outcome of a payroll run
+Parameters:
+    I   PayrollResult result    Result from runPayroll
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayPayrollResult(const PayrollResult& result)
+{
+    cout << szBreakMessage;
+    cout << "Employees: " << result.lEmployees << endl;
+    cout << "Paid in full: " << result.lPaidInFull << ", partly: " << result.lPaidPartly
+         << ", unpaid: " << result.lUnpaid << endl;
+    cout << "Owed: $" << result.mOwed << ", paid: $" << result.mPaid << endl;
+    cout << "Planned in " << fixed << setprecision(3) << result.dPlanSeconds * 1000.0 << " ms";
+    if (result.dLedgerSeconds > 0.0)
+    {
+        cout << ", ledger " << (result.bLedgerWritten ? "written" : "failed") << " in "
+             << result.dLedgerSeconds * 1000.0 << " ms";
+    }
+    cout << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void processPayroll(Supermarket& myStore)
+Purpose:
+    Function to prompt for a pay period, a policy and a ledger file,
+    then run the payroll
+Parameters:
+    I/O Supermarket& myStore    Store paying its employees
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processPayroll(Supermarket& myStore)
+{
+    PayrollConfig config;
+    int iPeriods;
+    int iPolicy;
+
+    cout << "Enter pay periods per year (1, 12, 26 or 52): ";
+    if (!(cin >> iPeriods) || (iPeriods != PAY_PERIOD_YEARLY && iPeriods != PAY_PERIOD_MONTHLY &&
+                               iPeriods != PAY_PERIOD_BIWEEKLY && iPeriods != PAY_PERIOD_WEEKLY))
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid pay period." << endl;
+        return;
+    }
+    config.ePeriod = (PayPeriod)iPeriods;
+
+    cout << "Enter period of the year (1 to " << iPeriods << "): ";
+    if (!(cin >> config.iPeriodIndex) || config.iPeriodIndex < 1 || config.iPeriodIndex > iPeriods)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid period." << endl;
+        return;
+    }
+    config.iPeriodIndex -= 1;
+
+    cout << "If funds are short pay 1. nobody 2. smallest amounts first 3. everyone a share: ";
+    if (!(cin >> iPolicy) || iPolicy < 1 || iPolicy > 3)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid policy." << endl;
+        return;
+    }
+    config.ePolicy = (PayrollPolicy)(iPolicy - 1);
+
+    cout << "Enter ledger file (- for none): ";
+    cin >> config.szLedgerFile;
+    if (config.szLedgerFile == "-")
+    {
+        config.szLedgerFile.clear();
+    }
+    config.iThreads = max((int)thread::hardware_concurrency(), 1);
+
+    displayPayrollResult(runPayroll(myStore, config));
+}
@@ -0,0 +1,159 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_pricing.cpp
+
+Purpose:
+    Price a checkout for its customer's tier.
+
+Notes:
+    - Each tier is a policy class with its unit price and sales tax.
+      The basket loop is a template over the policy, so each tier gets
+      its own loop with no per-line choice of price list left in it.
+    - The tier is chosen once per basket when the session is priced.
+    - Lines keep the shelf prices from when they were taken, so a
+      session can be priced after the fact and priced again as lines
+      are added without looking the items up.
+*********************************************************************/
+
+struct RegularPricing
+{
+    static Money unitPrice(const StockChange& change) { return change.mRegularPrice; }
+    static Money salesTax(Money mCartTotal) { return calculateSalesTax(mCartTotal); }
+};
+
+struct MemberPricing
+{
+    static Money unitPrice(const StockChange& change) { return change.mMembersPrice; }
+    static Money salesTax(Money mCartTotal) { return calculateSalesTax(mCartTotal); }
+};
+
+// Staff pay wholesale plus half the member margin, rounded down
+struct EmployeePricing
+{
+    static Money unitPrice(const StockChange& change)
+    {
+        return change.mWholesale + Money((change.mMembersPrice - change.mWholesale).iCents / 2);
+    }
+    static Money salesTax(Money mCartTotal) { return calculateSalesTax(mCartTotal); }
+};
+
+struct TaxExemptPricing
+{
+    static Money unitPrice(const StockChange& change) { return change.mRegularPrice; }
+    static Money salesTax(Money) { return Money(); }
+};
+
+/*********************************************************************
+static void priceLines(CheckoutSession& session)
+Purpose:
+    Helper function to price the lines not yet in the session totals
+Parameters:
+    I/O CheckoutSession& session    Open checkout session
+Return Value:
+    -
+Notes:
+    Sales and cost are summed separately and profit is taken once at
+    the end, so the loop is two multiply-adds per line
+*********************************************************************/
+template <typename Pricing>
+static void priceLines(CheckoutSession& session)
+{
+    Money mSales;
+    Money mCost;
+    StockChange* pChanges = session.takenVec.data();
+    size_t iLines = session.takenVec.size();
+    for (size_t i = session.iPricedLines; i < iLines; i++)
+    {
+        StockChange& change = pChanges[i];
+        change.mPrice = Pricing::unitPrice(change);
+        mSales += change.mPrice * change.iQuantity;
+        mCost += change.mWholesale * change.iQuantity;
+    }
+    session.mCartTotal += mSales;
+    session.mProfit += mSales - mCost;
+    session.iPricedLines = iLines;
+}
+
+/*********************************************************************
+void priceCheckout(CheckoutSession& session)
+Purpose:
+    Function to price every line added since the session was last priced
+Parameters:
+    I/O CheckoutSession& session    Open checkout session
+Return Value:
+    -
+Notes:
+    finishCheckout prices the session, call this first only to show a
+    running cart total
+*********************************************************************/
+void priceCheckout(CheckoutSession& session)
+{
+    switch (session.eTier)
+    {
+        case PRICING_MEMBER:
+            priceLines<MemberPricing>(session);
+            break;
+        case PRICING_EMPLOYEE:
+            priceLines<EmployeePricing>(session);
+            break;
+        case PRICING_TAX_EXEMPT:
+            priceLines<TaxExemptPricing>(session);
+            break;
+        default:
+            priceLines<RegularPricing>(session);
+            break;
+    }
+}
+
+/*********************************************************************
+Money checkoutSalesTax(PricingTier eTier, Money mCartTotal)
+Purpose:
+    Function to calculate the sales tax on a cart for a tier
+Parameters:
+    I   PricingTier eTier       Price list of the checkout
+    I   Money mCartTotal        Pre-tax cart total
+Return Value:
+    Sales tax, rounded once on the whole cart
+Notes:
+    -
+*********************************************************************/
+Money checkoutSalesTax(PricingTier eTier, Money mCartTotal)
+{
+    switch (eTier)
+    {
+        case PRICING_MEMBER:
+            return MemberPricing::salesTax(mCartTotal);
+        case PRICING_EMPLOYEE:
+            return EmployeePricing::salesTax(mCartTotal);
+        case PRICING_TAX_EXEMPT:
+            return TaxExemptPricing::salesTax(mCartTotal);
+        default:
+            return RegularPricing::salesTax(mCartTotal);
+    }
+}
+
+/*********************************************************************
+const char* pricingTierName(PricingTier eTier)
+Purpose:
+    Function to name a pricing tier for reports
+Parameters:
+    I   PricingTier eTier       Price list
+Return Value:
+    Lower case name of the tier
+Notes:
+    -
+*********************************************************************/
+const char* pricingTierName(PricingTier eTier)
+{
+    switch (eTier)
+    {
+        case PRICING_MEMBER:
+            return "member";
+        case PRICING_EMPLOYEE:
+            return "employee";
+        case PRICING_TAX_EXEMPT:
+            return "tax exempt";
+        default:
+            return "regular";
+    }
+}
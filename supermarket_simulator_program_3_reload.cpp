@@ -0,0 +1,713 @@
+#include "supermarket_simulator_program_3.h"
+#include <unistd.h>
+/*********************************************************************
+File name: supermarket_simulator_program_3_reload.cpp
+
+Purpose:
+    Reload a store file into a running store, taking its names, prices,
+    aisles and employees while keeping everything the store has done.
+
+Notes:
+    - The file is loaded into a fresh Supermarket beside the live one
+      and each of its items is matched to a live item, by SKU or else
+      by name. That is the slow part and it never touches live state.
+    - Swapping in carries the live stock of every matched item and
+      moves funds, purchases, members, sales totals, analytics and the
+      line item log across, so the store pauses only for a pass over
+      the items and a few pointer moves.
+    - Journal records name items by SKU, which the file may number
+      differently, so the journal is never carried across. The loader
+      opens a new journal for a journaled store and the swap switches to
+      it. The reclaimer then saves the state at the swap as the new
+      journal's base, <file>.snap (or <file>.2.snap, <file>.3.snap when
+      that one is in use), and puts a redirect to it in place of
+      <file>.journal, so loading the file again follows it. The old
+      journal is only replaced once the snapshot holding its changes
+      is on disk.
+    - The owner only copies the live state into a copy of the loaded
+      store the loader made, and never waits on the disk.
+    - New items take their stock from the file. Items no longer in the
+      file are taken off sale along with their stock.
+    - Checkouts already open keep the prices they were quoted, since
+      each line keeps its prices from when the item was taken. Their
+      lines are moved to the items' new SKUs and aisles, and lines of
+      items the file dropped leave the cart along with their stock.
+    - StoreReloader runs the load on a worker thread and hands it over
+      through an atomic shared_ptr, so the owner of the store (such as
+      the register server's loop) keeps checking out meanwhile. The
+      replaced store goes to a reclaimer thread, since freeing a large
+      store takes about as long as the swap itself.
+    - Carried containers keep the arena they were made in, so a store
+      holds at most the first load's arena beside its current one.
+*********************************************************************/
+
+// How long the reclaimer waits before trying a failed base save again
+static const chrono::seconds BASE_SAVE_RETRY(5);
+
+/*********************************************************************
+static Item& entryItem(Supermarket& myStore, const CatalogEntry& entry)
+Purpose:
+    Helper function to get the item a catalog entry points at
+Parameters:
+    I/O Supermarket& myStore    Store the entry belongs to
+    I   CatalogEntry entry      Catalog entry
+Return Value:
+    Item on the shelf
+Notes:
+    -
+*********************************************************************/
+static Item& entryItem(Supermarket& myStore, const CatalogEntry& entry)
+{
+    return myStore.aislesVec[entry.location.iAisleIndex].itemVec[entry.location.iItemIndex];
+}
+
+/*********************************************************************
+static const Item& entryItem(const Supermarket& myStore, const CatalogEntry& entry)
+Purpose:
+    Helper function to get the item a catalog entry points at
+Parameters:
+    I   Supermarket myStore     Store the entry belongs to
+    I   CatalogEntry entry      Catalog entry
+Return Value:
+    Item on the shelf
+Notes:
+    -
+*********************************************************************/
+static const Item& entryItem(const Supermarket& myStore, const CatalogEntry& entry)
+{
+    return myStore.aislesVec[entry.location.iAisleIndex].itemVec[entry.location.iItemIndex];
+}
+
+/*********************************************************************
+static bool prepareReloadJournal(const Supermarket& myStore, PreparedReload& reload)
+Purpose:
+    Helper function to set up the journal a reloaded store switches to
+Parameters:
+    I   Supermarket myStore         Live store, journaled
+    I/O PreparedReload& reload      Loaded store, given its base name, copy and journal
+Return Value:
+    True if the new journal could be opened, else false
+Notes:
+    The base is <file>.snap, or the next free of <file>.2.snap and
+    <file>.3.snap when <file>.snap is the live journal's base or the one
+    <file>.journal redirects to, so neither is overwritten before the
+    new base is saved. Runs on the loader, like the rest of the load.
+*********************************************************************/
+static bool prepareReloadJournal(const Supermarket& myStore, PreparedReload& reload)
+{
+    const string& szLiveJournal = myStore.pJournal->filename();
+    string szLiveBase = szLiveJournal.substr(0, szLiveJournal.length() - 8);
+    string szRedirected;
+    readJournalRedirect(reload.szFilename + ".journal", szRedirected);
+
+    string szBase = reload.szFilename + ".snap";
+    for (int i = 2; szBase == szLiveBase || szBase == szRedirected; i++)
+    {
+        szBase = reload.szFilename + "." + to_string(i) + ".snap";
+    }
+
+    StoreFileError error;
+    shared_ptr<TransactionJournal> pJournal = make_shared<TransactionJournal>();
+    if (!pJournal->open(szBase + ".journal", true, error))
+    {
+        cout << szBase << ".journal: " << error.szMessage << ". The store was not reloaded." << endl;
+        return false;
+    }
+
+    reload.szBaseFilename = szBase;
+    reload.baseStore = reload.store;
+    reload.pNewJournal = pJournal;
+    return true;
+}
+
+/*********************************************************************
+bool prepareStoreReload(const string& szFilename, const Supermarket& myStore, PreparedReload& reload)
+Purpose:
+    Function to load a store file beside a live store and match its
+    items to the live ones
+Parameters:
+    I   string szFilename           Store file or snapshot to load
+    I   Supermarket myStore         Live store, only its catalog is read
+    O   PreparedReload& reload      Loaded store, matches and item counts
+Return Value:
+    True if the file loaded, else false
+Notes:
+    Safe to run on another thread while myStore checks out, since it
+    reads only names, prices, the catalog and the journal's name, which
+    change only when a reload is applied. A journaled store also gets
+    its new journal opened and a copy of the loaded store for its base,
+    and the reload fails if that journal cannot be opened.
+*********************************************************************/
+bool prepareStoreReload(const string& szFilename, const Supermarket& myStore, PreparedReload& reload)
+{
+    auto tStart = chrono::steady_clock::now();
+    reload.stats = ReloadStats();
+    reload.szFilename = szFilename;
+    if (!loadSupermarketFile(szFilename, reload.store))
+    {
+        return false;
+    }
+
+    const vector<CatalogEntry>& liveEntriesVec = myStore.catalog.entriesVec;
+    const vector<CatalogEntry>& newEntriesVec = reload.store.catalog.entriesVec;
+
+    // Live entries by name, for items the file has renumbered
+    unordered_map<uint64_t, int> liveByNameMap;
+    liveByNameMap.reserve(liveEntriesVec.size());
+    for (size_t i = 0; i < liveEntriesVec.size(); i++)
+    {
+        liveByNameMap.emplace(liveEntriesVec[i].iNameHash, (int)i);
+    }
+
+    vector<bool> bKeptVec(liveEntriesVec.size(), false);
+    reload.liveEntryVec.assign(newEntriesVec.size(), -1);
+    for (size_t i = 0; i < newEntriesVec.size(); i++)
+    {
+        const CatalogEntry& entry = newEntriesVec[i];
+        const Item& newItem = entryItem(reload.store, entry);
+
+        int iLive = findCatalogEntry(myStore, entry.iSKU);
+        if (iLive >= 0 && liveEntriesVec[iLive].iNameHash != entry.iNameHash)
+        {
+            iLive = -1;
+        }
+        if (iLive < 0)
+        {
+            auto found = liveByNameMap.find(entry.iNameHash);
+            if (found != liveByNameMap.end() &&
+                normalizeItemName(entryItem(myStore, liveEntriesVec[found->second]).szName) ==
+                normalizeItemName(newItem.szName))
+            {
+                iLive = found->second;
+            }
+        }
+        if (iLive < 0 || bKeptVec[iLive])
+        {
+            reload.stats.lNewItems += 1;
+            continue;
+        }
+
+        bKeptVec[iLive] = true;
+        reload.liveEntryVec[i] = iLive;
+        reload.stats.lKeptItems += 1;
+        const Item& liveItem = entryItem(myStore, liveEntriesVec[iLive]);
+        if (liveItem.mRegularPrice != newItem.mRegularPrice || liveItem.mMembersPrice != newItem.mMembersPrice ||
+            liveItem.mWholesale != newItem.mWholesale)
+        {
+            reload.stats.lPriceChanges += 1;
+        }
+    }
+    reload.stats.lDroppedItems = (long long)liveEntriesVec.size() - reload.stats.lKeptItems;
+
+    reload.newEntryVec.assign(liveEntriesVec.size(), -1);
+    for (size_t i = 0; i < newEntriesVec.size(); i++)
+    {
+        if (reload.liveEntryVec[i] >= 0)
+        {
+            reload.newEntryVec[reload.liveEntryVec[i]] = (int)i;
+        }
+    }
+
+    if (myStore.pJournal != nullptr && !prepareReloadJournal(myStore, reload))
+    {
+        return false;
+    }
+    reload.stats.dLoadSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+    return true;
+}
+
+/*********************************************************************
+static void copyReloadedState(const Supermarket& myStore, Supermarket& baseStore)
+Purpose:
+    Helper function to give the new journal base the state of the store
+    just swapped in
+Parameters:
+    I   Supermarket myStore         Store just swapped in
+    I/O Supermarket& baseStore      Copy of the loaded store, same aisles and items
+Return Value:
+    -
+Notes:
+    Copies what applyStoreReload carries over. Names, prices, aisles and
+    employees are the loaded file's, which the copy already has.
+*********************************************************************/
+static void copyReloadedState(const Supermarket& myStore, Supermarket& baseStore)
+{
+    for (size_t iAisle = 0; iAisle < myStore.aislesVec.size(); iAisle++)
+    {
+        const ArenaVector<Item>& liveItemsVec = myStore.aislesVec[iAisle].itemVec;
+        ArenaVector<Item>& baseItemsVec = baseStore.aislesVec[iAisle].itemVec;
+        for (size_t i = 0; i < liveItemsVec.size(); i++)
+        {
+            baseItemsVec[i].iQuantity = liveItemsVec[i].iQuantity;
+        }
+    }
+
+    baseStore.mTotalFunds = myStore.mTotalFunds;
+    baseStore.customersVec = ArenaVector<CustomerPurchase>(baseStore.pArena);
+    baseStore.customersVec.reserve(myStore.customersVec.size());
+    for (const CustomerPurchase& purchase : myStore.customersVec)
+    {
+        baseStore.customersVec.push_back(purchase);
+    }
+    baseStore.memberRegistry = myStore.memberRegistry;
+    baseStore.sales = myStore.sales;
+    baseStore.analytics = myStore.analytics;
+    baseStore.lineItems = LineItemLog(baseStore.pArena);
+    baseStore.lineItems.appendLog(myStore.lineItems);
+    baseStore.restock = myStore.restock;
+}
+
+/*********************************************************************
+static bool commitReloadJournal(PreparedReload& reload)
+Purpose:
+    Helper function to save the new journal base of an applied reload
+    and point the reloaded file's journal at it
+Parameters:
+    I/O PreparedReload& reload      Applied reload, holding the replaced store and old journal
+Return Value:
+    True once the base is saved, or if there is none, else false
+Notes:
+    Closes the old journal first, its changes are all in the base.
+    <file>.journal is only replaced if it is missing, a redirect or the
+    old journal, so a journal of some other run on the file is kept.
+    Safe to call again after a failure.
+*********************************************************************/
+static bool commitReloadJournal(PreparedReload& reload)
+{
+    if (reload.szBaseFilename.empty())
+    {
+        return true;
+    }
+
+    string szOldJournal;
+    if (reload.store.pJournal != nullptr)
+    {
+        reload.store.pJournal->close();
+        szOldJournal = reload.store.pJournal->filename();
+    }
+
+    StoreFileError error;
+    const string& szBase = reload.szBaseFilename;
+    if (!saveStoreSnapshot(reload.baseStore, szBase, error))
+    {
+        cout << szBase << ": " << error.szMessage << ". Changes since the reload are in " << szBase
+             << ".journal but have no base until it is saved." << endl;
+        return false;
+    }
+
+    string szRedirect = reload.szFilename + ".journal";
+    string szRedirected;
+    if (access(szRedirect.c_str(), F_OK) != 0 || readJournalRedirect(szRedirect, szRedirected) ||
+        szRedirect == szOldJournal)
+    {
+        if (!writeJournalRedirect(szRedirect, szBase, error))
+        {
+            cout << szRedirect << ": " << error.szMessage << ". Changes since the reload are journaled against "
+                 << szBase << ", restart from it." << endl;
+            return false;
+        }
+        cout << "Reloaded store saved to " << szBase << ", changes are journaled against it" << endl;
+    }
+    else
+    {
+        cout << "Reloaded store saved to " << szBase << ", changes are journaled against it. " << szRedirect
+             << " belongs to another run and was left alone, restart from " << szBase << "." << endl;
+    }
+
+    reload.szBaseFilename.clear();
+    reload.baseStore = Supermarket();
+    return true;
+}
+
+/*********************************************************************
+void applyStoreReload(Supermarket& myStore, PreparedReload& reload)
+Purpose:
+    Function to swap a prepared reload into the live store
+Parameters:
+    I/O Supermarket& myStore        Live store, becomes the reloaded store
+    I/O PreparedReload& reload      Prepared reload, left holding the replaced store
+Return Value:
+    -
+Notes:
+    Must run on the thread that owns myStore, with no lanes running.
+    The replaced store is left in reload.store, with the old journal,
+    so the caller can free it off the checkout path. A journaled store
+    switches to the journal the loader opened, and its state is copied
+    into reload.baseStore for commitReloadJournal to save.
+*********************************************************************/
+void applyStoreReload(Supermarket& myStore, PreparedReload& reload)
+{
+    auto tStart = chrono::steady_clock::now();
+    Supermarket& newStore = reload.store;
+    const vector<CatalogEntry>& liveEntriesVec = myStore.catalog.entriesVec;
+    const vector<CatalogEntry>& newEntriesVec = newStore.catalog.entriesVec;
+
+    for (size_t i = 0; i < newEntriesVec.size(); i++)
+    {
+        if (reload.liveEntryVec[i] >= 0)
+        {
+            entryItem(newStore, newEntriesVec[i]).iQuantity =
+                entryItem(myStore, liveEntriesVec[reload.liveEntryVec[i]]).iQuantity;
+        }
+    }
+
+    newStore.mTotalFunds = myStore.mTotalFunds;
+    newStore.customersVec = std::move(myStore.customersVec);
+    newStore.memberRegistry = std::move(myStore.memberRegistry);
+    newStore.sales = std::move(myStore.sales);
+    newStore.analytics = std::move(myStore.analytics);
+    newStore.lineItems = std::move(myStore.lineItems);
+    newStore.pJournal = std::move(reload.pNewJournal);
+    carryRestockSales(newStore, myStore, reload.liveEntryVec);
+
+    swap(myStore, newStore);
+    auto tSwapped = chrono::steady_clock::now();
+    reload.stats.dSwapMicros = chrono::duration<double, micro>(tSwapped - tStart).count();
+
+    if (!reload.szBaseFilename.empty())
+    {
+        copyReloadedState(myStore, reload.baseStore);
+        reload.stats.dJournalMillis = chrono::duration<double, milli>(chrono::steady_clock::now() - tSwapped).count();
+    }
+}
+
+/*********************************************************************
+bool reloadSupermarketFile(const string& szFilename, Supermarket& myStore)
+Purpose:
+    Function to reload a store file into a running store and report it
+Parameters:
+    I   string szFilename       Store file or snapshot to load
+    I/O Supermarket& myStore    Live store
+Return Value:
+    True if the file loaded and was swapped in, else false
+Notes:
+    Loads and saves the new journal base on the calling thread, see
+    StoreReloader to do both elsewhere. A file that fails to load leaves
+    myStore unchanged.
+*********************************************************************/
+bool reloadSupermarketFile(const string& szFilename, Supermarket& myStore)
+{
+    PreparedReload reload;
+    if (!prepareStoreReload(szFilename, myStore, reload))
+    {
+        return false;
+    }
+    applyStoreReload(myStore, reload);
+    displayReloadStats(reload.stats);
+    if (!commitReloadJournal(reload))
+    {
+        cout << "Save a store snapshot from the employee menu to journal against it." << endl;
+    }
+    return true;
+}
+
+/*********************************************************************
+bool remapReloadedSession(const PreparedReload& reload, const Supermarket& myStore, CheckoutSession& session)
+Purpose:
+    Function to move a checkout opened before a reload onto the
+    reloaded catalog
+Parameters:
+    I   PreparedReload reload       Reload just applied, holding the replaced store
+    I   Supermarket myStore         Reloaded store
+    I/O CheckoutSession& session    Open checkout session
+Return Value:
+    True if every line was kept, false if lines were taken out
+Notes:
+    Kept lines take the item's new SKU and aisle and keep the prices
+    they were quoted. Lines of dropped items come off the cart, their
+    stock went with the item. Call before the replaced store is freed.
+*********************************************************************/
+bool remapReloadedSession(const PreparedReload& reload, const Supermarket& myStore, CheckoutSession& session)
+{
+    const vector<CatalogEntry>& newEntriesVec = myStore.catalog.entriesVec;
+    size_t iKept = 0;
+    size_t iPricedKept = 0;
+    for (size_t i = 0; i < session.takenVec.size(); i++)
+    {
+        StockChange change = session.takenVec[i];
+        int iOld = findCatalogEntry(reload.store, change.iSKU);
+        int iNew = iOld >= 0 ? reload.newEntryVec[iOld] : -1;
+        if (iNew < 0)
+        {
+            session.purchase.iNumberItems -= change.iQuantity;
+            if (i < session.iPricedLines)
+            {
+                session.mCartTotal -= change.mPrice * change.iQuantity;
+                session.mProfit -= (change.mPrice - change.mWholesale) * change.iQuantity;
+            }
+            continue;
+        }
+
+        change.iSKU = newEntriesVec[iNew].iSKU;
+        change.iAisleIndex = newEntriesVec[iNew].location.iAisleIndex;
+        iPricedKept += i < session.iPricedLines ? 1 : 0;
+        session.takenVec[iKept++] = change;
+    }
+
+    bool bAllKept = iKept == session.takenVec.size();
+    session.takenVec.resize(iKept);
+    session.iPricedLines = iPricedKept;
+    return bAllKept;
+}
+
+/*********************************************************************
+int remapReloadedAisle(const PreparedReload& reload, const Supermarket& myStore, int iAisleIndex)
+Purpose:
+    Function to find an aisle chosen before a reload in the reloaded store
+Parameters:
+    I   PreparedReload reload       Reload just applied, holding the replaced store
+    I   Supermarket myStore         Reloaded store
+    I   int iAisleIndex             Aisle in the replaced store
+Return Value:
+    Aisle with the same name in myStore, -1 for any aisle if it is gone
+Notes:
+    -
+*********************************************************************/
+int remapReloadedAisle(const PreparedReload& reload, const Supermarket& myStore, int iAisleIndex)
+{
+    if (iAisleIndex < 0 || (size_t)iAisleIndex >= reload.store.aislesVec.size())
+    {
+        return -1;
+    }
+
+    const string& szName = reload.store.aislesVec[iAisleIndex].szName;
+    if ((size_t)iAisleIndex < myStore.aislesVec.size() && myStore.aislesVec[iAisleIndex].szName == szName)
+    {
+        return iAisleIndex;
+    }
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
+    {
+        if (myStore.aislesVec[i].szName == szName)
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/*********************************************************************
+void displayReloadStats(const ReloadStats& stats)
+Purpose:
+    Function to display what a reload changed and how long it took
+Parameters:
+    I   ReloadStats stats   Counts and timing from the reload
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayReloadStats(const ReloadStats& stats)
+{
+    cout << "Store Reload" << endl;
+    cout << szBreakMessage;
+    cout << "Items kept: " << stats.lKeptItems << " (" << stats.lPriceChanges << " with new prices), new: "
+         << stats.lNewItems << ", dropped: " << stats.lDroppedItems << endl;
+    cout << "Load ms: " << setprecision(1) << stats.dLoadSeconds * 1000.0
+         << ", swap us: " << stats.dSwapMicros;
+    if (stats.dJournalMillis > 0.0)
+    {
+        cout << ", journal base copy ms: " << stats.dJournalMillis;
+    }
+    cout << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+StoreReloader::~StoreReloader()
+Purpose:
+    Destructor, waits for the worker and reclaimer threads
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    A load that was never polled is dropped
+*********************************************************************/
+StoreReloader::~StoreReloader()
+{
+    if (workerThread.joinable())
+    {
+        workerThread.join();
+    }
+    {
+        lock_guard<mutex> guard(reclaimLock);
+        bClosing = true;
+    }
+    reclaimWake.notify_one();
+    if (reclaimerThread.joinable())
+    {
+        reclaimerThread.join();
+    }
+}
+
+/*********************************************************************
+void StoreReloader::runReclaimer()
+Purpose:
+    Thread body that saves the journal bases of applied reloads and
+    frees the stores they replaced
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    The lock is released while saving and freeing, so the owner can
+    queue the next store meanwhile. A base that fails to save is tried
+    again every BASE_SAVE_RETRY and no new reload starts until it is
+    saved, since its journal would have no base. Once the reloader is
+    closing a failed base is given up on, loudly.
+*********************************************************************/
+void StoreReloader::runReclaimer()
+{
+    unique_lock<mutex> lock(reclaimLock);
+    while (true)
+    {
+        reclaimWake.wait(lock, [&]() { return !replacedVec.empty() || bClosing; });
+        if (replacedVec.empty())
+        {
+            break;
+        }
+
+        vector<shared_ptr<PreparedReload>> freeingVec;
+        freeingVec.swap(replacedVec);
+        for (shared_ptr<PreparedReload>& pReload : freeingVec)
+        {
+            lock.unlock();
+            bool bSaved = commitReloadJournal(*pReload);
+            lock.lock();
+            while (!bSaved && !bClosing)
+            {
+                reclaimWake.wait_for(lock, BASE_SAVE_RETRY, [&]() { return bClosing; });
+                lock.unlock();
+                bSaved = commitReloadJournal(*pReload);
+                lock.lock();
+            }
+            if (!bSaved)
+            {
+                cout << "Reloaded store was never saved to " << pReload->szBaseFilename
+                     << ", changes since the reload are only in its journal" << endl;
+            }
+        }
+        bBusy.store(false, memory_order_release);
+
+        lock.unlock();
+        freeingVec.clear();
+        lock.lock();
+    }
+}
+
+/*********************************************************************
+bool StoreReloader::start(const string& szFilename, const Supermarket& myStore)
+Purpose:
+    Function to start loading a store file on the worker thread
+Parameters:
+    I   string szFilename       Store file or snapshot to load
+    I   Supermarket myStore     Live store the file will replace
+Return Value:
+    False if a reload is already under way, else true
+Notes:
+    myStore must outlive the load and only be reloaded through poll
+    until the load is done. The previous loader has already been
+    joined by poll or has failed and is returning, so the join here
+    does not wait on any real work.
+*********************************************************************/
+bool StoreReloader::start(const string& szFilename, const Supermarket& myStore)
+{
+    if (bBusy.exchange(true, memory_order_acq_rel))
+    {
+        return false;
+    }
+    if (workerThread.joinable())
+    {
+        workerThread.join();
+    }
+
+    workerThread = thread([this, szFilename, &myStore]()
+    {
+        shared_ptr<PreparedReload> pReload = make_shared<PreparedReload>();
+        if (prepareStoreReload(szFilename, myStore, *pReload))
+        {
+            pReady.store(std::move(pReload), memory_order_release);
+        }
+        else
+        {
+            bBusy.store(false, memory_order_release);
+        }
+    });
+    return true;
+}
+
+/*********************************************************************
+bool StoreReloader::poll(Supermarket& myStore, ReloadStats& stats)
+Purpose:
+    Function to swap in a finished load, if there is one
+Parameters:
+    I/O Supermarket& myStore    Live store passed to start
+    O   ReloadStats& stats      What the reload changed, set when it is applied
+Return Value:
+    True if a reload was applied, else false
+Notes:
+    Call from the thread that owns myStore between checkouts, when it
+    has no open checkouts, else use the poll that takes a remap. Costs
+    one atomic load when nothing is ready. The replaced store is freed
+    on the reclaimer thread.
+*********************************************************************/
+bool StoreReloader::poll(Supermarket& myStore, ReloadStats& stats)
+{
+    return poll(myStore, stats, [](const PreparedReload&) {});
+}
+
+/*********************************************************************
+shared_ptr<PreparedReload> StoreReloader::applyReady(Supermarket& myStore, ReloadStats& stats)
+Purpose:
+    Helper function to swap in a finished load, if there is one
+Parameters:
+    I/O Supermarket& myStore    Live store passed to start
+    O   ReloadStats& stats      What the reload changed, set when it is applied
+Return Value:
+    The applied reload, holding the replaced store, else nullptr
+Notes:
+    Hand the result to reclaim once done with the replaced store
+*********************************************************************/
+shared_ptr<PreparedReload> StoreReloader::applyReady(Supermarket& myStore, ReloadStats& stats)
+{
+    if (!bBusy.load(memory_order_acquire))
+    {
+        return nullptr;
+    }
+    shared_ptr<PreparedReload> pReload = pReady.exchange(nullptr, memory_order_acq_rel);
+    if (!pReload)
+    {
+        return nullptr;
+    }
+
+    applyStoreReload(myStore, *pReload);
+    stats = pReload->stats;
+
+    // The loader has published, so it is only returning
+    workerThread.join();
+    return pReload;
+}
+
+/*********************************************************************
+void StoreReloader::reclaim(shared_ptr<PreparedReload> pReplaced)
+Purpose:
+    Helper function to queue an applied reload for the reclaimer thread
+Parameters:
+    I   shared_ptr<PreparedReload> pReplaced    Applied reload, holding the replaced store
+Return Value:
+    -
+Notes:
+    The next start runs once the reclaimer has saved the journal base
+*********************************************************************/
+void StoreReloader::reclaim(shared_ptr<PreparedReload> pReplaced)
+{
+    {
+        lock_guard<mutex> guard(reclaimLock);
+        replacedVec.push_back(std::move(pReplaced));
+        if (!reclaimerThread.joinable())
+        {
+            reclaimerThread = thread(&StoreReloader::runReclaimer, this);
+        }
+    }
+    reclaimWake.notify_one();
+}
@@ -0,0 +1,608 @@
+#include "supermarket_simulator_program_3.h"
+#include <limits>
+/*********************************************************************
+File name: supermarket_simulator_program_3_restock.cpp
+
+Purpose:
+    Track which items are running out and plan, charge and apply
+    restock orders.
+
+Notes:
+    - Cover is the stock on the shelf over the units sold since the
+      tracker started, so it counts in the days the sales cover and
+      comes out in days once multiplied by RestockConfig.dObservedDays.
+      Items that have not sold have endless cover unless they are out.
+    - The tracker is an indexed binary min-heap over the catalog
+      entries. Each sale moves one item, so a checkout costs a few
+      sift steps instead of a rescan of the aisles, and the plan only
+      walks the part of the heap below the reorder point.
+    - The tracker is built on first use and lives in the Supermarket,
+      so loading a store or snapshot starts it again.
+    - Orders are charged at wholesale against the store funds and
+      journaled as one record.
+*********************************************************************/
+
+// Endless cover, for items that have stock and have not sold
+static const double dENDLESS_COVER = numeric_limits<double>::infinity();
+
+// Restocks touching more than this share of the items rebuild the
+// heap in one pass instead of sifting each item
+static const size_t iREBUILD_DIVISOR = 8;
+
+/*********************************************************************
+static double itemCover(const Item& item, long long lSold)
+Purpose:
+    Helper function to work out how long an item's stock lasts
+Parameters:
+    I   Item item           Item on the shelf
+    I   long long lSold     Units sold since tracking began
+Return Value:
+    Stock over units sold, 0 if out, endless if never sold
+Notes:
+    -
+*********************************************************************/
+static double itemCover(const Item& item, long long lSold)
+{
+    if (item.iQuantity <= 0)
+    {
+        return 0.0;
+    }
+    if (lSold <= 0)
+    {
+        return dENDLESS_COVER;
+    }
+    return (double)item.iQuantity / (double)lSold;
+}
+
+/*********************************************************************
+static const Item& entryItem(const Supermarket& myStore, uint32_t iEntry)
+Purpose:
+    Helper function to find the item behind a catalog entry
+Parameters:
+    I   Supermarket myStore     Populated Supermarket info
+    I   uint32_t iEntry         Catalog entry number
+Return Value:
+    Item on its aisle
+Notes:
+    -
+*********************************************************************/
+static const Item& entryItem(const Supermarket& myStore, uint32_t iEntry)
+{
+    const ItemLocation& location = myStore.catalog.entriesVec[iEntry].location;
+    return myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex];
+}
+
+/*********************************************************************
+static void placeNode(RestockTracker& tracker, size_t iPosition, const RestockHeapNode& node)
+Purpose:
+    Helper function to put a node at a heap position
+Parameters:
+    I/O RestockTracker& tracker     Tracker to update
+    I   size_t iPosition            Heap position
+    I   RestockHeapNode node        Node to place
+Return Value:
+    -
+Notes:
+    Keeps the position table in step with the heap
+*********************************************************************/
+static void placeNode(RestockTracker& tracker, size_t iPosition, const RestockHeapNode& node)
+{
+    tracker.heapVec[iPosition] = node;
+    tracker.positionVec[node.iEntry] = (uint32_t)iPosition;
+}
+
+/*********************************************************************
+static void siftUp(RestockTracker& tracker, size_t iPosition)
+Purpose:
+    Helper function to move a node up until its parent has less cover
+Parameters:
+    I/O RestockTracker& tracker     Tracker to update
+    I   size_t iPosition            Heap position of the node
+Return Value:
+    -
+Notes:
+    Holes are moved instead of swapping, one write per level
+*********************************************************************/
+static void siftUp(RestockTracker& tracker, size_t iPosition)
+{
+    RestockHeapNode node = tracker.heapVec[iPosition];
+    while (iPosition > 0)
+    {
+        size_t iParent = (iPosition - 1) / 2;
+        if (tracker.heapVec[iParent].dCover <= node.dCover)
+        {
+            break;
+        }
+        placeNode(tracker, iPosition, tracker.heapVec[iParent]);
+        iPosition = iParent;
+    }
+    placeNode(tracker, iPosition, node);
+}
+
+/*********************************************************************
+static void siftDown(RestockTracker& tracker, size_t iPosition)
+Purpose:
+    Helper function to move a node down until its children have more
+    cover
+Parameters:
+    I/O RestockTracker& tracker     Tracker to update
+    I   size_t iPosition            Heap position of the node
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void siftDown(RestockTracker& tracker, size_t iPosition)
+{
+    size_t iSize = tracker.heapVec.size();
+    RestockHeapNode node = tracker.heapVec[iPosition];
+    while (true)
+    {
+        size_t iChild = 2 * iPosition + 1;
+        if (iChild >= iSize)
+        {
+            break;
+        }
+        if (iChild + 1 < iSize && tracker.heapVec[iChild + 1].dCover < tracker.heapVec[iChild].dCover)
+        {
+            iChild++;
+        }
+        if (node.dCover <= tracker.heapVec[iChild].dCover)
+        {
+            break;
+        }
+        placeNode(tracker, iPosition, tracker.heapVec[iChild]);
+        iPosition = iChild;
+    }
+    placeNode(tracker, iPosition, node);
+}
+
+/*********************************************************************
+static void rebuildHeap(Supermarket& myStore)
+Purpose:
+    Helper function to recompute every item's cover and reorder the heap
+Parameters:
+    I/O Supermarket& myStore    Store whose tracker is rebuilt
+Return Value:
+    -
+Notes:
+    Bottom-up heap construction, linear in the number of items
+*********************************************************************/
+static void rebuildHeap(Supermarket& myStore)
+{
+    RestockTracker& tracker = myStore.restock;
+    tracker.bHeapStale = false;
+    for (size_t i = 0; i < tracker.heapVec.size(); i++)
+    {
+        RestockHeapNode& node = tracker.heapVec[i];
+        node.dCover = itemCover(entryItem(myStore, node.iEntry), tracker.soldVec[node.iEntry]);
+        tracker.positionVec[node.iEntry] = (uint32_t)i;
+    }
+    for (size_t i = tracker.heapVec.size() / 2; i-- > 0; )
+    {
+        siftDown(tracker, i);
+    }
+}
+
+/*********************************************************************
+static void resetTracker(RestockTracker& tracker, size_t iEntries)
+Purpose:
+    Helper function to size a tracker with no sales, one node per entry
+Parameters:
+    O   RestockTracker& tracker     Tracker to reset
+    I   size_t iEntries             Catalog entries in the store
+Return Value:
+    -
+Notes:
+    The heap is left for rebuildHeap to order
+*********************************************************************/
+static void resetTracker(RestockTracker& tracker, size_t iEntries)
+{
+    tracker.heapVec.resize(iEntries);
+    tracker.positionVec.assign(iEntries, 0);
+    tracker.soldVec.assign(iEntries, 0);
+    for (size_t i = 0; i < iEntries; i++)
+    {
+        tracker.heapVec[i].iEntry = (uint32_t)i;
+    }
+}
+
+/*********************************************************************
+static RestockTracker& restockTracker(Supermarket& myStore)
+Purpose:
+    Helper function to get the store's tracker, building it on first use
+Parameters:
+    I/O Supermarket& myStore    Populated Supermarket info
+Return Value:
+    Tracker with one node per catalog entry
+Notes:
+    The heap may be stale after a reload, see bHeapStale
+*********************************************************************/
+static RestockTracker& restockTracker(Supermarket& myStore)
+{
+    RestockTracker& tracker = myStore.restock;
+    size_t iEntries = myStore.catalog.entriesVec.size();
+    if (tracker.positionVec.size() != iEntries)
+    {
+        resetTracker(tracker, iEntries);
+        rebuildHeap(myStore);
+    }
+    return tracker;
+}
+
+/*********************************************************************
+static void updateCover(Supermarket& myStore, uint32_t iEntry)
+Purpose:
+    Helper function to recompute one item's cover and move it in the heap
+Parameters:
+    I/O Supermarket& myStore    Store whose tracker is updated
+    I   uint32_t iEntry         Catalog entry of the item
+Return Value:
+    -
+Notes:
+    Skipped while the heap is stale, the rebuild will pick it up
+*********************************************************************/
+static void updateCover(Supermarket& myStore, uint32_t iEntry)
+{
+    RestockTracker& tracker = myStore.restock;
+    if (tracker.bHeapStale)
+    {
+        return;
+    }
+    size_t iPosition = tracker.positionVec[iEntry];
+    double dOldCover = tracker.heapVec[iPosition].dCover;
+    double dNewCover = itemCover(entryItem(myStore, iEntry), tracker.soldVec[iEntry]);
+    tracker.heapVec[iPosition].dCover = dNewCover;
+    if (dNewCover < dOldCover)
+    {
+        siftUp(tracker, iPosition);
+    }
+    else if (dNewCover > dOldCover)
+    {
+        siftDown(tracker, iPosition);
+    }
+}
+
+/*********************************************************************
+void recordRestockSale(Supermarket& myStore, int iSKU, int iQuantity)
+Purpose:
+    Function to count a sale against an item's cover
+Parameters:
+    I/O Supermarket& myStore    Store the item was sold from
+    I   int iSKU                SKU of the item sold
+    I   int iQuantity           Units sold, already taken off the shelf
+Return Value:
+    -
+Notes:
+    Unknown SKUs are ignored
+*********************************************************************/
+void recordRestockSale(Supermarket& myStore, int iSKU, int iQuantity)
+{
+    int iEntry = findCatalogEntry(myStore, iSKU);
+    if (iEntry < 0)
+    {
+        return;
+    }
+    RestockTracker& tracker = restockTracker(myStore);
+    tracker.soldVec[iEntry] += iQuantity;
+    updateCover(myStore, (uint32_t)iEntry);
+}
+
+/*********************************************************************
+void recordRestockSales(Supermarket& myStore, const CheckoutSession& session)
+Purpose:
+    Function to count every line of a checkout against item cover
+Parameters:
+    I/O Supermarket& myStore        Store the checkout was made against
+    I   CheckoutSession session     Finished checkout session
+Return Value:
+    -
+Notes:
+    Not safe to call from several lanes at once, lanes keep their
+    sales and record them after they finish
+*********************************************************************/
+void recordRestockSales(Supermarket& myStore, const CheckoutSession& session)
+{
+    for (const StockChange& change : session.takenVec)
+    {
+        recordRestockSale(myStore, change.iSKU, change.iQuantity);
+    }
+}
+
+/*********************************************************************
+void carryRestockSales(Supermarket& newStore, const Supermarket& oldStore, const vector<int>& oldEntryVec)
+Purpose:
+    Function to carry the units sold per item over to a reloaded store
+Parameters:
+    I/O Supermarket& newStore   Store replacing oldStore
+    I   Supermarket oldStore    Store being replaced
+    I   vector<int> oldEntryVec Old catalog entry of each new entry, -1 for none
+Return Value:
+    -
+Notes:
+    Nothing is built if the old store never tracked sales. The heap is
+    only marked stale, so the swap costs one pass over the entries and
+    the heap is rebuilt when restock is next planned.
+*********************************************************************/
+void carryRestockSales(Supermarket& newStore, const Supermarket& oldStore, const vector<int>& oldEntryVec)
+{
+    const RestockTracker& oldTracker = oldStore.restock;
+    if (oldTracker.soldVec.empty())
+    {
+        return;
+    }
+
+    RestockTracker& tracker = newStore.restock;
+    resetTracker(tracker, newStore.catalog.entriesVec.size());
+    for (size_t i = 0; i < oldEntryVec.size() && i < tracker.soldVec.size(); i++)
+    {
+        if (oldEntryVec[i] >= 0 && (size_t)oldEntryVec[i] < oldTracker.soldVec.size())
+        {
+            tracker.soldVec[i] = oldTracker.soldVec[oldEntryVec[i]];
+        }
+    }
+    tracker.bHeapStale = true;
+}
+
+/*********************************************************************
+bool receiveRestock(Supermarket& myStore, int iSKU, int iQuantity)
+Purpose:
+    Function to put delivered stock on the shelf
+Parameters:
+    I/O Supermarket& myStore    Store receiving the stock
+    I   int iSKU                SKU of the item
+    I   int iQuantity           Units delivered
+Return Value:
+    True if the item exists, else false
+Notes:
+    Does not charge or journal, see applyRestock
+*********************************************************************/
+bool receiveRestock(Supermarket& myStore, int iSKU, int iQuantity)
+{
+    int iEntry = findCatalogEntry(myStore, iSKU);
+    if (iEntry < 0)
+    {
+        return false;
+    }
+    restockTracker(myStore);
+    const ItemLocation& location = myStore.catalog.entriesVec[iEntry].location;
+    myStore.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex].iQuantity += iQuantity;
+    updateCover(myStore, (uint32_t)iEntry);
+    return true;
+}
+
+/*********************************************************************
+RestockPlan planRestock(Supermarket& myStore, const RestockConfig& config)
+Purpose:
+    Function to list the items below the reorder point and how many
+    of each to order
+Parameters:
+    I/O Supermarket& myStore    Store to plan for, its tracker is built if needed
+    I   RestockConfig config    Reorder point, target cover and limits
+Return Value:
+    Order lines, lowest cover first, with the units and cost
+Notes:
+    Only the heap nodes below the reorder point are visited, since a
+    node's children never have less cover. Lines past the line limit,
+    or that the funds cannot cover after the lines before them, are
+    left out and counted.
+*********************************************************************/
+RestockPlan planRestock(Supermarket& myStore, const RestockConfig& config)
+{
+    auto tStart = chrono::steady_clock::now();
+    RestockPlan plan;
+    RestockTracker& tracker = restockTracker(myStore);
+    if (tracker.bHeapStale)
+    {
+        rebuildHeap(myStore);
+    }
+    double dObservedDays = max(config.dObservedDays, 1e-9);
+    double dReorderCover = config.dReorderDays / dObservedDays;
+
+    // Collect every node below the reorder point
+    vector<RestockHeapNode> lowVec;
+    vector<size_t> pendingVec;
+    if (!tracker.heapVec.empty())
+    {
+        pendingVec.push_back(0);
+    }
+    while (!pendingVec.empty())
+    {
+        size_t iPosition = pendingVec.back();
+        pendingVec.pop_back();
+        if (iPosition >= tracker.heapVec.size() || tracker.heapVec[iPosition].dCover >= dReorderCover)
+        {
+            continue;
+        }
+        lowVec.push_back(tracker.heapVec[iPosition]);
+        pendingVec.push_back(2 * iPosition + 1);
+        pendingVec.push_back(2 * iPosition + 2);
+    }
+    sort(lowVec.begin(), lowVec.end(), [](const RestockHeapNode& a, const RestockHeapNode& b)
+    {
+        return a.dCover < b.dCover || (a.dCover == b.dCover && a.iEntry < b.iEntry);
+    });
+
+    Money mAvailable = myStore.mTotalFunds;
+    for (const RestockHeapNode& node : lowVec)
+    {
+        const CatalogEntry& entry = myStore.catalog.entriesVec[node.iEntry];
+        const Item& item = entryItem(myStore, node.iEntry);
+
+        // Units to reach the target cover at the observed daily rate
+        double dDailyUnits = (double)tracker.soldVec[node.iEntry] / dObservedDays;
+        long long lTarget = max((long long)ceil(dDailyUnits * config.dTargetDays - 1e-9), (long long)config.iMinStock);
+        long long lOrder = lTarget - item.iQuantity;
+        if (lOrder <= 0)
+        {
+            continue;
+        }
+
+        RestockLine line;
+        line.iSKU = entry.iSKU;
+        line.location = entry.location;
+        line.iQuantity = (int)min<long long>(lOrder, INT32_MAX);
+        line.dCoverDays = node.dCover * dObservedDays;
+        line.mCost = item.mWholesale * line.iQuantity;
+
+        if ((config.iMaxLines > 0 && (int)plan.linesVec.size() >= config.iMaxLines) ||
+            (config.bWithinFunds && line.mCost > mAvailable))
+        {
+            plan.lDroppedLines += 1;
+            continue;
+        }
+        mAvailable -= line.mCost;
+        plan.lUnits += line.iQuantity;
+        plan.mCost += line.mCost;
+        plan.linesVec.push_back(line);
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - tStart;
+    plan.dPlanSeconds = elapsed.count();
+    return plan;
+}
+
+/*********************************************************************
+bool applyRestock(Supermarket& myStore, const RestockPlan& plan)
+Purpose:
+    Function to charge a restock order and put the stock on the shelves
+Parameters:
+    I/O Supermarket& myStore    Store receiving the order
+    I   RestockPlan plan        Order from planRestock on the same store
+Return Value:
+    True if the order was paid for and applied, false if the funds do
+    not cover it, in which case nothing changes
+Notes:
+    Large orders rebuild the tracker heap in one pass instead of
+    moving each item. The order is journaled as one record.
+*********************************************************************/
+bool applyRestock(Supermarket& myStore, const RestockPlan& plan)
+{
+    if (plan.mCost > myStore.mTotalFunds)
+    {
+        return false;
+    }
+
+    RestockTracker& tracker = restockTracker(myStore);
+    bool bRebuild = tracker.bHeapStale || plan.linesVec.size() > tracker.heapVec.size() / iREBUILD_DIVISOR;
+    for (const RestockLine& line : plan.linesVec)
+    {
+        myStore.aislesVec[line.location.iAisleIndex].itemVec[line.location.iItemIndex].iQuantity += line.iQuantity;
+        if (!bRebuild)
+        {
+            updateCover(myStore, (uint32_t)findCatalogEntry(myStore, line.iSKU));
+        }
+    }
+    if (bRebuild)
+    {
+        rebuildHeap(myStore);
+    }
+
+    myStore.mTotalFunds -= plan.mCost;
+    journalRestock(myStore, plan);
+    return true;
+}
+
+/*********************************************************************
+void displayRestockPlan(const RestockPlan& plan, int iMaxLines)
+Purpose:
+    Function to display a restock order
+Parameters:
+    I   RestockPlan plan    Order from planRestock
+    I   int iMaxLines       Most lines to list, the totals cover them all
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayRestockPlan(const RestockPlan& plan, int iMaxLines)
+{
+    cout << "Restock Plan" << endl;
+    cout << szBreakMessage;
+    cout << left << setw(10) << "SKU" << setw(8) << "Aisle" << setw(12) << "Cover days"
+         << setw(10) << "Order" << "Cost" << right << endl;
+    for (size_t i = 0; i < plan.linesVec.size() && (int)i < iMaxLines; i++)
+    {
+        const RestockLine& line = plan.linesVec[i];
+        cout << left << setw(10) << line.iSKU << setw(8) << line.location.iAisleIndex
+             << setw(12) << line.dCoverDays << setw(10) << line.iQuantity << "$" << line.mCost << right << endl;
+    }
+    if ((int)plan.linesVec.size() > iMaxLines)
+    {
+        cout << "... " << plan.linesVec.size() - iMaxLines << " more lines" << endl;
+    }
+    cout << szBreakMessage;
+    cout << "Lines: " << plan.linesVec.size() << ", units: " << plan.lUnits << ", cost: $" << plan.mCost << endl;
+    if (plan.lDroppedLines > 0)
+    {
+        cout << "Lines left out for the line limit or funds: " << plan.lDroppedLines << endl;
+    }
+    cout << "Plan ms: " << setprecision(3) << plan.dPlanSeconds * 1000.0 << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+void processRestock(Supermarket& myStore)
+Purpose:
+    Function to prompt for the reorder point and target cover, show
+    the order and apply it if confirmed
+Parameters:
+    I/O Supermarket& myStore    Store to restock
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processRestock(Supermarket& myStore)
+{
+    RestockConfig config;
+    char cApply = 'n';
+
+    cout << "Enter trading days the sales so far cover: ";
+    if (!(cin >> config.dObservedDays) || config.dObservedDays <= 0)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid number of days." << endl;
+        return;
+    }
+    cout << "Reorder items with fewer days of cover than: ";
+    if (!(cin >> config.dReorderDays) || config.dReorderDays <= 0)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid number of days." << endl;
+        return;
+    }
+    cout << "Order enough for how many days: ";
+    if (!(cin >> config.dTargetDays) || config.dTargetDays < config.dReorderDays)
+    {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid number of days." << endl;
+        return;
+    }
+
+    RestockPlan plan = planRestock(myStore, config);
+    displayRestockPlan(plan, 20);
+    if (plan.linesVec.empty())
+    {
+        cout << "Nothing to restock." << endl;
+        return;
+    }
+
+    cout << "Apply restock? (y/n): ";
+    cin >> cApply;
+    if (cApply != 'y' && cApply != 'Y')
+    {
+        return;
+    }
+    if (applyRestock(myStore, plan))
+    {
+        cout << "Restocked " << plan.lUnits << " units for $" << plan.mCost << endl;
+    }
+    else
+    {
+        cout << "Insufficient funds" << endl;
+    }
+}
@@ -0,0 +1,235 @@
+#include "supermarket_simulator_program_3.h"
+#include <ctime>
+/*********************************************************************
+File name: supermarket_simulator_program_3_sales.cpp
+
+Purpose:
+    Running sales totals for the store, updated once per committed
+    checkout so reports never rescan the purchase list.
+
+Notes:
+    - Totals are kept for gross sales, tax, membership fees, cost of
+      goods and profit, plus buckets by hour of day and by aisle.
+    - Checkout lanes hand each committed sale to the ledger thread,
+      which is the only thread that updates the totals, like the funds.
+    - The journal records the hour and line prices of each checkout,
+      so replay rebuilds the same totals.
+*********************************************************************/
+
+/*********************************************************************
+int currentHourOfDay()
+Purpose:
+    Function to find the local hour of the day
+Parameters:
+    -
+Return Value:
+    Hour from 0 to 23
+Notes:
+    The hour is worked out once per hour per thread, every other call
+    only reads the clock
+*********************************************************************/
+int currentHourOfDay()
+{
+    thread_local time_t tNextHour = 0;
+    thread_local int iHour = 0;
+
+    time_t tNow = time(nullptr);
+    if (tNow >= tNextHour)
+    {
+        tm localNow;
+        localtime_r(&tNow, &localNow);
+        iHour = localNow.tm_hour;
+        tNextHour = tNow + (59 - localNow.tm_min) * 60 + (60 - localNow.tm_sec);
+    }
+    return iHour;
+}
+
+/*********************************************************************
+int currentDayNumber()
+Purpose:
+    Function to number the local calendar day
+Parameters:
+    -
+Return Value:
+    Days since 1 Jan 1970 in local time
+Notes:
+    Worked out once per day per thread like currentHourOfDay
+*********************************************************************/
+int currentDayNumber()
+{
+    thread_local time_t tNextDay = 0;
+    thread_local int iDay = 0;
+
+    time_t tNow = time(nullptr);
+    if (tNow >= tNextDay)
+    {
+        tm localNow;
+        localtime_r(&tNow, &localNow);
+        time_t tLocal = tNow + localNow.tm_gmtoff;
+        iDay = (int)(tLocal / 86400);
+        tNextDay = tNow + (86400 - tLocal % 86400);
+    }
+    return iDay;
+}
+
+/*********************************************************************
+void recordCheckoutSales(SalesAggregates& sales, const CheckoutSession& session,
+                         Money mMembershipFee, int iHour)
+Purpose:
+    Function to add a finished checkout to the running sales totals
+Parameters:
+    I/O SalesAggregates& sales      Totals to update
+    I   CheckoutSession session     Finished checkout session
+    I   Money mMembershipFee        Fee paid if the customer joined
+    I   int iHour                   Hour of day the checkout was committed
+Return Value:
+    -
+Notes:
+    Cost is one pass over the lines of this checkout only
+*********************************************************************/
+void recordCheckoutSales(SalesAggregates& sales, const CheckoutSession& session,
+                         Money mMembershipFee, int iHour)
+{
+    const CustomerPurchase& purchase = session.purchase;
+    Money mFee = purchase.bBoughtMembership ? mMembershipFee : Money();
+
+    SalesBucket& hour = sales.hourArr[iHour];
+    for (const StockChange& change : session.takenVec)
+    {
+        if ((size_t)change.iAisleIndex >= sales.aisleVec.size())
+        {
+            sales.aisleVec.resize(change.iAisleIndex + 1);
+        }
+
+        Money mSales = change.mPrice * change.iQuantity;
+        Money mCost = change.mWholesale * change.iQuantity;
+        SalesBucket& aisle = sales.aisleVec[change.iAisleIndex];
+        aisle.lCount += 1;
+        aisle.lItems += change.iQuantity;
+        aisle.mSales += mSales;
+        aisle.mProfit += mSales - mCost;
+
+        hour.lItems += change.iQuantity;
+        hour.mSales += mSales;
+        hour.mProfit += mSales - mCost;
+        sales.mCostOfGoods += mCost;
+    }
+    hour.lCount += 1;
+
+    sales.lCheckouts += 1;
+    sales.lItems += purchase.iNumberItems;
+    sales.mGrossSales += purchase.mPurchaseCost;
+    sales.mTaxCollected += purchase.mPurchaseCost - session.mCartTotal;
+    sales.mMembershipFees += mFee;
+    sales.mProfit += session.mProfit + mFee;
+}
+
+/*********************************************************************
+static void mergeSalesBucket(SalesBucket& target, const SalesBucket& source)
+Purpose:
+    Helper function to add one bucket to another
+Parameters:
+    I/O SalesBucket& target     Bucket to add to
+    I   SalesBucket source      Bucket to add
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void mergeSalesBucket(SalesBucket& target, const SalesBucket& source)
+{
+    target.lCount += source.lCount;
+    target.lItems += source.lItems;
+    target.mSales += source.mSales;
+    target.mProfit += source.mProfit;
+}
+
+/*********************************************************************
+void mergeSalesAggregates(SalesAggregates& target, const SalesAggregates& source)
+Purpose:
+    Function to add one set of sales totals to another
+Parameters:
+    I/O SalesAggregates& target     Totals to add to
+    I   SalesAggregates source      Totals to add, such as one lane's
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void mergeSalesAggregates(SalesAggregates& target, const SalesAggregates& source)
+{
+    target.lCheckouts += source.lCheckouts;
+    target.lItems += source.lItems;
+    target.mGrossSales += source.mGrossSales;
+    target.mTaxCollected += source.mTaxCollected;
+    target.mMembershipFees += source.mMembershipFees;
+    target.mCostOfGoods += source.mCostOfGoods;
+    target.mProfit += source.mProfit;
+
+    for (int i = 0; i < 24; i++)
+    {
+        mergeSalesBucket(target.hourArr[i], source.hourArr[i]);
+    }
+    if (target.aisleVec.size() < source.aisleVec.size())
+    {
+        target.aisleVec.resize(source.aisleVec.size());
+    }
+    for (size_t i = 0; i < source.aisleVec.size(); i++)
+    {
+        mergeSalesBucket(target.aisleVec[i], source.aisleVec[i]);
+    }
+}
+
+/*********************************************************************
+void displaySalesAggregates(const Supermarket& myStore)
+Purpose:
+    Function to display the running sales totals with the hour and
+    aisle breakdowns
+Parameters:
+    I   Supermarket myStore   Populated Supermarket info
+Return Value:
+    -
+Notes:
+    Hours and aisles with no sales are left out.
+    This function should only be called by an employee.
+*********************************************************************/
+void displaySalesAggregates(const Supermarket& myStore)
+{
+    const SalesAggregates& sales = myStore.sales;
+
+    cout << myStore.szName << "'s Sales" << endl;
+    cout << szBreakMessage;
+    cout << "Checkouts: " << sales.lCheckouts << ", items sold: " << sales.lItems << endl;
+    cout << "Gross sales including tax: $" << sales.mGrossSales << endl;
+    cout << "Tax collected: $" << sales.mTaxCollected << endl;
+    cout << "Membership fees: $" << sales.mMembershipFees << endl;
+    cout << "Cost of goods: $" << sales.mCostOfGoods << endl;
+    cout << "Profit: $" << sales.mProfit << endl;
+    cout << szBreakMessage;
+
+    cout << left << setw(8) << "Hour" << setw(12) << "Checkouts" << setw(10) << "Items"
+         << setw(14) << "Sales" << "Profit" << right << endl;
+    for (int i = 0; i < 24; i++)
+    {
+        const SalesBucket& hour = sales.hourArr[i];
+        if (hour.lCount > 0)
+        {
+            cout << left << setw(8) << (to_string(i) + ":00") << setw(12) << hour.lCount << setw(10) << hour.lItems
+                 << setw(14) << hour.mSales << hour.mProfit << right << endl;
+        }
+    }
+    cout << szBreakMessage;
+
+    cout << left << setw(8) << "Aisle" << setw(12) << "Lines" << setw(10) << "Items"
+         << setw(14) << "Sales" << "Profit" << right << endl;
+    for (size_t i = 0; i < sales.aisleVec.size(); i++)
+    {
+        const SalesBucket& aisle = sales.aisleVec[i];
+        if (aisle.lCount > 0)
+        {
+            cout << left << setw(8) << i << setw(12) << aisle.lCount << setw(10) << aisle.lItems
+                 << setw(14) << aisle.mSales << aisle.mProfit << right << endl;
+        }
+    }
+    cout << szBreakMessage;
+}
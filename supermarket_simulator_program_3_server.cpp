@@ -0,0 +1,1060 @@
+#include "supermarket_simulator_program_3.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+/*********************************************************************
+File name: supermarket_simulator_program_3_server.cpp
+
+Purpose:
+    Point of sale server for many register terminals at once, and a
+    load generator that plays thousands of terminals against it.
+
+Notes:
+    - One thread runs an epoll loop over non-blocking sockets. Each
+      terminal is a state machine that steps once per line it sends,
+      so a slow customer never holds up the others.
+    - Terminals get the customer menu and the interactive checkout
+      prompts, built with the same render functions and run through
+      the same checkout engine as the console.
+    - Only the loop thread touches the store, so no locks are needed.
+      Commits are journaled like any other checkout.
+    - Stock taken by a terminal that hangs up mid-checkout is put back.
+      A membership asked for at checkout is only signed up on commit,
+      and its fee dropped if another terminal signed the name up first.
+    - Addresses are a TCP port on 127.0.0.1, or unix:<path> for a Unix
+      domain socket.
+    - A reload of the store file is loaded on another thread and swapped
+      in between events, so terminals keep checking out while it loads.
+*********************************************************************/
+
+// Longest line a terminal may send
+static const size_t iMAX_LINE_BYTES = 4096;
+
+// Unsent reply bytes at which a terminal's input is left unread
+static const size_t iMAX_PENDING_REPLY = 64 * 1024;
+
+// Events taken from epoll per wait
+static const int iEPOLL_EVENTS = 256;
+
+// Seconds without a reply before a load run gives up
+static const double dLOAD_STALL_SECONDS = 10.0;
+
+// How often the loops check their stop flag
+static const int iPOLL_MILLISECONDS = 100;
+
+// Customer menu shown on a register terminal
+static const string szREGISTER_MENU_ARR[5] = {
+    "Display supermarket information",
+    "Display aisle information",
+    "Display aisle items",
+    "Checkout",
+    "Exit program"
+};
+
+enum TerminalState
+{
+    TERMINAL_MENU,              // Waiting for a menu choice
+    TERMINAL_VIEW_AISLE,        // Waiting for an aisle to list
+    TERMINAL_NAME,              // Waiting for the customer's name
+    TERMINAL_MEMBERSHIP,        // Waiting for y/n to a membership
+    TERMINAL_AISLE,             // Waiting for an aisle to buy from, -1 to pay
+    TERMINAL_ITEM,              // Waiting for an item name
+    TERMINAL_QUANTITY           // Waiting for a quantity
+};
+
+struct RegisterTerminal
+{
+    int iFd = -1;                           // Socket of the terminal
+    TerminalState eState = TERMINAL_MENU;
+    string szInput;                         // Bytes read, not yet a whole line
+    string szReply;                         // Bytes waiting to be sent
+    size_t iReplySent = 0;                  // Bytes of szReply already sent
+    bool bWantsOutput = false;              // Registered for EPOLLOUT
+    bool bClosing = false;                  // Close once the reply is sent
+    bool bInCheckout = false;               // Session holds stock to put back
+    CheckoutSession session;                // Open checkout
+    bool bSignUp = false;                   // Sign the customer up on commit
+    int iAisleIndex = -1;                   // Aisle the item is being bought from
+    string szItemName;                      // Item being bought
+};
+
+/*********************************************************************
+static bool parseAddress(const string& szAddress, sockaddr_storage& address, socklen_t& iLength)
+Purpose:
+    Helper function to turn an address argument into a socket address
+Parameters:
+    I   string szAddress            Port number, or unix:<path>
+    O   sockaddr_storage& address   Socket address
+    O   socklen_t& iLength          Bytes of address in use
+Return Value:
+    True if the address could be parsed, else false
+Notes:
+    TCP ports are bound and connected on 127.0.0.1 only
+*********************************************************************/
+static bool parseAddress(const string& szAddress, sockaddr_storage& address, socklen_t& iLength)
+{
+    memset(&address, 0, sizeof(address));
+    if (szAddress.compare(0, 5, "unix:") == 0)
+    {
+        sockaddr_un* pUnix = reinterpret_cast<sockaddr_un*>(&address);
+        string szPath = szAddress.substr(5);
+        if (szPath.empty() || szPath.size() >= sizeof(pUnix->sun_path))
+        {
+            return false;
+        }
+        pUnix->sun_family = AF_UNIX;
+        memcpy(pUnix->sun_path, szPath.c_str(), szPath.size() + 1);
+        iLength = (socklen_t)(offsetof(sockaddr_un, sun_path) + szPath.size() + 1);
+        return true;
+    }
+
+    char* pEnd = nullptr;
+    long lPort = strtol(szAddress.c_str(), &pEnd, 10);
+    if (szAddress.empty() || *pEnd != '\0' || lPort <= 0 || lPort > 65535)
+    {
+        return false;
+    }
+    sockaddr_in* pInet = reinterpret_cast<sockaddr_in*>(&address);
+    pInet->sin_family = AF_INET;
+    pInet->sin_port = htons((uint16_t)lPort);
+    pInet->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    iLength = sizeof(sockaddr_in);
+    return true;
+}
+
+/*********************************************************************
+static string checkoutPrompt(const Supermarket& myStore, CheckoutSession& session)
+Purpose:
+    Helper function to build the cart total and aisle prompt
+Parameters:
+    I   Supermarket myStore         Populated Supermarket info
+    I/O CheckoutSession& session    Open checkout, priced for the total
+Return Value:
+    Screen text
+Notes:
+    Same screen the console checkout shows between items
+*********************************************************************/
+static string checkoutPrompt(const Supermarket& myStore, CheckoutSession& session)
+{
+    priceCheckout(session);
+    return "\nCurrent cart total: " + formatMoney(session.mCartTotal) + "\n\n" + renderAisles(myStore) +
+           "Please enter aisle index (-1 to exit): ";
+}
+
+/*********************************************************************
+static string menuPrompt()
+Purpose:
+    Helper function to build the register menu and choice prompt
+Parameters:
+    -
+Return Value:
+    Screen text
+Notes:
+    -
+*********************************************************************/
+static string menuPrompt()
+{
+    return renderMenu("\nMenu", szREGISTER_MENU_ARR, 5) + "\nEnter choice: ";
+}
+
+/*********************************************************************
+static bool parseInteger(const string& szLine, int& iValue)
+Purpose:
+    Helper function to read a whole number typed at a terminal
+Parameters:
+    I   string szLine       Line typed
+    O   int& iValue         Number read
+Return Value:
+    True if the line held only a number, else false
+Notes:
+    -
+*********************************************************************/
+static bool parseInteger(const string& szLine, int& iValue)
+{
+    const char* pStart = szLine.c_str();
+    char* pEnd = nullptr;
+    long lValue = strtol(pStart, &pEnd, 10);
+    while (*pEnd == ' ' || *pEnd == '\t')
+    {
+        pEnd++;
+    }
+    if (pEnd == pStart || *pEnd != '\0')
+    {
+        return false;
+    }
+    iValue = (int)lValue;
+    return true;
+}
+
+/*********************************************************************
+static void handleLine(Supermarket& myStore, RegisterTerminal& terminal, const string& szLine,
+                       PosServerStats& stats)
+Purpose:
+    Helper function to step a terminal with one line it sent
+Parameters:
+    I/O Supermarket& myStore            Shared store
+    I/O RegisterTerminal& terminal      Terminal that sent the line
+    I   string szLine                   Line without its newline
+    I/O PosServerStats& stats           Server counters
+Return Value:
+    -
+Notes:
+    Mirrors the console menu and checkout, every step ends with the
+    next prompt
+*********************************************************************/
+static void handleLine(Supermarket& myStore, RegisterTerminal& terminal, const string& szLine,
+                       PosServerStats& stats)
+{
+    STAT_SCOPE(STAT_SERVER_REQUEST);
+    stats.lRequests += 1;
+    string& szReply = terminal.szReply;
+    int iValue = 0;
+
+    switch (terminal.eState)
+    {
+        case TERMINAL_MENU:
+        {
+            if (!parseInteger(szLine, iValue))
+            {
+                szReply += "Please choose a valid menu choice\n" + menuPrompt();
+            }
+            else if (iValue == 1)
+            {
+                szReply += renderSupermarketInfo(myStore) + menuPrompt();
+            }
+            else if (iValue == 2)
+            {
+                szReply += renderAisles(myStore) + menuPrompt();
+            }
+            else if (iValue == 3)
+            {
+                szReply += renderAisles(myStore) + "Enter an aisle index you would like to view: ";
+                terminal.eState = TERMINAL_VIEW_AISLE;
+            }
+            else if (iValue == 4)
+            {
+                szReply += "Please enter your name: ";
+                terminal.eState = TERMINAL_NAME;
+            }
+            else if (iValue == -1)
+            {
+                szReply += "Goodbye\n";
+                terminal.bClosing = true;
+            }
+            else
+            {
+                szReply += "Please choose a valid menu choice\n" + menuPrompt();
+            }
+            break;
+        }
+
+        case TERMINAL_VIEW_AISLE:
+        {
+            szReply += renderItems(myStore, parseInteger(szLine, iValue) ? iValue : -1) + menuPrompt();
+            terminal.eState = TERMINAL_MENU;
+            break;
+        }
+
+        case TERMINAL_NAME:
+        {
+            bool bIsMember = isMember(myStore, szLine);
+            terminal.session = openCheckout(myStore, szLine, bIsMember, false);
+            terminal.bInCheckout = true;
+            terminal.bSignUp = false;
+            if (bIsMember)
+            {
+                szReply += "Welcome back " + szLine + "\n" + checkoutPrompt(myStore, terminal.session);
+                terminal.eState = TERMINAL_AISLE;
+            }
+            else
+            {
+                szReply += "Would you like to become a member (y/n)? ";
+                terminal.eState = TERMINAL_MEMBERSHIP;
+            }
+            break;
+        }
+
+        case TERMINAL_MEMBERSHIP:
+        {
+            if (!szLine.empty() && szLine[0] == 'y')
+            {
+                // Fee and member prices now, the sign-up itself on commit
+                terminal.session = openCheckout(myStore, terminal.session.purchase.szName, false, true);
+                terminal.bSignUp = true;
+            }
+            szReply += checkoutPrompt(myStore, terminal.session);
+            terminal.eState = TERMINAL_AISLE;
+            break;
+        }
+
+        case TERMINAL_AISLE:
+        {
+            if (!parseInteger(szLine, iValue))
+            {
+                szReply += "Invalid Aisle Index. Please try again.\n" + checkoutPrompt(myStore, terminal.session);
+            }
+            else if (iValue == -1)
+            {
+                if (terminal.bSignUp && !addMember(myStore, terminal.session.purchase.szName))
+                {
+                    // Another terminal signed the name up first, the fee is not owed twice
+                    terminal.session.purchase.bBoughtMembership = false;
+                    terminal.session.mCartTotal -= myStore.mMembershipFee;
+                }
+                CustomerPurchase purchase = commitCheckout(myStore, terminal.session);
+                terminal.bInCheckout = false;
+                stats.lCheckouts += 1;
+                szReply += "\nYour total is $" + formatMoney(purchase.mPurchaseCost) + "\n" + menuPrompt();
+                terminal.eState = TERMINAL_MENU;
+            }
+            else if (!isValidAisle(myStore, iValue))
+            {
+                szReply += "Invalid Aisle Index. Please try again.\n" + checkoutPrompt(myStore, terminal.session);
+            }
+            else
+            {
+                terminal.iAisleIndex = iValue;
+                szReply += renderItems(myStore, iValue) + "Enter item to buy: ";
+                terminal.eState = TERMINAL_ITEM;
+            }
+            break;
+        }
+
+        case TERMINAL_ITEM:
+        {
+            terminal.szItemName = szLine;
+            replace(terminal.szItemName.begin(), terminal.szItemName.end(), '_', ' ');
+            szReply += "Please enter valid quantity: ";
+            terminal.eState = TERMINAL_QUANTITY;
+            break;
+        }
+
+        case TERMINAL_QUANTITY:
+        {
+            CheckoutStatus status = CHECKOUT_INVALID_QUANTITY;
+            if (parseInteger(szLine, iValue))
+            {
+                status = addCheckoutLine(myStore, terminal.session, terminal.iAisleIndex, terminal.szItemName, iValue);
+            }
+            if (status == CHECKOUT_ITEM_NOT_FOUND)
+            {
+                szReply += "No item " + terminal.szItemName + " found.\n";
+            }
+            else if (status == CHECKOUT_OUT_OF_STOCK)
+            {
+                szReply += terminal.szItemName + " out of stock\n";
+            }
+            else if (status != CHECKOUT_OK)
+            {
+                szReply += "Invalid quantity.\n";
+            }
+            szReply += checkoutPrompt(myStore, terminal.session);
+            terminal.eState = TERMINAL_AISLE;
+            break;
+        }
+    }
+}
+
+/*********************************************************************
+static bool flushReply(RegisterTerminal& terminal)
+Purpose:
+    Helper function to send as much of a terminal's reply as the socket takes
+Parameters:
+    I/O RegisterTerminal& terminal  Terminal to send to
+Return Value:
+    False if the socket failed, else true
+Notes:
+    -
+*********************************************************************/
+static bool flushReply(RegisterTerminal& terminal)
+{
+    while (terminal.iReplySent < terminal.szReply.size())
+    {
+        ssize_t iSent = send(terminal.iFd, terminal.szReply.data() + terminal.iReplySent,
+                             terminal.szReply.size() - terminal.iReplySent, MSG_NOSIGNAL);
+        if (iSent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        terminal.iReplySent += (size_t)iSent;
+    }
+    terminal.szReply.clear();
+    terminal.iReplySent = 0;
+    return true;
+}
+
+/*********************************************************************
+static bool serviceTerminal(Supermarket& myStore, RegisterTerminal& terminal, bool bReadable,
+                            PosServerStats& stats)
+Purpose:
+    Helper function to read, step and reply to a terminal
+Parameters:
+    I/O Supermarket& myStore            Shared store
+    I/O RegisterTerminal& terminal      Terminal with an event
+    I   bool bReadable                  Socket has input or hung up
+    I/O PosServerStats& stats           Server counters
+Return Value:
+    False when the terminal should be closed, else true
+Notes:
+    Lines are only handled while the unsent reply is small, so a
+    terminal that stops reading cannot grow its reply without bound.
+    Only the unfinished line is held to iMAX_LINE_BYTES.
+*********************************************************************/
+static bool serviceTerminal(Supermarket& myStore, RegisterTerminal& terminal, bool bReadable,
+                            PosServerStats& stats)
+{
+    bool bHungUp = false;
+    if (bReadable)
+    {
+        char szBuffer[4096];
+        while (true)
+        {
+            ssize_t iRead = recv(terminal.iFd, szBuffer, sizeof(szBuffer), 0);
+            if (iRead > 0)
+            {
+                terminal.szInput.append(szBuffer, (size_t)iRead);
+                continue;
+            }
+            if (iRead == 0)
+            {
+                bHungUp = true;
+            }
+            else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                return false;
+            }
+            break;
+        }
+    }
+
+    // Step and flush in turns, so lines queued behind a full reply are
+    // handled once the socket takes it
+    while (true)
+    {
+        size_t iStart = 0;
+        while (!terminal.bClosing && terminal.szReply.size() < iMAX_PENDING_REPLY)
+        {
+            size_t iNewline = terminal.szInput.find('\n', iStart);
+            if (iNewline == string::npos)
+            {
+                break;
+            }
+            size_t iEnd = iNewline;
+            if (iEnd > iStart && terminal.szInput[iEnd - 1] == '\r')
+            {
+                iEnd--;
+            }
+            handleLine(myStore, terminal, terminal.szInput.substr(iStart, iEnd - iStart), stats);
+            iStart = iNewline + 1;
+        }
+        terminal.szInput.erase(0, iStart);
+
+        if (!flushReply(terminal))
+        {
+            return false;
+        }
+        if (terminal.bClosing || !terminal.szReply.empty() || terminal.szInput.find('\n') == string::npos)
+        {
+            break;
+        }
+    }
+
+    // Only the unfinished line counts, whole lines wait on the reply
+    size_t iLastNewline = terminal.szInput.rfind('\n');
+    size_t iPartial = terminal.szInput.size() - (iLastNewline == string::npos ? 0 : iLastNewline + 1);
+    if (iPartial > iMAX_LINE_BYTES)
+    {
+        return false;
+    }
+    if (terminal.szReply.empty() && (terminal.bClosing || bHungUp))
+    {
+        return false;
+    }
+    return true;
+}
+
+/*********************************************************************
+static int openListener(const string& szAddress)
+Purpose:
+    Helper function to bind and listen on the server address
+Parameters:
+    I   string szAddress        Port number, or unix:<path>
+Return Value:
+    Non-blocking listening socket, -1 on failure
+Notes:
+    A stale Unix socket file left by an earlier run is removed
+*********************************************************************/
+static int openListener(const string& szAddress)
+{
+    sockaddr_storage address;
+    socklen_t iLength = 0;
+    if (!parseAddress(szAddress, address, iLength))
+    {
+        cout << "Invalid address " << szAddress << endl;
+        return -1;
+    }
+
+    int iListenFd = socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (iListenFd < 0)
+    {
+        cout << "Could not open a socket: " << strerror(errno) << endl;
+        return -1;
+    }
+    if (address.ss_family == AF_UNIX)
+    {
+        unlink(reinterpret_cast<sockaddr_un*>(&address)->sun_path);
+    }
+    else
+    {
+        int iReuse = 1;
+        setsockopt(iListenFd, SOL_SOCKET, SO_REUSEADDR, &iReuse, sizeof(iReuse));
+    }
+    if (bind(iListenFd, reinterpret_cast<sockaddr*>(&address), iLength) != 0 || listen(iListenFd, SOMAXCONN) != 0)
+    {
+        cout << "Could not listen on " << szAddress << ": " << strerror(errno) << endl;
+        close(iListenFd);
+        return -1;
+    }
+    return iListenFd;
+}
+
+/*********************************************************************
+bool runPosServer(Supermarket& myStore, const string& szAddress, const atomic<bool>& bStop,
+                  atomic<bool>& bReload, const string& szStoreFile, PosServerStats& stats)
+Purpose:
+    Function to serve register terminals until asked to stop
+Parameters:
+    I/O Supermarket& myStore        Store the terminals check out against
+    I   string szAddress            Port number, or unix:<path>
+    I   atomic<bool>& bStop         Set to stop the server
+    I/O atomic<bool>& bReload       Set to reload szStoreFile, cleared when taken
+    I   string szStoreFile          Store file to reload from
+    O   PosServerStats& stats       Terminals, checkouts and requests served
+Return Value:
+    False if the server could not start, else true
+Notes:
+    Terminals still connected when the server stops are closed and
+    any checkout they had open is cancelled. Checkouts open across a
+    reload keep the prices of the lines already taken.
+*********************************************************************/
+bool runPosServer(Supermarket& myStore, const string& szAddress, const atomic<bool>& bStop,
+                  atomic<bool>& bReload, const string& szStoreFile, PosServerStats& stats)
+{
+    int iListenFd = openListener(szAddress);
+    if (iListenFd < 0)
+    {
+        return false;
+    }
+    bool bTcp = szAddress.compare(0, 5, "unix:") != 0;
+    int iEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event listenEvent = {};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = iListenFd;
+    epoll_ctl(iEpollFd, EPOLL_CTL_ADD, iListenFd, &listenEvent);
+
+    // Terminals by socket number, sockets are small and reused
+    vector<unique_ptr<RegisterTerminal>> terminalsVec;
+    long long lOpen = 0;
+    StoreReloader reloader;
+
+    auto closeTerminal = [&](RegisterTerminal& terminal)
+    {
+        if (terminal.bInCheckout)
+        {
+            cancelCheckout(myStore, terminal.session);
+            stats.lAbandoned += 1;
+        }
+        epoll_ctl(iEpollFd, EPOLL_CTL_DEL, terminal.iFd, nullptr);
+        close(terminal.iFd);
+        terminalsVec[terminal.iFd].reset();
+        lOpen -= 1;
+    };
+
+    epoll_event eventsArr[iEPOLL_EVENTS];
+    while (!bStop.load(memory_order_relaxed))
+    {
+        int iEvents = epoll_wait(iEpollFd, eventsArr, iEPOLL_EVENTS, iPOLL_MILLISECONDS);
+        for (int i = 0; i < iEvents; i++)
+        {
+            int iFd = eventsArr[i].data.fd;
+            if (iFd == iListenFd)
+            {
+                int iClientFd;
+                while ((iClientFd = accept4(iListenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                {
+                    if (bTcp)
+                    {
+                        int iNoDelay = 1;
+                        setsockopt(iClientFd, IPPROTO_TCP, TCP_NODELAY, &iNoDelay, sizeof(iNoDelay));
+                    }
+                    if ((size_t)iClientFd >= terminalsVec.size())
+                    {
+                        terminalsVec.resize((size_t)iClientFd + 1);
+                    }
+                    terminalsVec[iClientFd] = make_unique<RegisterTerminal>();
+                    RegisterTerminal& terminal = *terminalsVec[iClientFd];
+                    terminal.iFd = iClientFd;
+                    terminal.szReply = menuPrompt();
+
+                    epoll_event clientEvent = {};
+                    clientEvent.events = EPOLLIN | EPOLLRDHUP;
+                    clientEvent.data.fd = iClientFd;
+                    epoll_ctl(iEpollFd, EPOLL_CTL_ADD, iClientFd, &clientEvent);
+                    stats.lTerminals += 1;
+                    lOpen += 1;
+                    stats.lPeakTerminals = max(stats.lPeakTerminals, lOpen);
+                    if (!serviceTerminal(myStore, terminal, false, stats))
+                    {
+                        closeTerminal(terminal);
+                    }
+                }
+                continue;
+            }
+
+            if ((size_t)iFd >= terminalsVec.size() || !terminalsVec[iFd])
+            {
+                continue;
+            }
+            RegisterTerminal& terminal = *terminalsVec[iFd];
+            bool bReadable = (eventsArr[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+            if (!serviceTerminal(myStore, terminal, bReadable, stats))
+            {
+                closeTerminal(terminal);
+                continue;
+            }
+
+            // Wait for the socket to drain only while a reply or a line is left over
+            bool bWantsOutput = !terminal.szReply.empty() || terminal.szInput.find('\n') != string::npos;
+            if (bWantsOutput != terminal.bWantsOutput)
+            {
+                epoll_event clientEvent = {};
+                clientEvent.events = EPOLLIN | EPOLLRDHUP | (bWantsOutput ? (uint32_t)EPOLLOUT : 0u);
+                clientEvent.data.fd = iFd;
+                epoll_ctl(iEpollFd, EPOLL_CTL_MOD, iFd, &clientEvent);
+                terminal.bWantsOutput = bWantsOutput;
+            }
+        }
+
+        if (bReload.exchange(false, memory_order_relaxed) && !reloader.start(szStoreFile, myStore))
+        {
+            cout << "A reload is already running" << endl;
+        }
+        ReloadStats reloadStats;
+        auto remapTerminals = [&](const PreparedReload& reload)
+        {
+            // Open checkouts hold SKUs and aisles of the replaced catalog
+            for (unique_ptr<RegisterTerminal>& pTerminal : terminalsVec)
+            {
+                if (!pTerminal)
+                {
+                    continue;
+                }
+                if (pTerminal->bInCheckout)
+                {
+                    remapReloadedSession(reload, myStore, pTerminal->session);
+                }
+                if (pTerminal->eState == TERMINAL_ITEM || pTerminal->eState == TERMINAL_QUANTITY)
+                {
+                    pTerminal->iAisleIndex = remapReloadedAisle(reload, myStore, pTerminal->iAisleIndex);
+                }
+            }
+        };
+        if (reloader.poll(myStore, reloadStats, remapTerminals))
+        {
+            stats.lReloads += 1;
+            displayReloadStats(reloadStats);
+        }
+    }
+
+    for (unique_ptr<RegisterTerminal>& pTerminal : terminalsVec)
+    {
+        if (pTerminal)
+        {
+            closeTerminal(*pTerminal);
+        }
+    }
+    close(iEpollFd);
+    close(iListenFd);
+    if (szAddress.compare(0, 5, "unix:") == 0)
+    {
+        unlink(szAddress.c_str() + 5);
+    }
+    return true;
+}
+
+/*********************************************************************
+void displayPosServerStats(const PosServerStats& stats)
+Purpose:
+    Function to display what a server run handled
+Parameters:
+    I   PosServerStats stats    Server counters
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayPosServerStats(const PosServerStats& stats)
+{
+    cout << "Register Server" << endl;
+    cout << szBreakMessage;
+    cout << "Terminals served: " << stats.lTerminals << ", most at once: " << stats.lPeakTerminals << endl;
+    cout << "Requests: " << stats.lRequests << ", checkouts: " << stats.lCheckouts
+         << ", abandoned checkouts: " << stats.lAbandoned << endl;
+    cout << "Store reloads: " << stats.lReloads << endl;
+    cout << szBreakMessage;
+}
+
+struct LoadTerminal
+{
+    int iFd = -1;                               // Socket to the server
+    bool bConnected = false;                    // Connect has finished
+    bool bDone = false;                         // Script finished or failed
+    vector<string> scriptVec;                   // Lines to send, one per reply
+    size_t iStep = 0;                           // Next line of the script
+    string szInput;                             // Reply read so far
+    string szOutput;                            // Line not yet sent
+    chrono::steady_clock::time_point tSent;     // When the last line went out
+};
+
+/*********************************************************************
+static vector<string> buildTerminalScript(const vector<pair<int, string>>& itemsVec,
+                                          const PosLoadConfig& config, int iTerminal, mt19937_64& rng)
+Purpose:
+    Helper function to write what one terminal types
+Parameters:
+    I   vector<pair<int, string>> itemsVec  Aisle and name of every item
+    I   PosLoadConfig config                Baskets and lines per terminal
+    I   int iTerminal                       Terminal number, used in the name
+    I/O mt19937_64& rng                     Random source
+Return Value:
+    Lines to send in order
+Notes:
+    Every basket checks out one unit per line and the script ends by
+    leaving the menu, which closes the connection
+*********************************************************************/
+static vector<string> buildTerminalScript(const vector<pair<int, string>>& itemsVec,
+                                          const PosLoadConfig& config, int iTerminal, mt19937_64& rng)
+{
+    vector<string> scriptVec;
+    for (int iBasket = 0; iBasket < config.iBasketsPerTerminal; iBasket++)
+    {
+        scriptVec.push_back("4");
+        scriptVec.push_back("Terminal_" + to_string(iTerminal));
+        scriptVec.push_back("n");
+        int iLines = 1 + (int)(rng() % (uint64_t)max(config.iMaxBasketLines, 1));
+        for (int i = 0; i < iLines; i++)
+        {
+            const pair<int, string>& item = itemsVec[rng() % itemsVec.size()];
+            scriptVec.push_back(to_string(item.first));
+            scriptVec.push_back(item.second);
+            scriptVec.push_back("1");
+        }
+        scriptVec.push_back("-1");
+    }
+    scriptVec.push_back("-1");
+    return scriptVec;
+}
+
+/*********************************************************************
+static bool sendPending(LoadTerminal& terminal)
+Purpose:
+    Helper function to send what is left of a terminal's line
+Parameters:
+    I/O LoadTerminal& terminal  Terminal to send from
+Return Value:
+    False if the socket failed, else true
+Notes:
+    -
+*********************************************************************/
+static bool sendPending(LoadTerminal& terminal)
+{
+    while (!terminal.szOutput.empty())
+    {
+        ssize_t iSent = send(terminal.iFd, terminal.szOutput.data(), terminal.szOutput.size(), MSG_NOSIGNAL);
+        if (iSent < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        terminal.szOutput.erase(0, (size_t)iSent);
+    }
+    return true;
+}
+
+/*********************************************************************
+static double percentile(const vector<float>& sortedVec, double dFraction)
+Purpose:
+    Helper function to read a percentile from sorted samples
+Parameters:
+    I   vector<float> sortedVec     Samples in increasing order
+    I   double dFraction            Percentile as a fraction, 0.99 for p99
+Return Value:
+    Sample at the percentile, 0 when there are none
+Notes:
+    -
+*********************************************************************/
+static double percentile(const vector<float>& sortedVec, double dFraction)
+{
+    if (sortedVec.empty())
+    {
+        return 0.0;
+    }
+    size_t iIndex = min((size_t)(dFraction * (double)sortedVec.size()), sortedVec.size() - 1);
+    return sortedVec[iIndex];
+}
+
+/*********************************************************************
+PosLoadResult runPosLoad(const Supermarket& myStore, const PosLoadConfig& config)
+Purpose:
+    Function to play many register terminals against a server at once
+Parameters:
+    I   Supermarket myStore     Copy of the served store, for item names
+    I   PosLoadConfig config    Address, terminals and baskets
+Return Value:
+    Terminals finished, checkouts, request latency percentiles and time
+Notes:
+    All terminals connect at the start and run on one epoll loop. A
+    request's latency runs from sending a line to receiving the whole
+    prompt that answers it, every prompt ends in ": " or "? ". The run
+    gives up when nothing arrives for ten seconds.
+*********************************************************************/
+PosLoadResult runPosLoad(const Supermarket& myStore, const PosLoadConfig& config)
+{
+    PosLoadResult result;
+
+    sockaddr_storage address;
+    socklen_t iLength = 0;
+    if (!parseAddress(config.szAddress, address, iLength))
+    {
+        cout << "Invalid address " << config.szAddress << endl;
+        return result;
+    }
+
+    vector<pair<int, string>> itemsVec;
+    for (size_t iAisle = 0; iAisle < myStore.aislesVec.size(); iAisle++)
+    {
+        for (const Item& item : myStore.aislesVec[iAisle].itemVec)
+        {
+            if (!item.szName.empty())
+            {
+                itemsVec.push_back({(int)iAisle, item.szName});
+            }
+        }
+    }
+    if (itemsVec.empty())
+    {
+        cout << "The store has no items to buy" << endl;
+        return result;
+    }
+
+    mt19937_64 rng(config.lSeed);
+    vector<LoadTerminal> terminalsVec(max(config.iTerminals, 0));
+    for (size_t i = 0; i < terminalsVec.size(); i++)
+    {
+        terminalsVec[i].scriptVec = buildTerminalScript(itemsVec, config, (int)i, rng);
+    }
+
+    vector<float> latencyVec;
+    int iEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    size_t iNextConnect = 0;
+    size_t iFinished = 0;
+    auto tStart = chrono::steady_clock::now();
+    auto tLastProgress = tStart;
+
+    auto finishTerminal = [&](LoadTerminal& terminal, bool bFailed)
+    {
+        epoll_ctl(iEpollFd, EPOLL_CTL_DEL, terminal.iFd, nullptr);
+        close(terminal.iFd);
+        terminal.bDone = true;
+        iFinished += 1;
+        if (bFailed)
+        {
+            result.lErrors += 1;
+        }
+        else
+        {
+            result.lTerminals += 1;
+        }
+    };
+
+    epoll_event eventsArr[iEPOLL_EVENTS];
+    while (iFinished < terminalsVec.size())
+    {
+        // Open connections until the listen queue pushes back
+        while (iNextConnect < terminalsVec.size())
+        {
+            LoadTerminal& terminal = terminalsVec[iNextConnect];
+            terminal.iFd = socket(address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (terminal.iFd < 0)
+            {
+                break;
+            }
+            if (connect(terminal.iFd, reinterpret_cast<sockaddr*>(&address), iLength) != 0 && errno != EINPROGRESS)
+            {
+                close(terminal.iFd);
+                terminal.iFd = -1;
+                if (errno == EAGAIN || errno == ECONNREFUSED)
+                {
+                    break;
+                }
+                terminal.bDone = true;
+                iFinished += 1;
+                result.lErrors += 1;
+                iNextConnect++;
+                continue;
+            }
+            if (address.ss_family == AF_INET)
+            {
+                int iNoDelay = 1;
+                setsockopt(terminal.iFd, IPPROTO_TCP, TCP_NODELAY, &iNoDelay, sizeof(iNoDelay));
+            }
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+            event.data.u64 = iNextConnect;
+            epoll_ctl(iEpollFd, EPOLL_CTL_ADD, terminal.iFd, &event);
+            iNextConnect++;
+        }
+
+        int iEvents = epoll_wait(iEpollFd, eventsArr, iEPOLL_EVENTS, iPOLL_MILLISECONDS);
+        auto tNow = chrono::steady_clock::now();
+        if (iEvents > 0)
+        {
+            tLastProgress = tNow;
+        }
+        else if (chrono::duration<double>(tNow - tLastProgress).count() > dLOAD_STALL_SECONDS)
+        {
+            cout << "No replies for " << dLOAD_STALL_SECONDS << " seconds, stopping" << endl;
+            break;
+        }
+
+        for (int i = 0; i < iEvents; i++)
+        {
+            LoadTerminal& terminal = terminalsVec[eventsArr[i].data.u64];
+            if (terminal.bDone)
+            {
+                continue;
+            }
+
+            if (!terminal.bConnected)
+            {
+                int iError = 0;
+                socklen_t iErrorLength = sizeof(iError);
+                getsockopt(terminal.iFd, SOL_SOCKET, SO_ERROR, &iError, &iErrorLength);
+                if (iError != 0)
+                {
+                    finishTerminal(terminal, true);
+                    continue;
+                }
+                terminal.bConnected = true;
+                terminal.tSent = tNow;
+            }
+
+            bool bClosed = false;
+            char szBuffer[16384];
+            while (true)
+            {
+                ssize_t iRead = recv(terminal.iFd, szBuffer, sizeof(szBuffer), 0);
+                if (iRead > 0)
+                {
+                    terminal.szInput.append(szBuffer, (size_t)iRead);
+                    continue;
+                }
+                bClosed = iRead == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+                break;
+            }
+
+            // A whole prompt has arrived, time it and send the next line
+            size_t iInput = terminal.szInput.size();
+            if (iInput >= 2 && (terminal.szInput[iInput - 2] == ':' || terminal.szInput[iInput - 2] == '?') &&
+                terminal.szInput[iInput - 1] == ' ')
+            {
+                if (terminal.iStep > 0)
+                {
+                    float fMicros = chrono::duration<float, micro>(tNow - terminal.tSent).count();
+                    latencyVec.push_back(fMicros);
+                    result.lRequests += 1;
+                    if (terminal.scriptVec[terminal.iStep - 1] == "-1" &&
+                        terminal.szInput.find("Your total is") != string::npos)
+                    {
+                        result.lCheckouts += 1;
+                    }
+                }
+                terminal.szInput.clear();
+                if (terminal.iStep < terminal.scriptVec.size())
+                {
+                    terminal.szOutput = terminal.scriptVec[terminal.iStep++] + "\n";
+                    terminal.tSent = chrono::steady_clock::now();
+                }
+            }
+
+            if (!sendPending(terminal))
+            {
+                finishTerminal(terminal, true);
+                continue;
+            }
+            if (bClosed)
+            {
+                // The server hangs up after the last line of the script
+                finishTerminal(terminal, terminal.iStep < terminal.scriptVec.size() || !terminal.szOutput.empty());
+                continue;
+            }
+
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLRDHUP | (terminal.szOutput.empty() ? 0u : (uint32_t)EPOLLOUT);
+            event.data.u64 = eventsArr[i].data.u64;
+            epoll_ctl(iEpollFd, EPOLL_CTL_MOD, terminal.iFd, &event);
+        }
+    }
+
+    for (LoadTerminal& terminal : terminalsVec)
+    {
+        if (!terminal.bDone && terminal.iFd >= 0)
+        {
+            close(terminal.iFd);
+            result.lErrors += 1;
+        }
+    }
+    close(iEpollFd);
+    result.dSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+
+    sort(latencyVec.begin(), latencyVec.end());
+    result.dP50Micros = percentile(latencyVec, 0.50);
+    result.dP99Micros = percentile(latencyVec, 0.99);
+    result.dP999Micros = percentile(latencyVec, 0.999);
+    result.dMaxMicros = latencyVec.empty() ? 0.0 : latencyVec.back();
+    return result;
+}
+
+/*********************************************************************
+void displayPosLoadResult(const PosLoadConfig& config, const PosLoadResult& result)
+Purpose:
+    Function to display the throughput and latency of a load run
+Parameters:
+    I   PosLoadConfig config    Terminals and baskets that were played
+    I   PosLoadResult result    Counters and latency of the run
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+void displayPosLoadResult(const PosLoadConfig& config, const PosLoadResult& result)
+{
+    double dSeconds = max(result.dSeconds, 1e-9);
+    cout << "Register Load" << endl;
+    cout << szBreakMessage;
+    cout << "Terminals: " << config.iTerminals << ", baskets each: " << config.iBasketsPerTerminal << endl;
+    cout << "Terminals finished: " << result.lTerminals << ", failed: " << result.lErrors << endl;
+    cout << "Checkouts: " << result.lCheckouts << ", requests: " << result.lRequests << endl;
+    cout << "Seconds: " << setprecision(3) << result.dSeconds << setprecision(2) << endl;
+    cout << "Terminal sessions per second: " << setprecision(1) << result.lTerminals / dSeconds << endl;
+    cout << "Checkouts per second: " << result.lCheckouts / dSeconds << endl;
+    cout << "Requests per second: " << result.lRequests / dSeconds << endl;
+    cout << "Request latency us p50: " << result.dP50Micros << ", p99: " << result.dP99Micros
+         << ", p99.9: " << result.dP999Micros << ", max: " << result.dMaxMicros << setprecision(2) << endl;
+    cout << szBreakMessage;
+}
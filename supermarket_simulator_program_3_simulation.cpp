@@ -0,0 +1,341 @@
+#include "supermarket_simulator_program_3.h"
+/*********************************************************************
+File name: supermarket_simulator_program_3_simulation.cpp
+
+Purpose:
+    Discrete-event simulation of a trading day behind extraCredit.
+
+Notes:
+    - Events are kept in a priority queue ordered by time, with a
+      sequence number so equal times pop in the order scheduled.
+    - Customers arrive as a Poisson process, browse the real aisles
+      to fill a basket, join the shortest lane queue and are checked
+      out through the checkout engine when their service ends.
+    - Each arrival schedules the next one, so the queue only holds
+      about one event per customer in the store.
+*********************************************************************/
+
+enum SimEventType
+{
+    SIM_ARRIVAL,        // Customer walks into the store
+    SIM_BROWSE_DONE,    // Customer finished shopping and joins a queue
+    SIM_SERVICE_DONE    // Lane finished serving its customer
+};
+
+struct SimEvent
+{
+    double dTime = 0.0;         // Seconds since the store opened
+    long long lSequence = 0;    // Order the event was scheduled in
+    SimEventType type = SIM_ARRIVAL;
+    int iCustomer = 0;          // Customer the event belongs to
+    int iLane = -1;             // Lane for service events
+
+    bool operator>(const SimEvent& other) const
+    {
+        return dTime != other.dTime ? dTime > other.dTime : lSequence > other.lSequence;
+    }
+};
+
+struct SimCustomer
+{
+    Basket basket;              // Items the customer picked up
+    double dQueueJoin = 0.0;    // Time the customer joined a lane queue
+};
+
+struct SimLane
+{
+    deque<int> queueDeq;        // Customers waiting in line
+    int iServing = -1;          // Customer at the register, -1 if idle
+    double dBusySeconds = 0.0;  // Time spent serving customers
+    double dQueueArea = 0.0;    // Integral of queue length over time
+    double dLastChange = 0.0;   // Time the queue length last changed
+    size_t iMaxQueue = 0;       // Longest queue seen
+    long long lServed = 0;      // Customers checked out
+};
+
+/*********************************************************************
+static double percentile(vector<double>& valuesVec, double dFraction)
+Purpose:
+    Helper function to find a percentile of a sample
+Parameters:
+    I/O vector<double>& valuesVec   Sample, reordered in place
+    I   double dFraction            Percentile as a fraction, 0.99 for p99
+Return Value:
+    Value at the percentile, 0 for an empty sample
+Notes:
+    Uses nth_element so the sample does not need a full sort
+*********************************************************************/
+static double percentile(vector<double>& valuesVec, double dFraction)
+{
+    if (valuesVec.empty())
+    {
+        return 0.0;
+    }
+
+    size_t iIndex = min(valuesVec.size() - 1, (size_t)(dFraction * valuesVec.size()));
+    nth_element(valuesVec.begin(), valuesVec.begin() + iIndex, valuesVec.end());
+    return valuesVec[iIndex];
+}
+
+/*********************************************************************
+static void noteQueueChange(SimLane& lane, double dNow)
+Purpose:
+    Helper function to accumulate time-weighted queue length
+Parameters:
+    I/O SimLane& lane       Lane whose queue is about to change
+    I   double dNow         Current simulation time
+Return Value:
+    -
+Notes:
+    Must be called before every push or pop of the lane queue
+*********************************************************************/
+static void noteQueueChange(SimLane& lane, double dNow)
+{
+    lane.dQueueArea += lane.queueDeq.size() * (dNow - lane.dLastChange);
+    lane.dLastChange = dNow;
+}
+
+/*********************************************************************
+SimulationResults runStoreSimulation(Supermarket& myStore, const SimulationConfig& config)
+Purpose:
+    Function to simulate a trading day against the store
+Parameters:
+    I/O Supermarket& myStore        Populated Supermarket info
+    I   SimulationConfig config     Customer count, lanes and timings
+Return Value:
+    Queue, wait and utilization results of the day
+Notes:
+    Arrivals stop at closing time, customers already inside are still
+    served. Stock, funds, members and customersVec are updated through
+    checkoutBasket exactly as at a real register.
+*********************************************************************/
+SimulationResults runStoreSimulation(Supermarket& myStore, const SimulationConfig& config)
+{
+    SimulationResults results;
+    results.iLanes = max(config.iLanes, 1);
+
+    // Everything a customer can pick up
+    vector<pair<int, int>> shelfVec;
+    for (size_t i = 0; i < myStore.aislesVec.size(); i++)
+    {
+        for (size_t j = 0; j < myStore.aislesVec[i].itemVec.size(); j++)
+        {
+            if (!myStore.aislesVec[i].szName.empty() && !myStore.aislesVec[i].itemVec[j].szName.empty())
+            {
+                shelfVec.push_back({(int)i, (int)j});
+            }
+        }
+    }
+    if (shelfVec.empty() || config.iCustomers <= 0)
+    {
+        return results;
+    }
+
+    mt19937_64 rng(config.lSeed);
+    exponential_distribution<double> arrivalGap(config.iCustomers / config.dDaySeconds);
+    exponential_distribution<double> browseTime(1.0 / config.dBrowseSecondsPerItem);
+    uniform_int_distribution<int> basketSize(1, max(config.iMaxBasketLines, 1));
+    uniform_int_distribution<int> lineQuantity(1, 3);
+    uniform_int_distribution<size_t> shelfPick(0, shelfVec.size() - 1);
+    bernoulli_distribution buysMembership(config.dMembershipRate);
+
+    vector<SimCustomer> customersVec(config.iCustomers);
+    vector<SimLane> lanesVec(results.iLanes);
+    vector<double> waitsVec;
+    waitsVec.reserve(config.iCustomers);
+
+    priority_queue<SimEvent, vector<SimEvent>, greater<SimEvent>> eventQueue;
+    long long lSequence = 0;
+    auto schedule = [&](double dTime, SimEventType type, int iCustomer, int iLane)
+    {
+        SimEvent event;
+        event.dTime = dTime;
+        event.lSequence = lSequence++;
+        event.type = type;
+        event.iCustomer = iCustomer;
+        event.iLane = iLane;
+        eventQueue.push(event);
+    };
+    auto startService = [&](SimLane& lane, int iLane, int iCustomer, double dNow)
+    {
+        lane.iServing = iCustomer;
+        waitsVec.push_back(dNow - customersVec[iCustomer].dQueueJoin);
+
+        int iItems = 0;
+        for (const BasketLine& line : customersVec[iCustomer].basket.linesVec)
+        {
+            iItems += line.iQuantity;
+        }
+        double dService = config.dServiceSecondsFixed + config.dServiceSecondsPerItem * iItems;
+        lane.dBusySeconds += dService;
+        schedule(dNow + dService, SIM_SERVICE_DONE, iCustomer, iLane);
+    };
+
+    auto tStart = chrono::steady_clock::now();
+    schedule(arrivalGap(rng), SIM_ARRIVAL, 0, -1);
+
+    double dNow = 0.0;
+    while (!eventQueue.empty())
+    {
+        SimEvent event = eventQueue.top();
+        eventQueue.pop();
+        dNow = event.dTime;
+        results.lEvents += 1;
+
+        switch (event.type)
+        {
+            case SIM_ARRIVAL:
+            {
+                // Fill the basket from the real shelves
+                SimCustomer& customer = customersVec[event.iCustomer];
+                customer.basket.szCustomerName = "Customer " + to_string(event.iCustomer);
+                customer.basket.bBuyMembership = buysMembership(rng);
+
+                int iLines = basketSize(rng);
+                double dBrowse = 0.0;
+                for (int i = 0; i < iLines; i++)
+                {
+                    pair<int, int> shelf = shelfVec[shelfPick(rng)];
+                    BasketLine line;
+                    line.iAisleIndex = shelf.first;
+                    const Item& item = myStore.aislesVec[shelf.first].itemVec[shelf.second];
+                    line.szItemName = item.szName;
+                    line.iSKU = item.iSKU;
+                    line.iQuantity = lineQuantity(rng);
+                    customer.basket.linesVec.push_back(line);
+                    dBrowse += browseTime(rng);
+                }
+                schedule(dNow + dBrowse, SIM_BROWSE_DONE, event.iCustomer, -1);
+
+                // Next customer through the door
+                double dNext = dNow + arrivalGap(rng);
+                if (event.iCustomer + 1 < config.iCustomers && dNext < config.dDaySeconds)
+                {
+                    schedule(dNext, SIM_ARRIVAL, event.iCustomer + 1, -1);
+                }
+                results.lCustomers += 1;
+                break;
+            }
+            case SIM_BROWSE_DONE:
+            {
+                // Join the shortest line, counting the customer at the register
+                int iBest = 0;
+                size_t iBestLength = SIZE_MAX;
+                for (int i = 0; i < results.iLanes; i++)
+                {
+                    size_t iLength = lanesVec[i].queueDeq.size() + (lanesVec[i].iServing >= 0 ? 1 : 0);
+                    if (iLength < iBestLength)
+                    {
+                        iBest = i;
+                        iBestLength = iLength;
+                    }
+                }
+
+                SimLane& lane = lanesVec[iBest];
+                customersVec[event.iCustomer].dQueueJoin = dNow;
+                if (lane.iServing < 0)
+                {
+                    startService(lane, iBest, event.iCustomer, dNow);
+                }
+                else
+                {
+                    noteQueueChange(lane, dNow);
+                    lane.queueDeq.push_back(event.iCustomer);
+                    lane.iMaxQueue = max(lane.iMaxQueue, lane.queueDeq.size());
+                }
+                break;
+            }
+            case SIM_SERVICE_DONE:
+            {
+                SimLane& lane = lanesVec[event.iLane];
+                SimCustomer& customer = customersVec[event.iCustomer];
+
+                ReplayStats lineStats;
+                CustomerPurchase purchase = checkoutBasket(myStore, customer.basket, &lineStats);
+                results.mSales += purchase.mPurchaseCost;
+                results.lRejectedLines += lineStats.lRejectedLines;
+                lane.lServed += 1;
+
+                // Free the basket, the customer has left
+                customer.basket = Basket();
+
+                lane.iServing = -1;
+                if (!lane.queueDeq.empty())
+                {
+                    noteQueueChange(lane, dNow);
+                    int iNext = lane.queueDeq.front();
+                    lane.queueDeq.pop_front();
+                    startService(lane, event.iLane, iNext, dNow);
+                }
+                break;
+            }
+        }
+    }
+
+    results.dSimulatedSeconds = max(dNow, config.dDaySeconds);
+    results.dWallSeconds = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+
+    for (SimLane& lane : lanesVec)
+    {
+        noteQueueChange(lane, results.dSimulatedSeconds);
+        results.laneServedVec.push_back(lane.lServed);
+        results.laneUtilizationVec.push_back(lane.dBusySeconds / results.dSimulatedSeconds);
+        results.laneAvgQueueVec.push_back(lane.dQueueArea / results.dSimulatedSeconds);
+        results.laneMaxQueueVec.push_back((int)lane.iMaxQueue);
+    }
+
+    if (!waitsVec.empty())
+    {
+        double dSum = 0.0;
+        for (double dWait : waitsVec)
+        {
+            dSum += dWait;
+        }
+        results.dWaitMean = dSum / waitsVec.size();
+        results.dWaitP50 = percentile(waitsVec, 0.50);
+        results.dWaitP90 = percentile(waitsVec, 0.90);
+        results.dWaitP99 = percentile(waitsVec, 0.99);
+        results.dWaitMax = *max_element(waitsVec.begin(), waitsVec.end());
+    }
+
+    return results;
+}
+
+/*********************************************************************
+void displaySimulationResults(const SimulationResults& results)
+Purpose:
+    Function to display the results of a simulated day
+Parameters:
+    I   SimulationResults results   Results of runStoreSimulation
+Return Value:
+    -
+Notes:
+    Times are shown in minutes
+*********************************************************************/
+void displaySimulationResults(const SimulationResults& results)
+{
+    cout << "Simulation Results" << endl;
+    cout << szBreakMessage;
+    cout << "Customers: " << results.lCustomers << endl;
+    cout << "Events processed: " << results.lEvents << endl;
+    cout << "Simulated hours: " << fixed << setprecision(2) << results.dSimulatedSeconds / 3600.0 << endl;
+    cout << "Wall seconds: " << setprecision(3) << results.dWallSeconds << endl;
+    cout << setprecision(2);
+    cout << "Sales including tax: $" << results.mSales << endl;
+    cout << "Rejected basket lines: " << results.lRejectedLines << endl;
+    cout << "Wait minutes mean/p50/p90/p99/max: "
+         << results.dWaitMean / 60.0 << " / " << results.dWaitP50 / 60.0 << " / "
+         << results.dWaitP90 / 60.0 << " / " << results.dWaitP99 / 60.0 << " / "
+         << results.dWaitMax / 60.0 << endl;
+    cout << szBreakMessage;
+
+    cout << left << setw(6) << "Lane" << setw(10) << "Served" << setw(14) << "Busy %"
+         << setw(12) << "Avg queue" << "Max queue" << right << endl;
+    for (int i = 0; i < results.iLanes; i++)
+    {
+        cout << left << setw(6) << i << setw(10) << results.laneServedVec[i]
+             << setw(14) << results.laneUtilizationVec[i] * 100.0
+             << setw(12) << results.laneAvgQueueVec[i] << results.laneMaxQueueVec[i] << right << endl;
+    }
+    cout << szBreakMessage;
+}
@@ -0,0 +1,986 @@
+#include "supermarket_simulator_program_3.h"
+#include <fcntl.h>
+#include <unistd.h>
+/*********************************************************************
+File name: supermarket_simulator_program_3_snapshot.cpp
+
+Purpose:
+    Versioned binary snapshot of the full store state, so a store
+    restarts without reparsing its text file and keeps the day's
+    stock, funds, purchases, members, sales totals, line item log and
+    best seller sketches.
+
+Notes:
+    - Layout is a fixed header followed by 8 byte aligned sections of
+      fixed-width records, then one string table. Strings are stored
+      as an offset and length into the table.
+    - Records are read straight out of a read-only mapping. Only the
+      strings are copied, into the store's own containers.
+    - The catalog index tables are saved as they are, so a restore
+      copies them instead of hashing every item again.
+    - The line item log is saved as its columns, one after another for
+      every day, so basket mining sees the baskets from before a save.
+    - Best seller sketches are saved as their counters, so the hour and
+      day windows carry on where they were.
+    - Numbers are written in the machine's byte order, snapshots are
+      meant to be restored on the machine that wrote them.
+    - A snapshot is written to a temporary file, flushed to disk and
+      renamed over the old one, so a crash never leaves half a file.
+*********************************************************************/
+
+static const char szSNAPSHOT_MAGIC[8] = {'S', 'M', 'S', 'N', 'A', 'P', '\r', '\n'};
+static const uint32_t iSNAPSHOT_VERSION = 5;
+
+// Location of a string in the string table
+struct SnapshotString
+{
+    uint32_t iOffset;
+    uint32_t iLength;
+};
+
+// Location of a section of records
+struct SnapshotSection
+{
+    uint64_t iOffset;
+    uint64_t iCount;
+};
+
+struct SnapshotHeader
+{
+    char szMagic[8];
+    uint32_t iVersion;
+    uint32_t iHeaderBytes;
+    uint64_t iFileBytes;            // Whole file, catches truncation
+    Money mMembershipFee;
+    Money mTotalFunds;
+    SnapshotString name;
+    SnapshotString storeHours;
+    SnapshotSection aisles;
+    SnapshotSection items;
+    SnapshotSection employees;
+    SnapshotSection purchases;
+    SnapshotSection members;
+    SnapshotSection catalogEntries;
+    SnapshotSection nameSlots;
+    SnapshotSection skuSlots;
+    SnapshotSection sales;          // Always one record
+    SnapshotSection salesHours;     // Always 24 buckets
+    SnapshotSection salesAisles;
+    SnapshotSection lineDays;
+    SnapshotSection lineSKUs;       // Lines of every day, oldest day first
+    SnapshotSection lineQuantities;
+    SnapshotSection lineUnitCents;
+    SnapshotSection basketEnds;     // Baskets of every day, ends count from the day's first line
+    SnapshotSection basketTiers;
+    SnapshotSection sketchWindows;  // Always two, the hour window then the day window
+    SnapshotSection sketchHitters;  // Space-Saving counters of every window, in window order
+    SnapshotSection sketchCounts;   // Count-Min counters of every window, in window order
+    SnapshotSection strings;        // Count is in bytes
+};
+
+struct SnapshotAisle
+{
+    SnapshotString name;
+    uint64_t iFirstItem;            // Index into the item section
+    uint64_t iItemCount;
+};
+
+struct SnapshotItem
+{
+    SnapshotString name;
+    int32_t iQuantity;
+    int32_t iSKU;
+    Money mWholesale;
+    Money mRegularPrice;
+    Money mMembersPrice;
+};
+
+struct SnapshotEmployee
+{
+    SnapshotString id;
+    SnapshotString name;
+    Money mSalary;
+};
+
+struct SnapshotPurchase
+{
+    SnapshotString name;
+    int32_t iNumberItems;
+    uint32_t bBoughtMembership;
+    Money mPurchaseCost;
+};
+
+struct SnapshotMember
+{
+    SnapshotString name;
+};
+
+struct SnapshotSales
+{
+    int64_t lCheckouts;
+    int64_t lItems;
+    Money mGrossSales;
+    Money mTaxCollected;
+    Money mMembershipFees;
+    Money mCostOfGoods;
+    Money mProfit;
+};
+
+struct SnapshotLineDay
+{
+    int32_t iDay;
+    uint32_t iBaskets;
+    uint64_t iLines;
+};
+
+// One window of best seller sketches, its counters are in the shared sections
+struct SnapshotSketchWindow
+{
+    int32_t iHour;
+    uint32_t iReserved;
+    uint64_t iUnits;
+    uint64_t iTopItems;             // Counters in the hitter section
+    uint64_t iTopAisles;
+    uint64_t iItemCounts;           // Counters in the count section
+    uint64_t iAisleCounts;
+};
+
+static_assert(sizeof(SnapshotHeader) == 392, "snapshot header layout changed");
+static_assert(sizeof(SnapshotAisle) == 24, "snapshot aisle layout changed");
+static_assert(sizeof(SnapshotItem) == 40, "snapshot item layout changed");
+static_assert(sizeof(SnapshotEmployee) == 24, "snapshot employee layout changed");
+static_assert(sizeof(SnapshotPurchase) == 24, "snapshot purchase layout changed");
+static_assert(sizeof(SnapshotMember) == 8, "snapshot member layout changed");
+static_assert(sizeof(SnapshotSales) == 56, "snapshot sales layout changed");
+static_assert(sizeof(SnapshotLineDay) == 16, "snapshot line day layout changed");
+static_assert(sizeof(SnapshotSketchWindow) == 48, "snapshot sketch window layout changed");
+static_assert(sizeof(HeavyHitter) == 24 && is_trivially_copyable_v<HeavyHitter>, "heavy hitter layout changed");
+static_assert(sizeof(SalesBucket) == 32 && is_trivially_copyable_v<SalesBucket>, "sales bucket layout changed");
+static_assert(sizeof(CatalogEntry) == 24 && is_trivially_copyable_v<CatalogEntry>, "catalog entry layout changed");
+
+/*********************************************************************
+static SnapshotString addString(string& szTable, const string& szValue)
+Purpose:
+    Helper function to append a string to the string table
+Parameters:
+    I/O string& szTable     String table being built
+    I   string szValue      String to store
+Return Value:
+    Location of the string in the table
+Notes:
+    -
+*********************************************************************/
+static SnapshotString addString(string& szTable, const string& szValue)
+{
+    SnapshotString location;
+    location.iOffset = (uint32_t)szTable.size();
+    location.iLength = (uint32_t)szValue.size();
+    szTable += szValue;
+    return location;
+}
+
+/*********************************************************************
+static SnapshotSection appendSection(string& szFile, const vector<T>& recordsVec)
+Purpose:
+    Helper function to append a section of records at an 8 byte boundary
+Parameters:
+    I/O string& szFile          Snapshot being built
+    I   vector<T> recordsVec    Records of the section
+Return Value:
+    Location of the section
+Notes:
+    -
+*********************************************************************/
+template <typename T>
+static SnapshotSection appendSection(string& szFile, const vector<T>& recordsVec)
+{
+    szFile.resize((szFile.size() + 7) & ~(size_t)7, '\0');
+
+    SnapshotSection section;
+    section.iOffset = szFile.size();
+    section.iCount = recordsVec.size();
+    szFile.append((const char*)recordsVec.data(), recordsVec.size() * sizeof(T));
+    return section;
+}
+
+/*********************************************************************
+bool writeWholeFile(const string& szFilename, const string& szContents, StoreFileError& error)
+Purpose:
+    Function to replace a file with new contents in one step
+Parameters:
+    I   string szFilename       Path of the file
+    I   string szContents       Bytes to write
+    O   StoreFileError& error   Reason on failure
+Return Value:
+    True if the file was written and flushed to disk, else false
+Notes:
+    Writes a .tmp file beside the target and renames it into place
+*********************************************************************/
+bool writeWholeFile(const string& szFilename, const string& szContents, StoreFileError& error)
+{
+    error.iLine = 0;
+    error.iColumn = 0;
+
+    string szTemporary = szFilename + ".tmp";
+    int iFile = ::open(szTemporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (iFile < 0)
+    {
+        error.szMessage = "file could not be created";
+        return false;
+    }
+
+    size_t iWritten = 0;
+    while (iWritten < szContents.size())
+    {
+        ssize_t iBytes = write(iFile, szContents.data() + iWritten, szContents.size() - iWritten);
+        if (iBytes <= 0)
+        {
+            close(iFile);
+            unlink(szTemporary.c_str());
+            error.szMessage = "file could not be written";
+            return false;
+        }
+        iWritten += (size_t)iBytes;
+    }
+
+    if (fsync(iFile) != 0 || close(iFile) != 0 || rename(szTemporary.c_str(), szFilename.c_str()) != 0)
+    {
+        unlink(szTemporary.c_str());
+        error.szMessage = "file could not be saved";
+        return false;
+    }
+    return true;
+}
+
+/*********************************************************************
+static void saveSketchWindow(const SalesWindowSketches& window, vector<SnapshotSketchWindow>& windowsVec,
+                             vector<HeavyHitter>& hittersVec, vector<uint64_t>& countsVec)
+Purpose:
+    Helper function to add one window of sketches to the snapshot records
+Parameters:
+    I   SalesWindowSketches window              Window to save
+    I/O vector<SnapshotSketchWindow>& windowsVec    Window records
+    I/O vector<HeavyHitter>& hittersVec         Space-Saving counters
+    I/O vector<uint64_t>& countsVec             Count-Min counters
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void saveSketchWindow(const SalesWindowSketches& window, vector<SnapshotSketchWindow>& windowsVec,
+                             vector<HeavyHitter>& hittersVec, vector<uint64_t>& countsVec)
+{
+    vector<HeavyHitter> topItemsVec = window.topItems.counters();
+    vector<HeavyHitter> topAislesVec = window.topAisles.counters();
+    const vector<uint64_t>& itemCountsVec = window.itemUnits.counts();
+    const vector<uint64_t>& aisleCountsVec = window.aisleUnits.counts();
+
+    SnapshotSketchWindow record = {};
+    record.iHour = window.iHour;
+    record.iUnits = window.iUnits;
+    record.iTopItems = topItemsVec.size();
+    record.iTopAisles = topAislesVec.size();
+    record.iItemCounts = itemCountsVec.size();
+    record.iAisleCounts = aisleCountsVec.size();
+    windowsVec.push_back(record);
+
+    hittersVec.insert(hittersVec.end(), topItemsVec.begin(), topItemsVec.end());
+    hittersVec.insert(hittersVec.end(), topAislesVec.begin(), topAislesVec.end());
+    countsVec.insert(countsVec.end(), itemCountsVec.begin(), itemCountsVec.end());
+    countsVec.insert(countsVec.end(), aisleCountsVec.begin(), aisleCountsVec.end());
+}
+
+/*********************************************************************
+bool saveStoreSnapshot(const Supermarket& myStore, const string& szFilename, StoreFileError& error)
+Purpose:
+    Function to write the full store state to a binary snapshot
+Parameters:
+    I   Supermarket myStore         Store to save
+    I   string szFilename           Path of the snapshot
+    O   StoreFileError& error       Reason on failure
+Return Value:
+    True if the snapshot was written, else false
+Notes:
+    -
+*********************************************************************/
+bool saveStoreSnapshot(const Supermarket& myStore, const string& szFilename, StoreFileError& error)
+{
+    string szTable;
+    SnapshotHeader header = {};
+    memcpy(header.szMagic, szSNAPSHOT_MAGIC, sizeof(header.szMagic));
+    header.iVersion = iSNAPSHOT_VERSION;
+    header.iHeaderBytes = sizeof(SnapshotHeader);
+    header.mMembershipFee = myStore.mMembershipFee;
+    header.mTotalFunds = myStore.mTotalFunds;
+    header.name = addString(szTable, myStore.szName);
+    header.storeHours = addString(szTable, myStore.szStoreHours);
+
+    vector<SnapshotAisle> aislesVec;
+    vector<SnapshotItem> itemsVec;
+    aislesVec.reserve(myStore.aislesVec.size());
+    for (const Aisle& aisle : myStore.aislesVec)
+    {
+        SnapshotAisle record;
+        record.name = addString(szTable, aisle.szName);
+        record.iFirstItem = itemsVec.size();
+        record.iItemCount = aisle.itemVec.size();
+        aislesVec.push_back(record);
+
+        for (const Item& item : aisle.itemVec)
+        {
+            SnapshotItem itemRecord;
+            itemRecord.name = addString(szTable, item.szName);
+            itemRecord.iQuantity = item.iQuantity;
+            itemRecord.iSKU = item.iSKU;
+            itemRecord.mWholesale = item.mWholesale;
+            itemRecord.mRegularPrice = item.mRegularPrice;
+            itemRecord.mMembersPrice = item.mMembersPrice;
+            itemsVec.push_back(itemRecord);
+        }
+    }
+
+    vector<SnapshotEmployee> employeesVec;
+    employeesVec.reserve(myStore.employeesVec.size());
+    for (const Employee& employee : myStore.employeesVec)
+    {
+        SnapshotEmployee record;
+        record.id = addString(szTable, employee.szID);
+        record.name = addString(szTable, employee.szName);
+        record.mSalary = employee.mSalary;
+        employeesVec.push_back(record);
+    }
+
+    vector<SnapshotPurchase> purchasesVec;
+    purchasesVec.reserve(myStore.customersVec.size());
+    for (const CustomerPurchase& purchase : myStore.customersVec)
+    {
+        SnapshotPurchase record;
+        record.name = addString(szTable, purchase.szName);
+        record.iNumberItems = purchase.iNumberItems;
+        record.bBoughtMembership = purchase.bBoughtMembership ? 1 : 0;
+        record.mPurchaseCost = purchase.mPurchaseCost;
+        purchasesVec.push_back(record);
+    }
+
+    vector<SnapshotMember> membersVec;
+    membersVec.reserve(myStore.memberRegistry.membersVec.size());
+    for (const Member& member : myStore.memberRegistry.membersVec)
+    {
+        membersVec.push_back({addString(szTable, member.szName)});
+    }
+
+    const SalesAggregates& sales = myStore.sales;
+    vector<SnapshotSales> salesVec(1);
+    salesVec[0].lCheckouts = sales.lCheckouts;
+    salesVec[0].lItems = sales.lItems;
+    salesVec[0].mGrossSales = sales.mGrossSales;
+    salesVec[0].mTaxCollected = sales.mTaxCollected;
+    salesVec[0].mMembershipFees = sales.mMembershipFees;
+    salesVec[0].mCostOfGoods = sales.mCostOfGoods;
+    salesVec[0].mProfit = sales.mProfit;
+    vector<SalesBucket> salesHoursVec(begin(sales.hourArr), end(sales.hourArr));
+
+    vector<SnapshotLineDay> lineDaysVec;
+    vector<int32_t> lineSKUsVec;
+    vector<int32_t> lineQuantitiesVec;
+    vector<int64_t> lineUnitCentsVec;
+    vector<uint32_t> basketEndsVec;
+    vector<uint8_t> basketTiersVec;
+    lineSKUsVec.reserve(myStore.lineItems.lineCount());
+    lineQuantitiesVec.reserve(myStore.lineItems.lineCount());
+    lineUnitCentsVec.reserve(myStore.lineItems.lineCount());
+    for (const LineItemDay& day : myStore.lineItems.days())
+    {
+        lineDaysVec.push_back({day.iDay, (uint32_t)day.basketEndVec.size(), day.iLines});
+        for (size_t i = 0; i < day.iLines; i++)
+        {
+            lineSKUsVec.push_back(day.sku(i));
+            lineQuantitiesVec.push_back(day.quantity(i));
+            lineUnitCentsVec.push_back(day.unitPrice(i).iCents);
+        }
+        basketEndsVec.insert(basketEndsVec.end(), day.basketEndVec.begin(), day.basketEndVec.end());
+        basketTiersVec.insert(basketTiersVec.end(), day.tierVec.begin(), day.tierVec.end());
+    }
+
+    vector<SnapshotSketchWindow> sketchWindowsVec;
+    vector<HeavyHitter> sketchHittersVec;
+    vector<uint64_t> sketchCountsVec;
+    saveSketchWindow(myStore.analytics.hourWindow, sketchWindowsVec, sketchHittersVec, sketchCountsVec);
+    saveSketchWindow(myStore.analytics.dayWindow, sketchWindowsVec, sketchHittersVec, sketchCountsVec);
+
+    if (szTable.size() > UINT32_MAX)
+    {
+        error.iLine = 0;
+        error.iColumn = 0;
+        error.szMessage = "store has more than 4 GB of text";
+        return false;
+    }
+
+    string szFile(sizeof(SnapshotHeader), '\0');
+    header.aisles = appendSection(szFile, aislesVec);
+    header.items = appendSection(szFile, itemsVec);
+    header.employees = appendSection(szFile, employeesVec);
+    header.purchases = appendSection(szFile, purchasesVec);
+    header.members = appendSection(szFile, membersVec);
+    header.catalogEntries = appendSection(szFile, myStore.catalog.entriesVec);
+    header.nameSlots = appendSection(szFile, myStore.catalog.nameSlotsVec);
+    header.skuSlots = appendSection(szFile, myStore.catalog.skuSlotsVec);
+    header.sales = appendSection(szFile, salesVec);
+    header.salesHours = appendSection(szFile, salesHoursVec);
+    header.salesAisles = appendSection(szFile, sales.aisleVec);
+    header.lineDays = appendSection(szFile, lineDaysVec);
+    header.lineSKUs = appendSection(szFile, lineSKUsVec);
+    header.lineQuantities = appendSection(szFile, lineQuantitiesVec);
+    header.lineUnitCents = appendSection(szFile, lineUnitCentsVec);
+    header.basketEnds = appendSection(szFile, basketEndsVec);
+    header.basketTiers = appendSection(szFile, basketTiersVec);
+    header.sketchWindows = appendSection(szFile, sketchWindowsVec);
+    header.sketchHitters = appendSection(szFile, sketchHittersVec);
+    header.sketchCounts = appendSection(szFile, sketchCountsVec);
+    header.strings.iOffset = szFile.size();
+    header.strings.iCount = szTable.size();
+    szFile += szTable;
+    header.iFileBytes = szFile.size();
+    memcpy(&szFile[0], &header, sizeof(header));
+
+    return writeWholeFile(szFilename, szFile, error);
+}
+
+/*********************************************************************
+static bool sectionFits(const SnapshotSection& section, size_t iRecordBytes, size_t iFileBytes)
+Purpose:
+    Helper function to check a section lies inside the file
+Parameters:
+    I   SnapshotSection section     Section to check
+    I   size_t iRecordBytes         Size of one record
+    I   size_t iFileBytes           Size of the file
+Return Value:
+    True if every record is inside the file and aligned, else false
+Notes:
+    -
+*********************************************************************/
+static bool sectionFits(const SnapshotSection& section, size_t iRecordBytes, size_t iFileBytes)
+{
+    return section.iOffset % 8 == 0 &&
+           section.iOffset <= iFileBytes &&
+           section.iCount <= (iFileBytes - section.iOffset) / iRecordBytes;
+}
+
+// Records of a mapped snapshot, checked against the file size
+struct SnapshotView
+{
+    const char* pStrings = nullptr;
+    uint64_t iStringBytes = 0;
+    bool bStringsValid = true;      // Cleared by readString on a bad location
+};
+
+/*********************************************************************
+static void readString(SnapshotView& view, const SnapshotString& location, string& szValue)
+Purpose:
+    Helper function to copy a string out of the string table
+Parameters:
+    I/O SnapshotView& view          Mapped snapshot
+    I   SnapshotString location     Location of the string
+    O   string& szValue             String to fill in
+Return Value:
+    -
+Notes:
+    A location outside the table marks the snapshot invalid
+*********************************************************************/
+static void readString(SnapshotView& view, const SnapshotString& location, string& szValue)
+{
+    if ((uint64_t)location.iOffset + location.iLength > view.iStringBytes)
+    {
+        view.bStringsValid = false;
+        return;
+    }
+    szValue.assign(view.pStrings + location.iOffset, location.iLength);
+}
+
+/*********************************************************************
+static const T* sectionRecords(const MappedFile& file, const SnapshotSection& section)
+Purpose:
+    Helper function to find the first record of a section
+Parameters:
+    I   MappedFile file             Mapped snapshot
+    I   SnapshotSection section     Section to read
+Return Value:
+    Pointer to the first record
+Notes:
+    Sections are 8 byte aligned and the mapping is page aligned, so the
+    records can be read in place
+*********************************************************************/
+template <typename T>
+static const T* sectionRecords(const MappedFile& file, const SnapshotSection& section)
+{
+    return (const T*)(file.data() + section.iOffset);
+}
+
+/*********************************************************************
+static bool restoreCatalogIndex(const MappedFile& file, const SnapshotHeader& header,
+                                Supermarket& restored)
+Purpose:
+    Helper function to copy the saved catalog index into a restored store
+Parameters:
+    I   MappedFile file             Mapped snapshot
+    I   SnapshotHeader header       Header of the snapshot
+    I/O Supermarket& restored       Store with its aisles already restored
+Return Value:
+    True if the saved index matches the restored items, else false
+Notes:
+    Every entry and slot is checked, so a damaged index can never
+    point outside the store
+*********************************************************************/
+static bool restoreCatalogIndex(const MappedFile& file, const SnapshotHeader& header,
+                                Supermarket& restored)
+{
+    uint64_t iEntries = header.catalogEntries.iCount;
+    uint64_t iSlots = header.nameSlots.iCount;
+    if (header.skuSlots.iCount != iSlots || iSlots == 0 || (iSlots & (iSlots - 1)) != 0 ||
+        iSlots < iEntries * 2 || iEntries > UINT32_MAX)
+    {
+        return false;
+    }
+
+    const CatalogEntry* pEntries = sectionRecords<CatalogEntry>(file, header.catalogEntries);
+    for (uint64_t i = 0; i < iEntries; i++)
+    {
+        const ItemLocation& location = pEntries[i].location;
+        if (location.iAisleIndex < 0 || (size_t)location.iAisleIndex >= restored.aislesVec.size() ||
+            location.iItemIndex < 0 || (size_t)location.iItemIndex >= restored.aislesVec[location.iAisleIndex].itemVec.size() ||
+            restored.aislesVec[location.iAisleIndex].itemVec[location.iItemIndex].iSKU != pEntries[i].iSKU)
+        {
+            return false;
+        }
+    }
+
+    const uint64_t* pNameSlots = sectionRecords<uint64_t>(file, header.nameSlots);
+    const uint64_t* pSKUSlots = sectionRecords<uint64_t>(file, header.skuSlots);
+    uint64_t iNamesUsed = 0;
+    uint64_t iSKUsUsed = 0;
+    for (uint64_t i = 0; i < iSlots; i++)
+    {
+        if ((uint32_t)pNameSlots[i] > iEntries || (uint32_t)pSKUSlots[i] > iEntries)
+        {
+            return false;
+        }
+        iNamesUsed += pNameSlots[i] != 0;
+        iSKUsUsed += pSKUSlots[i] != 0;
+    }
+
+    // Probes stop at an empty slot, so both tables must keep some
+    if (iNamesUsed > iEntries || iSKUsUsed > iEntries)
+    {
+        return false;
+    }
+
+    CatalogIndex& catalog = restored.catalog;
+    catalog.entriesVec.assign(pEntries, pEntries + iEntries);
+    catalog.nameSlotsVec.assign(pNameSlots, pNameSlots + iSlots);
+    catalog.skuSlotsVec.assign(pSKUSlots, pSKUSlots + iSlots);
+    return true;
+}
+
+/*********************************************************************
+static bool restoreLineItems(const MappedFile& file, const SnapshotHeader& header,
+                             Supermarket& restored)
+Purpose:
+    Helper function to refill the line item log of a restored store
+Parameters:
+    I   MappedFile file             Mapped snapshot
+    I   SnapshotHeader header       Header of the snapshot
+    I/O Supermarket& restored       Store to refill, its log starts empty
+Return Value:
+    True if the saved days, baskets and lines agree, else false
+Notes:
+    -
+*********************************************************************/
+static bool restoreLineItems(const MappedFile& file, const SnapshotHeader& header,
+                             Supermarket& restored)
+{
+    uint64_t iLines = header.lineSKUs.iCount;
+    uint64_t iBaskets = header.basketEnds.iCount;
+    if (header.lineQuantities.iCount != iLines || header.lineUnitCents.iCount != iLines ||
+        header.basketTiers.iCount != iBaskets)
+    {
+        return false;
+    }
+
+    const SnapshotLineDay* pDays = sectionRecords<SnapshotLineDay>(file, header.lineDays);
+    const int32_t* pSKUs = sectionRecords<int32_t>(file, header.lineSKUs);
+    const int32_t* pQuantities = sectionRecords<int32_t>(file, header.lineQuantities);
+    const int64_t* pUnitCents = sectionRecords<int64_t>(file, header.lineUnitCents);
+    const uint32_t* pBasketEnds = sectionRecords<uint32_t>(file, header.basketEnds);
+    const uint8_t* pTiers = sectionRecords<uint8_t>(file, header.basketTiers);
+
+    uint64_t iFirstLine = 0;
+    uint64_t iFirstBasket = 0;
+    for (uint64_t i = 0; i < header.lineDays.iCount; i++)
+    {
+        const SnapshotLineDay& day = pDays[i];
+        if ((i > 0 && day.iDay <= pDays[i - 1].iDay) || day.iLines > UINT32_MAX ||
+            day.iLines > iLines - iFirstLine || day.iBaskets > iBaskets - iFirstBasket ||
+            (day.iBaskets == 0 ? day.iLines != 0 : pBasketEnds[iFirstBasket + day.iBaskets - 1] != day.iLines))
+        {
+            return false;
+        }
+
+        uint32_t iLine = 0;
+        for (uint32_t iBasket = 0; iBasket < day.iBaskets; iBasket++)
+        {
+            uint32_t iEnd = pBasketEnds[iFirstBasket + iBasket];
+            if (iEnd < iLine)
+            {
+                return false;
+            }
+            restored.lineItems.beginBasket(day.iDay, pTiers[iFirstBasket + iBasket]);
+            for (; iLine < iEnd; iLine++)
+            {
+                uint64_t iAt = iFirstLine + iLine;
+                restored.lineItems.appendLine(pSKUs[iAt], pQuantities[iAt], Money(pUnitCents[iAt]));
+            }
+        }
+        iFirstLine += day.iLines;
+        iFirstBasket += day.iBaskets;
+    }
+    return iFirstLine == iLines && iFirstBasket == iBaskets;
+}
+
+/*********************************************************************
+static bool restoreAnalytics(const MappedFile& file, const SnapshotHeader& header,
+                             Supermarket& restored)
+Purpose:
+    Helper function to refill the best seller sketches of a restored store
+Parameters:
+    I   MappedFile file             Mapped snapshot
+    I   SnapshotHeader header       Header of the snapshot
+    I/O Supermarket& restored       Store to refill, its sketches start empty
+Return Value:
+    True if the saved windows and counters agree, else false
+Notes:
+    -
+*********************************************************************/
+static bool restoreAnalytics(const MappedFile& file, const SnapshotHeader& header,
+                             Supermarket& restored)
+{
+    if (header.sketchWindows.iCount != 2)
+    {
+        return false;
+    }
+
+    const SnapshotSketchWindow* pWindows = sectionRecords<SnapshotSketchWindow>(file, header.sketchWindows);
+    const HeavyHitter* pHitters = sectionRecords<HeavyHitter>(file, header.sketchHitters);
+    const uint64_t* pCounts = sectionRecords<uint64_t>(file, header.sketchCounts);
+    SalesWindowSketches* windowArr[2] = {&restored.analytics.hourWindow, &restored.analytics.dayWindow};
+
+    uint64_t iHitter = 0;
+    uint64_t iCount = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        const SnapshotSketchWindow& record = pWindows[i];
+        SalesWindowSketches& window = *windowArr[i];
+        if (record.iHour < -1 || record.iHour > 23 ||
+            record.iTopItems > window.topItems.capacity() || record.iTopAisles > window.topAisles.capacity() ||
+            record.iTopItems + record.iTopAisles > header.sketchHitters.iCount - iHitter ||
+            record.iItemCounts > header.sketchCounts.iCount - iCount ||
+            record.iAisleCounts > header.sketchCounts.iCount - iCount - record.iItemCounts)
+        {
+            return false;
+        }
+
+        window.iHour = record.iHour;
+        window.iUnits = record.iUnits;
+        window.topItems.restore(pHitters + iHitter, record.iTopItems);
+        iHitter += record.iTopItems;
+        window.topAisles.restore(pHitters + iHitter, record.iTopAisles);
+        iHitter += record.iTopAisles;
+        if (!window.itemUnits.restore(pCounts + iCount, record.iItemCounts))
+        {
+            return false;
+        }
+        iCount += record.iItemCounts;
+        if (!window.aisleUnits.restore(pCounts + iCount, record.iAisleCounts))
+        {
+            return false;
+        }
+        iCount += record.iAisleCounts;
+    }
+    return iHitter == header.sketchHitters.iCount && iCount == header.sketchCounts.iCount;
+}
+
+/*********************************************************************
+bool loadStoreSnapshot(const string& szFilename, Supermarket& myStore, StoreFileError& error)
+Purpose:
+    Function to restore the full store state from a binary snapshot
+Parameters:
+    I   string szFilename           Path of the snapshot
+    I/O Supermarket& myStore        Replaced by the restored store on success
+    O   StoreFileError& error       Reason on failure
+Return Value:
+    True if the snapshot was valid and restored, else false
+Notes:
+    myStore is left untouched when the snapshot is rejected
+*********************************************************************/
+bool loadStoreSnapshot(const string& szFilename, Supermarket& myStore, StoreFileError& error)
+{
+    MappedFile file;
+    if (!file.open(szFilename, error))
+    {
+        return false;
+    }
+
+    error.iLine = 0;
+    error.iColumn = 0;
+    if (file.size() < sizeof(szSNAPSHOT_MAGIC) || memcmp(file.data(), szSNAPSHOT_MAGIC, sizeof(szSNAPSHOT_MAGIC)) != 0)
+    {
+        error.szMessage = "not a store snapshot";
+        return false;
+    }
+    if (file.size() < sizeof(SnapshotHeader))
+    {
+        error.szMessage = "snapshot is truncated or damaged";
+        return false;
+    }
+
+    const SnapshotHeader& header = *(const SnapshotHeader*)file.data();
+    if (header.iVersion != iSNAPSHOT_VERSION || header.iHeaderBytes != sizeof(SnapshotHeader))
+    {
+        error.szMessage = "snapshot version " + to_string(header.iVersion) + " is not supported";
+        return false;
+    }
+    if (header.iFileBytes != file.size() ||
+        !sectionFits(header.aisles, sizeof(SnapshotAisle), file.size()) ||
+        !sectionFits(header.items, sizeof(SnapshotItem), file.size()) ||
+        !sectionFits(header.employees, sizeof(SnapshotEmployee), file.size()) ||
+        !sectionFits(header.purchases, sizeof(SnapshotPurchase), file.size()) ||
+        !sectionFits(header.members, sizeof(SnapshotMember), file.size()) ||
+        !sectionFits(header.catalogEntries, sizeof(CatalogEntry), file.size()) ||
+        !sectionFits(header.nameSlots, sizeof(uint64_t), file.size()) ||
+        !sectionFits(header.skuSlots, sizeof(uint64_t), file.size()) ||
+        !sectionFits(header.sales, sizeof(SnapshotSales), file.size()) || header.sales.iCount != 1 ||
+        !sectionFits(header.salesHours, sizeof(SalesBucket), file.size()) || header.salesHours.iCount != 24 ||
+        !sectionFits(header.salesAisles, sizeof(SalesBucket), file.size()) ||
+        header.salesAisles.iCount > header.aisles.iCount ||
+        !sectionFits(header.lineDays, sizeof(SnapshotLineDay), file.size()) ||
+        !sectionFits(header.lineSKUs, sizeof(int32_t), file.size()) ||
+        !sectionFits(header.lineQuantities, sizeof(int32_t), file.size()) ||
+        !sectionFits(header.lineUnitCents, sizeof(int64_t), file.size()) ||
+        !sectionFits(header.basketEnds, sizeof(uint32_t), file.size()) ||
+        !sectionFits(header.basketTiers, sizeof(uint8_t), file.size()) ||
+        !sectionFits(header.sketchWindows, sizeof(SnapshotSketchWindow), file.size()) ||
+        !sectionFits(header.sketchHitters, sizeof(HeavyHitter), file.size()) ||
+        !sectionFits(header.sketchCounts, sizeof(uint64_t), file.size()) ||
+        header.strings.iOffset > file.size() ||
+        header.strings.iCount > file.size() - header.strings.iOffset)
+    {
+        error.szMessage = "snapshot is truncated or damaged";
+        return false;
+    }
+
+    SnapshotView view;
+    view.pStrings = file.data() + header.strings.iOffset;
+    view.iStringBytes = header.strings.iCount;
+
+    Supermarket restored;
+    restored.mMembershipFee = header.mMembershipFee;
+    restored.mTotalFunds = header.mTotalFunds;
+    readString(view, header.name, restored.szName);
+    readString(view, header.storeHours, restored.szStoreHours);
+
+    const SnapshotAisle* pAisles = sectionRecords<SnapshotAisle>(file, header.aisles);
+    const SnapshotItem* pItems = sectionRecords<SnapshotItem>(file, header.items);
+    restored.aislesVec.reserve(header.aisles.iCount);
+    for (uint64_t i = 0; i < header.aisles.iCount; i++)
+    {
+        const SnapshotAisle& record = pAisles[i];
+        if (record.iFirstItem > header.items.iCount || record.iItemCount > header.items.iCount - record.iFirstItem)
+        {
+            error.szMessage = "snapshot is truncated or damaged";
+            return false;
+        }
+
+        Aisle& aisle = restored.aislesVec.emplace_back(restored.pArena);
+        readString(view, record.name, aisle.szName);
+        aisle.itemVec.reserve(record.iItemCount);
+        for (uint64_t j = 0; j < record.iItemCount; j++)
+        {
+            const SnapshotItem& itemRecord = pItems[record.iFirstItem + j];
+            Item& item = aisle.itemVec.emplace_back();
+            readString(view, itemRecord.name, item.szName);
+            item.iQuantity = itemRecord.iQuantity;
+            item.iSKU = itemRecord.iSKU;
+            item.mWholesale = itemRecord.mWholesale;
+            item.mRegularPrice = itemRecord.mRegularPrice;
+            item.mMembersPrice = itemRecord.mMembersPrice;
+        }
+    }
+
+    const SnapshotEmployee* pEmployees = sectionRecords<SnapshotEmployee>(file, header.employees);
+    restored.employeesVec.reserve(header.employees.iCount);
+    for (uint64_t i = 0; i < header.employees.iCount; i++)
+    {
+        Employee& employee = restored.employeesVec.emplace_back();
+        readString(view, pEmployees[i].id, employee.szID);
+        readString(view, pEmployees[i].name, employee.szName);
+        employee.mSalary = pEmployees[i].mSalary;
+    }
+
+    const SnapshotPurchase* pPurchases = sectionRecords<SnapshotPurchase>(file, header.purchases);
+    restored.customersVec.reserve(header.purchases.iCount);
+    for (uint64_t i = 0; i < header.purchases.iCount; i++)
+    {
+        CustomerPurchase& purchase = restored.customersVec.emplace_back();
+        readString(view, pPurchases[i].name, purchase.szName);
+        purchase.iNumberItems = pPurchases[i].iNumberItems;
+        purchase.bBoughtMembership = pPurchases[i].bBoughtMembership != 0;
+        purchase.mPurchaseCost = pPurchases[i].mPurchaseCost;
+    }
+
+    const SnapshotMember* pMembers = sectionRecords<SnapshotMember>(file, header.members);
+    string szMember;
+    for (uint64_t i = 0; i < header.members.iCount; i++)
+    {
+        readString(view, pMembers[i].name, szMember);
+        registryInsert(restored.memberRegistry, szMember);
+    }
+
+    const SnapshotSales& salesRecord = *sectionRecords<SnapshotSales>(file, header.sales);
+    const SalesBucket* pHours = sectionRecords<SalesBucket>(file, header.salesHours);
+    const SalesBucket* pAisleSales = sectionRecords<SalesBucket>(file, header.salesAisles);
+    SalesAggregates& sales = restored.sales;
+    sales.lCheckouts = salesRecord.lCheckouts;
+    sales.lItems = salesRecord.lItems;
+    sales.mGrossSales = salesRecord.mGrossSales;
+    sales.mTaxCollected = salesRecord.mTaxCollected;
+    sales.mMembershipFees = salesRecord.mMembershipFees;
+    sales.mCostOfGoods = salesRecord.mCostOfGoods;
+    sales.mProfit = salesRecord.mProfit;
+    copy(pHours, pHours + 24, sales.hourArr);
+    sales.aisleVec.assign(pAisleSales, pAisleSales + header.salesAisles.iCount);
+
+    if (!view.bStringsValid)
+    {
+        error.szMessage = "snapshot is truncated or damaged";
+        return false;
+    }
+
+    if (!restoreCatalogIndex(file, header, restored))
+    {
+        error.szMessage = "snapshot catalog index is damaged";
+        return false;
+    }
+
+    if (!restoreLineItems(file, header, restored))
+    {
+        error.szMessage = "snapshot line item log is damaged";
+        return false;
+    }
+
+    if (!restoreAnalytics(file, header, restored))
+    {
+        error.szMessage = "snapshot best seller sketches are damaged";
+        return false;
+    }
+
+    myStore = move(restored);
+    return true;
+}
+
+/*********************************************************************
+string promptForSnapshotFilename()
+Purpose:
+    Helper function ask the user for a snapshot file path
+Parameters:
+    -
+Return Value:
+    Snapshot path ending in .snap, or "EXIT"
+Notes:
+    -
+*********************************************************************/
+string promptForSnapshotFilename()
+{
+    string szFilename;
+
+    do
+    {
+        cout << "Please enter snapshot path: ";
+        getline(cin, szFilename);
+
+        if (szFilename == "EXIT" || szFilename == "exit")
+        {
+            return "EXIT";
+        }
+
+        bool isValidFile = szFilename.length() >= 5 &&
+                           szFilename.substr(szFilename.length() - 5) == ".snap" &&
+                           szFilename.find(' ') == string::npos;
+
+        if (isValidFile)
+        {
+            return szFilename;
+        }
+
+        cout << "Please enter a valid snapshot path" << endl;
+
+    } while (true);
+}
+
+/*********************************************************************
+void processSnapshotSave(Supermarket& myStore)
+Purpose:
+    Function to prompt for a path and save the store to a snapshot
+Parameters:
+    I/O Supermarket& myStore    Store to save
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee. Later changes
+    are journaled against the new snapshot.
+*********************************************************************/
+void processSnapshotSave(Supermarket& myStore)
+{
+    string szFilename = promptForSnapshotFilename();
+    if (szFilename == "EXIT")
+    {
+        cout << "Exiting function due to early exiting of file prompt." << endl;
+        return;
+    }
+
+    StoreFileError error;
+    if (saveStoreSnapshot(myStore, szFilename, error))
+    {
+        cout << "Snapshot saved to " << szFilename << endl;
+        attachJournal(myStore, szFilename, true);
+    }
+    else
+    {
+        cout << szFilename << ": " << error.szMessage << endl;
+    }
+}
+
+/*********************************************************************
+void processSnapshotLoad(Supermarket& myStore)
+Purpose:
+    Function to prompt for a path and restore the store from a snapshot
+Parameters:
+    I/O Supermarket& myStore    Store to replace
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processSnapshotLoad(Supermarket& myStore)
+{
+    string szFilename = promptForSnapshotFilename();
+    if (szFilename == "EXIT")
+    {
+        cout << "Exiting function due to early exiting of file prompt." << endl;
+        return;
+    }
+
+    if (loadSupermarketFile(szFilename, myStore))
+    {
+        cout << "Snapshot loaded from " << szFilename << endl;
+        attachJournal(myStore, szFilename, false);
+    }
+}
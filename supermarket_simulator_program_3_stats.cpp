@@ -0,0 +1,467 @@
+#include "supermarket_simulator_program_3.h"
+#include <bit>
+/*********************************************************************
+File name: supermarket_simulator_program_3_stats.cpp
+
+Purpose:
+    Count and time the hot paths of the store, and report latency
+    percentiles per path.
+
+Notes:
+    - Each thread records into its own block of counters, so recording
+      takes no lock and shares no cache line with other threads. The
+      owner updates a counter with a plain load and store, readers
+      merge every block under the registry lock.
+    - Latencies go into HDR-style log-linear buckets: exact below
+      64 ns, then 32 buckets per power of two, so a percentile is
+      within about 3% of the true value.
+    - A thread's block is folded into the retired totals when the
+      thread exits and reused by the next new thread, so short lived
+      lane and worker threads neither lose counts nor leak blocks.
+    - Building with -DSUPERMARKET_NO_STATS removes every probe, the
+      reports then say the stats were compiled out.
+*********************************************************************/
+
+// Names of the probes, in StatProbe order
+static const char* const szSTAT_PROBE_NAMES_ARR[STAT_PROBE_COUNT] = {
+    "file_load", "item_lookup", "member_lookup", "checkout", "checkout_commit", "payroll",
+    "server_request", "sale_queue"
+};
+
+// Latencies below this many nanoseconds get a bucket each
+static const uint64_t iSTAT_LINEAR_LIMIT = 64;
+
+// Buckets per power of two above the linear range, as a bit count
+static const int iSTAT_SUB_BUCKET_BITS = 5;
+
+// Largest power of two bucketed, longer latencies land in the top
+// bucket, 2^44 ns is nearly five hours
+static const int iSTAT_MAX_EXPONENT = 43;
+
+// Buckets per probe
+static const int iSTAT_BUCKETS = (int)iSTAT_LINEAR_LIMIT +
+                                 (iSTAT_MAX_EXPONENT - 5) * (1 << iSTAT_SUB_BUCKET_BITS);
+
+#ifndef SUPERMARKET_NO_STATS
+
+struct ProbeCounters
+{
+    atomic<uint64_t> iCount{0};
+    atomic<uint64_t> iSumNs{0};
+    atomic<uint64_t> iMaxNs{0};
+    atomic<uint64_t> bucketsArr[iSTAT_BUCKETS] = {};
+};
+
+struct alignas(64) ThreadStats
+{
+    ProbeCounters probesArr[STAT_PROBE_COUNT];
+};
+
+// Every block handed out, live threads' and retired ones, and the
+// blocks free for reuse
+static mutex statsLock;
+static vector<unique_ptr<ThreadStats>> statsVec;
+static vector<ThreadStats*> freeStatsVec;
+static ThreadStats retiredStats;
+
+/*********************************************************************
+static void clearThreadStats(ThreadStats& stats)
+Purpose:
+    Helper function to zero every counter in a block
+Parameters:
+    O   ThreadStats& stats  Block to clear
+Return Value:
+    -
+Notes:
+    -
+*********************************************************************/
+static void clearThreadStats(ThreadStats& stats)
+{
+    for (ProbeCounters& probe : stats.probesArr)
+    {
+        probe.iCount.store(0, memory_order_relaxed);
+        probe.iSumNs.store(0, memory_order_relaxed);
+        probe.iMaxNs.store(0, memory_order_relaxed);
+        for (atomic<uint64_t>& bucket : probe.bucketsArr)
+        {
+            bucket.store(0, memory_order_relaxed);
+        }
+    }
+}
+
+/*********************************************************************
+static void addThreadStats(ThreadStats& total, const ThreadStats& stats)
+Purpose:
+    Helper function to add one block of counters into another
+Parameters:
+    I/O ThreadStats& total      Block added into
+    I   ThreadStats stats       Block to add
+Return Value:
+    -
+Notes:
+    Caller holds statsLock
+*********************************************************************/
+static void addThreadStats(ThreadStats& total, const ThreadStats& stats)
+{
+    for (int i = 0; i < STAT_PROBE_COUNT; i++)
+    {
+        ProbeCounters& to = total.probesArr[i];
+        const ProbeCounters& from = stats.probesArr[i];
+        to.iCount.store(to.iCount.load(memory_order_relaxed) + from.iCount.load(memory_order_relaxed),
+                        memory_order_relaxed);
+        to.iSumNs.store(to.iSumNs.load(memory_order_relaxed) + from.iSumNs.load(memory_order_relaxed),
+                        memory_order_relaxed);
+        to.iMaxNs.store(max(to.iMaxNs.load(memory_order_relaxed), from.iMaxNs.load(memory_order_relaxed)),
+                        memory_order_relaxed);
+        for (int j = 0; j < iSTAT_BUCKETS; j++)
+        {
+            uint64_t iBucket = from.bucketsArr[j].load(memory_order_relaxed);
+            if (iBucket > 0)
+            {
+                to.bucketsArr[j].store(to.bucketsArr[j].load(memory_order_relaxed) + iBucket, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// Owns the calling thread's block, retiring it when the thread exits
+struct ThreadStatsHandle
+{
+    ThreadStats* pStats = nullptr;
+
+    ~ThreadStatsHandle()
+    {
+        if (pStats != nullptr)
+        {
+            lock_guard<mutex> guard(statsLock);
+            addThreadStats(retiredStats, *pStats);
+            clearThreadStats(*pStats);
+            freeStatsVec.push_back(pStats);
+        }
+    }
+};
+
+/*********************************************************************
+static ThreadStats& threadStats()
+Purpose:
+    Helper function to find the calling thread's block of counters
+Parameters:
+    -
+Return Value:
+    The thread's block, taken from the free list or made on first use
+Notes:
+    Only the first call on a thread takes the lock
+*********************************************************************/
+static ThreadStats& threadStats()
+{
+    thread_local ThreadStatsHandle handle;
+    if (handle.pStats == nullptr)
+    {
+        lock_guard<mutex> guard(statsLock);
+        if (!freeStatsVec.empty())
+        {
+            handle.pStats = freeStatsVec.back();
+            freeStatsVec.pop_back();
+        }
+        else
+        {
+            statsVec.push_back(make_unique<ThreadStats>());
+            handle.pStats = statsVec.back().get();
+        }
+    }
+    return *handle.pStats;
+}
+
+#endif
+
+/*********************************************************************
+static int statBucketIndex(uint64_t iNanoseconds)
+Purpose:
+    Helper function to find the bucket of a latency
+Parameters:
+    I   uint64_t iNanoseconds   Latency
+Return Value:
+    Bucket index, 0 up to but not including iSTAT_BUCKETS
+Notes:
+    Above the linear range the top bits after the leading one pick
+    the bucket within its power of two
+*********************************************************************/
+[[maybe_unused]] static int statBucketIndex(uint64_t iNanoseconds)
+{
+    if (iNanoseconds < iSTAT_LINEAR_LIMIT)
+    {
+        return (int)iNanoseconds;
+    }
+    int iExponent = bit_width(iNanoseconds) - 1;
+    if (iExponent > iSTAT_MAX_EXPONENT)
+    {
+        return iSTAT_BUCKETS - 1;
+    }
+    int iSubBucket = (int)((iNanoseconds >> (iExponent - iSTAT_SUB_BUCKET_BITS)) &
+                           ((1 << iSTAT_SUB_BUCKET_BITS) - 1));
+    return (int)iSTAT_LINEAR_LIMIT + (iExponent - 6) * (1 << iSTAT_SUB_BUCKET_BITS) + iSubBucket;
+}
+
+/*********************************************************************
+static uint64_t statBucketHighest(int iBucket)
+Purpose:
+    Helper function to find the longest latency a bucket holds
+Parameters:
+    I   int iBucket     Bucket index
+Return Value:
+    Longest latency in nanoseconds that lands in the bucket
+Notes:
+    Percentiles report this value, so they never understate
+*********************************************************************/
+[[maybe_unused]] static uint64_t statBucketHighest(int iBucket)
+{
+    if (iBucket < (int)iSTAT_LINEAR_LIMIT)
+    {
+        return (uint64_t)iBucket;
+    }
+    int iExponent = 6 + (iBucket - (int)iSTAT_LINEAR_LIMIT) / (1 << iSTAT_SUB_BUCKET_BITS);
+    int iSubBucket = (iBucket - (int)iSTAT_LINEAR_LIMIT) % (1 << iSTAT_SUB_BUCKET_BITS);
+    int iShift = iExponent - iSTAT_SUB_BUCKET_BITS;
+    return ((uint64_t)((1 << iSTAT_SUB_BUCKET_BITS) + iSubBucket + 1) << iShift) - 1;
+}
+
+#ifndef SUPERMARKET_NO_STATS
+
+/*********************************************************************
+void recordStat(StatProbe probe, uint64_t iNanoseconds)
+Purpose:
+    Function to record one timed run of a hot path
+Parameters:
+    I   StatProbe probe         Path that ran
+    I   uint64_t iNanoseconds   How long it took
+Return Value:
+    -
+Notes:
+    Called by StatTimer, use STAT_SCOPE rather than calling this
+*********************************************************************/
+void recordStat(StatProbe probe, uint64_t iNanoseconds)
+{
+    ProbeCounters& counters = threadStats().probesArr[probe];
+    atomic<uint64_t>& bucket = counters.bucketsArr[statBucketIndex(iNanoseconds)];
+    bucket.store(bucket.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    counters.iCount.store(counters.iCount.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    counters.iSumNs.store(counters.iSumNs.load(memory_order_relaxed) + iNanoseconds, memory_order_relaxed);
+    if (iNanoseconds > counters.iMaxNs.load(memory_order_relaxed))
+    {
+        counters.iMaxNs.store(iNanoseconds, memory_order_relaxed);
+    }
+}
+
+#endif
+
+/*********************************************************************
+vector<StatSummary> collectPerformanceStats()
+Purpose:
+    Function to merge every thread's counters into one summary per probe
+Parameters:
+    -
+Return Value:
+    Summary per probe, in StatProbe order, empty if compiled out
+Notes:
+    Runs alongside recording, a summary taken mid-run may be off by
+    the few records made while it was merged
+*********************************************************************/
+vector<StatSummary> collectPerformanceStats()
+{
+    vector<StatSummary> summariesVec;
+#ifndef SUPERMARKET_NO_STATS
+    unique_ptr<ThreadStats> pTotal = make_unique<ThreadStats>();
+    {
+        lock_guard<mutex> guard(statsLock);
+        addThreadStats(*pTotal, retiredStats);
+        for (const unique_ptr<ThreadStats>& pStats : statsVec)
+        {
+            addThreadStats(*pTotal, *pStats);
+        }
+    }
+
+    for (int i = 0; i < STAT_PROBE_COUNT; i++)
+    {
+        const ProbeCounters& probe = pTotal->probesArr[i];
+        StatSummary summary;
+        summary.szProbe = szSTAT_PROBE_NAMES_ARR[i];
+
+        // The buckets are read after the count, so sum them for the
+        // count the percentiles are taken over
+        uint64_t iCount = 0;
+        for (const atomic<uint64_t>& bucket : probe.bucketsArr)
+        {
+            iCount += bucket.load(memory_order_relaxed);
+        }
+        summary.lCount = (long long)iCount;
+        summary.lMaxNs = (long long)probe.iMaxNs.load(memory_order_relaxed);
+        if (iCount > 0)
+        {
+            summary.dMeanNs = (double)probe.iSumNs.load(memory_order_relaxed) / (double)iCount;
+
+            // Walk the buckets once, filling each percentile as its
+            // rank is passed
+            const double dQuantilesArr[4] = {0.50, 0.90, 0.99, 0.999};
+            long long* pValuesArr[4] = {&summary.lP50Ns, &summary.lP90Ns, &summary.lP99Ns, &summary.lP999Ns};
+            int iNext = 0;
+            uint64_t iSeen = 0;
+            for (int j = 0; j < iSTAT_BUCKETS && iNext < 4; j++)
+            {
+                iSeen += probe.bucketsArr[j].load(memory_order_relaxed);
+                while (iNext < 4 && iSeen >= (uint64_t)ceil(dQuantilesArr[iNext] * (double)iCount))
+                {
+                    *pValuesArr[iNext] = min((long long)statBucketHighest(j), summary.lMaxNs);
+                    iNext++;
+                }
+            }
+        }
+        summariesVec.push_back(summary);
+    }
+#endif
+    return summariesVec;
+}
+
+/*********************************************************************
+void resetPerformanceStats()
+Purpose:
+    Function to clear every thread's counters
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    Records made by other threads while this runs may survive it
+*********************************************************************/
+void resetPerformanceStats()
+{
+#ifndef SUPERMARKET_NO_STATS
+    lock_guard<mutex> guard(statsLock);
+    clearThreadStats(retiredStats);
+    for (const unique_ptr<ThreadStats>& pStats : statsVec)
+    {
+        clearThreadStats(*pStats);
+    }
+#endif
+}
+
+/*********************************************************************
+void displayPerformanceStats()
+Purpose:
+    Function to display the count and latency percentiles of each probe
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    Latencies are shown in microseconds
+*********************************************************************/
+void displayPerformanceStats()
+{
+    vector<StatSummary> summariesVec = collectPerformanceStats();
+    cout << "Performance Stats" << endl;
+    cout << szBreakMessage;
+    if (summariesVec.empty())
+    {
+        cout << "Stats were compiled out of this build." << endl;
+        cout << szBreakMessage;
+        return;
+    }
+
+    cout << left << setw(17) << "Probe" << right << setw(12) << "Count" << setw(11) << "Mean us"
+         << setw(11) << "p50 us" << setw(11) << "p90 us" << setw(11) << "p99 us"
+         << setw(11) << "p99.9 us" << setw(12) << "Max us" << endl;
+    cout << fixed << setprecision(3);
+    for (const StatSummary& summary : summariesVec)
+    {
+        cout << left << setw(17) << summary.szProbe << right << setw(12) << summary.lCount;
+        if (summary.lCount == 0)
+        {
+            cout << setw(11) << "-" << setw(11) << "-" << setw(11) << "-" << setw(11) << "-"
+                 << setw(11) << "-" << setw(12) << "-" << endl;
+            continue;
+        }
+        cout << setw(11) << summary.dMeanNs / 1000.0 << setw(11) << summary.lP50Ns / 1000.0
+             << setw(11) << summary.lP90Ns / 1000.0 << setw(11) << summary.lP99Ns / 1000.0
+             << setw(11) << summary.lP999Ns / 1000.0 << setw(12) << summary.lMaxNs / 1000.0 << endl;
+    }
+    cout << setprecision(2);
+    cout << szBreakMessage;
+}
+
+/*********************************************************************
+bool dumpPerformanceStats(const string& szFilename)
+Purpose:
+    Function to write the summary of each probe to a report file
+Parameters:
+    I   string szFilename       Report file, .json for JSON
+Return Value:
+    True if the whole report was written, else false
+Notes:
+    Latencies are written in nanoseconds. A build without stats
+    writes the columns and no rows.
+*********************************************************************/
+bool dumpPerformanceStats(const string& szFilename)
+{
+    ReportWriter writer;
+    if (!writer.open(szFilename, reportFormatForFile(szFilename),
+                     {"probe", "count", "mean_ns", "p50_ns", "p90_ns", "p99_ns", "p999_ns", "max_ns"}))
+    {
+        return false;
+    }
+
+    for (const StatSummary& summary : collectPerformanceStats())
+    {
+        writer.field(summary.szProbe);
+        writer.field(summary.lCount);
+        writer.field((long long)llround(summary.dMeanNs));
+        writer.field(summary.lP50Ns);
+        writer.field(summary.lP90Ns);
+        writer.field(summary.lP99Ns);
+        writer.field(summary.lP999Ns);
+        writer.field(summary.lMaxNs);
+        writer.endRow();
+    }
+    return writer.close();
+}
+
+/*********************************************************************
+void processPerformanceStats()
+Purpose:
+    Function to display the performance stats and offer to dump or
+    clear them
+Parameters:
+    -
+Return Value:
+    -
+Notes:
+    This function should only be called by an employee
+*********************************************************************/
+void processPerformanceStats()
+{
+    string szFilename;
+    char cReset = 'n';
+
+    displayPerformanceStats();
+
+    cout << "Enter file to dump stats to (.json for JSON, - for none): ";
+    cin >> szFilename;
+    if (szFilename != "-")
+    {
+        if (dumpPerformanceStats(szFilename))
+        {
+            cout << "Stats written to " << szFilename << endl;
+        }
+        else
+        {
+            cout << szFilename << ": stats could not be written" << endl;
+        }
+    }
+
+    cout << "Reset stats? (y/n): ";
+    cin >> cReset;
+    if (cReset == 'y' || cReset == 'Y')
+    {
+        resetPerformanceStats();
+        cout << "Stats reset." << endl;
+    }
+}